@@ -22,7 +22,9 @@ import os, sys, threading, time, subprocess
 from multiprocessing import cpu_count
 from collections import deque
 
-mapList = deque([0,1,13,25,30,33,34,35,36,37,42,43,44,47,48,70,90,109,129,169,189,209,229,230,249,269,289,309,329,349,369,
+# Continents are built one at a time with all the threads, other maps in parallel processes
+continentList = [0,1]
+mapList = deque([13,25,30,33,34,35,36,37,42,43,44,47,48,70,90,109,129,169,189,209,229,230,249,269,289,309,329,349,369,
     389,409,429,449,450,451,469,489,509,529,531,533])
 
 class workerThread(threading.Thread):
@@ -50,6 +52,10 @@ if __name__ == "__main__":
     cpu = cpu_count() - 0 # You can reduce the load by putting 1 instead of 0 if you need to free 1 core/cpu
     if cpu < 1:
         cpu = 1
+    for mapID in continentList:
+        print "++ Map %u on %u threads" % (mapID, cpu)
+        subprocess.call(["MoveMapGen.exe" if sys.platform == 'win32' else "./MoveMapGen", "%u" % (mapID), "--silent", "--threads", "%u" % (cpu)])
+        print "-- Map %u" % (mapID)
     print "I will always maintain %u MoveMapGen tasks running in //\n" % (cpu)
     while (len(mapList) > 0):
         if (threading.active_count() <= cpu):
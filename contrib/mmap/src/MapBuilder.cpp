@@ -17,6 +17,7 @@
  */
 
 #include <list>
+#include <thread>
 #include "MMapCommon.h"
 #include "MapBuilder.h"
 
@@ -37,6 +38,37 @@ inline void calcTriNormal(const float* v0, const float* v1, const float* v2, flo
     rcVnormalize(norm);
 }
 
+// FNV-1a, tiles inputs hash for incremental builds
+static const uint64 FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const uint64 FNV_PRIME = 1099511628211ULL;
+
+inline void hashBytes(uint64& hash, void const* data, size_t size)
+{
+    unsigned char const* bytes = (unsigned char const*)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+}
+
+void hashFile(uint64& hash, char const* fileName)
+{
+    FILE* file = fopen(fileName, "rb");
+    if (!file)
+    {
+        // a missing file is an input as well
+        hashBytes(hash, "-", 1);
+        return;
+    }
+
+    char buffer[4096];
+    size_t size;
+    while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        hashBytes(hash, buffer, size);
+    fclose(file);
+}
+
 inline unsigned int nextPow2(unsigned int v)
 {
         v--;
@@ -227,15 +259,19 @@ namespace MMAP
 {
     MapBuilder::MapBuilder(float maxWalkableAngle, bool skipLiquid,
                            bool skipContinents, bool skipJunkMaps, bool skipBattlegrounds,
-                           bool debugOutput, bool bigBaseUnit, bool quick, const char* offMeshFilePath) :
+                           bool debugOutput, bool bigBaseUnit, bool quick, const char* offMeshFilePath,
+                           uint32 threads, bool incremental) :
         m_terrainBuilder(NULL),
         m_debugOutput(debugOutput),
         m_skipContinents(skipContinents),
         m_skipJunkMaps(skipJunkMaps),
         m_skipBattlegrounds(skipBattlegrounds),
+        m_skipLiquid(skipLiquid),
         m_maxWalkableAngle(maxWalkableAngle),
         m_bigBaseUnit(bigBaseUnit),
         m_quick(quick),
+        m_threads(threads ? threads : 1),
+        m_incremental(incremental),
         m_rcContext(NULL),
         m_offMeshFilePath(offMeshFilePath)
     {
@@ -414,7 +450,11 @@ namespace MMAP
             return;
         }
 
-        buildTile(mapID, tileX, tileY, navMesh);
+        TileBuilderContext ctx;
+        ctx.terrainBuilder = m_terrainBuilder;
+        ctx.context = m_rcContext;
+        ctx.navMesh = navMesh;
+        buildTile(mapID, tileX, tileY, ctx);
         dtFreeNavMesh(navMesh);
     }
 
@@ -450,8 +490,12 @@ namespace MMAP
             return;
         }
 
-        // now start building mmtiles for each tile
-        printf("We have %u tiles.                          \n", (unsigned int)tiles->size());
+        // tiles with unchanged inputs since last build are skipped
+        TileHashes previousHashes, hashes, buildHashes;
+        if (m_incremental)
+            loadTileHashes(mapID, previousHashes);
+
+        vector<uint32> tilesToBuild;
         for (set<uint32>::iterator it = tiles->begin(); it != tiles->end(); ++it)
         {
             uint32 tileX, tileY;
@@ -459,54 +503,130 @@ namespace MMAP
             // unpack tile coords
             StaticMapTree::unpackTileID((*it), tileX, tileY);
 
-            if (shouldSkipTile(mapID, tileX, tileY))
+            uint64 hash = getTileHash(mapID, tileX, tileY);
+            if (shouldSkipTile(mapID, tileX, tileY, previousHashes, hash))
+            {
+                hashes[*it] = hash;
                 continue;
+            }
 
-            buildTile(mapID, tileX, tileY, navMesh);
+            tilesToBuild.push_back(*it);
+            buildHashes[*it] = hash;
         }
 
+        // now start building mmtiles for each tile
+        printf("We have %u tiles, %u to build on %u threads.                          \n",
+               (unsigned int)tiles->size(), (unsigned int)tilesToBuild.size(), m_threads);
+
+        buildTiles(mapID, tilesToBuild, navMesh, buildHashes, hashes);
+
         dtFreeNavMesh(navMesh);
 
+        saveTileHashes(mapID, hashes);
+
         printf("Complete!                               \n\n");
     }
 
     /**************************************************************************/
-    void MapBuilder::buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh)
+    void MapBuilder::buildTiles(uint32 mapID, vector<uint32> const& tiles, dtNavMesh* navMesh, TileHashes const& hashes, TileHashes& builtHashes)
+    {
+        uint32 threads = m_threads;
+        if (threads > tiles.size())
+            threads = tiles.size();
+        if (!threads)
+            return;
+
+        // First context is the builder one (current thread), others have their own terrain and navmesh
+        vector<TileBuilderContext> contexts(threads);
+        contexts[0].terrainBuilder = m_terrainBuilder;
+        contexts[0].context = m_rcContext;
+        contexts[0].navMesh = navMesh;
+        for (uint32 i = 1; i < threads; ++i)
+        {
+            contexts[i].terrainBuilder = new TerrainBuilder(m_skipLiquid, m_quick);
+            contexts[i].context = new rcContext(false);
+            contexts[i].navMesh = dtAllocNavMesh();
+            if (!contexts[i].navMesh->init(navMesh->getParams()))
+            {
+                printf("Failed creating navmesh!                \n");
+                exit(1);
+            }
+        }
+
+        // tiles are picked in order by the threads as they get free
+        atomic<uint32> nextTile(0);
+        vector<vector<uint32> > built(threads);
+        vector<std::thread> workers;
+        for (uint32 i = 1; i < threads; ++i)
+            workers.push_back(std::thread(&MapBuilder::buildTilesWorker, this, mapID, std::cref(tiles), &nextTile, &contexts[i], &built[i]));
+        buildTilesWorker(mapID, tiles, &nextTile, &contexts[0], &built[0]);
+
+        for (uint32 i = 0; i < workers.size(); ++i)
+            workers[i].join();
+
+        for (uint32 i = 1; i < threads; ++i)
+        {
+            dtFreeNavMesh(contexts[i].navMesh);
+            delete contexts[i].context;
+            delete contexts[i].terrainBuilder;
+        }
+
+        // failed tiles have no hash: they will be built again next time
+        for (uint32 i = 0; i < threads; ++i)
+            for (vector<uint32>::const_iterator it = built[i].begin(); it != built[i].end(); ++it)
+                builtHashes[*it] = hashes.find(*it)->second;
+    }
+
+    /**************************************************************************/
+    void MapBuilder::buildTilesWorker(uint32 mapID, vector<uint32> const& tiles, atomic<uint32>* nextTile, TileBuilderContext* ctx, vector<uint32>* built)
+    {
+        for (uint32 i = (*nextTile)++; i < tiles.size(); i = (*nextTile)++)
+        {
+            uint32 tileX, tileY;
+            StaticMapTree::unpackTileID(tiles[i], tileX, tileY);
+            if (buildTile(mapID, tileX, tileY, *ctx))
+                built->push_back(tiles[i]);
+        }
+    }
+
+    /**************************************************************************/
+    bool MapBuilder::buildTile(uint32 mapID, uint32 tileX, uint32 tileY, TileBuilderContext& ctx)
     {
         printf("Building map %03u, tile [%02u,%02u]\n", mapID, tileX, tileY);
 
         MeshData meshData;
 
         // get heightmap data
-        m_terrainBuilder->loadMap(mapID, tileX, tileY, meshData);
+        ctx.terrainBuilder->loadMap(mapID, tileX, tileY, meshData);
 
         // remove unused vertices
         TerrainBuilder::cleanVertices(meshData.solidVerts, meshData.solidTris);
         TerrainBuilder::cleanVertices(meshData.liquidVerts, meshData.liquidTris);
 
-        m_terrainBuilder->loadVMap(mapID, tileY, tileX, meshData); // get model data
+        ctx.terrainBuilder->loadVMap(mapID, tileY, tileX, meshData); // get model data
         //TerrainBuilder::cleanVertices(meshData.solidVerts, meshData.solidTris);
 
         // if there is no data, give up now
         if (!meshData.solidVerts.size() && !meshData.liquidVerts.size())
-            return;
+        {
+            ctx.terrainBuilder->unloadVMap(mapID, tileY, tileX);
+            return true;
+        }
         // gather all mesh data for final data check, and bounds calculation
         G3D::Array<float> allVerts;
         allVerts.append(meshData.liquidVerts);
         allVerts.append(meshData.solidVerts);
 
-        if (!allVerts.size())
-            return;
-
         // get bounds of current tile
         float bmin[3], bmax[3];
         getTileBounds(tileX, tileY, allVerts.getCArray(), allVerts.size() / 3, bmin, bmax);
 
-        m_terrainBuilder->loadOffMeshConnections(mapID, tileX, tileY, meshData, m_offMeshFilePath);
+        ctx.terrainBuilder->loadOffMeshConnections(mapID, tileX, tileY, meshData, m_offMeshFilePath);
 
         // build navmesh tile
-        buildMoveMapTile(mapID, tileX, tileY, meshData, bmin, bmax, navMesh);
-        m_terrainBuilder->unloadVMap(mapID, tileY, tileX);
+        bool built = buildMoveMapTile(mapID, tileX, tileY, meshData, bmin, bmax, ctx);
+        ctx.terrainBuilder->unloadVMap(mapID, tileY, tileX);
+        return built;
     }
 
     /**************************************************************************/
@@ -575,9 +695,9 @@ namespace MMAP
     }
 
     /**************************************************************************/
-    void MapBuilder::buildMoveMapTile(uint32 mapID, uint32 tileX, uint32 tileY,
+    bool MapBuilder::buildMoveMapTile(uint32 mapID, uint32 tileX, uint32 tileY,
                                       MeshData& meshData, float bmin[3], float bmax[3],
-                                      dtNavMesh* navMesh)
+                                      TileBuilderContext& ctx)
     {
         // console output
         char tileString[10];
@@ -683,7 +803,7 @@ namespace MMAP
                 // NOSTALRIUS - MMAPS TILE GENERATION
                 /// 1. Alloc heightfield for walkable areas
                 tile.solid = rcAllocHeightfield();
-                if (!tile.solid || !rcCreateHeightfield(m_rcContext, *tile.solid, tileCfg.width, tileCfg.height, tileCfg.bmin, tileCfg.bmax, tileCfg.cs, tileCfg.ch))
+                if (!tile.solid || !rcCreateHeightfield(ctx.context, *tile.solid, tileCfg.width, tileCfg.height, tileCfg.bmin, tileCfg.bmax, tileCfg.cs, tileCfg.ch))
                 {
                     printf("%sFailed building heightfield!            \n", tileString);
                     continue;
@@ -692,12 +812,12 @@ namespace MMAP
                 /// 2. Generate heightfield for water. Put all liquid geometry there
                 // We need to build liquid heighfield to set poly swim flag under.
                 liquidsTile.solid = rcAllocHeightfield();
-                if (!liquidsTile.solid || !rcCreateHeightfield(m_rcContext, *liquidsTile.solid, tileCfg.width, tileCfg.height, tileCfg.bmin, tileCfg.bmax, tileCfg.cs, tileCfg.ch))
+                if (!liquidsTile.solid || !rcCreateHeightfield(ctx.context, *liquidsTile.solid, tileCfg.width, tileCfg.height, tileCfg.bmin, tileCfg.bmax, tileCfg.cs, tileCfg.ch))
                 {
                     printf("%sFailed building liquids heightfield!            \n", tileString);
                     continue;
                 }
-                rcRasterizeTriangles(m_rcContext, lVerts, lVertCount, lTris, lTriAreas, lTriCount, *liquidsTile.solid, 0);
+                rcRasterizeTriangles(ctx.context, lVerts, lVertCount, lTris, lTriAreas, lTriCount, *liquidsTile.solid, 0);
 
                 /// 3. Mark all triangles with correct flags:
                 // Can't use rcMarkWalkableTriangles. We need something really more specific.
@@ -748,9 +868,9 @@ namespace MMAP
                             for (int v = 0; v < 3; ++v) // Coordinate
                                 verts[3*c + v] = (5*tVerts[tri[c]*3 + v] + tVerts[tri[(c+1)%3]*3 + v] + tVerts[tri[(c+2)%3]*3 + v]) / 7;
                         // A triangle is undermap if all corners are undermap
-                        bool undermap1 = m_terrainBuilder->IsUnderMap(&verts[0]);
-                        bool undermap2 = m_terrainBuilder->IsUnderMap(&verts[3]);
-                        bool undermap3 = m_terrainBuilder->IsUnderMap(&verts[6]);
+                        bool undermap1 = ctx.terrainBuilder->IsUnderMap(&verts[0]);
+                        bool undermap2 = ctx.terrainBuilder->IsUnderMap(&verts[3]);
+                        bool undermap3 = ctx.terrainBuilder->IsUnderMap(&verts[6]);
 
                         if ((undermap1 + undermap2 + undermap3) == 3)
                         {
@@ -760,7 +880,7 @@ namespace MMAP
                     }
                 }
                 /// 4. Every triangle is correctly marked now, we can rasterize everything
-                rcRasterizeTriangles(m_rcContext, tVerts, tVertCount, tTris, areas, tTriCount, *tile.solid, 0);
+                rcRasterizeTriangles(ctx.context, tVerts, tVertCount, tTris, areas, tTriCount, *tile.solid, 0);
                 delete [] areas;
 
                 /// 5. Don't walk over too high Obstacles.
@@ -768,17 +888,17 @@ namespace MMAP
                 // But for terrain->vmap->terrain kind of obstacles, it's harder to climb.
                 // (Why? No idea, ask Blizzard. Empirically confirmed on retail)
                 // 5.1 walkableClimbTerrain >= walkableClimbModelTransition so do it first
-                rcFilterLowHangingWalkableObstacles(m_rcContext, walkableClimbTerrain, *tile.solid);
+                rcFilterLowHangingWalkableObstacles(ctx.context, walkableClimbTerrain, *tile.solid);
                 // 5.2 maps <-> vmaps transition
                 filterLedgeSpans(tileCfg.walkableHeight, walkableClimbModelTransition, walkableClimbTerrain, *tile.solid);
-                //rcFilterLedgeSpans(m_rcContext, tileCfg.walkableHeight, walkableClimbTerrain, *tile.solid); // Default recast code
+                //rcFilterLedgeSpans(ctx.context, tileCfg.walkableHeight, walkableClimbTerrain, *tile.solid); // Default recast code
 
                 /// 6. Now we are happy because we have the correct flags.
                 // Set's cleanup tmp flags used by the generator, so we don't have a too
                 // complicated navmesh in the end.
                 // (We dont care if a poly comes from Terrain or Model at runtime)
                 filterRemoveUselessAreas(*tile.solid);
-                rcFilterWalkableLowHeightSpans(m_rcContext, tileCfg.walkableHeight, *tile.solid);
+                rcFilterWalkableLowHeightSpans(ctx.context, tileCfg.walkableHeight, *tile.solid);
 
 
                 /// 7. Let's process water now.
@@ -790,33 +910,33 @@ namespace MMAP
                 /// 8. Now let's move on with the last and more generic steps of navmesh generation.
                 // compact heightfield spans
                 tile.chf = rcAllocCompactHeightfield();
-                if (!tile.chf || !rcBuildCompactHeightfield(m_rcContext, tileCfg.walkableHeight, walkableClimbTerrain, *tile.solid, *tile.chf))
+                if (!tile.chf || !rcBuildCompactHeightfield(ctx.context, tileCfg.walkableHeight, walkableClimbTerrain, *tile.solid, *tile.chf))
                 {
                     printf("%sFailed compacting heightfield!            \n", tileString);
                     continue;
                 }
 
                 // build polymesh intermediates
-                if (!rcErodeWalkableArea(m_rcContext, config.walkableRadius, *tile.chf))
+                if (!rcErodeWalkableArea(ctx.context, config.walkableRadius, *tile.chf))
                 {
                     printf("%sFailed eroding area!                    \n", tileString);
                     continue;
                 }
 
-                if (!rcBuildDistanceField(m_rcContext, *tile.chf))
+                if (!rcBuildDistanceField(ctx.context, *tile.chf))
                 {
                     printf("%sFailed building distance field!         \n", tileString);
                     continue;
                 }
 
-                if (!rcBuildRegions(m_rcContext, *tile.chf, tileCfg.borderSize, tileCfg.minRegionArea, tileCfg.mergeRegionArea))
+                if (!rcBuildRegions(ctx.context, *tile.chf, tileCfg.borderSize, tileCfg.minRegionArea, tileCfg.mergeRegionArea))
                 {
                     printf("%sFailed building regions!                \n", tileString);
                     continue;
                 }
 
                 tile.cset = rcAllocContourSet();
-                if (!tile.cset || !rcBuildContours(m_rcContext, *tile.chf, tileCfg.maxSimplificationError, tileCfg.maxEdgeLen, *tile.cset))
+                if (!tile.cset || !rcBuildContours(ctx.context, *tile.chf, tileCfg.maxSimplificationError, tileCfg.maxEdgeLen, *tile.cset))
                 {
                     printf("%sFailed building contours!               \n", tileString);
                     continue;
@@ -824,14 +944,14 @@ namespace MMAP
 
                 // build polymesh
                 tile.pmesh = rcAllocPolyMesh();
-                if (!tile.pmesh || !rcBuildPolyMesh(m_rcContext, *tile.cset, tileCfg.maxVertsPerPoly, *tile.pmesh))
+                if (!tile.pmesh || !rcBuildPolyMesh(ctx.context, *tile.cset, tileCfg.maxVertsPerPoly, *tile.pmesh))
                 {
                     printf("%sFailed building polymesh!               \n", tileString);
                     continue;
                 }
 
                 tile.dmesh = rcAllocPolyMeshDetail();
-                if (!tile.dmesh || !rcBuildPolyMeshDetail(m_rcContext, *tile.pmesh, *tile.chf, tileCfg.detailSampleDist, tileCfg.detailSampleMaxError, *tile.dmesh))
+                if (!tile.dmesh || !rcBuildPolyMeshDetail(ctx.context, *tile.pmesh, *tile.chf, tileCfg.detailSampleDist, tileCfg.detailSampleMaxError, *tile.dmesh))
                 {
                     printf("%sFailed building polymesh detail!        \n", tileString);
                     continue;
@@ -855,7 +975,7 @@ namespace MMAP
         {
             printf("%s alloc pmmerge FAILED!          \r", tileString);
             delete [] tiles;
-            return;
+            return false;
         }
 
         rcPolyMeshDetail** dmmerge = new rcPolyMeshDetail*[TILES_PER_MAP * TILES_PER_MAP];
@@ -864,7 +984,7 @@ namespace MMAP
             printf("%s alloc dmmerge FAILED!          \r", tileString);
             delete [] tiles;
             delete [] pmmerge;
-            return;
+            return false;
         }
 
         int nmerge = 0;
@@ -889,9 +1009,9 @@ namespace MMAP
             delete[] pmmerge;
             delete[] dmmerge;
             printf("%s alloc iv.polyMesh FAILED!          \r", tileString);
-            return;
+            return false;
         }
-        rcMergePolyMeshes(m_rcContext, pmmerge, nmerge, *iv.polyMesh);
+        rcMergePolyMeshes(ctx.context, pmmerge, nmerge, *iv.polyMesh);
 
         iv.polyMeshDetail = rcAllocPolyMeshDetail();
         if (!iv.polyMeshDetail)
@@ -900,9 +1020,9 @@ namespace MMAP
             delete[] tiles;
             delete[] pmmerge;
             delete[] dmmerge;
-            return;
+            return false;
         }
-        rcMergePolyMeshDetails(m_rcContext, dmmerge, nmerge, *iv.polyMeshDetail);
+        rcMergePolyMeshDetails(ctx.context, dmmerge, nmerge, *iv.polyMeshDetail);
 
         // free things up
         delete [] pmmerge;
@@ -969,8 +1089,8 @@ namespace MMAP
         params.walkableHeight = agentHeight;  // agent height
         params.walkableRadius = agentRadius;  // agent radius
         params.walkableClimb = agentMaxClimbTerrain;    // keep less that walkableHeight (aka agent height)!
-        params.tileX = (((bmin[0] + bmax[0]) / 2) - navMesh->getParams()->orig[0]) / GRID_SIZE;
-        params.tileY = (((bmin[2] + bmax[2]) / 2) - navMesh->getParams()->orig[2]) / GRID_SIZE;
+        params.tileX = (((bmin[0] + bmax[0]) / 2) - ctx.navMesh->getParams()->orig[0]) / GRID_SIZE;
+        params.tileY = (((bmin[2] + bmax[2]) / 2) - ctx.navMesh->getParams()->orig[2]) / GRID_SIZE;
         params.tileLayer = 0;
         params.buildBvTree = true;
         rcVcopy(params.bmin, bmin);
@@ -981,6 +1101,8 @@ namespace MMAP
         // will hold final navmesh
         unsigned char* navData = NULL;
         int navDataSize = 0;
+        // tile written, or nothing to build there
+        bool built = false;
 
         do
         {
@@ -1004,6 +1126,7 @@ namespace MMAP
 
                 // message is an annoyance
                 //printf("%sNo vertices to build tile!              \n", tileString);
+                built = true;
                 continue;
             }
             if (!params.polyCount || !params.polys ||
@@ -1013,6 +1136,7 @@ namespace MMAP
                 // keep in mind that we do output those into debug info
                 // drop tiles with only exact count - some tiles may have geometry while having less tiles
                 printf("%s No polygons to build on tile!              \n", tileString);
+                built = true;
                 continue;
             }
             if (!params.detailMeshes || !params.detailVerts || !params.detailTris)
@@ -1028,18 +1152,8 @@ namespace MMAP
                 continue;
             }
 
-            dtTileRef tileRef = 0;
-            printf("%s Adding tile to navmesh...                \r", tileString);
-            // DT_TILE_FREE_DATA tells detour to unallocate memory when the tile
-            // is removed via removeTile()
-            dtStatus dtResult = navMesh->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, &tileRef);
-            if (!tileRef || dtStatusFailed(dtResult))
-            {
-                printf("%s Failed adding tile to navmesh (0x%x)   \n", tileString, dtResult);
-                continue;
-            }
-
-            // file output
+            // file output - before adding the tile: addTile() fills the links with tile
+            // references that depend on the build order, they are rebuilt on load anyway
             char fileName[255];
             sprintf(fileName, "mmaps/%03u%02i%02i.mmtile", mapID, tileY, tileX);
             FILE* file = fopen(fileName, "wb");
@@ -1048,15 +1162,19 @@ namespace MMAP
                 char message[1024];
                 sprintf(message, "Failed to open %s for writing!\n", fileName);
                 perror(message);
-                navMesh->removeTile(tileRef, NULL, NULL);
+                dtFree(navData);
                 continue;
             }
 
             printf("%s Writing to file...                      \r", tileString);
 
-            // write header
+            // write header - padding is zeroed so that identical tiles give identical files
             MmapTileHeader header;
-            header.usesLiquids = m_terrainBuilder->usesLiquids();
+            memset(&header, 0, sizeof(MmapTileHeader));
+            header.mmapMagic = MMAP_MAGIC;
+            header.dtVersion = DT_NAVMESH_VERSION;
+            header.mmapVersion = MMAP_VERSION;
+            header.usesLiquids = ctx.terrainBuilder->usesLiquids();
             header.size = uint32(navDataSize);
             fwrite(&header, sizeof(MmapTileHeader), 1, file);
 
@@ -1064,6 +1182,19 @@ namespace MMAP
             fwrite(navData, sizeof(unsigned char), navDataSize, file);
             fclose(file);
 
+            dtTileRef tileRef = 0;
+            printf("%s Adding tile to navmesh...                \r", tileString);
+            // DT_TILE_FREE_DATA tells detour to unallocate memory when the tile
+            // is removed via removeTile()
+            dtStatus dtResult = ctx.navMesh->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, &tileRef);
+            if (!tileRef || dtStatusFailed(dtResult))
+            {
+                printf("%s Failed adding tile to navmesh (0x%x)   \n", tileString, dtResult);
+                remove(fileName);
+                dtFree(navData);
+                continue;
+            }
+
             if (m_debugOutput)
             {
                 iv.generateObjFile(mapID, tileX, tileY, meshData);
@@ -1080,9 +1211,12 @@ namespace MMAP
                 }
             }
             // now that tile is written to disk, we can unload it
-            navMesh->removeTile(tileRef, NULL, NULL);
+            ctx.navMesh->removeTile(tileRef, NULL, NULL);
+            built = true;
         }
         while (0);
+
+        return built;
     }
 
     /**************************************************************************/
@@ -1156,13 +1290,18 @@ namespace MMAP
     }
 
     /**************************************************************************/
-    bool MapBuilder::shouldSkipTile(uint32 mapID, uint32 tileX, uint32 tileY)
+    bool MapBuilder::shouldSkipTile(uint32 mapID, uint32 tileX, uint32 tileY, TileHashes const& hashes, uint64 hash)
     {
+        // inputs changed since last build, or not built yet
+        TileHashes::const_iterator itr = hashes.find(StaticMapTree::packTileID(tileX, tileY));
+        if (itr == hashes.end() || itr->second != hash)
+            return false;
+
         char fileName[255];
         sprintf(fileName, "mmaps/%03u%02i%02i.mmtile", mapID, tileY, tileX);
         FILE* file = fopen(fileName, "rb");
         if (!file)
-            return false;
+            return true;                                    // nothing to build on this tile
 
         MmapTileHeader header;
         fread(&header, sizeof(MmapTileHeader), 1, file);
@@ -1173,9 +1312,90 @@ namespace MMAP
 
         if (header.mmapVersion != MMAP_VERSION)
             return false;
-        return false;
         return true;
     }
+
+    /**************************************************************************/
+    uint64 MapBuilder::getTileHash(uint32 mapID, uint32 tileX, uint32 tileY)
+    {
+        uint64 hash = FNV_OFFSET_BASIS;
+
+        // generation settings
+        uint32 settings[] = { MMAP_VERSION, DT_NAVMESH_VERSION, m_bigBaseUnit, m_quick, m_skipLiquid };
+        hashBytes(hash, settings, sizeof(settings));
+        hashBytes(hash, &m_maxWalkableAngle, sizeof(m_maxWalkableAngle));
+
+        // terrain of the tile and borders of its neighbours, see TerrainBuilder::loadMap
+        static const int neighbours[5][2] = { {0, 0}, {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+        char fileName[255];
+        for (int i = 0; i < 5; ++i)
+        {
+            sprintf(fileName, "maps/%03u%02u%02u.map", mapID, tileY + neighbours[i][1], tileX + neighbours[i][0]);
+            hashFile(hash, fileName);
+        }
+
+        // models, see TerrainBuilder::loadVMap
+        sprintf(fileName, "vmaps/%03u.vmtree", mapID);
+        hashFile(hash, fileName);
+        hashFile(hash, ("vmaps/" + StaticMapTree::getTileFileName(mapID, tileY, tileX)).c_str());
+
+        // off mesh connections, see TerrainBuilder::loadOffMeshConnections
+        if (m_offMeshFilePath)
+        {
+            if (FILE* fp = fopen(m_offMeshFilePath, "rb"))
+            {
+                char buf[512];
+                while (fgets(buf, 512, fp))
+                {
+                    int mid, tx, ty;
+                    if (3 == sscanf(buf, "%d %d,%d", &mid, &tx, &ty) && mapID == mid && tileX == tx && tileY == ty)
+                        hashBytes(hash, buf, strlen(buf));
+                }
+                fclose(fp);
+            }
+        }
+
+        return hash;
+    }
+
+    /**************************************************************************/
+    void MapBuilder::loadTileHashes(uint32 mapID, TileHashes& hashes)
+    {
+        char fileName[25];
+        sprintf(fileName, "mmaps/%03u.mmhash", mapID);
+        FILE* file = fopen(fileName, "r");
+        if (!file)
+            return;
+
+        uint32 tileX, tileY;
+        unsigned long long hash;
+        while (fscanf(file, "%u %u %llx", &tileX, &tileY, &hash) == 3)
+            hashes[StaticMapTree::packTileID(tileX, tileY)] = hash;
+        fclose(file);
+    }
+
+    /**************************************************************************/
+    void MapBuilder::saveTileHashes(uint32 mapID, TileHashes const& hashes)
+    {
+        char fileName[25];
+        sprintf(fileName, "mmaps/%03u.mmhash", mapID);
+        FILE* file = fopen(fileName, "w");
+        if (!file)
+        {
+            char message[1024];
+            sprintf(message, "Failed to open %s for writing!\n", fileName);
+            perror(message);
+            return;
+        }
+
+        for (TileHashes::const_iterator it = hashes.begin(); it != hashes.end(); ++it)
+        {
+            uint32 tileX, tileY;
+            StaticMapTree::unpackTileID(it->first, tileX, tileY);
+            fprintf(file, "%02u %02u %016llx\n", tileX, tileY, (unsigned long long)it->second);
+        }
+        fclose(file);
+    }
     /**
      * Build navmesh for GameObject model.
      * Yup, transports are GameObjects and we need pathfinding there.
@@ -22,6 +22,7 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <atomic>
 
 #include "TerrainBuilder.h"
 #include "IntermediateValues.h"
@@ -57,6 +58,19 @@ namespace MMAP
         rcPolyMeshDetail* dmesh;
     };
 
+    // Per thread tile generation data: the terrain builder keeps the tile being
+    // built loaded, and the navmesh tiles are added to, so none can be shared.
+    struct TileBuilderContext
+    {
+        TileBuilderContext() : terrainBuilder(NULL), context(NULL), navMesh(NULL) {}
+        TerrainBuilder* terrainBuilder;
+        rcContext* context;
+        dtNavMesh* navMesh;
+    };
+
+    // Hash of the tiles inputs, by packed tile id
+    typedef map<uint32, uint64> TileHashes;
+
     class MapBuilder
     {
         public:
@@ -68,7 +82,9 @@ namespace MMAP
                        bool debugOutput         = false,
                        bool bigBaseUnit         = false,
                        bool quick               = false,
-                       const char* offMeshFilePath = NULL);
+                       const char* offMeshFilePath = NULL,
+                       uint32 threads           = 1,
+                       bool incremental         = true);
 
             ~MapBuilder();
 
@@ -91,16 +107,25 @@ namespace MMAP
 
             void buildNavMesh(uint32 mapID, dtNavMesh*& navMesh);
 
-            void buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh);
+            // builds the given tiles on m_threads threads
+            void buildTiles(uint32 mapID, vector<uint32> const& tiles, dtNavMesh* navMesh, TileHashes const& hashes, TileHashes& builtHashes);
+            void buildTilesWorker(uint32 mapID, vector<uint32> const& tiles, atomic<uint32>* nextTile, TileBuilderContext* ctx, vector<uint32>* built);
+
+            bool buildTile(uint32 mapID, uint32 tileX, uint32 tileY, TileBuilderContext& ctx);
 
             // move map building
-            void buildMoveMapTile(uint32 mapID,
+            bool buildMoveMapTile(uint32 mapID,
                                   uint32 tileX,
                                   uint32 tileY,
                                   MeshData& meshData,
                                   float bmin[3],
                                   float bmax[3],
-                                  dtNavMesh* navMesh);
+                                  TileBuilderContext& ctx);
+
+            // incremental build: tiles inputs hashes
+            uint64 getTileHash(uint32 mapID, uint32 tileX, uint32 tileY);
+            void loadTileHashes(uint32 mapID, TileHashes& hashes);
+            void saveTileHashes(uint32 mapID, TileHashes const& hashes);
 
             void getTileBounds(uint32 tileX, uint32 tileY,
                                float* verts, int vertCount,
@@ -109,7 +134,7 @@ namespace MMAP
 
             bool shouldSkipMap(uint32 mapID);
             bool isTransportMap(uint32 mapID);
-            bool shouldSkipTile(uint32 mapID, uint32 tileX, uint32 tileY);
+            bool shouldSkipTile(uint32 mapID, uint32 tileX, uint32 tileY, TileHashes const& hashes, uint64 hash);
 
             TerrainBuilder* m_terrainBuilder;
             TileList m_tiles;
@@ -120,7 +145,10 @@ namespace MMAP
             bool m_skipContinents;
             bool m_skipJunkMaps;
             bool m_skipBattlegrounds;
+            bool m_skipLiquid;
             bool m_quick;
+            uint32 m_threads;
+            bool m_incremental;
 
             float m_maxWalkableAngle;
             bool m_bigBaseUnit;
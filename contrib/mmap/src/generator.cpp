@@ -73,7 +73,9 @@ void printUsage()
     printf("--bigBaseUnit [true|false] : Generate tile/map using bigger basic unit.\n");
     printf("--quick : Does not remove undermap positions ... But generates way more quickly.\n");
     printf("--silent : Make script friendly. No wait for user input, error, completion.\n");
-    printf("--offMeshInput [file.*] : Path to file containing off mesh connections data.\n\n");
+    printf("--offMeshInput [file.*] : Path to file containing off mesh connections data.\n");
+    printf("--threads [#] : Number of threads building the tiles of a map.\n");
+    printf("--incremental [true|false] : Only build tiles whose inputs changed since last build.\n\n");
     printf("Exemple:\nmovemapgen (generate all mmap with default arg\n"
         "movemapgen 0 (generate map 0)\n"
         "movemapgen --tile 34,46 (builds only tile 34,46 of map 0)\n\n");
@@ -93,7 +95,9 @@ bool handleArgs(int argc, char** argv,
                 bool& silent,
                 bool& bigBaseUnit,
                 bool &quick,
-                char*& offMeshInputPath)
+                char*& offMeshInputPath,
+                int& threads,
+                bool& incremental)
 {
     char* param = NULL;
     for (int i = 1; i < argc; ++i)
@@ -226,6 +230,31 @@ bool handleArgs(int argc, char** argv,
 
             offMeshInputPath = param;
         }
+        else if (strcmp(argv[i], "--threads") == 0)
+        {
+            param = argv[++i];
+            if (!param)
+                return false;
+
+            int nthreads = atoi(param);
+            if (nthreads > 0)
+                threads = nthreads;
+            else
+                printf("invalid option for '--threads', using default\n");
+        }
+        else if (strcmp(argv[i], "--incremental") == 0)
+        {
+            param = argv[++i];
+            if (!param)
+                return false;
+
+            if (strcmp(param, "true") == 0)
+                incremental = true;
+            else if (strcmp(param, "false") == 0)
+                incremental = false;
+            else
+                printf("invalid option for '--incremental', using default true\n");
+        }
         else if (strcmp(argv[i], "-?") == 0)
         {
             printUsage();
@@ -268,11 +297,14 @@ int main(int argc, char** argv)
          bigBaseUnit = false,
          quick = false;
     char* offMeshInputPath = NULL;
+    int threads = 1;
+    bool incremental = true;
 
     bool validParam = handleArgs(argc, argv, mapnum,
                                  tileX, tileY, maxAngle,
                                  skipLiquid, skipContinents, skipJunkMaps, skipBattlegrounds,
-                                 debugOutput, silent, bigBaseUnit, quick, offMeshInputPath);
+                                 debugOutput, silent, bigBaseUnit, quick, offMeshInputPath,
+                                 threads, incremental);
 
     if (!validParam)
         return silent ? -1 : finish("You have specified invalid parameters (use -? for more help)", -1);
@@ -293,7 +325,8 @@ int main(int argc, char** argv)
         return silent ? -3 : finish("Press any key to close...", -3);
 
     MapBuilder builder(maxAngle, skipLiquid, skipContinents, skipJunkMaps,
-                       skipBattlegrounds, debugOutput, bigBaseUnit, quick, offMeshInputPath);
+                       skipBattlegrounds, debugOutput, bigBaseUnit, quick, offMeshInputPath,
+                       threads, incremental);
 
     if (tileX > -1 && tileY > -1 && mapnum >= 0)
         builder.buildSingleTile(mapnum, tileX, tileY);
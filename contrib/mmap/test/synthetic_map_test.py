@@ -0,0 +1,145 @@
+#!/usr/bin/python
+
+"""
+  This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Builds the navmesh of a small synthetic map (3x3 tiles of hills, no models)
+  and checks that:
+  - the output is the same when built on 1 and on several threads
+  - an incremental build skips every tile when nothing changed
+  - changing a .map file only rebuilds this tile and its neighbours
+
+  usage: synthetic_map_test.py <path to MoveMapGen> [threads]
+"""
+
+from __future__ import print_function
+import os, sys, math, re, shutil, struct, subprocess, tempfile
+
+MAP_ID = 13
+TILES = [(x, y) for x in range(40, 43) for y in range(40, 43)]
+GRID_SIZE = 533.33333
+V9_SIZE = 129
+V8_SIZE = 128
+
+def height(x, y, bump):
+    # Steep bumps on top of the hills: a tile that is walkable everywhere gives exactly one
+    # polygon per sub-tile and is dropped by the generator as flat
+    return 20.0 * math.sin(x / 45.0) + 15.0 * math.cos(y / 60.0) + 25.0 * math.sin(x / 9.0) * math.sin(y / 11.0) + bump
+
+def writeMapTile(directory, tileX, tileY, bump = 0.0):
+    # Same layout as the extractor output, heights stored as float
+    xoffset = (tileX - 32) * GRID_SIZE
+    yoffset = (tileY - 32) * GRID_SIZE
+    v9 = [height(xoffset + (i % V9_SIZE) * GRID_SIZE / V8_SIZE, yoffset + (i // V9_SIZE) * GRID_SIZE / V8_SIZE, bump)
+          for i in range(V9_SIZE * V9_SIZE)]
+    v8 = [height(xoffset + ((i % V8_SIZE) + 0.5) * GRID_SIZE / V8_SIZE, yoffset + ((i // V8_SIZE) + 0.5) * GRID_SIZE / V8_SIZE, bump)
+          for i in range(V8_SIZE * V8_SIZE)]
+
+    fileHeaderSize = 40
+    heightHeader = struct.pack("<4sIff", b"MHGT", 0, min(v9 + v8), max(v9 + v8))
+    heights = struct.pack("<%uf" % len(v9), *v9) + struct.pack("<%uf" % len(v8), *v8)
+    holesOffset = fileHeaderSize + len(heightHeader) + len(heights)
+    fileHeader = struct.pack("<4s4s8I", b"MAPS", b"z1.3", 0, 0, fileHeaderSize, len(heightHeader) + len(heights), 0, 0, holesOffset, 0)
+
+    with open(os.path.join(directory, "maps", "%03u%02u%02u.map" % (MAP_ID, tileY, tileX)), "wb") as f:
+        f.write(fileHeader + heightHeader + heights)
+
+def createMap(directory):
+    for sub in ("maps", "vmaps", "mmaps"):
+        os.makedirs(os.path.join(directory, sub))
+    for tileX, tileY in TILES:
+        writeMapTile(directory, tileX, tileY)
+    # Only needed to pass the directories check: the map has no models
+    open(os.path.join(directory, "vmaps", "%03u.vmtree" % MAP_ID), "wb").close()
+
+def build(generator, directory, threads, incremental = True):
+    process = subprocess.Popen([generator, "%u" % MAP_ID, "--silent", "--threads", "%u" % threads,
+                                "--incremental", "true" if incremental else "false"], cwd = directory, stdout = subprocess.PIPE)
+    output = process.communicate()[0].decode("latin-1")
+    # --silent returns 1 once the build is complete
+    if process.returncode != 1:
+        fail("MoveMapGen exited with %d:\n%s" % (process.returncode, output))
+    match = re.search(r"We have (\d+) tiles, (\d+) to build", output)
+    if not match:
+        fail("unexpected MoveMapGen output:\n" + output)
+    return int(match.group(1)), int(match.group(2))
+
+def readOutput(directory):
+    files = {}
+    mmaps = os.path.join(directory, "mmaps")
+    for name in sorted(os.listdir(mmaps)):
+        with open(os.path.join(mmaps, name), "rb") as f:
+            files[name] = (f.read(), os.stat(os.path.join(mmaps, name)).st_mtime)
+    return files
+
+def fail(message):
+    print("FAILED: " + message)
+    sys.exit(1)
+
+def check(condition, message):
+    if not condition:
+        fail(message)
+    print("ok: " + message)
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(2)
+
+    generator = os.path.abspath(sys.argv[1])
+    threads = int(sys.argv[2]) if len(sys.argv) > 2 else 4
+    root = tempfile.mkdtemp(prefix = "mmap_test_")
+    try:
+        single = os.path.join(root, "single")
+        multi = os.path.join(root, "multi")
+        createMap(single)
+        createMap(multi)
+
+        total, built = build(generator, single, 1, False)
+        check(total == len(TILES) and built == len(TILES), "all %u tiles built on 1 thread" % len(TILES))
+        total, built = build(generator, multi, threads, False)
+        check(built == len(TILES), "all %u tiles built on %u threads" % (len(TILES), threads))
+
+        singleFiles = readOutput(single)
+        multiFiles = readOutput(multi)
+        tileFiles = [name for name in singleFiles if name.endswith(".mmtile")]
+        check(len(tileFiles) == len(TILES), "one .mmtile per tile")
+        check(sorted(singleFiles) == sorted(multiFiles), "same output files on 1 and %u threads" % threads)
+        for name in singleFiles:
+            check(singleFiles[name][0] == multiFiles[name][0], "%s identical on 1 and %u threads" % (name, threads))
+
+        # Nothing changed: every tile is skipped and left as is
+        total, built = build(generator, multi, threads)
+        check(total == len(TILES) and built == 0, "incremental build of an unchanged map skips every tile")
+        unchanged = readOutput(multi)
+        for name in tileFiles:
+            check(unchanged[name] == multiFiles[name], "%s not written again" % name)
+
+        # The center tile changed: its neighbours read its borders, corners are not affected
+        writeMapTile(multi, 41, 41, 5.0)
+        total, built = build(generator, multi, threads)
+        check(built == 5, "changed tile and its 4 neighbours rebuilt")
+        changed = readOutput(multi)
+        for tileX, tileY in ((40, 40), (40, 42), (42, 40), (42, 42)):
+            name = "%03u%02u%02u.mmtile" % (MAP_ID, tileY, tileX)
+            check(changed[name] == multiFiles[name], "unchanged corner tile %s skipped" % name)
+        name = "%03u%02u%02u.mmtile" % (MAP_ID, 41, 41)
+        check(changed[name][0] != multiFiles[name][0], "changed tile %s rebuilt" % name)
+    finally:
+        shutil.rmtree(root)
+
+    print("All checks passed.")
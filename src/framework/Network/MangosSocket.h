@@ -11,7 +11,6 @@
 #include <ace/Connector.h>
 #include <ace/Thread_Mutex.h>
 #include <ace/Guard_T.h>
-#include <ace/Unbounded_Queue.h>
 #include <ace/Message_Block.h>
 
 #if !defined (ACE_LACKS_PRAGMA_ONCE)
@@ -19,11 +18,26 @@
 #endif /* ACE_LACKS_PRAGMA_ONCE */
 
 #include "Common.h"
+#include "WorldPacket.h"
+
+#include <atomic>
+#include <deque>
 
 class ACE_Message_Block;
-class WorldPacket;
 class WorldSession;
 
+/// Max number of packets (header and payload) gathered in one writev
+#define MANGOS_SOCKET_MAX_IOV_PACKETS 64
+
+/// Max number of sent packets kept by a socket to be reused by SendPacket
+#define MANGOS_SOCKET_MAX_FREE_PACKETS 64
+
+/// Packets bigger than this are not recycled, so their buffer is released
+#define MANGOS_SOCKET_MAX_RECYCLED_PACKET_SIZE 4096
+
+/// Ms without any packet sent after which the kept packets are released
+#define MANGOS_SOCKET_FREE_PACKETS_IDLE_DELAY 30000
+
 
 #if defined( __GNUC__ )
 #pragma pack(1)
@@ -60,19 +74,25 @@ typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> WorldHandler;
  * Most methods return -1 on failure.
  * The class uses reference counting.
  *
- * For output the class uses one buffer (64K usually) and
- * a queue where it stores packet if there is no place on
- * the queue. The reason this is done, is because the server
- * does really a lot of small-size writes to it, and it doesn't
- * scale well to allocate memory for every. When something is
- * written to the output buffer the socket is not immediately
- * activated for output (again for the same reason), there
- * is 10ms celling (thats why there is Update() method).
+ * For output, producer threads push a copy of each packet
+ * on a lock-free list, so sending a packet never waits on
+ * the network thread. The copies are made in packets sent
+ * before, which the network thread puts back in free slots
+ * taken by the producers with an atomic exchange. The list is collected by the network
+ * thread, which encrypts the headers in order and writes the
+ * pending packets with a single writev per reactor iteration
+ * (so 10ms celling with the default Network.Interval).
  * This concept is similar to TCP_CORK, but TCP_CORK
  * uses 200ms celling. As result overhead generated by
  * sending packets from "producer" threads is minimal,
  * and doing a lot of writes with small size is tolerated.
  *
+ * The flush policy can be tuned per socket: with a flush delay,
+ * bulk packets are kept until the oldest one is that old, or
+ * enough bytes are pending. Packets flagged as immediate by the
+ * socket type (IsImmediatePacket) wake up the network thread so
+ * they are written without waiting for the next iteration.
+ *
  * The calls to Update () method are managed by WorldSocketMgr
  * and ReactorRunnable.
  *
@@ -104,8 +124,40 @@ class MangosSocket : protected WorldHandler
         typedef ACE_Thread_Mutex LockType;
         typedef ACE_Guard<LockType> GuardType;
 
-        /// Queue for storing packets for which there is no space.
-        typedef ACE_Unbounded_Queue<WorldPacket*> PacketQueueT;
+        /// Packet waiting to be written on the socket.
+        struct OutgoingPacket
+        {
+            explicit OutgoingPacket(const WorldPacket& pct) : packet(pct), headerSize(0), next(NULL) {}
+
+            /// Reuse a sent packet: its storage is kept if large enough
+            void Assign(const WorldPacket& pct)
+            {
+                packet.Initialize(pct.GetOpcode(), pct.size());
+                if (!pct.empty())
+                    packet.append(pct.contents(), pct.size());
+                headerSize = 0;
+                next = NULL;
+            }
+
+            WorldPacket packet;
+            uint8 header[sizeof(ClientPktHeader)];          // encrypted header, built by the network thread
+            uint8 headerSize;
+            OutgoingPacket* next;                           // lock-free submission list link
+        };
+
+        /// Queue of packets with their header built, waiting for the socket to be writable.
+        typedef std::deque<OutgoingPacket*> PacketQueueT;
+
+        /// Output statistics of the socket.
+        struct SendStats
+        {
+            uint64 calls;                                   // send syscalls
+            uint64 bytes;
+            uint64 packets;
+            uint64 immediateFlushes;                        // flushes triggered by an immediate packet
+            uint32 callsPerSec;                             // last second
+            uint32 bytesPerSec;                             // last second
+        };
 
         /// Check if socket is closed.
         bool IsClosed() const { return closing_; }
@@ -116,7 +168,7 @@ class MangosSocket : protected WorldHandler
         /// Get address of connected peer.
         const std::string& GetRemoteAddress () const { return m_Address; }
 
-        /// Send A packet on the socket, this function is reentrant.
+        /// Send A packet on the socket, this function is reentrant and lock-free.
         /// @param pct packet to send
         /// @return -1 of failure
         int SendPacket (const WorldPacket& pct);
@@ -133,6 +185,32 @@ class MangosSocket : protected WorldHandler
          * @brief returns true iif the socket is connected TO a client (ie we are the server)
          */
         bool IsServerSide() { return m_isServerSocket; }
+
+        /// Bytes written since the previous call, used by ReactorRunnable for load balancing.
+        uint32 TakeSentBytes() { uint32 bytes = m_SentBytes; m_SentBytes = 0; return bytes; }
+
+        /// Output flush policy.
+        /// @param delay max time in ms a bulk packet waits for other packets, 0 to flush at each network update
+        /// @param bytes pending amount of bytes that triggers a flush before the delay
+        void SetFlushPolicy(uint32 delay, uint32 bytes)
+        {
+            m_FlushDelay.store(delay, std::memory_order_relaxed);
+            m_FlushBytes.store(bytes, std::memory_order_relaxed);
+        }
+        uint32 GetFlushDelay() const { return m_FlushDelay.load(std::memory_order_relaxed); }
+        uint32 GetFlushBytes() const { return m_FlushBytes.load(std::memory_order_relaxed); }
+
+        SendStats GetSendStats() const
+        {
+            SendStats stats;
+            stats.calls = m_StatsCalls.load(std::memory_order_relaxed);
+            stats.bytes = m_StatsBytes.load(std::memory_order_relaxed);
+            stats.packets = m_StatsPackets.load(std::memory_order_relaxed);
+            stats.immediateFlushes = m_StatsImmediateFlushes.load(std::memory_order_relaxed);
+            stats.callsPerSec = m_StatsCallsPerSec.load(std::memory_order_relaxed);
+            stats.bytesPerSec = m_StatsBytesPerSec.load(std::memory_order_relaxed);
+            return stats;
+        }
     protected:
         /// things called by ACE framework.
         MangosSocket();
@@ -172,15 +250,31 @@ class MangosSocket : protected WorldHandler
         int cancel_wakeup_output (GuardType& g);
         int schedule_wakeup_output (GuardType& g);
 
-        /// Try to write WorldPacket to m_OutBuffer ,return -1 if no space
-        /// Need to be called with m_OutBufferLock lock held
-        int iSendPacket (const WorldPacket& pct);
+        /// Write the (encrypted) header of pct, return the header size.
+        /// Called by the network thread in packet send order.
+        int BuildPacketHeader (const WorldPacket& pct, uint8* header);
+
+        /// Latency critical packets, not delayed by the flush policy.
+        bool IsImmediatePacket (const WorldPacket& /*pct*/) const { return false; }
 
-        /// Flush m_PacketQueue if there are packets in it
+        /// True if the pending packets have to be written now, according to the flush policy.
+        bool IsFlushDue () const;
+
+        /// Cork the socket while a flush needs several writes (TCP_CORK)
+        void SetCork (bool on);
+
+        /// Move the packets submitted by SendPacket to m_PacketQueue
         /// Need to be called with m_OutBufferLock lock held
-        /// @return true if it wrote to the buffer ( AKA you need
-        /// to mark the socket for output ).
-        bool iFlushPacketQueue ();
+        void FetchOutgoingPackets ();
+
+        /// Copy a packet to a recycled node, or to a new one if none is free
+        OutgoingPacket* AllocateOutgoingPacket (const WorldPacket& pct);
+
+        /// Give back a list of sent packets (linked by next) for reuse. Network thread only.
+        void RecycleOutgoingPackets (OutgoingPacket* out);
+
+        /// Release the packets kept for reuse
+        void ClearFreePackets ();
 
         /// Time in which the last ping was received
         ACE_Time_Value m_LastPingTime;
@@ -214,19 +308,56 @@ class MangosSocket : protected WorldHandler
         /// Mutex for protecting output related data.
         LockType m_OutBufferLock;
 
-        /// Buffer used for writing output.
-        ACE_Message_Block *m_OutBuffer;
+        /// Packets submitted by SendPacket, most recent first.
+        std::atomic<OutgoingPacket*> m_OutgoingPackets;
+
+        /// Sent packets kept for reuse by SendPacket. Only the network thread
+        /// fills an empty slot, SendPacket empties one by taking its packet.
+        std::atomic<OutgoingPacket*> m_FreePackets[MANGOS_SOCKET_MAX_FREE_PACKETS];
+        /// Approximate count of m_FreePackets, to skip the slots when empty.
+        std::atomic<uint32> m_FreePacketsCount;
+        /// Last time sent packets were recycled (network thread only).
+        uint32 m_FreePacketsTime;
 
-        /// Size of the m_OutBuffer.
+        /// Max amount of bytes given to one writev.
         size_t m_OutBufferSize;
 
-        /// Here are stored packets for which there was no space on m_OutBuffer,
-        /// this allows not-to kick player if its buffer is overflowed.
+        /// Packets waiting for the socket to be writable, in send order.
         PacketQueueT m_PacketQueue;
 
+        /// Bytes of the first packet of m_PacketQueue already written.
+        size_t m_PacketQueueOffset;
+
+        /// Bytes written since the last TakeSentBytes call (network thread only).
+        uint32 m_SentBytes;
+
+        /// Flush policy, see SetFlushPolicy.
+        std::atomic<uint32> m_FlushDelay;
+        std::atomic<uint32> m_FlushBytes;
+        bool m_UseCork;
+
+        /// Packets submitted since the last fetch, maintained by SendPacket.
+        std::atomic<uint32> m_PendingBytes;
+        std::atomic<uint32> m_PendingSince;
+        std::atomic<bool> m_ImmediatePending;
+
+        /// Output statistics (written by the network thread only).
+        std::atomic<uint64> m_StatsCalls;
+        std::atomic<uint64> m_StatsBytes;
+        std::atomic<uint64> m_StatsPackets;
+        std::atomic<uint64> m_StatsImmediateFlushes;
+        std::atomic<uint32> m_StatsCallsPerSec;
+        std::atomic<uint32> m_StatsBytesPerSec;
+        uint64 m_StatsSampleCalls;
+        uint64 m_StatsSampleBytes;
+        uint32 m_StatsSampleTime;
+
         /// True if the socket is registered with the reactor for output
         bool m_OutActive;
 
+        /// True once open() has been called
+        bool m_Opened;
+
         uint32 m_Seed;
 
         bool m_isServerSocket;
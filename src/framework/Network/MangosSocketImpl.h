@@ -1,6 +1,7 @@
 #include <ace/Message_Block.h>
 #include <ace/OS_NS_string.h>
 #include <ace/OS_NS_unistd.h>
+#include <ace/OS_NS_sys_socket.h>
 #include <ace/os_include/arpa/os_inet.h>
 #include <ace/os_include/netinet/os_tcp.h>
 #include <ace/os_include/sys/os_types.h>
@@ -22,6 +23,7 @@
 #include "WorldSession.h"
 #include "Log.h"
 #include "DBCStores.h"
+#include "Timer.h"
 
 
 template <typename SessionType, typename SocketName, typename Crypt>
@@ -33,13 +35,36 @@ MangosSocket<SessionType, SocketName, Crypt>::MangosSocket() :
     m_RecvWPct(0),
     m_RecvPct(),
     m_Header(sizeof(ClientPktHeader)),
-    m_OutBuffer(0),
+    m_OutgoingPackets(NULL),
+    m_FreePacketsCount(0),
+    m_FreePacketsTime(0),
     m_OutBufferSize(65536),
+    m_PacketQueueOffset(0),
+    m_SentBytes(0),
+    m_FlushDelay(0),
+    m_FlushBytes(0),
+    m_UseCork(false),
+    m_PendingBytes(0),
+    m_PendingSince(0),
+    m_ImmediatePending(false),
+    m_StatsCalls(0),
+    m_StatsBytes(0),
+    m_StatsPackets(0),
+    m_StatsImmediateFlushes(0),
+    m_StatsCallsPerSec(0),
+    m_StatsBytesPerSec(0),
+    m_StatsSampleCalls(0),
+    m_StatsSampleBytes(0),
+    m_StatsSampleTime(WorldTimer::getMSTime()),
     m_OutActive(false),
+    m_Opened(false),
     m_Seed(static_cast<uint32>(rand32())),
     m_isServerSocket(true)
 {
     reference_counting_policy().value(ACE_Event_Handler::Reference_Counting_Policy::ENABLED);
+
+    for (uint32 i = 0; i < MANGOS_SOCKET_MAX_FREE_PACKETS; ++i)
+        m_FreePackets[i] = NULL;
 }
 
 template <typename SessionType, typename SocketName, typename Crypt>
@@ -47,16 +72,22 @@ MangosSocket<SessionType, SocketName, Crypt>::~MangosSocket(void)
 {
     delete m_RecvWPct;
 
-    if (m_OutBuffer)
-        m_OutBuffer->release();
-
     closing_ = true;
 
     peer().close();
 
-    WorldPacket* pct;
-    while (m_PacketQueue.dequeue_head(pct) == 0)
-        delete pct;
+    OutgoingPacket* out = m_OutgoingPackets.exchange(NULL);
+    while (out)
+    {
+        OutgoingPacket* next = out->next;
+        delete out;
+        out = next;
+    }
+
+    for (typename PacketQueueT::const_iterator itr = m_PacketQueue.begin(); itr != m_PacketQueue.end(); ++itr)
+        delete *itr;
+
+    ClearFreePackets();
 }
 
 template <typename SessionType, typename SocketName, typename Crypt>
@@ -82,26 +113,27 @@ void MangosSocket<SessionType, SocketName, Crypt>::CloseSocket(void)
 template <typename SessionType, typename SocketName, typename Crypt>
 int MangosSocket<SessionType, SocketName, Crypt>::SendPacket(const WorldPacket& pct)
 {
-    ACE_GUARD_RETURN(LockType, Guard, m_OutBufferLock, -1);
-
     if (closing_)
         return -1;
 
-    if (((SocketName*)this)->iSendPacket(pct) == -1)
-    {
-        WorldPacket* npct;
+    OutgoingPacket* out = AllocateOutgoingPacket(pct);
+    if (!out)
+        return -1;
 
-        ACE_NEW_RETURN(npct, WorldPacket(pct), -1);
+    m_PendingBytes.fetch_add(uint32(pct.size()), std::memory_order_relaxed);
 
-        // NOTE maybe check of the size of the queue can be good ?
-        // to make it bounded instead of unbounded
-        if (m_PacketQueue.enqueue_tail(npct) == -1)
-        {
-            delete npct;
-            sLog.outError("MangosSocket<SessionType, SocketName, Crypt>::SendPacket: m_PacketQueue.enqueue_tail failed");
-            return -1;
-        }
-    }
+    // The network thread restores the send order when collecting the list
+    out->next = m_OutgoingPackets.load(std::memory_order_relaxed);
+    while (!m_OutgoingPackets.compare_exchange_weak(out->next, out, std::memory_order_release, std::memory_order_relaxed))
+        ;
+
+    // First packet since the last fetch: the flush delay starts now
+    if (!out->next)
+        m_PendingSince.store(WorldTimer::getMSTime(), std::memory_order_relaxed);
+
+    // Wake up the network thread, only once until the next fetch
+    if (((SocketName*)this)->IsImmediatePacket(pct) && !m_ImmediatePending.exchange(true) && reactor())
+        reactor()->notify(this, ACE_Event_Handler::WRITE_MASK);
 
     return 0;
 }
@@ -112,9 +144,11 @@ int MangosSocket<SessionType, SocketName, Crypt>::open(void *a)
     ACE_UNUSED_ARG(a);
 
     // Prevent double call to this func.
-    if (m_OutBuffer)
+    if (m_Opened)
         return -1;
 
+    m_Opened = true;
+
     // This will also prevent the socket from being Updated
     // while we are initializing it.
     m_OutActive = true;
@@ -123,9 +157,6 @@ int MangosSocket<SessionType, SocketName, Crypt>::open(void *a)
     if (((SocketName*)this)->OnSocketOpen() == -1)
         return -1;
 
-    // Allocate the buffer.
-    ACE_NEW_RETURN(m_OutBuffer, ACE_Message_Block(m_OutBufferSize), -1);
-
     // Store peer address.
     ACE_INET_Addr remote_addr;
 
@@ -175,11 +206,10 @@ int MangosSocket<SessionType, SocketName, Crypt>::handle_input(ACE_HANDLE)
     {
         case -1 :
         {
+            // Output is flushed by ReactorRunnable once per reactor iteration
             if ((errno == EWOULDBLOCK) ||
                     (errno == EAGAIN))
-            {
-                return Update();                            // interesting line ,isn't it ?
-            }
+                return 0;
 
             DEBUG_LOG("WorldSocket::handle_input: Peer error closing connection errno = %s", ACE_OS::strerror(errno));
 
@@ -196,7 +226,7 @@ int MangosSocket<SessionType, SocketName, Crypt>::handle_input(ACE_HANDLE)
         case 1:
             return 1;
         default:
-            return Update();                                // another interesting line ;)
+            return 0;
     }
 
     ACE_NOTREACHED(return -1);
@@ -210,46 +240,114 @@ int MangosSocket<SessionType, SocketName, Crypt>::handle_output(ACE_HANDLE)
     if (closing_)
         return -1;
 
-    const size_t send_len = m_OutBuffer->length();
+    FetchOutgoingPackets();
 
-    if (send_len == 0)
-        return cancel_wakeup_output(Guard);
+    bool corked = false;
+    while (!m_PacketQueue.empty())
+    {
+        // Gather as many pending packets as possible in one writev
+        iovec iov[MANGOS_SOCKET_MAX_IOV_PACKETS * 2];
+        int iovcnt = 0;
+        size_t send_len = 0;
+        size_t offset = m_PacketQueueOffset;
+
+        typename PacketQueueT::const_iterator itr = m_PacketQueue.begin();
+        for (; itr != m_PacketQueue.end(); ++itr)
+        {
+            if (iovcnt + 2 > MANGOS_SOCKET_MAX_IOV_PACKETS * 2 || send_len >= m_OutBufferSize)
+                break;
+
+            OutgoingPacket* out = *itr;
+            if (offset < out->headerSize)
+            {
+                iov[iovcnt].iov_base = (char*)out->header + offset;
+                iov[iovcnt].iov_len = out->headerSize - offset;
+                send_len += iov[iovcnt].iov_len;
+                ++iovcnt;
+                offset = 0;
+            }
+            else
+                offset -= out->headerSize;
+
+            if (offset < out->packet.size())
+            {
+                iov[iovcnt].iov_base = (char*)out->packet.contents() + offset;
+                iov[iovcnt].iov_len = out->packet.size() - offset;
+                send_len += iov[iovcnt].iov_len;
+                ++iovcnt;
+            }
+            offset = 0;
+        }
+
+        // Several writes needed: only send full segments until the last one
+        if (m_UseCork && !corked && itr != m_PacketQueue.end())
+        {
+            SetCork(true);
+            corked = true;
+        }
 
 #ifdef MSG_NOSIGNAL
-    ssize_t n = peer().send(m_OutBuffer->rd_ptr(), send_len, MSG_NOSIGNAL);
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovcnt;
+        ssize_t n = ACE_OS::sendmsg(get_handle(), &msg, MSG_NOSIGNAL);
 #else
-    ssize_t n = peer().send(m_OutBuffer->rd_ptr(), send_len);
+        ssize_t n = peer().sendv(iov, iovcnt);
 #endif // MSG_NOSIGNAL
 
-    if (n == 0)
-        return -1;
-    else if (n == -1)
-    {
-        if (errno == EWOULDBLOCK || errno == EAGAIN)
-            return schedule_wakeup_output(Guard);
+        m_StatsCalls.fetch_add(1, std::memory_order_relaxed);
+        if (n <= 0 && corked)
+            SetCork(false);
 
-        return -1;
-    }
-    else if (n < (ssize_t)send_len) //now n > 0
-    {
-        m_OutBuffer->rd_ptr(static_cast<size_t>(n));
+        if (n == 0)
+            return -1;
+        else if (n == -1)
+        {
+            if (errno == EWOULDBLOCK || errno == EAGAIN)
+                return schedule_wakeup_output(Guard);
 
-        // move the data to the base of the buffer
-        m_OutBuffer->crunch();
+            return -1;
+        }
 
-        return schedule_wakeup_output(Guard);
-    }
-    else //now n == send_len
-    {
-        m_OutBuffer->reset();
+        m_SentBytes += uint32(n);
+        m_StatsBytes.fetch_add(uint64(n), std::memory_order_relaxed);
 
-        if (!iFlushPacketQueue())
-            return cancel_wakeup_output(Guard);
-        else
+        // Release the packets fully written
+        size_t written = static_cast<size_t>(n);
+        OutgoingPacket* released = NULL;
+        while (written)
+        {
+            OutgoingPacket* out = m_PacketQueue.front();
+            size_t left = out->headerSize + out->packet.size() - m_PacketQueueOffset;
+            if (written < left)
+            {
+                m_PacketQueueOffset += written;
+                break;
+            }
+
+            written -= left;
+            m_PacketQueueOffset = 0;
+            m_PacketQueue.pop_front();
+            m_StatsPackets.fetch_add(1, std::memory_order_relaxed);
+            out->next = released;
+            released = out;
+        }
+        RecycleOutgoingPackets(released);
+
+        // Kernel buffer is full, wait for the socket to be writable
+        if (static_cast<size_t>(n) < send_len)
+        {
+            if (corked)
+                SetCork(false);
             return schedule_wakeup_output(Guard);
+        }
     }
 
-    ACE_NOTREACHED(return 0);
+    if (corked)
+        SetCork(false);
+
+    return cancel_wakeup_output(Guard);
 }
 
 template <typename SessionType, typename SocketName, typename Crypt>
@@ -282,12 +380,56 @@ int MangosSocket<SessionType, SocketName, Crypt>::Update(void)
     if (closing_)
         return -1;
 
-    if (m_OutActive || m_OutBuffer->length() == 0)
+    uint32 sampleDiff = WorldTimer::getMSTimeDiffToNow(m_StatsSampleTime);
+    if (sampleDiff >= 1000)
+    {
+        uint64 calls = m_StatsCalls.load(std::memory_order_relaxed);
+        uint64 bytes = m_StatsBytes.load(std::memory_order_relaxed);
+        m_StatsCallsPerSec.store(uint32((calls - m_StatsSampleCalls) * 1000 / sampleDiff), std::memory_order_relaxed);
+        m_StatsBytesPerSec.store(uint32((bytes - m_StatsSampleBytes) * 1000 / sampleDiff), std::memory_order_relaxed);
+        m_StatsSampleCalls = calls;
+        m_StatsSampleBytes = bytes;
+        m_StatsSampleTime = WorldTimer::getMSTime();
+    }
+
+    if (m_FreePacketsCount.load(std::memory_order_relaxed) &&
+        WorldTimer::getMSTimeDiffToNow(m_FreePacketsTime) >= MANGOS_SOCKET_FREE_PACKETS_IDLE_DELAY)
+        ClearFreePackets();
+
+    if (m_OutActive || (m_PacketQueue.empty() && !m_OutgoingPackets.load(std::memory_order_relaxed)))
+        return 0;
+
+    if (!IsFlushDue())
         return 0;
 
     return handle_output(get_handle());
 }
 
+template <typename SessionType, typename SocketName, typename Crypt>
+bool MangosSocket<SessionType, SocketName, Crypt>::IsFlushDue() const
+{
+    uint32 delay = m_FlushDelay.load(std::memory_order_relaxed);
+    if (!delay || !m_PacketQueue.empty() || m_ImmediatePending.load(std::memory_order_relaxed))
+        return true;
+
+    uint32 bytes = m_FlushBytes.load(std::memory_order_relaxed);
+    if (bytes && m_PendingBytes.load(std::memory_order_relaxed) >= bytes)
+        return true;
+
+    return WorldTimer::getMSTimeDiffToNow(m_PendingSince.load(std::memory_order_relaxed)) >= delay;
+}
+
+template <typename SessionType, typename SocketName, typename Crypt>
+void MangosSocket<SessionType, SocketName, Crypt>::SetCork(bool on)
+{
+#ifdef TCP_CORK
+    int option = on ? 1 : 0;
+    peer().set_option(ACE_IPPROTO_TCP, TCP_CORK, (void*)&option, sizeof(int));
+#else
+    ACE_UNUSED_ARG(on);
+#endif
+}
+
 template <typename SessionType, typename SocketName, typename Crypt>
 int MangosSocket<SessionType, SocketName, Crypt>::handle_input_header(void)
 {
@@ -482,60 +624,111 @@ int MangosSocket<SessionType, SocketName, Crypt>::schedule_wakeup_output(GuardTy
 }
 
 template <typename SessionType, typename SocketName, typename Crypt>
-int MangosSocket<SessionType, SocketName, Crypt>::iSendPacket(const WorldPacket& pct)
+int MangosSocket<SessionType, SocketName, Crypt>::BuildPacketHeader(const WorldPacket& pct, uint8* header)
 {
-    if (m_OutBuffer->space() < pct.size() + sizeof(ServerPktHeader))
-    {
-        errno = ENOBUFS;
-        return -1;
-    }
+    ServerPktHeader& serverHeader = *((ServerPktHeader*) header);
 
-    ServerPktHeader header;
+    serverHeader.cmd = pct.GetOpcode();
 
-    header.cmd = pct.GetOpcode();
+    serverHeader.size = (uint16) pct.size() + 2;
 
-    header.size = (uint16) pct.size() + 2;
+    EndianConvertReverse(serverHeader.size);
+    EndianConvert(serverHeader.cmd);
 
-    EndianConvertReverse(header.size);
-    EndianConvert(header.cmd);
+    m_Crypt.EncryptSend(header, sizeof(ServerPktHeader));
 
-    m_Crypt.EncryptSend((uint8*) & header, sizeof(header));
+    return sizeof(ServerPktHeader);
+}
 
-    if (m_OutBuffer->copy((char*) & header, sizeof(header)) == -1)
-        ACE_ASSERT(false);
+template <typename SessionType, typename SocketName, typename Crypt>
+typename MangosSocket<SessionType, SocketName, Crypt>::OutgoingPacket* MangosSocket<SessionType, SocketName, Crypt>::AllocateOutgoingPacket(const WorldPacket& pct)
+{
+    // The exchange makes the packet ours, even if another thread emptied the slot meanwhile
+    OutgoingPacket* out = NULL;
+    if (m_FreePacketsCount.load(std::memory_order_relaxed))
+    {
+        for (uint32 i = 0; i < MANGOS_SOCKET_MAX_FREE_PACKETS && !out; ++i)
+            if (m_FreePackets[i].load(std::memory_order_relaxed))
+                out = m_FreePackets[i].exchange(NULL, std::memory_order_acquire);
+        if (out)
+            m_FreePacketsCount.fetch_sub(1, std::memory_order_relaxed);
+    }
 
-    if (!pct.empty())
-        if (m_OutBuffer->copy((char*) pct.contents(), pct.size()) == -1)
-            ACE_ASSERT(false);
+    if (out)
+        out->Assign(pct);
+    else
+        ACE_NEW_RETURN(out, OutgoingPacket(pct), NULL);
 
-    return 0;
+    return out;
 }
 
 template <typename SessionType, typename SocketName, typename Crypt>
-bool MangosSocket<SessionType, SocketName, Crypt>::iFlushPacketQueue()
+void MangosSocket<SessionType, SocketName, Crypt>::RecycleOutgoingPackets(OutgoingPacket* out)
 {
-    WorldPacket *pct;
-    bool haveone = false;
+    m_FreePacketsTime = WorldTimer::getMSTime();
 
-    while (m_PacketQueue.dequeue_head(pct) == 0)
+    // An empty slot stays empty until we fill it
+    uint32 slot = 0;
+    while (out)
     {
-        if (((SocketName*)this)->iSendPacket(*pct) == -1)
-        {
-            if (m_PacketQueue.enqueue_head(pct) == -1)
-            {
-                delete pct;
-                sLog.outError("MangosSocket<SessionType, SocketName, Crypt>::iFlushPacketQueue m_PacketQueue->enqueue_head");
-                return false;
-            }
+        OutgoingPacket* next = out->next;
+        if (out->packet.size() <= MANGOS_SOCKET_MAX_RECYCLED_PACKET_SIZE)
+            while (slot < MANGOS_SOCKET_MAX_FREE_PACKETS && m_FreePackets[slot].load(std::memory_order_relaxed))
+                ++slot;
 
-            break;
+        if (slot < MANGOS_SOCKET_MAX_FREE_PACKETS && out->packet.size() <= MANGOS_SOCKET_MAX_RECYCLED_PACKET_SIZE)
+        {
+            out->next = NULL;
+            m_FreePackets[slot++].store(out, std::memory_order_release);
+            m_FreePacketsCount.fetch_add(1, std::memory_order_relaxed);
         }
         else
+            delete out;
+        out = next;
+    }
+}
+
+template <typename SessionType, typename SocketName, typename Crypt>
+void MangosSocket<SessionType, SocketName, Crypt>::ClearFreePackets()
+{
+    for (uint32 i = 0; i < MANGOS_SOCKET_MAX_FREE_PACKETS; ++i)
+    {
+        if (OutgoingPacket* out = m_FreePackets[i].exchange(NULL, std::memory_order_acquire))
         {
-            haveone = true;
-            delete pct;
+            m_FreePacketsCount.fetch_sub(1, std::memory_order_relaxed);
+            delete out;
         }
     }
+}
+
+template <typename SessionType, typename SocketName, typename Crypt>
+void MangosSocket<SessionType, SocketName, Crypt>::FetchOutgoingPackets()
+{
+    // Reset before fetching: a packet submitted meanwhile may only cause an early flush
+    m_PendingBytes.store(0, std::memory_order_relaxed);
+    if (m_ImmediatePending.exchange(false))
+        m_StatsImmediateFlushes.fetch_add(1, std::memory_order_relaxed);
+
+    OutgoingPacket* out = m_OutgoingPackets.exchange(NULL, std::memory_order_acquire);
+    if (!out)
+        return;
+
+    // Restore send order
+    OutgoingPacket* ordered = NULL;
+    while (out)
+    {
+        OutgoingPacket* next = out->next;
+        out->next = ordered;
+        ordered = out;
+        out = next;
+    }
 
-    return haveone;
+    // Headers are encrypted here, in send order
+    while (ordered)
+    {
+        out = ordered;
+        ordered = ordered->next;
+        out->headerSize = uint8(((SocketName*)this)->BuildPacketHeader(out->packet, out->header));
+        m_PacketQueue.push_back(out);
+    }
 }
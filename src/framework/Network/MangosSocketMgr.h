@@ -30,7 +30,11 @@ class MangosSocketMgr
         void SetOutUBuff(int v) { m_SockOutUBuff = v; }
         void SetThreads(int v) { m_NetThreadsCount = v; }
         void SetTcpNodelay(bool v) { m_UseNoDelay = v; }
+        void SetTcpCork(bool v) { m_UseCork = v; }
+        /// Default flush policy of the sockets, see MangosSocket::SetFlushPolicy
+        void SetFlushPolicy(uint32 delay, uint32 bytes) { m_FlushDelay = delay; m_FlushBytes = bytes; }
         void SetInterval(int v) { m_Interval = v * 1000; /* to microseconds */ }
+        void SetCpuAffinity(uint32 mask) { m_CpuAffinity = mask; }
 
         int Connect(int port, std::string const& address, SocketType*& sock);
     protected:
@@ -47,7 +51,11 @@ class MangosSocketMgr
         int m_SockOutKBuff;
         int m_SockOutUBuff;
         bool m_UseNoDelay;
+        bool m_UseCork;
+        uint32 m_FlushDelay;
+        uint32 m_FlushBytes;
         int m_Interval;
+        uint32 m_CpuAffinity;
 
         std::string m_addr;
         ACE_UINT16 m_port;
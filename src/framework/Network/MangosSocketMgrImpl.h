@@ -14,12 +14,20 @@
 #include <ace/os_include/sys/os_types.h>
 #include <ace/os_include/sys/os_socket.h>
 
+#include <atomic>
 #include <set>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include "Log.h"
 #include "Common.h"
 #include "Config/Config.h"
 #include "Database/DatabaseEnv.h"
+#include "Timer.h"
 
 /**
 * This is a helper class to WorldSocketMgr ,that manages
@@ -34,7 +42,9 @@ public:
         m_Reactor(0),
         m_Connections(0),
         m_ThreadId(-1),
-        m_Interval(0)
+        m_Interval(0),
+        m_Cpu(-1),
+        m_OutputLoad(0)
     {
         ACE_Reactor_Impl* imp = 0;
 
@@ -68,9 +78,11 @@ public:
         m_Reactor->end_reactor_event_loop();
     }
 
-    int Start(int interval)
+    /// @param cpu core to pin the network thread to, -1 to let the OS choose
+    int Start(int interval, int cpu = -1)
     {
         m_Interval = interval;
+        m_Cpu = cpu;
 
         if (m_ThreadId != -1)
             return -1;
@@ -88,6 +100,12 @@ public:
         return static_cast<long>(m_Connections.value());
     }
 
+    /// Bytes written per second by the sockets of this thread (last second)
+    uint32 OutputLoad() const
+    {
+        return m_OutputLoad.load(std::memory_order_relaxed);
+    }
+
     int AddSocket(SocketType* sock)
     {
         ACE_GUARD_RETURN(ACE_Thread_Mutex, Guard, m_NewSockets_Lock, -1);
@@ -129,6 +147,20 @@ protected:
         m_NewSockets.clear();
     }
 
+    void BindToCpu()
+    {
+#if defined(__linux__)
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(m_Cpu, &cpus);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+            sLog.outError("Network thread: unable to bind to cpu %d", m_Cpu);
+#elif defined(WIN32)
+        if (!SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << m_Cpu))
+            sLog.outError("Network thread: unable to bind to cpu %d", m_Cpu);
+#endif
+    }
+
     virtual int svc()
     {
         DEBUG_LOG("Network Thread Starting");
@@ -137,7 +169,12 @@ protected:
 
         MANGOS_ASSERT(m_Reactor);
 
+        if (m_Cpu >= 0)
+            BindToCpu();
+
         typename SocketSet::iterator i, t;
+        uint32 sentBytes = 0;
+        uint32 loadSampleTime = WorldTimer::getMSTime();
 
         while (!m_Reactor->reactor_event_loop_done())
         {
@@ -152,7 +189,9 @@ protected:
 
             for (i = m_Sockets.begin(); i != m_Sockets.end();)
             {
-                if ((*i)->Update() == -1)
+                int result = (*i)->Update();
+                sentBytes += (*i)->TakeSentBytes();
+                if (result == -1)
                 {
                     t = i;
                     ++i;
@@ -164,6 +203,14 @@ protected:
                 else
                     ++i;
             }
+
+            uint32 sampleDiff = WorldTimer::getMSTimeDiffToNow(loadSampleTime);
+            if (sampleDiff >= 1000)
+            {
+                m_OutputLoad.store(uint32(uint64(sentBytes) * 1000 / sampleDiff), std::memory_order_relaxed);
+                sentBytes = 0;
+                loadSampleTime = WorldTimer::getMSTime();
+            }
         }
 
         WorldDatabase.ThreadEnd();
@@ -181,6 +228,8 @@ private:
     AtomicInt m_Connections;
     int m_ThreadId;
     int m_Interval;
+    int m_Cpu;
+    std::atomic<uint32> m_OutputLoad;
 
     SocketSet m_Sockets;
 
@@ -196,6 +245,10 @@ MangosSocketMgr<SocketType>::MangosSocketMgr():
     m_SockOutUBuff(65536),
     m_Interval(10000),
     m_UseNoDelay(true),
+    m_UseCork(false),
+    m_FlushDelay(0),
+    m_FlushBytes(0),
+    m_CpuAffinity(0),
     m_Acceptor(0),
     m_port(0)
 {
@@ -214,8 +267,15 @@ int MangosSocketMgr<SocketType>::StartThreadsIfNeeded()
     if (m_NetThreads)
         return 0;
     m_NetThreads = new ReactorRunnable<SocketType>[m_NetThreadsCount];
+
+    // Threads are pinned in turn to the cores of the affinity mask
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < 32; ++cpu)
+        if (m_CpuAffinity & (1u << cpu))
+            cpus.push_back(cpu);
+
     for (size_t i = 0; i < m_NetThreadsCount; ++i)
-        m_NetThreads[i].Start(m_Interval);
+        m_NetThreads[i].Start(m_Interval, cpus.empty() ? -1 : cpus[i % cpus.size()]);
     return 0;
 }
 
@@ -304,8 +364,8 @@ int MangosSocketMgr<SocketType>::OnSocketOpen(SocketType* sock)
 
     static const int ndoption = 1;
 
-    // Set TCP_NODELAY.
-    if (m_UseNoDelay)
+    // Set TCP_NODELAY. Packets are already batched when a flush delay is used.
+    if (m_UseNoDelay || m_FlushDelay)
     {
         if (sock->peer().set_option(ACE_IPPROTO_TCP, TCP_NODELAY, (void*)&ndoption, sizeof(int)) == -1)
         {
@@ -315,15 +375,35 @@ int MangosSocketMgr<SocketType>::OnSocketOpen(SocketType* sock)
     }
 
     sock->m_OutBufferSize = static_cast<size_t>(m_SockOutUBuff);
+    sock->m_UseCork = m_UseCork;
+    sock->SetFlushPolicy(m_FlushDelay, m_FlushBytes);
 
     // we skip the Acceptor Thread
     size_t min = 1;
 
     MANGOS_ASSERT(m_NetThreadsCount >= 1);
 
+    // Balance on output load: measured throughput of each thread, plus its connections
+    // at the average throughput per connection (so idle new sockets still count)
+    uint64 totalLoad = 0;
+    long totalConnections = 0;
     for (size_t i = 1; i < m_NetThreadsCount; ++i)
-        if (m_NetThreads[i].Connections() < m_NetThreads[min].Connections())
+    {
+        totalLoad += m_NetThreads[i].OutputLoad();
+        totalConnections += m_NetThreads[i].Connections();
+    }
+    uint64 connectionLoad = (totalConnections ? totalLoad / totalConnections : 0) + 1;
+
+    uint64 minLoad = 0;
+    for (size_t i = 1; i < m_NetThreadsCount; ++i)
+    {
+        uint64 load = m_NetThreads[i].OutputLoad() + connectionLoad * m_NetThreads[i].Connections();
+        if (i == 1 || load < minLoad)
+        {
             min = i;
+            minLoad = load;
+        }
+    }
 
     return m_NetThreads[min].AddSocket(sock);
 }
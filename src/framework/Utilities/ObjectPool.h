@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2005-2011 MaNGOS <http://getmangos.com/>
+ * Copyright (C) 2009-2011 MaNGOSZero <https://github.com/mangos/zero>
+ * Copyright (C) 2011-2016 Nostalrius <https://nostalrius.org>
+ * Copyright (C) 2016-2017 Elysium Project <https://github.com/elysium-project>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_OBJECTPOOL_H
+#define MANGOS_OBJECTPOOL_H
+
+#include "Platform/Define.h"
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace MaNGOS
+{
+    /// Allocation statistics of a subsystem, readable from any thread
+    struct AllocationCounters
+    {
+        AllocationCounters() : allocations(0), heapAllocations(0), frees(0) {}
+
+        std::atomic<uint64> allocations;        ///< Objects created
+        std::atomic<uint64> heapAllocations;    ///< Objects (or blocks) which had to be taken from the global allocator
+        std::atomic<uint64> frees;              ///< Objects destroyed
+
+        uint64 GetLiveCount() const { return allocations - frees; }
+    };
+
+    /**
+     * Recycles the memory of short lived objects of type T.
+     *
+     * Each thread keeps its own list of free blocks, so there is no locking:
+     * a block freed by a map thread is reused by the next object created by
+     * this same thread. A block may be freed by another thread than the one
+     * which allocated it. At most MaxFreeBlocks blocks are kept per thread,
+     * they are given back to the global allocator when the thread exits.
+     *
+     * Use it from the class operator new / operator delete:
+     *     static void* operator new(size_t size) { return MaNGOS::ObjectPool<Foo>::Allocate(size, counters); }
+     *     static void operator delete(void* p, size_t size) { MaNGOS::ObjectPool<Foo>::Free(p, size, counters); }
+     */
+    template <typename T, size_t MaxFreeBlocks = 128>
+    class ObjectPool
+    {
+        public:
+            static void* Allocate(size_t size, AllocationCounters& counters)
+            {
+                ++counters.allocations;
+                FreeList& freeList = GetFreeList();
+                // Derived classes without their own operator new end up here too
+                if (size == sizeof(T) && freeList.head)
+                {
+                    FreeBlock* block = freeList.head;
+                    freeList.head = block->next;
+                    --freeList.count;
+                    return block;
+                }
+                ++counters.heapAllocations;
+                return ::operator new(size);
+            }
+
+            static void Free(void* p, size_t size, AllocationCounters& counters)
+            {
+                if (!p)
+                    return;
+                ++counters.frees;
+                FreeList& freeList = GetFreeList();
+                if (size == sizeof(T) && freeList.count < MaxFreeBlocks)
+                {
+                    FreeBlock* block = static_cast<FreeBlock*>(p);
+                    block->next = freeList.head;
+                    freeList.head = block;
+                    ++freeList.count;
+                    return;
+                }
+                ::operator delete(p);
+            }
+
+        private:
+            struct FreeBlock
+            {
+                FreeBlock* next;
+            };
+            static_assert(sizeof(T) >= sizeof(FreeBlock), "ObjectPool: type too small");
+
+            struct FreeList
+            {
+                FreeList() : head(nullptr), count(0) {}
+                ~FreeList()
+                {
+                    while (head)
+                    {
+                        FreeBlock* block = head;
+                        head = block->next;
+                        ::operator delete(block);
+                    }
+                }
+
+                FreeBlock* head;
+                size_t count;
+            };
+
+            static FreeList& GetFreeList()
+            {
+                static thread_local FreeList freeList;
+                return freeList;
+            }
+    };
+}
+
+#endif
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2005-2011 MaNGOS <http://getmangos.com/>
+ * Copyright (C) 2009-2011 MaNGOSZero <https://github.com/mangos/zero>
+ * Copyright (C) 2011-2016 Nostalrius <https://nostalrius.org>
+ * Copyright (C) 2016-2017 Elysium Project <https://github.com/elysium-project>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_SMALLSTABLEVECTOR_H
+#define MANGOS_SMALLSTABLEVECTOR_H
+
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace MaNGOS
+{
+    /**
+     * Append only vector storing its first N elements inline.
+     *
+     * Elements are never moved once added: pointers and references stay valid
+     * while the vector grows (elements after the N first ones are stored in a
+     * std::deque, allocated on first use). Iterators are index based, so a loop comparing against end()
+     * also visits the elements added during the loop.
+     */
+    template <typename T, size_t N>
+    class SmallStableVector
+    {
+        public:
+            typedef T value_type;
+            typedef T& reference;
+            typedef T const& const_reference;
+            typedef size_t size_type;
+
+            static const size_t InlineCapacity = N;
+            static_assert(N > 0, "SmallStableVector: use std::deque without inline storage");
+
+            template <typename Container, typename Value>
+            class Iterator : public std::iterator<std::random_access_iterator_tag, Value>
+            {
+                public:
+                    Iterator() : m_container(nullptr), m_index(0) {}
+                    Iterator(Container* container, size_t index) : m_container(container), m_index(index) {}
+                    // iterator -> const_iterator
+                    template <typename C, typename V>
+                    Iterator(Iterator<C, V> const& other) : m_container(other.m_container), m_index(other.m_index) {}
+
+                    Value& operator*() const { return (*m_container)[m_index]; }
+                    Value* operator->() const { return &(*m_container)[m_index]; }
+                    Value& operator[](ptrdiff_t n) const { return (*m_container)[m_index + n]; }
+
+                    Iterator& operator++() { ++m_index; return *this; }
+                    Iterator operator++(int) { Iterator tmp(*this); ++m_index; return tmp; }
+                    Iterator& operator--() { --m_index; return *this; }
+                    Iterator operator--(int) { Iterator tmp(*this); --m_index; return tmp; }
+                    Iterator& operator+=(ptrdiff_t n) { m_index += n; return *this; }
+                    Iterator& operator-=(ptrdiff_t n) { m_index -= n; return *this; }
+                    Iterator operator+(ptrdiff_t n) const { return Iterator(m_container, m_index + n); }
+                    Iterator operator-(ptrdiff_t n) const { return Iterator(m_container, m_index - n); }
+                    ptrdiff_t operator-(Iterator const& other) const { return ptrdiff_t(m_index) - ptrdiff_t(other.m_index); }
+
+                    // Past the end iterators compare equal even if the vector has grown meanwhile
+                    bool operator==(Iterator const& other) const { return Position() == other.Position(); }
+                    bool operator!=(Iterator const& other) const { return Position() != other.Position(); }
+                    bool operator<(Iterator const& other) const { return m_index < other.m_index; }
+                    bool operator>(Iterator const& other) const { return m_index > other.m_index; }
+                    bool operator<=(Iterator const& other) const { return m_index <= other.m_index; }
+                    bool operator>=(Iterator const& other) const { return m_index >= other.m_index; }
+
+                private:
+                    template <typename C, typename V> friend class Iterator;
+
+                    size_t Position() const { return m_index < m_container->size() ? m_index : m_container->size(); }
+
+                    Container* m_container;
+                    size_t m_index;
+            };
+
+            typedef Iterator<SmallStableVector, T> iterator;
+            typedef Iterator<SmallStableVector const, T const> const_iterator;
+
+            SmallStableVector() : m_inlineSize(0) {}
+            SmallStableVector(SmallStableVector const& other) : m_inlineSize(0)
+            {
+                for (size_t i = 0; i < other.size(); ++i)
+                    push_back(other[i]);
+            }
+            SmallStableVector& operator=(SmallStableVector const& other)
+            {
+                if (this != &other)
+                {
+                    clear();
+                    for (size_t i = 0; i < other.size(); ++i)
+                        push_back(other[i]);
+                }
+                return *this;
+            }
+            ~SmallStableVector() { clear(); }
+
+            size_t size() const { return m_inlineSize + (m_overflow ? m_overflow->size() : 0); }
+            bool empty() const { return !m_inlineSize; }
+            /// True if some elements had to be stored on the heap
+            bool overflowed() const { return m_overflow && !m_overflow->empty(); }
+
+            T& operator[](size_t i) { return i < N ? InlineAt(i) : (*m_overflow)[i - N]; }
+            T const& operator[](size_t i) const { return i < N ? InlineAt(i) : (*m_overflow)[i - N]; }
+
+            T& front() { return (*this)[0]; }
+            T const& front() const { return (*this)[0]; }
+            T& back() { return (*this)[size() - 1]; }
+            T const& back() const { return (*this)[size() - 1]; }
+
+            iterator begin() { return iterator(this, 0); }
+            iterator end() { return iterator(this, size()); }
+            const_iterator begin() const { return const_iterator(this, 0); }
+            const_iterator end() const { return const_iterator(this, size()); }
+
+            void push_back(T const& value)
+            {
+                if (m_inlineSize < N)
+                {
+                    new (&InlineAt(m_inlineSize)) T(value);
+                    ++m_inlineSize;
+                }
+                else
+                {
+                    if (!m_overflow)
+                        m_overflow.reset(new std::deque<T>());
+                    m_overflow->push_back(value);
+                }
+            }
+
+            /// Keeps the overflow storage allocated once it has been needed
+            void clear()
+            {
+                if (m_overflow)
+                    m_overflow->clear();
+                for (size_t i = 0; i < m_inlineSize; ++i)
+                    InlineAt(i).~T();
+                m_inlineSize = 0;
+            }
+
+        private:
+            T& InlineAt(size_t i) { return reinterpret_cast<T*>(&m_inline)[i]; }
+            T const& InlineAt(size_t i) const { return reinterpret_cast<T const*>(&m_inline)[i]; }
+
+            typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type m_inline;
+            size_t m_inlineSize;
+            std::unique_ptr<std::deque<T> > m_overflow;
+    };
+}
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2005-2011 MaNGOS <http://getmangos.com/>
+ * Copyright (C) 2009-2011 MaNGOSZero <https://github.com/mangos/zero>
+ * Copyright (C) 2011-2016 Nostalrius <https://nostalrius.org>
+ * Copyright (C) 2016-2017 Elysium Project <https://github.com/elysium-project>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_SMALLVECTOR_H
+#define MANGOS_SMALLVECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace MaNGOS
+{
+    /**
+     * Contiguous vector storing its first N elements inline.
+     *
+     * Nothing is allocated until more than N elements are added, then all the
+     * elements move to a heap block grown by doubling. Iterators are plain
+     * pointers, invalidated by any insertion or removal. Only for trivially
+     * copyable types (object pointers, ids).
+     */
+    template <typename T, size_t N>
+    class SmallVector
+    {
+        public:
+            typedef T value_type;
+            typedef T& reference;
+            typedef T const& const_reference;
+            typedef T* iterator;
+            typedef T const* const_iterator;
+            typedef size_t size_type;
+
+            static const size_t InlineCapacity = N;
+            static_assert(N > 0, "SmallVector: use std::vector without inline storage");
+            static_assert(std::is_trivially_copyable<T>::value, "SmallVector: elements are moved with memcpy");
+
+            SmallVector() : m_data(m_inline), m_size(0), m_capacity(N) {}
+            SmallVector(SmallVector const& other) : m_data(m_inline), m_size(0), m_capacity(N)
+            {
+                Append(other.begin(), other.size());
+            }
+            SmallVector& operator=(SmallVector const& other)
+            {
+                if (this != &other)
+                {
+                    clear();
+                    Append(other.begin(), other.size());
+                }
+                return *this;
+            }
+            ~SmallVector()
+            {
+                if (overflowed())
+                    delete[] m_data;
+            }
+
+            size_t size() const { return m_size; }
+            size_t capacity() const { return m_capacity; }
+            bool empty() const { return !m_size; }
+            /// True if the elements had to be moved to the heap
+            bool overflowed() const { return m_data != m_inline; }
+
+            T& operator[](size_t i) { return m_data[i]; }
+            T const& operator[](size_t i) const { return m_data[i]; }
+
+            T& front() { return m_data[0]; }
+            T const& front() const { return m_data[0]; }
+            T& back() { return m_data[m_size - 1]; }
+            T const& back() const { return m_data[m_size - 1]; }
+
+            iterator begin() { return m_data; }
+            iterator end() { return m_data + m_size; }
+            const_iterator begin() const { return m_data; }
+            const_iterator end() const { return m_data + m_size; }
+
+            void push_back(T const& value)
+            {
+                if (m_size == m_capacity)
+                    Grow();
+                m_data[m_size++] = value;
+            }
+
+            void push_front(T const& value)
+            {
+                if (m_size == m_capacity)
+                    Grow();
+                memmove(m_data + 1, m_data, m_size * sizeof(T));
+                m_data[0] = value;
+                ++m_size;
+            }
+
+            iterator erase(iterator pos)
+            {
+                memmove(pos, pos + 1, (end() - pos - 1) * sizeof(T));
+                --m_size;
+                return pos;
+            }
+
+            void remove(T const& value)
+            {
+                m_size = std::remove(begin(), end(), value) - begin();
+            }
+
+            /// Stable, as std::list::sort. Insertion sort while the elements are inline, so that sorting allocates nothing.
+            /// Once overflowed, std::stable_sort allocates a temporary buffer as large as the elements
+            template <typename Compare>
+            void sort(Compare comp)
+            {
+                if (overflowed())
+                {
+                    std::stable_sort(begin(), end(), comp);
+                    return;
+                }
+
+                for (size_t i = 1; i < m_size; ++i)
+                {
+                    T value = m_data[i];
+                    size_t j = i;
+                    for (; j > 0 && comp(value, m_data[j - 1]); --j)
+                        m_data[j] = m_data[j - 1];
+                    m_data[j] = value;
+                }
+            }
+
+            /// Keeps the heap block, if any, for the next elements
+            void clear() { m_size = 0; }
+
+        private:
+            void Grow()
+            {
+                T* data = new T[m_capacity * 2];
+                memcpy(data, m_data, m_size * sizeof(T));
+                if (overflowed())
+                    delete[] m_data;
+                m_data = data;
+                m_capacity *= 2;
+            }
+
+            void Append(T const* values, size_t count)
+            {
+                for (size_t i = 0; i < count; ++i)
+                    push_back(values[i]);
+            }
+
+            T* m_data;
+            size_t m_size;
+            size_t m_capacity;
+            T m_inline[N];
+    };
+}
+
+#endif
@@ -16,6 +16,8 @@ void AddTest_controls();
 void AddTest_channeling();
 void AddTest_auras_stack();
 void AddTest_packet_broadcaster();
+void AddTest_map_nodes();
+void AddTest_who_list();
 
 void LoadTests()
 {
@@ -30,4 +32,6 @@ void LoadTests()
     AddTest_auras_stack();
     AddTest_cinematics();
     AddTest_packet_broadcaster();
+    AddTest_map_nodes();
+    AddTest_who_list();
 }
@@ -51,6 +51,113 @@ public:
     }
 };
 
+// Cached aura aggregates (Unit::GetTotalAuraModifier...) against a walk of the auras list
+class check_aura_modifier_cache : public SingleTest
+{
+public:
+    check_aura_modifier_cache() : SingleTest("aura_modifier_cache", MAP_TESTING_ID, false)
+    {
+    }
+
+    void CheckAuraModifiers(Unit* unit)
+    {
+        for (uint32 type = 0; type < TOTAL_AURAS; ++type)
+        {
+            AuraType auraType = AuraType(type);
+            Unit::AuraList const& auras = unit->GetAurasByType(auraType);
+
+            int32 total = 0;
+            float multiplier = 1.0f;
+            int32 maxPositive = 0;
+            int32 maxNegative = 0;
+            for (Unit::AuraList::const_iterator i = auras.begin(); i != auras.end(); ++i)
+            {
+                int32 amount = (*i)->GetModifier()->m_amount;
+                if ((*i)->GetId() != 2836)
+                    total += amount;
+                multiplier *= (100.0f + amount) / 100.0f;
+                maxPositive = std::max(maxPositive, amount);
+                maxNegative = std::min(maxNegative, amount);
+            }
+            TEST_ASSERT(unit->GetTotalAuraModifier(auraType) == total);
+            TEST_ASSERT(fabs(unit->GetTotalAuraMultiplier(auraType) - multiplier) < 0.0001f);
+            TEST_ASSERT(unit->GetMaxPositiveAuraModifier(auraType) == maxPositive);
+            TEST_ASSERT(unit->GetMaxNegativeAuraModifier(auraType) == maxNegative);
+
+            for (uint32 mask = 1; mask < (1 << MAX_SPELL_SCHOOL); mask <<= 1)
+            {
+                int32 maskTotal = 0;
+                float maskMultiplier = 1.0f;
+                for (Unit::AuraList::const_iterator i = auras.begin(); i != auras.end(); ++i)
+                {
+                    if ((*i)->GetModifier()->m_miscvalue & mask)
+                    {
+                        maskTotal += (*i)->GetModifier()->m_amount;
+                        maskMultiplier *= (100.0f + (*i)->GetModifier()->m_amount) / 100.0f;
+                    }
+                }
+                TEST_ASSERT(unit->GetTotalAuraModifierByMiscMask(auraType, mask) == maskTotal);
+                TEST_ASSERT(fabs(unit->GetTotalAuraMultiplierByMiscMask(auraType, mask) - maskMultiplier) < 0.0001f);
+            }
+        }
+    }
+
+    void Test() override
+    {
+        Player* pl;
+        switch (GetTestStep())
+        {
+            case 0:
+                SpawnPlayer(0, CLASS_WARRIOR, RACE_HUMAN, 0, 0);
+                WaitPlayerSummon();
+                break;
+            case 1:
+            {
+                pl = GetTestPlayer(0, TESTPLAYER_MAXLEVEL);
+                CheckAuraModifiers(pl);
+
+                // Several SPELL_AURA_MOD_STAT, long enough to be cached
+                uint32 const buffs[] = { SPELL_FORTITUDE_R1, SPELL_ARCANE_INTELLECT_R1, SPELL_DIVINE_SPIRIT_R1, SPELL_MARK_OF_THE_WILD_R2 };
+                for (uint32 i = 0; i < sizeof(buffs) / sizeof(buffs[0]); ++i)
+                {
+                    pl->AddAura(buffs[i]);
+                    CheckAuraModifiers(pl);
+                }
+                TEST_ASSERT(pl->GetAurasByType(SPELL_AURA_MOD_STAT).size() >= AURA_MODIFIER_CACHE_MIN_AURAS);
+
+                // Amount change, as done at stack change
+                Aura* aura = pl->GetAura(SPELL_FORTITUDE_R1, EFFECT_INDEX_0);
+                TEST_ASSERT(aura);
+                if (aura)
+                {
+                    aura->ApplyModifier(false, true);
+                    aura->GetModifier()->m_amount += 10;
+                    aura->ApplyModifier(true, true);
+                    CheckAuraModifiers(pl);
+                }
+
+                pl->RemoveAurasDueToSpell(SPELL_ARCANE_INTELLECT_R1);
+                CheckAuraModifiers(pl);
+                pl->RemoveAllAuras();
+                CheckAuraModifiers(pl);
+                break;
+            }
+            case 2:
+                Finish();
+                break;
+        }
+        NextStep();
+    }
+
+    enum
+    {
+        SPELL_FORTITUDE_R1          = 1243,
+        SPELL_ARCANE_INTELLECT_R1   = 1459,
+        SPELL_DIVINE_SPIRIT_R1      = 14752,
+        SPELL_MARK_OF_THE_WILD_R2   = 5232,
+    };
+};
+
 enum
 {
     SPELL_CONSECRATION_R1   = 26573,
@@ -65,5 +172,6 @@ void AddTest_auras_stack()
     sAutoTestingMgr->AddTest(new check_auras_stack("aura_stack_consecration_r1_r1", SPELL_CONSECRATION_R1, SPELL_CONSECRATION_R1));
     sAutoTestingMgr->AddTest(new check_auras_stack("aura_stack_blizzard_r1_r2", SPELL_BLIZZARD_R1, SPELL_BLIZZARD_R2));
     sAutoTestingMgr->AddTest(new check_auras_stack("aura_stack_blizzard_r1_r1", SPELL_BLIZZARD_R1, SPELL_BLIZZARD_R1));
+    sAutoTestingMgr->AddTest(new check_aura_modifier_cache());
 }
 
@@ -0,0 +1,139 @@
+/*
+* MapNodes.cpp
+*
+*/
+#include "TestPCH.h"
+#include "PlayerSnapshot.h"
+
+#include "ace/ACE.h"
+#include "ace/Pipe.h"
+
+class check_player_snapshot : public SingleTest
+{
+public:
+    check_player_snapshot() : SingleTest("player_snapshot", MAP_TESTING_ID, false)
+    {
+    }
+
+    // Sends $in through a local socket pair, as it would be sent to a Node.
+    bool TransferOverLocalSocket(ByteBuffer const& in, ByteBuffer& out)
+    {
+        ACE_Pipe pipe;
+        if (pipe.open() == -1)
+            return false;
+
+        uint32 size = in.wpos();
+        bool ok = ACE::send_n(pipe.write_handle(), &size, sizeof(size)) == ssize_t(sizeof(size));
+        ok = ok && ACE::recv_n(pipe.read_handle(), &size, sizeof(size)) == ssize_t(sizeof(size)) && size == in.wpos();
+        out.resize(size);
+        // Chunks smaller than the socket buffers, so both ends can be handled by this thread
+        for (uint32 offset = 0; ok && offset < size; offset += 4096)
+        {
+            uint32 chunk = std::min<uint32>(4096, size - offset);
+            ok = ACE::send_n(pipe.write_handle(), in.contents() + offset, chunk) == ssize_t(chunk);
+            ok = ok && ACE::recv_n(pipe.read_handle(), const_cast<uint8*>(out.contents()) + offset, chunk) == ssize_t(chunk);
+        }
+        pipe.close();
+        return ok;
+    }
+
+    void CheckSameSections(PlayerSnapshot const& a, PlayerSnapshot const& b)
+    {
+        for (uint32 i = 0; i < MAX_PLAYER_SNAPSHOT_SECTIONS; ++i)
+        {
+            ByteBuffer const* sectionA = a.GetSection(i);
+            ByteBuffer const* sectionB = b.GetSection(i);
+            TEST_ASSERT(sectionA && sectionB);
+            if (!sectionA || !sectionB)
+                continue;
+            TEST_ASSERT(sectionA->wpos() == sectionB->wpos());
+            TEST_ASSERT(sectionA->wpos() == 0 || !memcmp(sectionA->contents(), sectionB->contents(), sectionA->wpos()));
+        }
+    }
+
+    void CheckRoundTrip(PlayerSnapshot const& snapshot, bool compress)
+    {
+        ByteBuffer encoded;
+        snapshot.Encode(encoded, compress);
+        if (!compress)
+            TEST_ASSERT(encoded.wpos() > snapshot.GetRawSize());
+
+        ByteBuffer received;
+        TEST_ASSERT(TransferOverLocalSocket(encoded, received));
+        TEST_ASSERT(received.wpos() == encoded.wpos());
+
+        PlayerSnapshot decoded;
+        TEST_ASSERT(decoded.Decode(received));
+        TEST_ASSERT(received.rpos() == received.wpos());
+        TEST_ASSERT(decoded.GetRawSize() == snapshot.GetRawSize());
+        CheckSameSections(snapshot, decoded);
+
+        // Corrupted header
+        ByteBuffer corrupted(encoded);
+        corrupted.put<uint32>(0, 0);
+        PlayerSnapshot invalid;
+        TEST_ASSERT(!invalid.Decode(corrupted));
+
+        // Truncated payload
+        ByteBuffer truncated;
+        truncated.append(encoded.contents(), encoded.wpos() - 1);
+        TEST_ASSERT(!invalid.Decode(truncated));
+
+        // Oversized raw size (magic + version + flags, then raw size)
+        ByteBuffer oversized(encoded);
+        oversized.put<uint32>(8, PLAYER_SNAPSHOT_MAX_RAW_SIZE + 1);
+        TEST_ASSERT(!invalid.Decode(oversized));
+    }
+
+    void Test() override
+    {
+        Player* pl;
+        switch (GetTestStep())
+        {
+            case 0:
+                SpawnPlayer(0, CLASS_WARRIOR, RACE_HUMAN, 0, 0);
+                WaitPlayerSummon();
+                break;
+            case 1:
+            {
+                pl = GetTestPlayer(0, TESTPLAYER_MAXLEVEL);
+                pl->AddAura(SPELL_FORTITUDE_R1);
+                pl->StoreNewItemInBestSlots(ITEM_LINEN_CLOTH, 20);
+
+                PlayerSnapshot snapshot;
+                snapshot.Capture(*pl);
+                TEST_ASSERT(snapshot.IsComplete());
+                TEST_ASSERT(snapshot.GetSection(PLAYER_SNAPSHOT_AURAS)->wpos() > sizeof(uint32));
+                TEST_ASSERT(snapshot.GetSection(PLAYER_SNAPSHOT_INVENTORY)->wpos() > sizeof(uint32));
+
+                CheckRoundTrip(snapshot, false);
+                CheckRoundTrip(snapshot, true);
+
+                // Copy on write: a copy shares the sections until it modifies them
+                PlayerSnapshot copy(snapshot);
+                TEST_ASSERT(copy.GetSection(PLAYER_SNAPSHOT_SPELLS) == snapshot.GetSection(PLAYER_SNAPSHOT_SPELLS));
+                uint32 fieldsSize = snapshot.GetSection(PLAYER_SNAPSHOT_FIELDS)->wpos();
+                copy.ModifySection(PLAYER_SNAPSHOT_FIELDS) << uint32(0);
+                TEST_ASSERT(copy.GetSection(PLAYER_SNAPSHOT_FIELDS) != snapshot.GetSection(PLAYER_SNAPSHOT_FIELDS));
+                TEST_ASSERT(snapshot.GetSection(PLAYER_SNAPSHOT_FIELDS)->wpos() == fieldsSize);
+                TEST_ASSERT(copy.GetSection(PLAYER_SNAPSHOT_SPELLS) == snapshot.GetSection(PLAYER_SNAPSHOT_SPELLS));
+                break;
+            }
+            case 2:
+                Finish();
+                break;
+        }
+        NextStep();
+    }
+
+    enum
+    {
+        SPELL_FORTITUDE_R1  = 1243,
+        ITEM_LINEN_CLOTH    = 2589,
+    };
+};
+
+void AddTest_map_nodes()
+{
+    sAutoTestingMgr->AddTest(new check_player_snapshot());
+}
@@ -0,0 +1,91 @@
+/*
+* WhoList.cpp
+*
+*/
+#include "TestPCH.h"
+#include "WhoListIndex.h"
+#include "WorldSession.h"
+#include "Guild.h"
+#include "GuildMgr.h"
+
+class who_list_guild_name : public SingleTest
+{
+public:
+    who_list_guild_name() : SingleTest("who_list_guild_name")
+    {
+    }
+
+    // Returns the guild name listed for $player, or false if /who does not find it
+    bool Who(Player* player, std::string const& guildFilter, std::string& listedGuild)
+    {
+        WhoListQuery query;
+        query.levelMin = 0;
+        query.levelMax = 100;
+        query.raceMask = 0xFFFFFFFF;
+        query.classMask = 0xFFFFFFFF;
+        query.zonesCount = 0;
+        query.stringsCount = 0;
+        Utf8toWStr(player->GetName(), query.playerName);
+        wstrToLower(query.playerName);
+        Utf8toWStr(guildFilter, query.guildName);
+        wstrToLower(query.guildName);
+
+        WorldPacket data(SMSG_WHO, 50);
+        sWhoListIndex.BuildWhoList(player->GetSession(), query, data);
+        uint32 listed, online;
+        data >> listed >> online;
+        for (uint32 i = 0; i < listed; ++i)
+        {
+            std::string name;
+            uint32 level, classId, race, zoneId;
+            data >> name >> listedGuild >> level >> classId >> race >> zoneId;
+            if (name == player->GetName())
+                return true;
+        }
+        return false;
+    }
+
+    void Test() override
+    {
+        switch (GetTestStep())
+        {
+            case 0:
+                SpawnPlayer(0, CLASS_WARRIOR, RACE_HUMAN);
+                WaitPlayerSummon();
+                break;
+            case 1:
+            {
+                Player* player = GetTestPlayer(0);
+                std::string listedGuild;
+                TEST_ASSERT(Who(player, "", listedGuild));
+                TEST_ASSERT(listedGuild.empty());
+
+                // Guild::Create sets the guild of the leader before GuildMgr knows the guild
+                std::ostringstream gname;
+                gname << "WhoListTest" << player->GetGUIDLow();
+                Guild* guild = new Guild;
+                if (!guild->Create(player, gname.str()))
+                {
+                    delete guild;
+                    Fail("Unable to create guild %s", gname.str().c_str());
+                    break;
+                }
+                sGuildMgr.AddGuild(guild);
+
+                TEST_ASSERT(Who(player, gname.str(), listedGuild));
+                TEST_ASSERT(listedGuild == gname.str());
+
+                guild->Disband();
+                delete guild;
+                Finish();
+                break;
+            }
+        }
+        NextStep();
+    }
+};
+
+void AddTest_who_list()
+{
+    sAutoTestingMgr->AddTest(new who_list_guild_name());
+}
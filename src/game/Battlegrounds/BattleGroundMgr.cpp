@@ -56,6 +56,14 @@ BattleGroundQueue::BattleGroundQueue()
                 m_WaitTimes[i][j][k] = 0;
         }
     }
+    for (uint32 i = 0; i < MAX_BATTLEGROUND_BRACKETS; ++i)
+    {
+        for (uint32 j = 0; j < BG_QUEUE_GROUP_TYPES_COUNT; ++j)
+        {
+            m_WaitingPlayers[i][j] = 0;
+            m_WaitingGroups[i][j] = 0;
+        }
+    }
 }
 
 BattleGroundQueue::~BattleGroundQueue()
@@ -150,6 +158,7 @@ GroupQueueInfo * BattleGroundQueue::AddGroup(Player *leader, Group* grp, BattleG
     ginfo->RemoveInviteTime          = 0;
     ginfo->GroupTeam                 = leader->GetTeam();
     ginfo->BracketId                 = bracketId;
+    ginfo->QueueType                 = BG_QUEUE_PREMADE_ALLIANCE;
     ginfo->Players.clear();
 
     //compute index (if group is premade or joined a rated match) to queues
@@ -213,7 +222,7 @@ GroupQueueInfo * BattleGroundQueue::AddGroup(Player *leader, Group* grp, BattleG
 
         //add GroupInfo to m_QueuedGroups
         if (ginfo->Players.size())
-            m_QueuedGroups[bracketId][index].push_back(ginfo);
+            EnqueueGroup(ginfo, index);
         else
             return ginfo; // group size was above limit
 
@@ -225,17 +234,10 @@ GroupQueueInfo * BattleGroundQueue::AddGroup(Player *leader, Group* grp, BattleG
             {
                 char const* bgName = bg->GetName();
                 uint32 MinPlayers = bg->GetMinPlayersPerTeam();
-                uint32 qHorde = 0;
-                uint32 qAlliance = 0;
+                uint32 qHorde = m_WaitingPlayers[bracketId][BG_QUEUE_NORMAL_HORDE];
+                uint32 qAlliance = m_WaitingPlayers[bracketId][BG_QUEUE_NORMAL_ALLIANCE];
                 uint32 q_min_level = leader->GetMinLevelForBattleGroundBracketId(bracketId, BgTypeId);
                 uint32 q_max_level = leader->GetMaxLevelForBattleGroundBracketId(bracketId, BgTypeId);
-                GroupsQueueType::const_iterator itr;
-                for (itr = m_QueuedGroups[bracketId][BG_QUEUE_NORMAL_ALLIANCE].begin(); itr != m_QueuedGroups[bracketId][BG_QUEUE_NORMAL_ALLIANCE].end(); ++itr)
-                    if (!(*itr)->IsInvitedToBGInstanceGUID)
-                        qAlliance += (*itr)->Players.size();
-                for (itr = m_QueuedGroups[bracketId][BG_QUEUE_NORMAL_HORDE].begin(); itr != m_QueuedGroups[bracketId][BG_QUEUE_NORMAL_HORDE].end(); ++itr)
-                    if (!(*itr)->IsInvitedToBGInstanceGUID)
-                        qHorde += (*itr)->Players.size();
 
                 // Show queue status to player only (when joining queue)
                 if (sWorld.getConfig(CONFIG_UINT32_BATTLEGROUND_QUEUE_ANNOUNCER_JOIN) == 1)
@@ -314,7 +316,6 @@ void BattleGroundQueue::RemovePlayer(ObjectGuid guid, bool decreaseInvitedCount)
     //Player *plr = sObjectMgr.GetPlayer(guid);
     //ACE_Guard<ACE_Recursive_Thread_Mutex> guard(m_Lock);
 
-    int32 bracket_id = -1;                                     // signed for proper for-loop finish
     QueuedPlayersMap::iterator itr;
 
     //remove player from map, if he's there
@@ -326,37 +327,16 @@ void BattleGroundQueue::RemovePlayer(ObjectGuid guid, bool decreaseInvitedCount)
     }
 
     GroupQueueInfo* group = itr->second.GroupInfo;
-    GroupsQueueType::iterator group_itr, group_itr_tmp;
-    // mostly people with the highest levels are in battlegrounds, thats why
-    // we count from MAX_BATTLEGROUND_QUEUES - 1 to 0
-    // variable index removes useless searching in other team's queue
-    uint32 index = BattleGround::GetTeamIndexByTeamId(group->GroupTeam);
-
-    for (int32 bracket_id_tmp = MAX_BATTLEGROUND_BRACKETS - 1; bracket_id_tmp >= 0 && bracket_id == -1; --bracket_id_tmp)
-    {
-        //we must check premade and normal team's queue - because when players from premade are joining bg,
-        //they leave groupinfo so we can't use its players size to find out index
-        for (uint32 j = index; j < BG_QUEUE_GROUP_TYPES_COUNT; j += BG_QUEUE_NORMAL_ALLIANCE)
-        {
-            for (group_itr_tmp = m_QueuedGroups[bracket_id_tmp][j].begin(); group_itr_tmp != m_QueuedGroups[bracket_id_tmp][j].end(); ++group_itr_tmp)
-            {
-                if ((*group_itr_tmp) == group)
-                {
-                    bracket_id = bracket_id_tmp;
-                    group_itr = group_itr_tmp;
-                    //we must store index to be able to erase iterator
-                    index = j;
-                    break;
-                }
-            }
-        }
-    }
+    // the group knows its bracket and queue, premade groups moved to the normal queue update it
+    GroupsQueueType& queue = m_QueuedGroups[group->BracketId][group->QueueType];
+    GroupsQueueType::iterator group_itr = std::find(queue.begin(), queue.end(), group);
     //player can't be in queue without group, but just in case
-    if (bracket_id == -1)
+    if (group_itr == queue.end())
     {
         sLog.outError("BattleGroundQueue: ERROR Cannot find groupinfo for %s", guid.GetString().c_str());
         return;
     }
+    uint32 bracket_id = group->BracketId;
     DEBUG_LOG("BattleGroundQueue: Removing %s, from bracket_id %u", guid.GetString().c_str(), (uint32)bracket_id);
 
     // ALL variables are correctly set
@@ -367,7 +347,11 @@ void BattleGroundQueue::RemovePlayer(ObjectGuid guid, bool decreaseInvitedCount)
     // remove player queue info from group queue info
     GroupQueueInfoPlayers::iterator pitr = group->Players.find(guid);
     if (pitr != group->Players.end())
+    {
         group->Players.erase(pitr);
+        if (!group->IsInvitedToBGInstanceGUID)
+            --m_WaitingPlayers[bracket_id][group->QueueType];
+    }
 
     // if invited to bg, and should decrease invited count, then do it
     if (decreaseInvitedCount && group->IsInvitedToBGInstanceGUID)
@@ -383,7 +367,9 @@ void BattleGroundQueue::RemovePlayer(ObjectGuid guid, bool decreaseInvitedCount)
     // remove group queue info if needed
     if (group->Players.empty())
     {
-        m_QueuedGroups[bracket_id][index].erase(group_itr);
+        if (!group->IsInvitedToBGInstanceGUID)
+            --m_WaitingGroups[bracket_id][group->QueueType];
+        queue.erase(group_itr);
         delete group;
     }
 }
@@ -408,6 +394,27 @@ bool BattleGroundQueue::GetPlayerGroupInfoData(ObjectGuid guid, GroupQueueInfo*
     return true;
 }
 
+// adds a group at the end of one of the bracket queues
+void BattleGroundQueue::EnqueueGroup(GroupQueueInfo* ginfo, uint32 queueType)
+{
+    ginfo->QueueType = queueType;
+    m_QueuedGroups[ginfo->BracketId][queueType].push_back(ginfo);
+    if (!ginfo->IsInvitedToBGInstanceGUID)
+    {
+        m_WaitingPlayers[ginfo->BracketId][queueType] += ginfo->Players.size();
+        ++m_WaitingGroups[ginfo->BracketId][queueType];
+    }
+}
+
+// invited groups stay in queue until they enter the battleground, but are not waiting anymore
+void BattleGroundQueue::SetGroupInvited(GroupQueueInfo* ginfo, uint32 bgInstanceId)
+{
+    MANGOS_ASSERT(!ginfo->IsInvitedToBGInstanceGUID);
+    ginfo->IsInvitedToBGInstanceGUID = bgInstanceId;
+    m_WaitingPlayers[ginfo->BracketId][ginfo->QueueType] -= ginfo->Players.size();
+    --m_WaitingGroups[ginfo->BracketId][ginfo->QueueType];
+}
+
 bool BattleGroundQueue::InviteGroupToBG(GroupQueueInfo * ginfo, BattleGround * bg, Team side)
 {
     // set side if needed
@@ -418,7 +425,7 @@ bool BattleGroundQueue::InviteGroupToBG(GroupQueueInfo * ginfo, BattleGround * b
     {
         // not yet invited
         // set invitation
-        ginfo->IsInvitedToBGInstanceGUID = bg->GetInstanceID();
+        SetGroupInvited(ginfo, bg->GetInstanceID());
         BattleGroundTypeId bgTypeId = bg->GetTypeID();
         BattleGroundQueueTypeId bgQueueTypeId = BattleGroundMgr::BGQueueTypeId(bgTypeId);
         BattleGroundBracketId bracket_id = bg->GetBracketId();
@@ -598,8 +605,11 @@ bool BattleGroundQueue::CheckPremadeMatch(BattleGroundBracketId bracket_id, uint
             if (!(*itr)->IsInvitedToBGInstanceGUID && ((*itr)->JoinTime < time_before || (*itr)->Players.size() < MinPlayersPerTeam))
             {
                 //we must insert group to normal queue and erase pointer from premade queue
-                m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].push_back((*itr));
+                GroupQueueInfo* ginfo = *itr;
                 m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i].erase(itr);
+                m_WaitingPlayers[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i] -= ginfo->Players.size();
+                --m_WaitingGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i];
+                EnqueueGroup(ginfo, BG_QUEUE_NORMAL_ALLIANCE + i);
             }
         }
     }
@@ -610,6 +620,11 @@ bool BattleGroundQueue::CheckPremadeMatch(BattleGroundBracketId bracket_id, uint
 // this method tries to create battleground with MinPlayersPerTeam against MinPlayersPerTeam
 bool BattleGroundQueue::CheckNormalMatch(BattleGroundBracketId bracket_id, uint32 minPlayers, uint32 maxPlayers)
 {
+    // not enough waiting players on one side, no need to build the selection pools
+    if (!sBattleGroundMgr.isTesting() &&
+            (m_WaitingPlayers[bracket_id][BG_QUEUE_NORMAL_ALLIANCE] < minPlayers || m_WaitingPlayers[bracket_id][BG_QUEUE_NORMAL_HORDE] < minPlayers))
+        return false;
+
     GroupsQueueType::const_iterator itr_team[BG_TEAMS_COUNT];
     for (uint32 i = 0; i < BG_TEAMS_COUNT; i++)
     {
@@ -660,22 +675,19 @@ void BattleGroundQueue::Update(BattleGroundTypeId bgTypeId, BattleGroundBracketI
 {
     //ACE_Guard<ACE_Recursive_Thread_Mutex> guard(m_Lock);
     // First, remove old offline players
-    QueuedPlayersMap::iterator itrOffline = m_QueuedPlayers.begin();
-    while (itrOffline != m_QueuedPlayers.end())
+    while (!m_OfflinePlayers.empty() && WorldTimer::getMSTimeDiffToNow(m_OfflinePlayers.front().second) > OFFLINE_BG_QUEUE_TIME)
     {
-        if (!itrOffline->second.online && WorldTimer::getMSTimeDiffToNow(itrOffline->second.LastOnlineTime) > OFFLINE_BG_QUEUE_TIME)
-        {
+        QueuedPlayersMap::const_iterator itrOffline = m_QueuedPlayers.find(m_OfflinePlayers.front().first);
+        // player may have left the queue, or logged in (and maybe out again) meanwhile
+        if (itrOffline != m_QueuedPlayers.end() && !itrOffline->second.online && itrOffline->second.LastOnlineTime == m_OfflinePlayers.front().second)
             RemovePlayer(itrOffline->first, true);
-            itrOffline = m_QueuedPlayers.begin();
-        }
-        else
-            ++itrOffline;
+        m_OfflinePlayers.pop_front();
     }
-    //if no players in queue - do nothing
-    if (m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].empty() &&
-            m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].empty() &&
-            m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE].empty() &&
-            m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_HORDE].empty())
+    //if no players waiting for an invitation in queue - do nothing
+    if (!m_WaitingGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE] &&
+            !m_WaitingGroups[bracket_id][BG_QUEUE_PREMADE_HORDE] &&
+            !m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE] &&
+            !m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_HORDE])
         return;
 
     if (sWorld.getConfig(CONFIG_BOOL_BATTLEGROUND_RANDOMIZE))
@@ -735,17 +747,10 @@ void BattleGroundQueue::Update(BattleGroundTypeId bgTypeId, BattleGroundBracketI
     // now check if there are in queues enough players to start new game of (normal battleground)
     if (bgTypeId == BATTLEGROUND_AV && sWorld.getConfig(CONFIG_UINT32_AV_MIN_PLAYERS_IN_QUEUE) && !sBattleGroundMgr.isTesting())
     {
-        int minPlayersInQueue = sWorld.getConfig(CONFIG_UINT32_AV_MIN_PLAYERS_IN_QUEUE);
-        int playersInQueuePerTeam[BG_TEAMS_COUNT] = {0};
-        for (uint32 i = 0; i < BG_TEAMS_COUNT; i++)
-        {
-            GroupsQueueType::const_iterator itr = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].begin();
-            for (; itr != m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].end(); ++itr)
-                if (!(*itr)->IsInvitedToBGInstanceGUID)
-                    playersInQueuePerTeam[i]++; // Only one player, because premades are not allowed in AV.
-        }
-        if (playersInQueuePerTeam[BG_TEAM_ALLIANCE] < minPlayersInQueue ||
-                playersInQueuePerTeam[BG_TEAM_HORDE] < minPlayersInQueue)
+        uint32 minPlayersInQueue = sWorld.getConfig(CONFIG_UINT32_AV_MIN_PLAYERS_IN_QUEUE);
+        // Only one player per group, because premades are not allowed in AV.
+        if (m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE] < minPlayersInQueue ||
+                m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_HORDE] < minPlayersInQueue)
             normalMatchesCreationAttempts = 0;
         else
         {
@@ -818,6 +823,87 @@ void BattleGroundQueue::Update(BattleGroundTypeId bgTypeId, BattleGroundBracketI
     }
 }
 
+// Solo players join (and sometimes leave) the queue of bracket 0, and the normal match is checked after each change,
+// as Update would do. Matched groups are invited and then enter their battleground (leave the queue).
+void BattleGroundQueue::Simulate(uint32 operations, uint32 minPlayers, uint32 maxPlayers, uint32& matchesCount, uint32& matchTime, uint32& totalTime)
+{
+    BattleGroundBracketId const bracket_id = BattleGroundBracketId(0);
+    std::vector<ObjectGuid> queued;
+    uint32 nextGuid = 1;
+    matchesCount = 0;
+    matchTime = 0;
+
+    uint32 startTime = WorldTimer::getMSTime();
+    for (uint32 i = 0; i < operations; ++i)
+    {
+        if (queued.empty() || urand(0, 3))
+        {
+            GroupQueueInfo* ginfo = new GroupQueueInfo;
+            ginfo->BgTypeId = BATTLEGROUND_WS;
+            ginfo->IsInvitedToBGInstanceGUID = 0;
+            ginfo->JoinTime = WorldTimer::getMSTime();
+            ginfo->RemoveInviteTime = 0;
+            ginfo->GroupTeam = urand(0, 1) ? ALLIANCE : HORDE;
+            ginfo->BracketId = bracket_id;
+
+            ObjectGuid guid(HIGHGUID_PLAYER, nextGuid++);
+            PlayerQueueInfo& pl_info = m_QueuedPlayers[guid];
+            pl_info.online = true;
+            pl_info.LastOnlineTime = 0;
+            pl_info.GroupInfo = ginfo;
+            ginfo->Players[guid] = &pl_info;
+            EnqueueGroup(ginfo, ginfo->GroupTeam == HORDE ? BG_QUEUE_NORMAL_HORDE : BG_QUEUE_NORMAL_ALLIANCE);
+            queued.push_back(guid);
+        }
+        else
+        {
+            uint32 idx = urand(0, queued.size() - 1);
+            RemovePlayer(queued[idx], false);
+            queued[idx] = queued.back();
+            queued.pop_back();
+        }
+
+        uint32 matchStartTime = WorldTimer::getMSTime();
+        m_SelectionPools[BG_TEAM_ALLIANCE].Init();
+        m_SelectionPools[BG_TEAM_HORDE].Init();
+        bool matched = CheckNormalMatch(bracket_id, minPlayers, maxPlayers);
+        matchTime += WorldTimer::getMSTimeDiffToNow(matchStartTime);
+        if (!matched)
+            continue;
+
+        ++matchesCount;
+        std::set<ObjectGuid> entered;
+        for (uint32 team = 0; team < BG_TEAMS_COUNT; ++team)
+        {
+            for (GroupsQueueType::const_iterator citr = m_SelectionPools[team].SelectedGroups.begin(); citr != m_SelectionPools[team].SelectedGroups.end(); ++citr)
+            {
+                SetGroupInvited(*citr, matchesCount);
+                for (GroupQueueInfoPlayers::const_iterator pitr = (*citr)->Players.begin(); pitr != (*citr)->Players.end(); ++pitr)
+                    entered.insert(pitr->first);
+            }
+        }
+        for (std::set<ObjectGuid>::const_iterator itr = entered.begin(); itr != entered.end(); ++itr)
+            RemovePlayer(*itr, false);
+        for (uint32 j = 0; j < queued.size();)
+        {
+            if (entered.find(queued[j]) != entered.end())
+            {
+                queued[j] = queued.back();
+                queued.pop_back();
+            }
+            else
+                ++j;
+        }
+    }
+    totalTime = WorldTimer::getMSTimeDiffToNow(startTime);
+
+    while (!queued.empty())
+    {
+        RemovePlayer(queued.back(), false);
+        queued.pop_back();
+    }
+}
+
 /*********************************************************/
 /***            BATTLEGROUND QUEUE EVENTS              ***/
 /*********************************************************/
@@ -1699,6 +1785,7 @@ void BattleGroundQueue::PlayerLoggedOut(ObjectGuid guid)
     }
     itr->second.LastOnlineTime  = WorldTimer::getMSTime();
     itr->second.online          = false;
+    m_OfflinePlayers.push_back(std::make_pair(guid, itr->second.LastOnlineTime));
 }
 
 bool BattleGroundQueue::PlayerLoggedIn(Player* player)
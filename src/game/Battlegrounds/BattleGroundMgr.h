@@ -23,6 +23,7 @@
 #define __BATTLEGROUNDMGR_H
 
 #include <vector>
+#include <deque>
 
 #include "Common.h"
 #include "Policies/Singleton.h"
@@ -60,6 +61,7 @@ struct GroupQueueInfo                                       // stores informatio
     uint32  RemoveInviteTime;                               // time when we will remove invite for players in group
     uint32  IsInvitedToBGInstanceGUID;                      // was invited to certain BG
     BattleGroundBracketId BracketId;
+    uint32  QueueType;                                      // BattleGroundQueueGroupTypes of the queue holding the group
 };
 
 enum BattleGroundQueueGroupTypes
@@ -100,6 +102,12 @@ class BattleGroundQueue
         void PlayerLoggedOut(ObjectGuid guid);
         bool PlayerLoggedIn(Player* player);
 
+        // Not yet invited players waiting in a queue, maintained at every membership change
+        uint32 GetWaitingPlayersCount(BattleGroundBracketId bracket_id, uint32 queueType) const { return m_WaitingPlayers[bracket_id][queueType]; }
+
+        // Runs a join/leave storm of solo players against CheckNormalMatch on this (empty) queue, for `.debug bgqueuebench`
+        void Simulate(uint32 operations, uint32 minPlayers, uint32 maxPlayers, uint32& matchesCount, uint32& matchTime, uint32& totalTime);
+
         //mutex that should not allow changing private data, nor allowing to update Queue during private data change.
         ACE_Recursive_Thread_Mutex  m_Lock;
 
@@ -140,6 +148,16 @@ class BattleGroundQueue
         SelectionPool m_SelectionPools[BG_TEAMS_COUNT];
 
         bool InviteGroupToBG(GroupQueueInfo * ginfo, BattleGround * bg, Team side);
+        void EnqueueGroup(GroupQueueInfo* ginfo, uint32 queueType);
+        void SetGroupInvited(GroupQueueInfo* ginfo, uint32 bgInstanceId);
+
+        // Running sums of the not yet invited players and groups of m_QueuedGroups
+        uint32 m_WaitingPlayers[MAX_BATTLEGROUND_BRACKETS][BG_QUEUE_GROUP_TYPES_COUNT];
+        uint32 m_WaitingGroups[MAX_BATTLEGROUND_BRACKETS][BG_QUEUE_GROUP_TYPES_COUNT];
+
+        // Logged out players in logout order, with their logout time, to expire them without scanning m_QueuedPlayers
+        typedef std::deque<std::pair<ObjectGuid, uint32> > OfflinePlayersQueue;
+        OfflinePlayersQueue m_OfflinePlayers;
         uint32 m_WaitTimes[BG_TEAMS_COUNT][MAX_BATTLEGROUND_BRACKETS][COUNT_OF_PLAYERS_TO_AVERAGE_WAIT_TIME];
         uint32 m_WaitTimeLastPlayer[BG_TEAMS_COUNT][MAX_BATTLEGROUND_BRACKETS];
         uint32 m_SumOfWaitTimes[BG_TEAMS_COUNT][MAX_BATTLEGROUND_BRACKETS];
@@ -25,8 +25,10 @@
 #include "Log.h"
 #include "Errors.h"
 #include "Player.h"
+#include "World.h"
 
-Camera::Camera(Player* pl) : m_owner(*pl), m_source(pl)
+Camera::Camera(Player* pl) : m_owner(*pl), m_source(pl),
+    m_lastUpdateX(0.0f), m_lastUpdateY(0.0f), m_lastUpdateRadius(0.0f), m_lastFullUpdateTime(0)
 {
     m_source->GetViewPoint().Attach(this);
 }
@@ -114,6 +116,8 @@ void Camera::Event_AddedToWorld()
 
 void Camera::Event_RemovedFromWorld()
 {
+    m_lastUpdateRadius = 0.0f;
+
     if (m_source == &m_owner)
     {
         m_gridRef.unlink();
@@ -158,6 +162,111 @@ void Camera::UpdateVisibilityForOwner()
     GetOwner()->m_visibleGUIDs_lock.release();
     Cell::VisitAllObjects(m_source, notifier, m_source->GetMap()->GetVisibilityDistance());
     notifier.Notify();
+
+    m_lastUpdateX = m_source->GetPositionX();
+    m_lastUpdateY = m_source->GetPositionY();
+    m_lastUpdateRadius = m_source->GetMap()->GetVisibilityDistance() + m_source->GetObjectBoundingRadius();
+    m_lastFullUpdateTime = WorldTimer::getMSTime();
+}
+
+// Farthest distance between a point and the world area covered by a cell
+static float GetMaxDistanceToCell(float x, float y, CellPair const& p)
+{
+    float const lowX = (int32(p.x_coord) - CENTER_GRID_CELL_ID) * SIZE_OF_GRID_CELL;
+    float const lowY = (int32(p.y_coord) - CENTER_GRID_CELL_ID) * SIZE_OF_GRID_CELL;
+    float const dx = std::max(fabs(x - lowX), fabs(x - lowX - SIZE_OF_GRID_CELL));
+    float const dy = std::max(fabs(y - lowY), fabs(y - lowY - SIZE_OF_GRID_CELL));
+    return sqrt(dx * dx + dy * dy);
+}
+
+static bool IsInCellArea(CellArea const& area, CellPair const& p)
+{
+    return p.x_coord >= area.low_bound.x_coord && p.x_coord <= area.high_bound.x_coord &&
+           p.y_coord >= area.low_bound.y_coord && p.y_coord <= area.high_bound.y_coord;
+}
+
+void Camera::UpdateVisibilityAfterMove()
+{
+    Map* map = m_source->FindMap();
+    if (!map)
+        return;
+
+    // Cells fully inside the view before and after the move keep the visibility of their objects,
+    // except for the units relocated during this update. Anything else falls back to a full scan.
+    float const radius = map->GetVisibilityDistance() + m_source->GetObjectBoundingRadius();
+    float const x = m_source->GetPositionX();
+    float const y = m_source->GetPositionY();
+    uint32 const fullUpdateInterval = sWorld.getConfig(CONFIG_UINT32_VISIBILITY_FULL_UPDATE_INTERVAL);
+    if (!fullUpdateInterval || !map->IsProcessingUnitsRelocation() || m_lastUpdateRadius != radius ||
+        (x - m_lastUpdateX) * (x - m_lastUpdateX) + (y - m_lastUpdateY) * (y - m_lastUpdateY) > SIZE_OF_GRID_CELL * SIZE_OF_GRID_CELL ||
+        WorldTimer::getMSTimeDiffToNow(m_lastFullUpdateTime) > fullUpdateInterval)
+    {
+        UpdateVisibilityForOwner();
+        return;
+    }
+
+    CellArea const oldArea = Cell::CalculateCellArea(m_lastUpdateX, m_lastUpdateY, radius);
+    CellArea const newArea = Cell::CalculateCellArea(x, y, radius);
+
+    // Objects of the cells which left the view go out of range
+    ObjectGuidSet outOfRange;
+    {
+        MaNGOS::VisibleObjectsCollector collector(m_owner, outOfRange);
+        TypeContainerVisitor<MaNGOS::VisibleObjectsCollector, GridTypeMapContainer> gcollector(collector);
+        TypeContainerVisitor<MaNGOS::VisibleObjectsCollector, WorldTypeMapContainer> wcollector(collector);
+        for (uint32 cx = oldArea.low_bound.x_coord; cx <= oldArea.high_bound.x_coord; ++cx)
+        {
+            for (uint32 cy = oldArea.low_bound.y_coord; cy <= oldArea.high_bound.y_coord; ++cy)
+            {
+                CellPair p(cx, cy);
+                if (IsInCellArea(newArea, p))
+                    continue;
+                Cell cell(p);
+                cell.SetNoCreate();
+                map->Visit(cell, gcollector);
+                map->Visit(cell, wcollector);
+            }
+        }
+    }
+
+    MaNGOS::VisibleNotifier notifier(*this, outOfRange);
+    TypeContainerVisitor<MaNGOS::VisibleNotifier, GridTypeMapContainer> gnotifier(notifier);
+    TypeContainerVisitor<MaNGOS::VisibleNotifier, WorldTypeMapContainer> wnotifier(notifier);
+    MaNGOS::HiddenUnitsVisibleNotifier hiddenNotifier(notifier);
+    TypeContainerVisitor<MaNGOS::HiddenUnitsVisibleNotifier, GridTypeMapContainer> ghiddenNotifier(hiddenNotifier);
+    TypeContainerVisitor<MaNGOS::HiddenUnitsVisibleNotifier, WorldTypeMapContainer> whiddenNotifier(hiddenNotifier);
+    // Objects may move up to the relocation threshold before being reported
+    float const interiorDistance = map->GetVisibilityDistance() - sqrt(World::GetRelocationLowerLimitSq());
+    for (uint32 cx = newArea.low_bound.x_coord; cx <= newArea.high_bound.x_coord; ++cx)
+    {
+        for (uint32 cy = newArea.low_bound.y_coord; cy <= newArea.high_bound.y_coord; ++cy)
+        {
+            CellPair p(cx, cy);
+            if (IsInCellArea(oldArea, p) &&
+                GetMaxDistanceToCell(m_lastUpdateX, m_lastUpdateY, p) < interiorDistance &&
+                GetMaxDistanceToCell(x, y, p) < interiorDistance)
+            {
+                if (std::vector<Unit*> const* units = map->GetRelocatedUnitsInCell(p))
+                    for (std::vector<Unit*>::const_iterator itr = units->begin(); itr != units->end(); ++itr)
+                        if (*itr != &m_owner)
+                            notifier.VisitUnit(*itr);
+                // Stealth detection depends on the distance to the viewer which just moved
+                Cell cell(p);
+                cell.SetNoCreate();
+                map->Visit(cell, ghiddenNotifier);
+                map->Visit(cell, whiddenNotifier);
+                continue;
+            }
+            Cell cell(p);
+            cell.SetNoCreate();
+            map->Visit(cell, gnotifier);
+            map->Visit(cell, wnotifier);
+        }
+    }
+    notifier.Notify();
+
+    m_lastUpdateX = x;
+    m_lastUpdateY = y;
 }
 
 //////////////////
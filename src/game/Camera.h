@@ -60,6 +60,9 @@ class MANGOS_DLL_SPEC Camera
         // updates visibility of worldobjects around viewpoint for camera's owner
         void UpdateVisibilityForOwner();
 
+        // same after a move of the viewpoint, rescanning only the cells that entered or left the view
+        void UpdateVisibilityAfterMove();
+
     private:
         // called when viewpoint changes visibility state
         void Event_AddedToWorld();
@@ -72,6 +75,12 @@ class MANGOS_DLL_SPEC Camera
 
         void UpdateForCurrentViewPoint();
 
+        // viewpoint position and scan radius of the last visibility update, no radius forces a full update
+        float m_lastUpdateX;
+        float m_lastUpdateY;
+        float m_lastUpdateRadius;
+        uint32 m_lastFullUpdateTime;
+
     public:
         GridReference<Camera>& GetGridRef() { return m_gridRef; }
         bool isActiveObject() const { return false; }
@@ -139,6 +148,11 @@ public:
     {
         CameraCall(&Camera::UpdateVisibilityForOwner);
     }
+
+    void Call_UpdateVisibilityAfterMove()
+    {
+        CameraCall(&Camera::UpdateVisibilityAfterMove);
+    }
 };
 
 #endif
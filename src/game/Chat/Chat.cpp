@@ -236,6 +236,7 @@ ChatCommand * ChatHandler::getCommandTable()
     {
         { NODE, "anim",           SEC_GAMEMASTER,     false, &ChatHandler::HandleDebugAnimCommand,                "", nullptr },
         { NODE, "bg",             SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugBattlegroundCommand,        "", nullptr },
+        { NODE, "bgqueuebench",   SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugBattlegroundQueueBenchCommand, "", nullptr },
         { NODE, "getitemstate",   SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugGetItemStateCommand,        "", nullptr },
         { NODE, "lrecipient",     SEC_GAMEMASTER,     false, &ChatHandler::HandleDebugGetLootRecipientCommand,    "", nullptr },
         { NODE, "getitemvalue",   SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugGetItemValueCommand,        "", nullptr },
@@ -269,6 +270,14 @@ ChatCommand * ChatHandler::getCommandTable()
         { NODE, "movemotion",     SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugMoveCommand,                "", nullptr },
         { NODE, "factionchange_items", SEC_ADMINISTRATOR, true, &ChatHandler::HandleFactionChangeItemsCommand,    "", nullptr },
         { NODE, "loottable",      SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugLootTableCommand,           "", nullptr },
+        { NODE, "lootbench",      SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugLootBenchCommand,           "", nullptr },
+        { NODE, "dbqueues",       SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugDbQueuesCommand,            "", nullptr },
+        { NODE, "procbench",      SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugProcBenchCommand,           "", nullptr },
+        { NODE, "network",        SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugNetworkCommand,             "", nullptr },
+        { NODE, "allocations",    SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugAllocationsCommand,         "", nullptr },
+        { NODE, "charcache",      SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugCharacterCacheCommand,      "", nullptr },
+        { NODE, "instancepool",   SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugInstancePoolCommand,        "", nullptr },
+        { NODE, "threatbench",    SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugThreatBenchCommand,         "", nullptr },
         { MSTR, nullptr,       0,                  false, nullptr,                                                "", nullptr }
     };
 
@@ -547,6 +556,8 @@ ChatCommand * ChatHandler::getCommandTable()
     {
         { NODE, "load",           SEC_ADMINISTRATOR,  true,  &ChatHandler::HandlePDumpLoadCommand,           "", nullptr },
         { NODE, "write",          SEC_ADMINISTRATOR,  true,  &ChatHandler::HandlePDumpWriteCommand,          "", nullptr },
+        { NODE, "bulkload",       SEC_ADMINISTRATOR,  true,  &ChatHandler::HandlePDumpBulkLoadCommand,       "", nullptr },
+        { NODE, "bulkwrite",      SEC_ADMINISTRATOR,  true,  &ChatHandler::HandlePDumpBulkWriteCommand,      "", nullptr },
         { MSTR, nullptr,       0,                  false, nullptr,                                           "", nullptr }
     };
 
@@ -184,6 +184,14 @@ class MANGOS_DLL_SPEC ChatHandler
         bool HandleDebugExp(char* );
         bool HandleVideoTurn(char* );
         bool HandleDebugLootTableCommand(char*);
+        bool HandleDebugLootBenchCommand(char*);
+        bool HandleDebugDbQueuesCommand(char*);
+        bool HandleDebugProcBenchCommand(char*);
+        bool HandleDebugNetworkCommand(char*);
+        bool HandleDebugAllocationsCommand(char*);
+        bool HandleDebugCharacterCacheCommand(char*);
+        bool HandleDebugInstancePoolCommand(char*);
+        bool HandleDebugThreatBenchCommand(char*);
         bool HandleServiceDeleteCharacters(char* args);
 
         bool HandleSpamerMute(char* args);
@@ -390,6 +398,7 @@ class MANGOS_DLL_SPEC ChatHandler
 
         bool HandleDebugAnimCommand(char* args);
         bool HandleDebugBattlegroundCommand(char* args);
+        bool HandleDebugBattlegroundQueueBenchCommand(char* args);
         bool HandleDebugGetItemStateCommand(char* args);
         bool HandleDebugGetItemValueCommand(char* args);
         bool HandleDebugGetLootRecipientCommand(char* args);
@@ -615,6 +624,8 @@ class MANGOS_DLL_SPEC ChatHandler
 
         bool HandlePDumpLoadCommand(char* args);
         bool HandlePDumpWriteCommand(char* args);
+        bool HandlePDumpBulkLoadCommand(char* args);
+        bool HandlePDumpBulkWriteCommand(char* args);
 
         bool HandlePoolListCommand(char* args);
         bool HandlePoolSpawnsCommand(char* args);
@@ -55,6 +55,7 @@
 #include <map>
 #include <typeinfo>
 #include "Formulas.h"
+#include "CharacterEnumCache.h"
 
 #include "TargetedMovementGenerator.h"                      // for HandleNpcUnFollowCommand
 
@@ -3769,6 +3770,7 @@ bool ChatHandler::HandleCharacterRenameCommand(char* args)
         PSendSysMessage(LANG_RENAME_PLAYER, GetNameLink(target).c_str());
         target->SetAtLoginFlag(AT_LOGIN_RENAME);
         CharacterDatabase.PExecute("UPDATE characters SET at_login = at_login | '1' WHERE guid = '%u'", target->GetGUIDLow());
+        sCharacterEnumCache.InvalidateAccount(target->GetSession()->GetAccountId());
     }
     else
     {
@@ -3780,6 +3782,7 @@ bool ChatHandler::HandleCharacterRenameCommand(char* args)
 
         PSendSysMessage(LANG_RENAME_PLAYER_GUID, oldNameLink.c_str(), target_guid.GetCounter());
         CharacterDatabase.PExecute("UPDATE characters SET at_login = at_login | '1' WHERE guid = '%u'", target_guid.GetCounter());
+        sCharacterEnumCache.InvalidateAccount(sObjectMgr.GetPlayerAccountIdByGUID(target_guid));
     }
 
     return true;
@@ -59,6 +59,9 @@
 #include "CreatureEventAIMgr.h"
 #include "QuestDef.h"
 #include "Anticheat.h"
+#include "CharacterEnumCache.h"
+
+#include <fstream>
 
 bool ChatHandler::HandleReloadAllCommand(char* /*args*/)
 {
@@ -4294,6 +4297,7 @@ void ChatHandler::HandleCharacterLevel(Player* player, ObjectGuid player_guid, u
     {
         // update level and XP at level, all other will be updated at loading
         CharacterDatabase.PExecute("UPDATE characters SET level = '%u', xp = 0 WHERE guid = '%u'", newlevel, player_guid.GetCounter());
+        sCharacterEnumCache.InvalidateAccount(sObjectMgr.GetPlayerAccountIdByGUID(player_guid));
     }
 }
 
@@ -4825,6 +4829,7 @@ bool ChatHandler::HandleResetSpellsCommand(char* args)
     else
     {
         CharacterDatabase.PExecute("UPDATE characters SET at_login = at_login | '%u' WHERE guid = '%u'", uint32(AT_LOGIN_RESET_SPELLS), target_guid.GetCounter());
+        sCharacterEnumCache.InvalidateAccount(sObjectMgr.GetPlayerAccountIdByGUID(target_guid));
         PSendSysMessage(LANG_RESET_SPELLS_OFFLINE, target_name.c_str());
     }
 
@@ -4851,6 +4856,7 @@ bool ChatHandler::HandleResetTalentsCommand(char* args)
     {
         uint32 at_flags = AT_LOGIN_RESET_TALENTS;
         CharacterDatabase.PExecute("UPDATE characters SET at_login = at_login | '%u' WHERE guid = '%u'", at_flags, target_guid.GetCounter());
+        sCharacterEnumCache.InvalidateAccount(sObjectMgr.GetPlayerAccountIdByGUID(target_guid));
         std::string nameLink = playerLink(target_name);
         PSendSysMessage(LANG_RESET_TALENTS_OFFLINE, nameLink.c_str());
     }
@@ -4890,6 +4896,7 @@ bool ChatHandler::HandleResetAllCommand(char* args)
     }
 
     CharacterDatabase.PExecute("UPDATE characters SET at_login = at_login | '%u' WHERE (at_login & '%u') = '0'", atLogin, atLogin);
+    sCharacterEnumCache.InvalidateAll();
     HashMapHolder<Player>::MapType const& plist = sObjectAccessor.GetPlayers();
     for (HashMapHolder<Player>::MapType::const_iterator itr = plist.begin(); itr != plist.end(); ++itr)
         itr->second->SetAtLoginFlag(atLogin);
@@ -5995,6 +6002,95 @@ bool ChatHandler::HandlePDumpWriteCommand(char *args)
     return true;
 }
 
+// .pdump bulkload $listfile - one "$file $accountid [$name]" per line
+bool ChatHandler::HandlePDumpBulkLoadCommand(char *args)
+{
+    char* listFile = ExtractQuotedOrLiteralArg(&args);
+    if (!listFile)
+        return false;
+
+    std::ifstream list(listFile);
+    if (!list.is_open())
+    {
+        PSendSysMessage(LANG_FILE_OPEN_FAIL, listFile);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    std::vector<PlayerDumpReader::BulkEntry> dumps;
+    std::string line;
+    while (std::getline(list, line))
+    {
+        std::istringstream ss(line);
+        PlayerDumpReader::BulkEntry entry;
+        if (!(ss >> entry.file >> entry.account))
+            continue;
+        ss >> entry.name;
+
+        std::string accountName;
+        if (!sAccountMgr.GetName(entry.account, accountName))
+        {
+            PSendSysMessage("Account %u of dump '%s' not found, skipped.", entry.account, entry.file.c_str());
+            continue;
+        }
+        dumps.push_back(entry);
+    }
+
+    if (!PlayerDumpReader::StartBulkLoad(dumps))
+    {
+        SendSysMessage("A bulk load is already running.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+    PSendSysMessage("%u characters queued for loading, the progress is logged.", uint32(dumps.size()));
+    return true;
+}
+
+// .pdump bulkwrite $listfile $directory [$threads] - one character guid per line
+bool ChatHandler::HandlePDumpBulkWriteCommand(char *args)
+{
+    char* listFile = ExtractQuotedOrLiteralArg(&args);
+    if (!listFile)
+        return false;
+
+    char* directory = ExtractQuotedOrLiteralArg(&args);
+    if (!directory)
+        return false;
+
+    uint32 threads = 4;
+    if (*args && !ExtractUInt32(&args, threads))
+        return false;
+
+    std::ifstream list(listFile);
+    if (!list.is_open())
+    {
+        PSendSysMessage(LANG_FILE_OPEN_FAIL, listFile);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    std::vector<uint32> guids;
+    uint32 lowguid;
+    while (list >> lowguid)
+    {
+        if (!sObjectMgr.GetPlayerAccountIdByGUID(ObjectGuid(HIGHGUID_PLAYER, lowguid)))
+        {
+            PSendSysMessage("Character %u not found, skipped.", lowguid);
+            continue;
+        }
+        guids.push_back(lowguid);
+    }
+
+    if (!PlayerDumpWriter::StartBulkWrite(guids, directory, threads))
+    {
+        SendSysMessage("A bulk write is already running.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+    PSendSysMessage("%u characters queued for writing, the progress is logged.", uint32(guids.size()));
+    return true;
+}
+
 bool ChatHandler::HandleMovegensCommand(char* /*args*/)
 {
     Unit* unit = getSelectedUnit();
@@ -7954,6 +8050,7 @@ bool ChatHandler::HandleReloadConditionsCommand(char* /*args*/)
 {
     sLog.outString("Re-Loading `conditions`... ");
     sObjectMgr.LoadConditions();
+    CompileLootTables();
     SendSysMessage("DB table `conditions` reloaded.");
     return true;
 }
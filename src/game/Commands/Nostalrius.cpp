@@ -1,5 +1,6 @@
 #include <string.h>
 #include <map>
+#include <chrono>
 
 #include "Common.h"
 #include "Database/DatabaseEnv.h"
@@ -54,6 +55,9 @@
 // VMAPS
 #include "VMapFactory.h"
 #include "ModelInstance.h"
+#include "WorldSocket.h"
+#include "Spell.h"
+#include "CharacterEnumCache.h"
 
 #define MAX_SPELL_EFFECTS 3
 
@@ -3077,6 +3081,29 @@ extern LootStore LootTemplates_Pickpocketing;
 extern LootStore LootTemplates_Skinning;
 extern LootStore LootTemplates_Disenchant;
 
+static LootStore const* GetLootStoreByName(std::string const& tableName)
+{
+    if (tableName == "creature")
+        return &LootTemplates_Creature;
+    else if (tableName == "reference")
+        return &LootTemplates_Reference;
+    else if (tableName == "fishing")
+        return &LootTemplates_Fishing;
+    else if (tableName == "gameobject")
+        return &LootTemplates_Gameobject;
+    else if (tableName == "item")
+        return &LootTemplates_Item;
+    else if (tableName == "mail")
+        return &LootTemplates_Mail;
+    else if (tableName == "pickpocketing")
+        return &LootTemplates_Pickpocketing;
+    else if (tableName == "skinning")
+        return &LootTemplates_Skinning;
+    else if (tableName == "disenchant")
+        return &LootTemplates_Disenchant;
+    return NULL;
+}
+
 bool ChatHandler::HandleDebugLootTableCommand(char* args)
 {
     std::stringstream in(args);
@@ -3088,26 +3115,8 @@ bool ChatHandler::HandleDebugLootTableCommand(char* args)
     simCount = simCount? simCount : 10000;
     SetSentErrorMessage(true);
 
-    LootStore const* store = NULL;
-    if (tableName == "creature")
-        store = &LootTemplates_Creature;
-    else if (tableName == "reference")
-        store = &LootTemplates_Reference;
-    else if (tableName == "fishing")
-        store = &LootTemplates_Fishing;
-    else if (tableName == "gameobject")
-        store = &LootTemplates_Gameobject;
-    else if (tableName == "item")
-        store = &LootTemplates_Item;
-    else if (tableName == "mail")
-        store = &LootTemplates_Mail;
-    else if (tableName == "pickpocketing")
-        store = &LootTemplates_Pickpocketing;
-    else if (tableName == "skinning")
-        store = &LootTemplates_Skinning;
-    else if (tableName == "disenchant")
-        store = &LootTemplates_Disenchant;
-    else
+    LootStore const* store = GetLootStoreByName(tableName);
+    if (!store)
     {
         PSendSysMessage("Error: loot type \"%s\" unknown", tableName.c_str());
         return false;
@@ -3186,6 +3195,328 @@ bool ChatHandler::HandleDebugLootTableCommand(char* args)
     return true;
 }
 
+// Generates the same loot with the alias tables and with the linear group rolls, and compares timings and drop rates
+bool ChatHandler::HandleDebugLootBenchCommand(char* args)
+{
+    std::stringstream in(args);
+    std::string tableName;
+    int lootid = 0;
+    unsigned int simCount = 0;
+    in >> tableName >> lootid >> simCount;
+    // Runs on the world thread: keep it short
+    simCount = std::min(simCount ? simCount : 10000, 200000u);
+    SetSentErrorMessage(true);
+
+    LootStore const* store = GetLootStoreByName(tableName);
+    if (!store)
+    {
+        PSendSysMessage("Error: loot type \"%s\" unknown", tableName.c_str());
+        return false;
+    }
+
+    LootTemplate const* tab = store->GetLootFor(lootid);
+    if (!tab)
+    {
+        PSendSysMessage("Error: loot type \"%s\" has no lootid %u", tableName.c_str(), lootid);
+        return false;
+    }
+
+    Player* lootOwner = getSelectedPlayer();
+
+    // [0] alias tables, [1] linear rolls
+    std::map<uint32, uint32> drops[2];
+    uint32 elapsed[2];
+    for (uint32 legacy = 0; legacy < 2; ++legacy)
+    {
+        uint32 startTime = WorldTimer::getMSTime();
+        for (unsigned int i = 0; i < simCount; ++i)
+        {
+            Loot l(NULL);
+            if (lootOwner)
+                l.SetTeam(lootOwner->GetTeam());
+            tab->Process(l, *store, store->IsRatesAllowed(), 0, legacy != 0);
+            for (LootItemList::const_iterator it = l.items.begin(); it != l.items.end(); ++it)
+                drops[legacy][it->itemid]++;
+            for (LootItemList::const_iterator it = l.m_questItems.begin(); it != l.m_questItems.end(); ++it)
+                drops[legacy][it->itemid]++;
+        }
+        elapsed[legacy] = WorldTimer::getMSTimeDiffToNow(startTime);
+    }
+
+    // Two samples of the same size: chi2 = sum (a - b)^2 / (a + b), with one degree of freedom less than the number of items
+    std::set<uint32> itemIds;
+    for (uint32 legacy = 0; legacy < 2; ++legacy)
+        for (std::map<uint32, uint32>::const_iterator it = drops[legacy].begin(); it != drops[legacy].end(); ++it)
+            itemIds.insert(it->first);
+
+    double chi2 = 0.0;
+    for (std::set<uint32>::const_iterator it = itemIds.begin(); it != itemIds.end(); ++it)
+    {
+        double a = drops[0][*it];
+        double b = drops[1][*it];
+        chi2 += (a - b) * (a - b) / (a + b);
+    }
+    uint32 freedom = itemIds.size() > 1 ? itemIds.size() - 1 : 1;
+    // Normal approximation of the 99.9% quantile of the chi2 distribution
+    double threshold = freedom + 3.1 * sqrt(2.0 * freedom);
+
+    PSendSysMessage("Loot %s.%u, %u generations: alias %ums, linear %ums", tableName.c_str(), lootid, simCount, elapsed[0], elapsed[1]);
+    PSendSysMessage("%u items, chi2 %.2f for %u degrees of freedom (threshold %.2f): distributions %s",
+                    uint32(itemIds.size()), chi2, freedom, threshold, chi2 <= threshold ? "match" : "DIFFER");
+    return true;
+}
+
+// Proc candidates lookup on the selected unit: whole holders map walk against the proc flag index
+bool ChatHandler::HandleDebugProcBenchCommand(char* args)
+{
+    uint32 iterations = 100000;
+    ExtractOptUInt32(&args, iterations, 100000);
+    if (!iterations)
+        iterations = 1;
+
+    Unit* unit = getSelectedUnit();
+    if (!unit)
+    {
+        SendSysMessage(LANG_SELECT_CHAR_OR_CREATURE);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    // Combat events of a melee fight. Kill flags are left out, they need a victim.
+    uint32 const procFlags[] =
+    {
+        PROC_FLAG_SUCCESSFUL_MELEE_HIT,
+        PROC_FLAG_TAKEN_MELEE_HIT | PROC_FLAG_TAKEN_ANY_DAMAGE,
+        PROC_FLAG_SUCCESSFUL_NEGATIVE_SPELL_HIT,
+        PROC_FLAG_TAKEN_NEGATIVE_SPELL_HIT | PROC_FLAG_TAKEN_ANY_DAMAGE,
+        PROC_FLAG_ON_TAKE_PERIODIC | PROC_FLAG_TAKEN_ANY_DAMAGE,
+    };
+    uint32 const procFlagsCount = sizeof(procFlags) / sizeof(procFlags[0]);
+
+    uint64 examined[2] = { 0, 0 };
+    uint32 triggered[2] = { 0, 0 };
+    uint32 elapsed[2];
+
+    // [0] holders map walk
+    uint32 startTime = WorldTimer::getMSTime();
+    for (uint32 i = 0; i < iterations; ++i)
+    {
+        uint32 procFlag = procFlags[i % procFlagsCount];
+        Unit::SpellAuraHolderMap const& holders = unit->GetSpellAuraHolderMap();
+        for (Unit::SpellAuraHolderMap::const_iterator itr = holders.begin(); itr != holders.end(); ++itr)
+        {
+            SpellProcEventEntry const* spellProcEvent = nullptr;
+            if (unit->IsTriggeredAtSpellProcEvent(nullptr, itr->second, nullptr, procFlag, PROC_EX_NORMAL_HIT, BASE_ATTACK, false, spellProcEvent))
+                ++triggered[0];
+        }
+        examined[0] += holders.size();
+    }
+    elapsed[0] = WorldTimer::getMSTimeDiffToNow(startTime);
+
+    // [1] proc flag index
+    startTime = WorldTimer::getMSTime();
+    ProcHolderBucket candidates;
+    for (uint32 i = 0; i < iterations; ++i)
+    {
+        uint32 procFlag = procFlags[i % procFlagsCount];
+        candidates.clear();
+        unit->GetProcHolderCandidates(procFlag, candidates);
+        for (ProcHolderBucket::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
+        {
+            SpellProcEventEntry const* spellProcEvent = nullptr;
+            if (unit->IsTriggeredAtSpellProcEvent(nullptr, itr->holder, nullptr, procFlag, PROC_EX_NORMAL_HIT, BASE_ATTACK, false, spellProcEvent))
+                ++triggered[1];
+        }
+        examined[1] += candidates.size();
+    }
+    elapsed[1] = WorldTimer::getMSTimeDiffToNow(startTime);
+
+    PSendSysMessage("%s: %u holders, %u proc events", unit->GetName(), uint32(unit->GetSpellAuraHolderMap().size()), iterations);
+    PSendSysMessage("Holders map: %ums, %.2f holders checked per event, %u procs", elapsed[0], examined[0] / float(iterations), triggered[0]);
+    PSendSysMessage("Proc index:  %ums, %.2f holders checked per event, %u procs", elapsed[1], examined[1] / float(iterations), triggered[1]);
+    return true;
+}
+
+static std::string FormatSqlDelayHistogram(SqlDelayHistogram const& histogram)
+{
+    std::stringstream str;
+    for (uint32 i = 0; i < SQL_DELAY_HISTOGRAM_BUCKETS; ++i)
+        if (uint32 count = histogram.Get(i))
+            str << " " << SqlDelayHistogram::BucketLowerBound(i) << (i == SQL_DELAY_HISTOGRAM_BUCKETS - 1 ? "+" : "") << ":" << count;
+    return str.str();
+}
+
+// Async SQL workers: queue depth on wake up, operations per commit, commit latency (ms). Buckets are powers of two.
+bool ChatHandler::HandleDebugDbQueuesCommand(char* /*args*/)
+{
+    struct
+    {
+        char const* name;
+        Database* db;
+    } databases[] =
+    {
+        { "World", &WorldDatabase },
+        { "Character", &CharacterDatabase },
+        { "Login", &LoginDatabase },
+        { "Logs", &LogsDatabase },
+    };
+
+    for (uint32 i = 0; i < sizeof(databases) / sizeof(databases[0]); ++i)
+    {
+        Database* db = databases[i].db;
+        PSendSysMessage("%s database: %u workers, group commit up to %u statements / %ums",
+                        databases[i].name, db->GetAsyncWorkersCount(), db->GetGroupCommitMaxStatements(), db->GetGroupCommitMaxLatency());
+        for (uint32 worker = 0; worker < db->GetAsyncWorkersCount(); ++worker)
+        {
+            SqlDelayStats const* stats = db->GetDelayThreadStats(worker);
+            if (!stats)
+                continue;
+            PSendSysMessage("  Worker %u: %u operations, %u commits, %u replayed groups", worker, stats->operations.load(), stats->commits.load(), stats->replays.load());
+            PSendSysMessage("    Queue depth:%s", FormatSqlDelayHistogram(stats->queueDepth).c_str());
+            PSendSysMessage("    Batch size:%s", FormatSqlDelayHistogram(stats->batchSize).c_str());
+            PSendSysMessage("    Commit latency:%s", FormatSqlDelayHistogram(stats->commitLatency).c_str());
+        }
+    }
+    return true;
+}
+
+// Output of the selected player socket. Optional: new flush delay (ms) and bytes threshold for this session.
+bool ChatHandler::HandleDebugNetworkCommand(char* args)
+{
+    Player* player = getSelectedPlayer();
+    if (!player)
+        player = m_session->GetPlayer();
+
+    WorldSocket* sock = player->GetSession()->GetSocket();
+    if (!sock)
+    {
+        PSendSysMessage("%s has no socket.", player->GetName());
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    if (*args)
+    {
+        uint32 delay, bytes;
+        if (!ExtractUInt32(&args, delay) || !ExtractOptUInt32(&args, bytes, sock->GetFlushBytes()))
+            return false;
+        sock->SetFlushPolicy(delay, bytes);
+    }
+
+    WorldSocket::SendStats stats = sock->GetSendStats();
+    PSendSysMessage("%s [%s]: flush delay %ums, flush bytes %u", player->GetName(), sock->GetRemoteAddress().c_str(), sock->GetFlushDelay(), sock->GetFlushBytes());
+    PSendSysMessage("Last second: %u sends, %u bytes", stats.callsPerSec, stats.bytesPerSec);
+    PSendSysMessage("Total: %u sends, %u packets, %u KB, avg %u bytes / %.1f packets per send, %u immediate flushes",
+                    uint32(stats.calls), uint32(stats.packets), uint32(stats.bytes / 1024),
+                    uint32(stats.calls ? stats.bytes / stats.calls : 0), stats.calls ? float(stats.packets) / stats.calls : 0.0f,
+                    uint32(stats.immediateFlushes));
+    return true;
+}
+
+// Short lived objects of the spell system: created, taken from the heap instead of a pool, alive. Also shows the change since the previous call.
+bool ChatHandler::HandleDebugAllocationsCommand(char* /*args*/)
+{
+    struct
+    {
+        char const* name;
+        MaNGOS::AllocationCounters const* counters;
+        uint64 lastAllocations;
+        uint64 lastHeapAllocations;
+    } static subsystems[] =
+    {
+        { "Spell", &Spell::s_allocations, 0, 0 },
+        { "SpellEvent", &SpellEvent::s_allocations, 0, 0 },
+        { "Spell targets", &Spell::s_targetAllocations, 0, 0 },
+        // created: hits, one std::list node each before; from heap: blocks now allocated
+        { "Grid search results", &MaNGOS::GridSearchResultsCounters::s_allocations, 0, 0 },
+    };
+
+    for (uint32 i = 0; i < sizeof(subsystems) / sizeof(subsystems[0]); ++i)
+    {
+        uint64 allocations = subsystems[i].counters->allocations;
+        uint64 heapAllocations = subsystems[i].counters->heapAllocations;
+        PSendSysMessage("%s: " UI64FMTD " created (+" UI64FMTD "), " UI64FMTD " from heap (+" UI64FMTD "), " UI64FMTD " alive",
+                        subsystems[i].name, allocations, allocations - subsystems[i].lastAllocations,
+                        heapAllocations, heapAllocations - subsystems[i].lastHeapAllocations,
+                        subsystems[i].counters->GetLiveCount());
+        subsystems[i].lastAllocations = allocations;
+        subsystems[i].lastHeapAllocations = heapAllocations;
+    }
+    return true;
+}
+
+// Characters list cache used at the characters screen
+bool ChatHandler::HandleDebugCharacterCacheCommand(char* /*args*/)
+{
+    CharacterEnumCacheStats stats = sCharacterEnumCache.GetStats();
+    uint32 requests = stats.hits + stats.misses;
+    PSendSysMessage("Characters list cache: %u / %u accounts", sCharacterEnumCache.GetSize(), sWorld.getConfig(CONFIG_UINT32_CHARACTER_ENUM_CACHE_SIZE));
+    PSendSysMessage("%u hits, %u misses (%.1f%% hit rate), %u evictions, %u invalidations, %u updates, %u not stored (recent write)",
+                    stats.hits, stats.misses, requests ? stats.hits * 100.0f / requests : 0.0f,
+                    stats.evictions, stats.invalidations, stats.updates, stats.skippedStores);
+    return true;
+}
+
+// Pre-built instance maps and instance creation times
+bool ChatHandler::HandleDebugInstancePoolCommand(char* /*args*/)
+{
+    std::vector<uint32> const& mapIds = sMapMgr.GetInstancePoolMapIds();
+    for (std::vector<uint32>::const_iterator itr = mapIds.begin(); itr != mapIds.end(); ++itr)
+        PSendSysMessage("Map %u: %u / %u instances ready", *itr, sMapMgr.GetPooledInstancesCount(*itr), sWorld.getConfig(CONFIG_UINT32_INSTANCE_POOL_SIZE));
+
+    InstanceCreationStats const& stats = sMapMgr.GetInstanceCreationStats();
+    PSendSysMessage("Pooled: %u instances, %uus avg, %uus max", stats.pooled,
+                    stats.pooled ? uint32(stats.pooledTimeUs / stats.pooled) : 0, stats.maxPooledTimeUs);
+    PSendSysMessage("Built on demand: %u instances, %uus avg, %uus max", stats.created,
+                    stats.created ? uint32(stats.createdTimeUs / stats.created) : 0, stats.maxCreatedTimeUs);
+    PSendSysMessage("%u unused pooled instances expired", stats.expired);
+    return true;
+}
+
+// Replays threat changes and victim selections on the selected creature's threat list, as in a boss fight
+bool ChatHandler::HandleDebugThreatBenchCommand(char* args)
+{
+    uint32 rounds = 1000;
+    ExtractOptUInt32(&args, rounds, 1000);
+    if (!rounds)
+        rounds = 1;
+
+    Creature* target = getSelectedCreature();
+    if (!target || !target->CanHaveThreatList() || target->getThreatManager().isThreatListEmpty())
+    {
+        SendSysMessage(LANG_SELECT_CREATURE);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    ThreatManager& threatManager = target->getThreatManager();
+    ThreatList const& threatList = threatManager.getThreatList();
+    std::vector<std::pair<HostileReference*, float> > threats;
+    threats.reserve(threatList.size());
+    for (ThreatList::const_iterator itr = threatList.begin(); itr != threatList.end(); ++itr)
+        threats.push_back(std::make_pair(*itr, (*itr)->getThreat()));
+    HostileReference* currentVictim = threatManager.getCurrentVictim();
+
+    // each round a quarter of the attackers gain or lose threat, then the victim is selected again
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < rounds; ++i)
+    {
+        for (uint32 j = 0; j < (threats.size() + 3) / 4; ++j)
+            threats[urand(0, threats.size() - 1)].first->addThreat(frand(-100.0f, 500.0f));
+        threatManager.getHostileTarget();
+    }
+    uint64 elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    for (std::vector<std::pair<HostileReference*, float> >::const_iterator itr = threats.begin(); itr != threats.end(); ++itr)
+        itr->first->setThreat(itr->second);
+    threatManager.setCurrentVictim(currentVictim);
+    threatManager.setDirty(true);
+
+    PSendSysMessage("%u rounds on %u attackers: %uus total, %.2fus per round", rounds, uint32(threats.size()),
+                    uint32(elapsed), float(elapsed) / rounds);
+    return true;
+}
+
 bool ChatHandler::HandleReloadCreatureTemplate(char*)
 {
     sObjectMgr.LoadCreatureTemplates();
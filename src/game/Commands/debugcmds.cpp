@@ -796,6 +796,26 @@ bool ChatHandler::HandleDebugBattlegroundCommand(char* /*args*/)
     return true;
 }
 
+// Simulates a busy battleground queue outside of the real queues and reports the matchmaking cost
+bool ChatHandler::HandleDebugBattlegroundQueueBenchCommand(char* args)
+{
+    uint32 operations, minPlayers, maxPlayers;
+    if (!ExtractOptUInt32(&args, operations, 100000) || !ExtractOptUInt32(&args, minPlayers, 10) || !ExtractOptUInt32(&args, maxPlayers, 10))
+        return false;
+
+    if (!minPlayers || maxPlayers < minPlayers)
+        return false;
+
+    BattleGroundQueue* queue = new BattleGroundQueue;
+    uint32 matchesCount, matchTime, totalTime;
+    queue->Simulate(operations, minPlayers, maxPlayers, matchesCount, matchTime, totalTime);
+    delete queue;
+
+    PSendSysMessage("%u queue joins/leaves: %u matches of %u-%u players per team, %ums in match checks, %ums total",
+                    operations, matchesCount, minPlayers, maxPlayers, matchTime, totalTime);
+    return true;
+}
+
 bool ChatHandler::HandleDebugSpellCheckCommand(char* /*args*/)
 {
     sLog.outString("Check expected in code spell properties base at table 'spell_check' content...");
@@ -0,0 +1,155 @@
+#include "CharacterEnumCache.h"
+#include "Policies/SingletonImp.h"
+#include "Database/DatabaseEnv.h"
+#include "Player.h"
+#include "World.h"
+#include "Timer.h"
+
+INSTANTIATE_SINGLETON_1(CharacterEnumCache);
+
+void CharacterEnumData::LoadFromDB(Field* fields)
+{
+    guid = fields[0].GetUInt32();
+    name = fields[1].GetCppString();
+    race = fields[2].GetUInt8();
+    classId = fields[3].GetUInt8();
+    gender = fields[4].GetUInt8();
+    playerBytes = fields[5].GetUInt32();
+    playerBytes2 = fields[6].GetUInt32();
+    level = fields[7].GetUInt8();
+    zone = fields[8].GetUInt32();
+    map = fields[9].GetUInt32();
+    x = fields[10].GetFloat();
+    y = fields[11].GetFloat();
+    z = fields[12].GetFloat();
+    guildId = fields[13].GetUInt32();
+    playerFlags = fields[14].GetUInt32();
+    atLoginFlags = fields[15].GetUInt32();
+    petEntry = fields[16].GetUInt32();
+    petModelId = fields[17].GetUInt32();
+    petLevel = fields[18].GetUInt32();
+    equipmentCache = fields[19].GetCppString();
+}
+
+bool CharacterEnumCache::GetCharacters(uint32 accountId, CharacterEnumList& list)
+{
+    if (!sWorld.getConfig(CONFIG_UINT32_CHARACTER_ENUM_CACHE_SIZE))
+        return false;
+
+    ACE_Guard<ACE_Thread_Mutex> guard(m_lock);
+    AccountMap::iterator itr = m_accounts.find(accountId);
+    if (itr == m_accounts.end())
+    {
+        ++m_stats.misses;
+        return false;
+    }
+    ++m_stats.hits;
+    Touch(itr->second);
+    list = itr->second.characters;
+    return true;
+}
+
+void CharacterEnumCache::StoreCharacters(uint32 accountId, CharacterEnumList const& list)
+{
+    uint32 maxSize = sWorld.getConfig(CONFIG_UINT32_CHARACTER_ENUM_CACHE_SIZE);
+    if (!maxSize)
+        return;
+
+    ACE_Guard<ACE_Thread_Mutex> guard(m_lock);
+    AccountMap::iterator itr = m_accounts.find(accountId);
+    if (itr != m_accounts.end())
+        Erase(itr);
+
+    uint32 lastWrite = m_lastWriteTime[accountId % CHARACTER_ENUM_CACHE_WRITE_SLOTS];
+    if (lastWrite && WorldTimer::getMSTimeDiffToNow(lastWrite) < CHARACTER_ENUM_CACHE_WRITE_DELAY)
+    {
+        ++m_stats.skippedStores;
+        return;
+    }
+
+    while (m_accounts.size() >= maxSize)
+    {
+        Erase(m_accounts.find(m_lru.back()));
+        ++m_stats.evictions;
+    }
+
+    m_lru.push_front(accountId);
+    AccountEntry& entry = m_accounts[accountId];
+    entry.lruPos = m_lru.begin();
+    entry.characters = list;
+}
+
+void CharacterEnumCache::UpdateCharacter(Player* player)
+{
+    // Built outside of the lock, players are saved from the map threads
+    CharacterEnumData data;
+    player->GetEnumData(data);
+
+    uint32 accountId = player->GetSession()->GetAccountId();
+    ACE_Guard<ACE_Thread_Mutex> guard(m_lock);
+    MarkWritten(accountId);
+    AccountMap::iterator itr = m_accounts.find(accountId);
+    if (itr == m_accounts.end())
+        return;
+
+    for (CharacterEnumList::iterator character = itr->second.characters.begin(); character != itr->second.characters.end(); ++character)
+    {
+        if (character->guid == data.guid)
+        {
+            *character = data;
+            ++m_stats.updates;
+            return;
+        }
+    }
+    // Not in the cached list (new character): the list has to be queried again
+    Erase(itr);
+    ++m_stats.invalidations;
+}
+
+void CharacterEnumCache::InvalidateAccount(uint32 accountId)
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(m_lock);
+    MarkWritten(accountId);
+    AccountMap::iterator itr = m_accounts.find(accountId);
+    if (itr == m_accounts.end())
+        return;
+    Erase(itr);
+    ++m_stats.invalidations;
+}
+
+void CharacterEnumCache::InvalidateAll()
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(m_lock);
+    m_stats.invalidations += m_accounts.size();
+    m_accounts.clear();
+    m_lru.clear();
+    std::fill(std::begin(m_lastWriteTime), std::end(m_lastWriteTime), WorldTimer::getMSTime());
+}
+
+CharacterEnumCacheStats CharacterEnumCache::GetStats()
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(m_lock);
+    return m_stats;
+}
+
+uint32 CharacterEnumCache::GetSize()
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(m_lock);
+    return m_accounts.size();
+}
+
+void CharacterEnumCache::Touch(AccountEntry& entry)
+{
+    m_lru.splice(m_lru.begin(), m_lru, entry.lruPos);
+}
+
+void CharacterEnumCache::Erase(AccountMap::iterator itr)
+{
+    m_lru.erase(itr->second.lruPos);
+    m_accounts.erase(itr);
+}
+
+void CharacterEnumCache::MarkWritten(uint32 accountId)
+{
+    m_lastWriteTime[accountId % CHARACTER_ENUM_CACHE_WRITE_SLOTS] = WorldTimer::getMSTime();
+}
@@ -0,0 +1,93 @@
+#ifndef _CHARACTER_ENUM_CACHE_H
+#define _CHARACTER_ENUM_CACHE_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+
+#include <list>
+#include <unordered_map>
+
+#include <ace/Thread_Mutex.h>
+
+class Field;
+class Player;
+
+// One row of the SMSG_CHAR_ENUM query (see WorldSession::HandleCharEnumOpcode)
+struct CharacterEnumData
+{
+    uint32 guid;
+    std::string name;
+    uint8 race, classId, gender, level;
+    uint32 playerBytes, playerBytes2;
+    uint32 zone, map;
+    float x, y, z;
+    uint32 guildId, playerFlags, atLoginFlags;
+    uint32 petEntry, petModelId, petLevel;
+    std::string equipmentCache;
+
+    void LoadFromDB(Field* fields);
+};
+typedef std::vector<CharacterEnumData> CharacterEnumList;
+
+struct CharacterEnumCacheStats
+{
+    uint32 hits, misses, evictions, invalidations, updates, skippedStores;
+};
+
+// Characters are written asynchronously: a list read from the DB shortly after
+// a write to the account (save, invalidation) may not contain it yet, and is not cached.
+#define CHARACTER_ENUM_CACHE_WRITE_SLOTS    4096
+#define CHARACTER_ENUM_CACHE_WRITE_DELAY    60000
+
+/**
+ * Characters list of the accounts which recently opened the characters screen,
+ * so that a relog (or all the reconnects after a network issue) do not query
+ * the characters again.
+ * Only the characters screen is served from here: logging in to a character
+ * which left the world still runs all the LoginQueryHolder queries.
+ *
+ * Kept up to date by Player::SaveToDB (logout, autosave). Everything else
+ * writing the `characters` columns of the list while the character is offline
+ * (create, delete, rename, guild membership, GM commands ...) has to call
+ * InvalidateAccount, even if the account is not cached: a query of its list
+ * may be running.
+ * Holds at most CharacterEnumCache.Size accounts, the least recently used is evicted.
+ */
+class CharacterEnumCache
+{
+    public:
+        /// Copies the cached list of $accountId into $list. Returns false if not cached.
+        bool GetCharacters(uint32 accountId, CharacterEnumList& list);
+        void StoreCharacters(uint32 accountId, CharacterEnumList const& list);
+
+        /// Updates the entry of $player after it was saved
+        void UpdateCharacter(Player* player);
+        void InvalidateAccount(uint32 accountId);
+        void InvalidateAll();
+
+        CharacterEnumCacheStats GetStats();
+        uint32 GetSize();
+
+    private:
+        typedef std::list<uint32> LruList;                  // most recently used first
+        struct AccountEntry
+        {
+            LruList::iterator lruPos;
+            CharacterEnumList characters;
+        };
+        typedef std::unordered_map<uint32, AccountEntry> AccountMap;
+
+        void Touch(AccountEntry& entry);
+        void Erase(AccountMap::iterator itr);
+        void MarkWritten(uint32 accountId);
+
+        AccountMap m_accounts;
+        LruList m_lru;
+        uint32 m_lastWriteTime[CHARACTER_ENUM_CACHE_WRITE_SLOTS] = { };    // by account id modulo
+        CharacterEnumCacheStats m_stats = { };
+        ACE_Thread_Mutex m_lock;
+};
+
+#define sCharacterEnumCache MaNGOS::Singleton<CharacterEnumCache>::Instance()
+
+#endif
@@ -33,6 +33,7 @@
 #include "Language.h"
 #include "World.h"
 #include "Anticheat.h"
+#include "CharacterEnumCache.h"
 
 //// MemberSlot ////////////////////////////////////////////
 void MemberSlot::SetMemberStats(Player* player)
@@ -235,6 +236,7 @@ GuildAddStatus Guild::AddMember(ObjectGuid plGuid, uint32 plRank)
 
     CharacterDatabase.PExecute("INSERT INTO guild_member (guildid,guid,rank,pnote,offnote) VALUES ('%u', '%u', '%u','%s','%s')",
                                m_Id, lowguid, newmember.RankId, dbPnote.c_str(), dbOFFnote.c_str());
+    sCharacterEnumCache.InvalidateAccount(newmember.accountId);
 
     // If player not in game data in data field will be loaded from guild tables, no need to update it!!
     if (pl)
@@ -548,6 +550,7 @@ bool Guild::DelMember(ObjectGuid guid, bool isDisbanding)
     }
 
     CharacterDatabase.PExecute("DELETE FROM guild_member WHERE guid = '%u'", lowguid);
+    sCharacterEnumCache.InvalidateAccount(sObjectMgr.GetPlayerAccountIdByGUID(guid));
 
     if (!isDisbanding)
         UpdateAccountsNumber();
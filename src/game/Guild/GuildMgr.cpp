@@ -24,6 +24,7 @@
 #include "Policies/SingletonImp.h"
 #include "ProgressBar.h"
 #include "World.h"
+#include "WhoListIndex.h"
 
 INSTANTIATE_SINGLETON_1(GuildMgr);
 
@@ -40,6 +41,8 @@ GuildMgr::~GuildMgr()
 void GuildMgr::AddGuild(Guild* guild)
 {
     m_GuildMap[guild->GetId()] = guild;
+    // The members of a new guild were indexed while it was not known yet
+    sWhoListIndex.UpdateGuildName(guild->GetId(), guild->GetName());
 }
 
 void GuildMgr::RemoveGuild(uint32 guildId)
@@ -44,6 +44,7 @@
 #include "Anticheat.h"
 #include "MasterPlayer.h"
 #include "PlayerBroadcaster.h"
+#include "CharacterEnumCache.h"
 
 // config option SkipCinematics supported values
 enum CinematicsSkipMode
@@ -59,9 +60,10 @@ class LoginQueryHolder : public SqlQueryHolder
 private:
     uint32 m_accountId;
     ObjectGuid m_guid;
+    bool m_initialized;
 public:
     LoginQueryHolder(uint32 accountId, ObjectGuid guid)
-        : SqlQueryHolder(guid.GetCounter()), m_accountId(accountId), m_guid(guid) { }
+        : SqlQueryHolder(guid.GetCounter()), m_accountId(accountId), m_guid(guid), m_initialized(false) { }
     ~LoginQueryHolder()
     {
         // Queries should NOT be deleted by user
@@ -75,12 +77,18 @@ public:
     {
         return m_accountId;
     }
+    // False for the holder of a reconnect, which has no query results
+    bool IsInitialized() const
+    {
+        return m_initialized;
+    }
     bool Initialize();
 };
 
 bool LoginQueryHolder::Initialize()
 {
     SetSize(MAX_PLAYER_LOGIN_QUERY);
+    m_initialized = true;
 
     bool res = true;
 
@@ -144,6 +152,24 @@ public:
 } chrHandler;
 
 void WorldSession::HandleCharEnum(QueryResult * result)
+{
+    CharacterEnumList characters;
+    if (result)
+    {
+        characters.resize(result->GetRowCount());
+        for (CharacterEnumList::iterator itr = characters.begin(); itr != characters.end(); ++itr)
+        {
+            itr->LoadFromDB(result->Fetch());
+            result->NextRow();
+        }
+        delete result;
+    }
+
+    sCharacterEnumCache.StoreCharacters(GetAccountId(), characters);
+    SendCharEnum(characters);
+}
+
+void WorldSession::SendCharEnum(CharacterEnumList const& characters)
 {
     WorldPacket data(SMSG_CHAR_ENUM, 100);                  // we guess size
 
@@ -151,22 +177,14 @@ void WorldSession::HandleCharEnum(QueryResult * result)
 
     data << num;
 
-    if (result)
+    for (CharacterEnumList::const_iterator itr = characters.begin(); itr != characters.end(); ++itr)
     {
-        do
-        {
-            uint32 guidlow = (*result)[0].GetUInt32();
-            uint32 level   = (*result)[7].GetUInt32();
-            if (_characterMaxLevel < level)
-                _characterMaxLevel = level;
-
-            DETAIL_LOG("Build enum data for char guid %u from account %u.", guidlow, GetAccountId());
-            if (Player::BuildEnumData(result, &data))
-                ++num;
-        }
-        while (result->NextRow());
+        if (_characterMaxLevel < itr->level)
+            _characterMaxLevel = itr->level;
 
-        delete result;
+        DETAIL_LOG("Build enum data for char guid %u from account %u.", itr->guid, GetAccountId());
+        if (Player::BuildEnumData(*itr, &data))
+            ++num;
     }
 
     data.put<uint8>(0, num);
@@ -177,6 +195,13 @@ void WorldSession::HandleCharEnum(QueryResult * result)
 
 void WorldSession::HandleCharEnumOpcode(WorldPacket & /*recv_data*/)
 {
+    CharacterEnumList characters;
+    if (sCharacterEnumCache.GetCharacters(GetAccountId(), characters))
+    {
+        SendCharEnum(characters);
+        return;
+    }
+
     /// get all the data necessary for loading all characters (along with their pets) on the account
     CharacterDatabase.AsyncPQuery(&chrHandler, &CharacterHandler::HandleCharEnumCallback, GetAccountId(),
                                   //           0               1                2                3                 4                  5                       6                        7
@@ -353,6 +378,7 @@ void WorldSession::HandleCharCreateOpcode(WorldPacket & recv_data)
     masterPlayer.SaveToDB();
 
     sObjectMgr.InsertPlayerInCache(pNewChar);
+    sCharacterEnumCache.InvalidateAccount(GetAccountId());
     _charactersCount += 1;
 
     LoginDatabase.PExecute("DELETE FROM realmcharacters WHERE acctid= '%u' AND realmid = '%u'", GetAccountId(), realmID);
@@ -435,6 +461,18 @@ void WorldSession::HandlePlayerLoginOpcode(WorldPacket & recv_data)
 
     DEBUG_LOG("WORLD: Recvd Player Logon Message");
 
+    // Reconnect while the character is still in world (network issue, ALT-F4 ...):
+    // nothing is loaded from the DB, HandlePlayerLogin takes the online player back.
+    if (Player* onlinePlayer = sObjectAccessor.FindPlayer(playerGuid))
+    {
+        if (onlinePlayer->GetSession()->GetAccountId() == GetAccountId() && sObjectAccessor.FindMasterPlayer(playerGuid))
+        {
+            m_playerLoading = true;
+            HandlePlayerLogin(new LoginQueryHolder(GetAccountId(), playerGuid));
+            return;
+        }
+    }
+
     LoginQueryHolder *holder = new LoginQueryHolder(GetAccountId(), playerGuid);
     if (!holder->Initialize())
     {
@@ -473,6 +511,19 @@ void WorldSession::HandlePlayerLogin(LoginQueryHolder *holder)
     ObjectGuid playerGuid = holder->GetGuid();
     ASSERT(playerGuid.IsPlayer());
 
+    // Reconnect without DB queries, but the character is no longer fully online: load it the usual way
+    if (!holder->IsInitialized() && (!sObjectAccessor.FindPlayer(playerGuid) || !sObjectAccessor.FindMasterPlayer(playerGuid)))
+    {
+        if (!holder->Initialize())
+        {
+            delete holder;                                  // delete all unprocessed queries
+            m_playerLoading = false;
+            return;
+        }
+        CharacterDatabase.DelayQueryHolderUnsafe(&chrHandler, &CharacterHandler::HandlePlayerLoginCallback, holder);
+        return;
+    }
+
     // If the character is online (ALT-F4 logout for example)
     Player *pCurrChar = sObjectAccessor.FindPlayer(playerGuid);
     MasterPlayer* pCurrMasterPlayer = sObjectAccessor.FindMasterPlayer(playerGuid);
@@ -932,6 +983,7 @@ void WorldSession::HandleChangePlayerNameOpcodeCallBack(QueryResult *result, uin
 
     CharacterDatabase.BeginTransaction();
     CharacterDatabase.PExecute("UPDATE characters set name = '%s', at_login = at_login & ~ %u WHERE guid ='%u'", newname.c_str(), uint32(AT_LOGIN_RENAME), guidLow);
+    sCharacterEnumCache.InvalidateAccount(accountId);
     CharacterDatabase.CommitTransaction();
 
     sLog.out(LOG_CHAR, "Account: %d (IP: %s) Character:[%s] (guid:%u) Changed name to: %s", session->GetAccountId(), session->GetRemoteAddress().c_str(), oldname.c_str(), guidLow, newname.c_str());
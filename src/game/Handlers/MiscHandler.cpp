@@ -48,6 +48,7 @@
 #include "Anticheat.h"
 #include "MasterPlayer.h"
 #include "GossipDef.h"
+#include "WhoListIndex.h"
 
 void WorldSession::HandleRepopRequestOpcode(WorldPacket & /*recv_data*/)
 {
@@ -79,10 +80,7 @@ class WhoListClientQueryTask: public AsyncTask
 {
 public:
     uint32 accountId;
-    uint32 level_min, level_max, racemask, classmask, zones_count, str_count;
-    uint32 zoneids[10];                                     // 10 is client limit
-    std::wstring str[4];                                    // 4 is client limit
-    std::wstring wplayer_name, wguild_name;
+    WhoListQuery query;
     void run()
     {
         WorldSession* sess = sWorld.FindSession(accountId);
@@ -91,136 +89,9 @@ public:
         sess->SetReceivedWhoRequest(false);
         if (!sess->GetPlayer() || !sess->GetPlayer()->IsInWorld())
             return;
-        uint32 clientcount = 0;
-        Team team = sess->GetPlayer()->GetTeam();
-        AccountTypes security = sess->GetSecurity();
-        bool allowTwoSideWhoList = sWorld.getConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_WHO_LIST);
-        AccountTypes gmLevelInWhoList = (AccountTypes)sWorld.getConfig(CONFIG_UINT32_GM_LEVEL_IN_WHO_LIST);
-
-        const uint32 zone = sess->GetPlayer()->GetCachedZoneId();
-        const bool notInBattleground = !((zone == 2597) || (zone == 3277) || (zone == 3358));
 
         WorldPacket data(SMSG_WHO, 50);                         // guess size
-        data << uint32(clientcount);                            // clientcount place holder, listed count
-        data << uint32(clientcount);                            // clientcount place holder, online count
-
-        // TODO: Guard Player map
-        HashMapHolder<Player>::MapType& m = sObjectAccessor.GetPlayers();
-        for (HashMapHolder<Player>::MapType::const_iterator itr = m.begin(); itr != m.end(); ++itr)
-        {
-            Player* pl = itr->second;
-
-            if (security == SEC_PLAYER)
-            {
-                // player can see member of other team only if CONFIG_BOOL_ALLOW_TWO_SIDE_WHO_LIST
-                if (pl->GetTeam() != team && !allowTwoSideWhoList)
-                    continue;
-
-                // player can see MODERATOR, GAME MASTER, ADMINISTRATOR only if CONFIG_GM_IN_WHO_LIST
-                if (pl->GetSession()->GetSecurity() > gmLevelInWhoList)
-                    continue;
-            }
-
-            // do not process players which are not in world
-            if (!pl->IsInWorld())
-                continue;
-
-            // check if target's level is in level range
-            uint32 lvl = pl->getLevel();
-            if (lvl < level_min || lvl > level_max)
-                continue;
-
-            // check if target is globally visible for player
-            if (!pl->IsVisibleGloballyFor(sess->GetPlayer()))
-                continue;
-
-            // check if class matches classmask
-            uint32 class_ = pl->getClass();
-            if (!(classmask & (1 << class_)))
-                continue;
-
-            // check if race matches racemask
-            uint32 race = pl->getRace();
-            if (!(racemask & (1 << race)))
-                continue;
-
-            std::string pname = pl->GetName();
-            std::wstring wpname;
-            if (!Utf8toWStr(pname, wpname))
-                continue;
-            wstrToLower(wpname);
-
-            if (!(wplayer_name.empty() || wpname.find(wplayer_name) != std::wstring::npos))
-                continue;
-
-            std::string gname = sGuildMgr.GetGuildNameById(pl->GetGuildId());
-            std::wstring wgname;
-            if (!Utf8toWStr(gname, wgname))
-                continue;
-            wstrToLower(wgname);
-
-            if (!(wguild_name.empty() || wgname.find(wguild_name) != std::wstring::npos))
-                continue;
-
-            uint32 pzoneid = pl->GetCachedZoneId();
-
-            bool z_show = true;
-            for (uint32 i = 0; i < zones_count; ++i)
-            {
-                if (zoneids[i] == pzoneid)
-                {
-                    // World of Warcraft Client Patch 1.7.0 (2005-09-13)
-                    // Using the / who command while in a Battleground instance will now only display players in your instance.
-                    z_show = (zone != pzoneid) || notInBattleground || (sess->GetPlayer()->GetInstanceId() == pl->GetInstanceId());
-                    break;
-                }
-
-                z_show = false;
-            }
-            if (!z_show)
-                continue;
-
-            std::string aname;
-            if (const auto *areaEntry = AreaEntry::GetById(pzoneid))
-            {
-                aname = areaEntry->Name;
-                sObjectMgr.GetAreaLocaleString(areaEntry->Id, sess->GetSessionDbLocaleIndex(), &aname);
-            }
-
-            bool s_show = true;
-            for (uint32 i = 0; i < str_count; ++i)
-            {
-                if (!str[i].empty())
-                {
-                    if (wgname.find(str[i]) != std::wstring::npos ||
-                            wpname.find(str[i]) != std::wstring::npos ||
-                            Utf8FitTo(aname, str[i]))
-                    {
-                        s_show = true;
-                        break;
-                    }
-                    s_show = false;
-                }
-            }
-            if (!s_show)
-                continue;
-
-            data << pname;                                      // player name
-            data << gname;                                      // guild name
-            data << uint32(lvl);                                // player level
-            data << uint32(class_);                             // player class
-            data << uint32(race);                               // player race
-            data << uint32(pzoneid);                            // player zone id
-
-            // 50 is maximum player count sent to client
-            if ((++clientcount) == 49)
-                break;
-        }
-
-        uint32 count = m.size();
-        data.put(0, clientcount);                               // insert right count, listed count
-        data.put(4, count > 49 ? count : clientcount);          // insert right count, online count
-
+        sWhoListIndex.BuildWhoList(sess, query, data);
         sess->SendPacket(&data);
         DEBUG_LOG("WORLD: Send SMSG_WHO Message");
     }
@@ -238,63 +109,63 @@ void WorldSession::HandleWhoOpcode(WorldPacket & recv_data)
     std::string player_name, guild_name;
 
 
-    recv_data >> task->level_min;                               // maximal player level, default 0
-    recv_data >> task->level_max;                               // minimal player level, default 100 (MAX_LEVEL)
+    recv_data >> task->query.levelMin;                          // maximal player level, default 0
+    recv_data >> task->query.levelMax;                          // minimal player level, default 100 (MAX_LEVEL)
     recv_data >> player_name;                                   // player name, case sensitive...
 
     recv_data >> guild_name;                                    // guild name, case sensitive...
 
-    recv_data >> task->racemask;                                // race mask
-    recv_data >> task->classmask;                               // class mask
-    recv_data >> task->zones_count;                             // zones count, client limit=10 (2.0.10)
+    recv_data >> task->query.raceMask;                          // race mask
+    recv_data >> task->query.classMask;                         // class mask
+    recv_data >> task->query.zonesCount;                        // zones count, client limit=10 (2.0.10)
 
-    if (task->zones_count > 10)
+    if (task->query.zonesCount > WHO_LIST_MAX_ZONES)
     {
         delete task;
         return;                                                 // can't be received from real client or broken packet
     }
-    for (uint32 i = 0; i < task->zones_count; ++i)
+    for (uint32 i = 0; i < task->query.zonesCount; ++i)
     {
         uint32 temp;
         recv_data >> temp;                                  // zone id, 0 if zone is unknown...
-        task->zoneids[i] = temp;
-        DEBUG_LOG("Zone %u: %u", i, task->zoneids[i]);
+        task->query.zoneIds[i] = temp;
+        DEBUG_LOG("Zone %u: %u", i, task->query.zoneIds[i]);
     }
 
-    recv_data >> task->str_count;                                 // user entered strings count, client limit=4 (checked on 2.0.10)
+    recv_data >> task->query.stringsCount;                      // user entered strings count, client limit=4 (checked on 2.0.10)
 
-    if (task->str_count > 4)
+    if (task->query.stringsCount > WHO_LIST_MAX_STRINGS)
     {
         delete task;
         return;                                             // can't be received from real client or broken packet
     }
-    DEBUG_LOG("Minlvl %u, maxlvl %u, name %s, guild %s, racemask %u, classmask %u, zones %u, strings %u", task->level_min, task->level_max, player_name.c_str(), guild_name.c_str(), task->racemask, task->classmask, task->zones_count, task->str_count);
+    DEBUG_LOG("Minlvl %u, maxlvl %u, name %s, guild %s, racemask %u, classmask %u, zones %u, strings %u", task->query.levelMin, task->query.levelMax, player_name.c_str(), guild_name.c_str(), task->query.raceMask, task->query.classMask, task->query.zonesCount, task->query.stringsCount);
 
-    for (uint32 i = 0; i < task->str_count; ++i)
+    for (uint32 i = 0; i < task->query.stringsCount; ++i)
     {
         std::string temp;
         recv_data >> temp;                                  // user entered string, it used as universal search pattern(guild+player name)?
 
-        if (!Utf8toWStr(temp, task->str[i]))
+        if (!Utf8toWStr(temp, task->query.strings[i]))
             continue;
 
-        wstrToLower(task->str[i]);
+        wstrToLower(task->query.strings[i]);
 
         DEBUG_LOG("String %u: %s", i, temp.c_str());
     }
 
-    if (!(Utf8toWStr(player_name, task->wplayer_name) && Utf8toWStr(guild_name, task->wguild_name)))
+    if (!(Utf8toWStr(player_name, task->query.playerName) && Utf8toWStr(guild_name, task->query.guildName)))
     {
         delete task;
         return;
     }
-    wstrToLower(task->wplayer_name);
-    wstrToLower(task->wguild_name);
+    wstrToLower(task->query.playerName);
+    wstrToLower(task->query.guildName);
 
     // client send in case not set max level value 100 but mangos support 255 max level,
     // update it to show GMs with characters after 100 level
-    if (task->level_max >= MAX_LEVEL)
-        task->level_max = STRONG_MAX_LEVEL;
+    if (task->query.levelMax >= MAX_LEVEL)
+        task->query.levelMax = STRONG_MAX_LEVEL;
 
     SetReceivedWhoRequest(true);
     sWorld.AddAsyncTask(task);
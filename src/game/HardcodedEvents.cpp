@@ -150,6 +150,7 @@ void ElementalInvasion::ResetThings()
 
         // ready bosses respawn timers
         CharacterDatabase.PExecute("DELETE FROM `creature_respawn` WHERE `guid` = '%u'", InvasionData[i].bossGuid);
+        sMapPersistentStateMgr.JournalRespawnTimesRemoval(RESPAWN_JOURNAL_DEL_CREATURE, InvasionData[i].bossGuid);
     }
 }
 
@@ -55,19 +55,28 @@ public:
     bool HasQuestDrop() const;                          // True if group includes at least 1 quest drop entry
     bool HasQuestDropForPlayer(Player const * player) const;
     // The same for active quests of the player
-    void Process(Loot& loot) const;                     // Rolls an item from the group (if any) and adds the item to the loot
+    void Process(Loot& loot, bool legacyRoll = false) const; // Rolls an item from the group (if any) and adds the item to the loot
     float RawTotalChance() const;                       // Overall chance for the group (without equal chanced items)
     float TotalChance() const;                          // Overall chance for the group
 
     void Verify(LootStore const& lootstore, uint32 id, uint32 group_id) const;
     void CollectLootIds(LootIdSet& set) const;
     void CheckLootRefs(LootIdSet* ref_set) const;
+    void Compile();                                     // Builds the alias tables (after loading stage)
 private:
     LootStoreItemList ExplicitlyChanced;                // Entries with chances defined in DB
     LootStoreItemList EqualChanced;                     // Zero chances - every entry takes the same chance
 
     LootStoreItem const * Roll(Loot const& loot) const;                 // Rolls an item from the group, returns NULL if all miss their chances
+    LootStoreItem const * RollLinear(Loot const& loot) const;           // Same as Roll, walking the entries (reference implementation)
+    LootStoreItem const * RollEqualChanced(Loot const& loot) const;
     bool hasConditionalEqualChancedItem;
+
+    // Walker alias table over ExplicitlyChanced, the last column is the "nothing explicitly chanced dropped" outcome
+    std::vector<float>  m_aliasProbability;
+    std::vector<uint32> m_aliasIndex;
+    // EqualChanced indexes allowed for an alliance (0), horde (1) or other (2) looting group, when hasConditionalEqualChancedItem
+    std::vector<uint32> m_equalChancedForTeam[3];
 };
 
 //Remove all data and free all memory
@@ -184,6 +193,7 @@ void LootStore::LoadLootTable()
         delete result;
 
         Verify();                                           // Checks validity of the loot store
+        Compile();
 
         sLog.outString();
         sLog.outString(">> Loaded %u loot definitions (%lu templates)", count, (unsigned long)m_LootTemplates.size());
@@ -215,6 +225,12 @@ bool LootStore::HaveQuestLootForPlayer(uint32 loot_id, Player* player) const
     return false;
 }
 
+void LootStore::Compile()
+{
+    for (LootTemplateMap::const_iterator i = m_LootTemplates.begin(); i != m_LootTemplates.end(); ++i)
+        i->second->Compile();
+}
+
 LootTemplate const* LootStore::GetLootFor(uint32 loot_id) const
 {
     LootTemplateMap::const_iterator tab = m_LootTemplates.find(loot_id);
@@ -1021,8 +1037,121 @@ void LootTemplate::LootGroup::AddEntry(LootStoreItem& item)
     }
 }
 
+// Builds the alias tables used by Roll. Chances are taken as seen by the sequential roll of RollLinear:
+// an entry only gets what the previous entries left (and everything left if its chance is >= 100%).
+void LootTemplate::LootGroup::Compile()
+{
+    m_aliasProbability.clear();
+    m_aliasIndex.clear();
+
+    if (!ExplicitlyChanced.empty())
+    {
+        uint32 const columns = ExplicitlyChanced.size() + 1;
+        std::vector<double> weights(columns, 0.0);
+
+        double remaining = 100.0;
+        for (uint32 i = 0; i < ExplicitlyChanced.size() && remaining > 0.0; ++i)
+        {
+            double chance = ExplicitlyChanced[i].chance >= 100.0f ? remaining : std::min<double>(ExplicitlyChanced[i].chance, remaining);
+            weights[i] = chance;
+            remaining -= chance;
+        }
+        weights[columns - 1] = std::max(remaining, 0.0);
+
+        // Vose's construction: every column holds its own entry up to m_aliasProbability, the alias above
+        m_aliasProbability.resize(columns, 1.0f);
+        m_aliasIndex.resize(columns);
+        std::vector<uint32> small, large;
+        for (uint32 i = 0; i < columns; ++i)
+        {
+            m_aliasIndex[i] = i;
+            weights[i] = weights[i] * columns / 100.0;
+            if (weights[i] < 1.0)
+                small.push_back(i);
+            else
+                large.push_back(i);
+        }
+
+        while (!small.empty() && !large.empty())
+        {
+            uint32 less = small.back();
+            small.pop_back();
+            uint32 more = large.back();
+            large.pop_back();
+
+            m_aliasProbability[less] = float(weights[less]);
+            m_aliasIndex[less] = more;
+
+            weights[more] = (weights[more] + weights[less]) - 1.0;
+            if (weights[more] < 1.0)
+                small.push_back(more);
+            else
+                large.push_back(more);
+        }
+        // Leftovers are only rounding errors away from 1.0
+    }
+
+    for (uint32 t = 0; t < 3; ++t)
+        m_equalChancedForTeam[t].clear();
+    if (!hasConditionalEqualChancedItem)
+        return;
+
+    Team const teams[3] = { ALLIANCE, HORDE, TEAM_NONE };
+    for (uint32 t = 0; t < 3; ++t)
+    {
+        m_equalChancedForTeam[t].reserve(EqualChanced.size());
+        for (uint32 i = 0; i < EqualChanced.size(); ++i)
+        {
+            if (uint32 conditionId = EqualChanced[i].conditionId)
+            {
+                PlayerCondition const* condition = sConditionStorage.LookupEntry<PlayerCondition>(conditionId);
+                if (!condition)
+                    continue;
+                Team conditionTeam = condition->GetTeam();
+                if ((conditionTeam == ALLIANCE || conditionTeam == HORDE) && conditionTeam != teams[t])
+                    continue;
+                if (!condition->CheckPatch())
+                    continue;
+            }
+            m_equalChancedForTeam[t].push_back(i);
+        }
+    }
+}
+
 // Rolls an item from the group, returns NULL if all miss their chances
 LootStoreItem const * LootTemplate::LootGroup::Roll(Loot const& loot) const
+{
+    if (!m_aliasProbability.empty())                        // First explicitly chanced entries are checked, in O(1)
+    {
+        double roll = rand_norm() * m_aliasProbability.size();
+        uint32 column = std::min(uint32(roll), uint32(m_aliasProbability.size() - 1));
+        uint32 index = (roll - column) < m_aliasProbability[column] ? column : m_aliasIndex[column];
+
+        if (index < ExplicitlyChanced.size())
+            return &ExplicitlyChanced[index];
+    }
+
+    return RollEqualChanced(loot);
+}
+
+// Takes an item from the equal-chanced part, regarding looting group faction
+LootStoreItem const * LootTemplate::LootGroup::RollEqualChanced(Loot const& loot) const
+{
+    if (EqualChanced.empty())
+        return NULL;
+
+    if (!hasConditionalEqualChancedItem || loot.GetTeam() == TEAM_CROSSFACTION)
+        return &EqualChanced[irand(0, EqualChanced.size() - 1)];
+
+    std::vector<uint32> const& indexesOk = m_equalChancedForTeam[loot.GetTeam() == ALLIANCE ? 0 : (loot.GetTeam() == HORDE ? 1 : 2)];
+    if (indexesOk.empty())
+        return NULL;
+
+    return &EqualChanced[indexesOk[urand(0, indexesOk.size() - 1)]];
+}
+
+// Rolls an item from the group walking all entries, as done before alias tables
+LootStoreItem const * LootTemplate::LootGroup::RollLinear(Loot const& loot) const
 {
     if (!ExplicitlyChanced.empty())                         // First explicitly chanced entries are checked
     {
@@ -1093,9 +1222,9 @@ bool LootTemplate::LootGroup::HasQuestDropForPlayer(Player const * player) const
 }
 
 // Rolls an item from the group (if any takes its chance) and adds the item to the loot
-void LootTemplate::LootGroup::Process(Loot& loot) const
+void LootTemplate::LootGroup::Process(Loot& loot, bool legacyRoll) const
 {
-    LootStoreItem const * item = Roll(loot);
+    LootStoreItem const * item = legacyRoll ? RollLinear(loot) : Roll(loot);
     if (item != NULL)
         loot.AddItem(*item);
 }
@@ -1179,40 +1308,48 @@ void LootTemplate::AddEntry(LootStoreItem& item)
 }
 
 // Rolls for every item in the template and adds the rolled items the the loot
-void LootTemplate::Process(Loot& loot, LootStore const& store, bool rate, uint8 groupId) const
+void LootTemplate::Process(Loot& loot, LootStore const& store, bool rate, uint8 groupId, bool legacyRoll) const
 {
     if (groupId)                                            // Group reference uses own processing of the group
     {
         if (groupId > Groups.size())
             return;                                         // Error message already printed at loading stage
 
-        Groups[groupId - 1].Process(loot);
+        Groups[groupId - 1].Process(loot, legacyRoll);
         return;
     }
 
     // Rolling non-grouped items
-    for (LootStoreItemList::const_iterator i = Entries.begin() ; i != Entries.end() ; ++i)
+    for (uint32 i = 0; i < Entries.size(); ++i)
     {
-        if (!i->Roll(rate))
+        LootStoreItem const& entry = Entries[i];
+        if (!entry.Roll(rate))
             continue;                                       // Bad luck for the entry
 
-        if (i->mincountOrRef < 0)                           // References processing
+        if (entry.mincountOrRef < 0)                        // References processing
         {
-            LootTemplate const* Referenced = LootTemplates_Reference.GetLootFor(-i->mincountOrRef);
+            // Linked at CheckLootRefs, not linked yet only while loading
+            LootTemplate const* Referenced = i < References.size() && References[i] ? References[i] : LootTemplates_Reference.GetLootFor(-entry.mincountOrRef);
 
             if (!Referenced)
                 continue;                                   // Error message already printed at loading stage
 
-            for (uint32 loop = 0; loop < i->maxcount; ++loop) // Ref multiplicator
-                Referenced->Process(loot, store, rate, i->group);
+            for (uint32 loop = 0; loop < entry.maxcount; ++loop) // Ref multiplicator
+                Referenced->Process(loot, store, rate, entry.group, legacyRoll);
         }
         else                                                // Plain entries (not a reference, not grouped)
-            loot.AddItem(*i);                               // Chance is already checked, just add
+            loot.AddItem(entry);                            // Chance is already checked, just add
     }
 
     // Now processing groups
     for (LootGroups::const_iterator i = Groups.begin() ; i != Groups.end() ; ++i)
-        i->Process(loot);
+        i->Process(loot, legacyRoll);
+}
+
+void LootTemplate::Compile()
+{
+    for (LootGroups::iterator i = Groups.begin(); i != Groups.end(); ++i)
+        i->Compile();
 }
 
 // True if template includes at least 1 quest drop entry
@@ -1290,16 +1427,18 @@ void LootTemplate::Verify(LootStore const& lootstore, uint32 id) const
     // TODO: References validity checks
 }
 
-void LootTemplate::CheckLootRefs(LootIdSet* ref_set) const
+void LootTemplate::CheckLootRefs(LootIdSet* ref_set)
 {
-    for (LootStoreItemList::const_iterator ieItr = Entries.begin(); ieItr != Entries.end(); ++ieItr)
+    References.assign(Entries.size(), NULL);
+    for (uint32 i = 0; i < Entries.size(); ++i)
     {
-        if (ieItr->mincountOrRef < 0)
+        if (Entries[i].mincountOrRef < 0)
         {
-            if (!LootTemplates_Reference.GetLootFor(-ieItr->mincountOrRef))
-                LootTemplates_Reference.ReportNotExistedId(-ieItr->mincountOrRef);
+            References[i] = LootTemplates_Reference.GetLootFor(-Entries[i].mincountOrRef);
+            if (!References[i])
+                LootTemplates_Reference.ReportNotExistedId(-Entries[i].mincountOrRef);
             else if (ref_set)
-                ref_set->erase(-ieItr->mincountOrRef);
+                ref_set->erase(-Entries[i].mincountOrRef);
         }
     }
 
@@ -1511,3 +1650,16 @@ void LoadLootTemplates_Reference()
     // output error for any still listed ids (not referenced from any loot table)
     LootTemplates_Reference.ReportUnusedIds(ids_set);
 }
+
+void CompileLootTables()
+{
+    LootTemplates_Creature.Compile();
+    LootTemplates_Fishing.Compile();
+    LootTemplates_Gameobject.Compile();
+    LootTemplates_Item.Compile();
+    LootTemplates_Mail.Compile();
+    LootTemplates_Pickpocketing.Compile();
+    LootTemplates_Skinning.Compile();
+    LootTemplates_Disenchant.Compile();
+    LootTemplates_Reference.Compile();
+}
@@ -170,7 +170,8 @@ class LootStore
         void Verify() const;
 
         void LoadAndCollectLootIds(LootIdSet& ids_set);
-        void CheckLootRefs(LootIdSet* ref_set = NULL) const;// check existence reference and remove it from ref_set
+        void CheckLootRefs(LootIdSet* ref_set = NULL) const;// check existence reference, link it and remove it from ref_set
+        void Compile();                                     // rebuild alias tables of all templates
         void ReportUnusedIds(LootIdSet const& ids_set) const;
         void ReportNotExistedId(uint32 id) const;
 
@@ -202,7 +203,10 @@ class LootTemplate
         // Adds an entry to the group (at loading stage)
         void AddEntry(LootStoreItem& item);
         // Rolls for every item in the template and adds the rolled items the the loot
-        void Process(Loot& loot, LootStore const& store, bool rate, uint8 GroupId = 0) const;
+        // legacyRoll walks the groups linearly instead of using the alias tables (used by `.debug lootbench`)
+        void Process(Loot& loot, LootStore const& store, bool rate, uint8 GroupId = 0, bool legacyRoll = false) const;
+        // Builds the groups alias tables (after loading or conditions reload)
+        void Compile();
 
         // True if template includes at least 1 quest drop entry
         bool HasQuestDrop(LootTemplateMap const& store, uint8 GroupId = 0) const;
@@ -211,10 +215,14 @@ class LootTemplate
 
         // Checks integrity of the template
         void Verify(LootStore const& store, uint32 Id) const;
-        void CheckLootRefs(LootIdSet* ref_set) const;
+        // Also links the references to their reference_loot_template entry
+        void CheckLootRefs(LootIdSet* ref_set);
     private:
+        typedef std::vector<LootTemplate const*> LootTemplateRefs;
+
         LootStoreItemList Entries;                          // not grouped only
         LootGroups        Groups;                           // groups have own (optimised) processing, grouped entries go there
+        LootTemplateRefs  References;                       // resolved reference template for each of Entries (NULL for plain items)
 };
 
 //=====================================================
@@ -399,6 +407,9 @@ void LoadLootTemplates_Disenchant();
 
 void LoadLootTemplates_Reference();
 
+// Alias tables depend on `conditions`, must be rebuilt when they are reloaded
+void CompileLootTables();
+
 inline void LoadLootTables()
 {
     LoadLootTemplates_Creature();
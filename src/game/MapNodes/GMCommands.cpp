@@ -36,5 +36,15 @@ void NodesMgr::ListServers(ChatHandler& handler)
 {
     handler.PSendSysMessage("%u nodes.", m_nodes.size());
     for (NodesMap::const_iterator it = m_nodes.begin(); it != m_nodes.end(); ++it)
+    {
         handler.PSendSysMessage("[%3u][%s] %s", it->first, it->second->IsConnectedToMaster() ? "MSTR" : "NODE", it->second->GetName());
+        NodeSession::SnapshotTransferStats const& sent = it->second->GetSentSnapshotsStats();
+        NodeSession::SnapshotTransferStats const& received = it->second->GetReceivedSnapshotsStats();
+        if (uint32 count = sent.count)
+            handler.PSendSysMessage("      %u players sent: avg %u bytes (raw %u), %uus",
+                count, uint32(sent.transferBytes / count), uint32(sent.rawBytes / count), uint32(sent.timeUs / count));
+        if (uint32 count = received.count)
+            handler.PSendSysMessage("      %u players received: avg %u bytes (raw %u), %uus",
+                count, uint32(received.transferBytes / count), uint32(received.rawBytes / count), uint32(received.timeUs / count));
+    }
 }
@@ -59,6 +59,17 @@ void NodeSession::ForwardClientPacket(uint32 accountId, WorldPacket const* packe
 {
     WorldPacket data(MSG_FORWARD_CLIENT_PACKET, 0);
     WritePacketForward(data, *packet, accountId);
+
+    ACE_Guard<ACE_Thread_Mutex> guard(m_pendingSnapshotsLock);
+    // Hold the packet back until the player it is sent to is on the Node
+    for (PendingSnapshots::const_iterator itr = m_pendingSnapshots.begin(); itr != m_pendingSnapshots.end(); ++itr)
+    {
+        if ((*itr)->accountId == accountId)
+        {
+            (*itr)->heldPackets.push_back(new WorldPacket(data));
+            return;
+        }
+    }
     SendPacket(&data);
 }
 
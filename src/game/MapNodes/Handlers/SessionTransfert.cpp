@@ -1,12 +1,16 @@
+#include <chrono>
+
 #include "NodeSession.h"
+#include "NodesMgr.h"
 #include "WorldPacket.h"
 #include "WorldSocket.h"
 #include "World.h"
 #include "WorldSession.h"
 #include "CharacterDatabaseCache.h"
 #include "NodesOpcodes.h"
-#include "Serializer.h"
-#include "PlayerSerializer.h"
+#include "PlayerSnapshot.h"
+#include "Player.h"
+#include "ObjectAccessor.h"
 
 /*** SESSION LOADING ***/
 struct PacketLoadSession_Header
@@ -107,15 +111,66 @@ void NodeSession::HandleLoadPlayerFromDB(WorldPacket& pkt)
 
 void NodeSession::SendPlayer(WorldSession* wsess, Player* player)
 {
-    PacketLoadPlayer_Header plInfos;
-    plInfos.accountId = wsess->GetAccountId();
-    plInfos.playerGuid = player->GetObjectGuid();
+    player->SaveToDB(); // Make sure there is no corrupted item - checked at DB save
 
-    WorldPacket data(MSG_LOAD_PLAYER_SERIALIZED, 500);
-    data.append(&plInfos, 1);
-    MaNGOS::Serializer::WriteSerializer s(data);
-    MaNGOS::Serializer::Serialize(s, *player);
-    SendPacket(&data);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    PendingPlayerSnapshot* pending = new PendingPlayerSnapshot;
+    pending->accountId = wsess->GetAccountId();
+    pending->playerGuid = player->GetObjectGuid();
+    pending->snapshot.Capture(*player);
+    pending->captureTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    pending->queuedTime = WorldTimer::getMSTime();
+
+    ACE_Guard<ACE_Thread_Mutex> guard(m_pendingSnapshotsLock);
+    m_pendingSnapshots.push_back(pending);
+}
+
+void NodeSession::SendPendingSnapshots()
+{
+    // Only this thread removes snapshots: they can be encoded without the lock
+    std::vector<PendingPlayerSnapshot*> snapshots;
+    {
+        ACE_Guard<ACE_Thread_Mutex> guard(m_pendingSnapshotsLock);
+        if (m_pendingSnapshots.empty())
+            return;
+        snapshots.assign(m_pendingSnapshots.begin(), m_pendingSnapshots.end());
+    }
+
+    for (std::vector<PendingPlayerSnapshot*>::const_iterator itr = snapshots.begin(); itr != snapshots.end(); ++itr)
+    {
+        PendingPlayerSnapshot* pending = *itr;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        PacketLoadPlayer_Header plInfos;
+        plInfos.accountId = pending->accountId;
+        plInfos.playerGuid = pending->playerGuid;
+
+        uint32 rawSize = pending->snapshot.GetRawSize();
+        WorldPacket data(MSG_LOAD_PLAYER_SERIALIZED, sizeof(plInfos) + rawSize + 16);
+        data.append(&plInfos, 1);
+        pending->snapshot.Encode(data, sNodesMgr->IsSnapshotCompressionEnabled());
+        uint32 encodeTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        // The Node must load the player before handling its client packets
+        {
+            ACE_Guard<ACE_Thread_Mutex> guard(m_pendingSnapshotsLock);
+            SendPacket(&data);
+            for (std::vector<WorldPacket*>::const_iterator held = pending->heldPackets.begin(); held != pending->heldPackets.end(); ++held)
+            {
+                SendPacket(*held);
+                delete *held;
+            }
+            m_pendingSnapshots.remove(pending);
+        }
+
+        ++m_sentSnapshots.count;
+        m_sentSnapshots.rawBytes += rawSize;
+        m_sentSnapshots.transferBytes += data.size();
+        m_sentSnapshots.timeUs += pending->captureTimeUs + encodeTimeUs;
+        sLog.out(LOG_PERFORMANCE, "[%s] Sent player %u snapshot: %u bytes (raw %u), capture %uus, queued %ums, encode %uus",
+            GetName(), pending->playerGuid.GetCounter(), uint32(data.size()), rawSize,
+            pending->captureTimeUs, WorldTimer::getMSTimeDiffToNow(pending->queuedTime), encodeTimeUs);
+        delete pending;
+    }
 }
 
 void NodeSession::HandleLoadPlayerSerialized(WorldPacket& pkt)
@@ -132,14 +187,36 @@ void NodeSession::HandleLoadPlayerSerialized(WorldPacket& pkt)
     // TODO: Already online, etc ...
     ASSERT(!sObjectAccessor.FindPlayerNotInWorld(loadInfos.playerGuid));
 
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    PlayerSnapshot snapshot;
+    if (!snapshot.Decode(pkt))
+    {
+        sLog.outError("MSG_LOAD_PLAYER_SERIALIZED: Unable to load player %u (corrupted snapshot, %u bytes)", loadInfos.playerGuid.GetCounter(), uint32(pkt.size()));
+        return;
+    }
+
     Player* player = new Player(wsess);
     wsess->SetPlayer(player);
     player->PrepareWakeUp(loadInfos.playerGuid);
-    MaNGOS::Serializer::ReadSerializer s(pkt);
-    MaNGOS::Serializer::Serialize(s, *player);
+    if (!snapshot.Apply(*player))
+    {
+        sLog.outError("MSG_LOAD_PLAYER_SERIALIZED: Unable to load player %u (snapshot rejected, %u bytes)", loadInfos.playerGuid.GetCounter(), uint32(pkt.size()));
+        wsess->KickPlayer();                                // disconnect client, player is not in world and will not be saved
+        wsess->SetPlayer(NULL);
+        delete player;                                      // delete it manually
+        return;
+    }
     player->WakeUp();
     sObjectAccessor.AddObject(player);
 
+    uint32 loadTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    ++m_receivedSnapshots.count;
+    m_receivedSnapshots.rawBytes += snapshot.GetRawSize();
+    m_receivedSnapshots.transferBytes += pkt.size();
+    m_receivedSnapshots.timeUs += loadTimeUs;
+    sLog.out(LOG_PERFORMANCE, "[%s] Loaded player %s snapshot: %u bytes (raw %u), decode and load %uus",
+        GetName(), player->GetName(), uint32(pkt.size()), snapshot.GetRawSize(), loadTimeUs);
+
     WorldPacket data(SMSG_NEW_WORLD, 20);
     data << uint32(player->GetTeleportDest().mapid);
     data << float(player->GetTeleportDest().coord_x);
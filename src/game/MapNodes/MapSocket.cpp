@@ -64,32 +64,19 @@ int MapSocket::ProcessIncoming(WorldPacket* new_pct)
     return 0;
 }
 
-int MapSocket::iSendPacket(const WorldPacket& pct)
+int MapSocket::BuildPacketHeader(const WorldPacket& pct, uint8* header)
 {
-    if (m_OutBuffer->space() < pct.size() + sizeof(ClientPktHeader))
-    {
-        errno = ENOBUFS;
-        return -1;
-    }
-
-    ClientPktHeader header;
+    ClientPktHeader& clientHeader = *((ClientPktHeader*) header);
 
-    header.cmd = pct.GetOpcode();
-    header.size = pct.size() + 4;
+    clientHeader.cmd = pct.GetOpcode();
+    clientHeader.size = pct.size() + 4;
 
-    EndianConvertReverse(header.size);
-    EndianConvert(header.cmd);
+    EndianConvertReverse(clientHeader.size);
+    EndianConvert(clientHeader.cmd);
 
-    m_Crypt.EncryptSend((uint8*) & header, sizeof(header));
+    m_Crypt.EncryptSend(header, sizeof(ClientPktHeader));
 
-    if (m_OutBuffer->copy((char*) & header, sizeof(header)) == -1)
-        ACE_ASSERT(false);
-
-    if (!pct.empty())
-        if (m_OutBuffer->copy((char*) pct.contents(), pct.size()) == -1)
-            ACE_ASSERT(false);
-
-    return 0;
+    return sizeof(ClientPktHeader);
 }
 
 int MapSocket::OnSocketOpen()
@@ -96,6 +96,8 @@ void NodeSession::UnsafeUpdate(uint32 diff)
             SendPacket(NMSG_REQUEST_FREE_GUIDS_PETS);
     }
 
+    SendPendingSnapshots();
+
     ProcessPacketsByType(NODE_PROCESS_SAFE);
 
     // Update corresponding sessions - to get packets handled !
@@ -160,4 +162,13 @@ void NodeSession::Close()
     }
     m_accountSockets.clear();
     m_socketsLock.release();
+
+    ACE_Guard<ACE_Thread_Mutex> guard(m_pendingSnapshotsLock);
+    for (PendingSnapshots::const_iterator itr = m_pendingSnapshots.begin(); itr != m_pendingSnapshots.end(); ++itr)
+    {
+        for (std::vector<WorldPacket*>::const_iterator held = (*itr)->heldPackets.begin(); held != (*itr)->heldPackets.end(); ++held)
+            delete *held;
+        delete *itr;
+    }
+    m_pendingSnapshots.clear();
 }
@@ -1,6 +1,7 @@
 #ifndef NODESESSION_H
 #define NODESESSION_H
 
+#include <atomic>
 #include <string>
 #include <list>
 #include <unordered_map>
@@ -8,6 +9,7 @@
 #include "MapSocket.h"
 #include "NodesOpcodes.h"
 #include "ObjectGuid.h"
+#include "PlayerSnapshot.h"
 
 class MapSocket;
 class WorldSocket;
@@ -69,10 +71,18 @@ public:
     /**
      * @brief Transfers the given player to the Node (after a serialization).
      * The Node will not need to reload everything from DB.
+     * The player is saved and captured into a PlayerSnapshot here, on the calling thread.
+     * Only the encoding is deferred: the snapshot is encoded and sent at the next UnsafeUpdate.
+     * Until then, the client packets forwarded to the Node for this account are held back.
      * @param wsess
      * @param player
      */
     void SendPlayer(WorldSession* wsess, Player* player);
+    /**
+     * @brief Encodes and sends the snapshots captured by SendPlayer, followed by
+     *  the client packets held back while they were pending.
+     */
+    void SendPendingSnapshots();
 
     /**
      * @brief Sends given $packet to $accountId player.
@@ -111,6 +121,19 @@ public:
     void HandleLoadPlayerSerialized(WorldPacket& pkt);
     void HandleSessionSocketClosed(WorldPacket& pkt);
     void HandleSessionLogoutComplete(WorldPacket& pkt);
+
+    struct SnapshotTransferStats
+    {
+        SnapshotTransferStats() : count(0), rawBytes(0), transferBytes(0), timeUs(0) {}
+
+        // Updated by the world thread, read by the commands
+        std::atomic<uint32> count;
+        std::atomic<uint64> rawBytes;
+        std::atomic<uint64> transferBytes;
+        std::atomic<uint64> timeUs;     // Capture + encode when sending, decode + load when receiving
+    };
+    SnapshotTransferStats const& GetSentSnapshotsStats() const { return m_sentSnapshots; }
+    SnapshotTransferStats const& GetReceivedSnapshotsStats() const { return m_receivedSnapshots; }
 protected:
     void ReadPacketForward(WorldPacket& rcvPacket, WorldPacket& forwardedPacket, uint32& session);
     void WritePacketForward(WorldPacket& sendPacket, WorldPacket const& forwardedPacket, uint32 const& session);
@@ -151,6 +174,21 @@ protected:
     };
     GuidsGenerator itemGuidsGenerator;
     GuidsGenerator petGuidsGenerator;
+
+    struct PendingPlayerSnapshot
+    {
+        uint32 accountId;
+        ObjectGuid playerGuid;
+        PlayerSnapshot snapshot;
+        uint32 captureTimeUs;
+        uint32 queuedTime;      // WorldTimer::getMSTime()
+        std::vector<WorldPacket*> heldPackets;  // MSG_FORWARD_CLIENT_PACKET, sent after the snapshot
+    };
+    typedef std::list<PendingPlayerSnapshot*> PendingSnapshots;
+    PendingSnapshots m_pendingSnapshots;
+    ACE_Thread_Mutex m_pendingSnapshotsLock;    // Also held while sending a snapshot or a packet forwarded to its account
+    SnapshotTransferStats m_sentSnapshots;
+    SnapshotTransferStats m_receivedSnapshots;
 };
 
 #endif // NODESESSION_H
@@ -13,6 +13,7 @@ bool NodesMgr::OnServerStartup()
     m_serverName = sConfig.GetStringDefault("ServerName", "<Unnamed>");
     int nodesListenPort = sConfig.GetIntDefault("NodesListenPort", 0);
     m_masterListenPort = sConfig.GetIntDefault("MasterListenPort", 0);
+    m_snapshotCompression = sConfig.GetBoolDefault("NodesNetwork.PlayerSnapshotCompression", true);
     m_nodeIdx = 0;
 
     // Node system disabled.
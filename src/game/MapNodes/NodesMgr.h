@@ -20,6 +20,7 @@ public:
     void RegisterNode(NodeSession* s) { m_nodes[m_nodeIdx++] = s; }
 
     std::string const& GetServerName() const { return m_serverName; }
+    bool IsSnapshotCompressionEnabled() const { return m_snapshotCompression; }
 
     static NodesMgr* instance()
     {
@@ -38,6 +39,7 @@ protected:
     uint32                      m_nodeIdx;
     uint32                      m_masterListenPort;
     std::string                 m_masterListenAddress;
+    bool                        m_snapshotCompression;
 };
 
 #define sNodesMgr (NodesMgr::instance())
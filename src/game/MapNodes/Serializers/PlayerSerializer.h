@@ -31,13 +31,13 @@ void Serialize(OP& buf, Position& pos)
 
 inline ByteBuffer& operator<<(ByteBuffer& buf, Position const& p)
 {
-    buf << p.x << p.y << p.y << p.o;
+    buf << p.x << p.y << p.z << p.o;
     return buf;
 }
 
 inline ByteBuffer& operator>>(ByteBuffer& buf, Position& p)
 {
-    buf >> p.x >> p.y >> p.y >> p.o;
+    buf >> p.x >> p.y >> p.z >> p.o;
     return buf;
 }
 
@@ -75,6 +75,38 @@ void Player::Serialize(OP& buf)
     if (!buf.IsRead())
         SaveToDB(); // Make sure there is no corrupted item - checked at DB save
 
+    SerializeFields(buf);
+    SerializeSkills(buf);
+    SerializeAuras(buf);
+    if (buf.IsRead() && !isAlive())
+        RemoveAllAurasOnDeath();
+    SerializeSpells(buf);
+    SerializeSpellCooldowns(buf);
+
+    // Not needed:
+    /*
+    _LoadActions(QueryResult *result);
+    _LoadMails(QueryResult *result);
+    _LoadMailedItems(QueryResult *result);
+    _LoadBoundInstances(QueryResult *result);
+    _LoadGroup(QueryResult *result);
+    _LoadFriendList(QueryResult *result);
+    */
+    // TODO:
+    /**
+     * Inventory loading
+     *  Requires map loaded (map dependant items)
+     *  Requires skills loaded (equipment items, can modify skill bonuses)
+     */
+    SerializeInventory(buf);
+    SerializeQuestStatus(buf);
+    m_reputationMgr.Serialize(buf);
+    //_LoadHonorCP(QueryResult *result); // Needed for Player::CalculateTotalKills(victim)
+}
+
+template <typename OP>
+void Player::SerializeFields(OP& buf)
+{
     // Copy paste from Player::SaveToDB to be sure to forget nothing
     buf(m_name);
 
@@ -156,33 +188,6 @@ void Player::Serialize(OP& buf)
 
         SetMap(sMapMgr.CreateMap(GetMapId(), this));
     }
-
-    SerializeSkills(buf);
-    SerializeAuras(buf);
-    if (buf.IsRead() && !isAlive())
-        RemoveAllAurasOnDeath();
-    SerializeSpells(buf);
-    SerializeSpellCooldowns(buf);
-
-    // Not needed:
-    /*
-    _LoadActions(QueryResult *result);
-    _LoadMails(QueryResult *result);
-    _LoadMailedItems(QueryResult *result);
-    _LoadBoundInstances(QueryResult *result);
-    _LoadGroup(QueryResult *result);
-    _LoadFriendList(QueryResult *result);
-    */
-    // TODO:
-    /**
-     * Inventory loading
-     *  Requires map loaded (map dependant items)
-     *  Requires skills loaded (equipment items, can modify skill bonuses)
-     */
-    SerializeInventory(buf);
-    SerializeQuestStatus(buf);
-    m_reputationMgr.Serialize(buf);
-    //_LoadHonorCP(QueryResult *result); // Needed for Player::CalculateTotalKills(victim)
 }
 
 
@@ -0,0 +1,180 @@
+#include "PlayerSnapshot.h"
+#include "PlayerSerializer.h"
+#include "UpdateData.h"
+#include "Log.h"
+#include "zlib/zlib.h"
+
+// magic + version + flags + rawSize + payloadSize
+static size_t const PLAYER_SNAPSHOT_HEADER_SIZE = 4 + 2 + 2 + 4 + 4;
+// section id + length
+static size_t const PLAYER_SNAPSHOT_SECTION_HEADER_SIZE = 1 + 4;
+
+template <typename OP>
+void PlayerSnapshot::SerializeSection(Player& player, uint32 section, OP& buf)
+{
+    switch (section)
+    {
+        case PLAYER_SNAPSHOT_FIELDS:        player.SerializeFields(buf);          break;
+        case PLAYER_SNAPSHOT_SKILLS:        player.SerializeSkills(buf);          break;
+        case PLAYER_SNAPSHOT_AURAS:         player.SerializeAuras(buf);           break;
+        case PLAYER_SNAPSHOT_SPELLS:        player.SerializeSpells(buf);          break;
+        case PLAYER_SNAPSHOT_COOLDOWNS:     player.SerializeSpellCooldowns(buf);  break;
+        case PLAYER_SNAPSHOT_INVENTORY:     player.SerializeInventory(buf);       break;
+        case PLAYER_SNAPSHOT_QUESTS:        player.SerializeQuestStatus(buf);     break;
+        case PLAYER_SNAPSHOT_REPUTATION:    player.m_reputationMgr.Serialize(buf); break;
+    }
+}
+
+void PlayerSnapshot::Capture(Player& player)
+{
+    for (uint32 i = 0; i < MAX_PLAYER_SNAPSHOT_SECTIONS; ++i)
+    {
+        m_sections[i] = std::make_shared<ByteBuffer>();
+        MaNGOS::Serializer::WriteSerializer buf(*m_sections[i]);
+        SerializeSection(player, i, buf);
+    }
+}
+
+bool PlayerSnapshot::Apply(Player& player)
+{
+    if (!IsComplete())
+        return false;
+
+    for (uint32 i = 0; i < MAX_PLAYER_SNAPSHOT_SECTIONS; ++i)
+    {
+        ByteBuffer& section = ModifySection(i);
+        section.rpos(0);
+        MaNGOS::Serializer::ReadSerializer buf(section);
+        SerializeSection(player, i, buf);
+        if (i == PLAYER_SNAPSHOT_AURAS && !player.isAlive())
+            player.RemoveAllAurasOnDeath();
+
+        if (section.rpos() != section.wpos())
+        {
+            sLog.outError("PlayerSnapshot: section %u of player %s has %u unread bytes",
+                i, player.GetName(), uint32(section.wpos() - section.rpos()));
+            return false;
+        }
+    }
+    return true;
+}
+
+void PlayerSnapshot::Encode(ByteBuffer& out, bool compress) const
+{
+    ByteBuffer raw(GetRawSize());
+    for (uint32 i = 0; i < MAX_PLAYER_SNAPSHOT_SECTIONS; ++i)
+    {
+        uint32 length = m_sections[i] ? m_sections[i]->wpos() : 0;
+        raw << uint8(i);
+        raw << length;
+        if (length)
+            raw.append(m_sections[i]->contents(), length);
+    }
+
+    uint16 flags = 0;
+    ByteBuffer compressed;
+    if (compress)
+    {
+        uint32 compressedSize = compressBound(raw.wpos());
+        compressed.resize(compressedSize);
+        PacketCompressor::Compress(const_cast<uint8*>(compressed.contents()), &compressedSize, const_cast<uint8*>(raw.contents()), raw.wpos());
+        // Not worth it on very small snapshots
+        if (compressedSize && compressedSize < raw.wpos())
+        {
+            compressed.resize(compressedSize);
+            flags |= PLAYER_SNAPSHOT_FLAG_COMPRESSED;
+        }
+    }
+
+    ByteBuffer const& payload = (flags & PLAYER_SNAPSHOT_FLAG_COMPRESSED) ? compressed : raw;
+    out.reserve(out.wpos() + PLAYER_SNAPSHOT_HEADER_SIZE + payload.wpos());
+    out << uint32(PLAYER_SNAPSHOT_MAGIC);
+    out << uint16(PLAYER_SNAPSHOT_VERSION);
+    out << flags;
+    out << uint32(raw.wpos());
+    out << uint32(payload.wpos());
+    out.append(payload);
+}
+
+bool PlayerSnapshot::Decode(ByteBuffer& in)
+{
+    if (in.size() < in.rpos() + PLAYER_SNAPSHOT_HEADER_SIZE)
+        return false;
+
+    uint32 magic, rawSize, payloadSize;
+    uint16 version, flags;
+    in >> magic >> version >> flags >> rawSize >> payloadSize;
+    if (magic != PLAYER_SNAPSHOT_MAGIC || version != PLAYER_SNAPSHOT_VERSION)
+    {
+        sLog.outError("PlayerSnapshot: invalid header (magic 0x%X version %u, expected version %u)", magic, version, PLAYER_SNAPSHOT_VERSION);
+        return false;
+    }
+    if (in.size() - in.rpos() < payloadSize || rawSize < MAX_PLAYER_SNAPSHOT_SECTIONS * PLAYER_SNAPSHOT_SECTION_HEADER_SIZE || !payloadSize)
+        return false;
+    // Allocated before uncompressing: do not trust it
+    if (rawSize > PLAYER_SNAPSHOT_MAX_RAW_SIZE)
+    {
+        sLog.outError("PlayerSnapshot: raw size %u is over the %u bytes limit", rawSize, PLAYER_SNAPSHOT_MAX_RAW_SIZE);
+        return false;
+    }
+
+    ByteBuffer raw;
+    if (flags & PLAYER_SNAPSHOT_FLAG_COMPRESSED)
+    {
+        raw.resize(rawSize);
+        uLongf realSize = rawSize;
+        if (uncompress(const_cast<uint8*>(raw.contents()), &realSize, in.contents() + in.rpos(), payloadSize) != Z_OK || realSize != rawSize)
+        {
+            sLog.outError("PlayerSnapshot: unable to uncompress %u bytes", payloadSize);
+            return false;
+        }
+    }
+    else if (payloadSize == rawSize)
+        raw.append(in.contents() + in.rpos(), payloadSize);
+    else
+        return false;
+    in.read_skip(payloadSize);
+
+    while (raw.rpos() < raw.wpos())
+    {
+        if (raw.wpos() - raw.rpos() < PLAYER_SNAPSHOT_SECTION_HEADER_SIZE)
+            return false;
+
+        uint8 section;
+        uint32 length;
+        raw >> section >> length;
+        if (section >= MAX_PLAYER_SNAPSHOT_SECTIONS || raw.wpos() - raw.rpos() < length)
+            return false;
+
+        m_sections[section] = std::make_shared<ByteBuffer>(length);
+        if (length)
+            m_sections[section]->append(raw.contents() + raw.rpos(), length);
+        raw.read_skip(length);
+    }
+    return IsComplete();
+}
+
+bool PlayerSnapshot::IsComplete() const
+{
+    for (uint32 i = 0; i < MAX_PLAYER_SNAPSHOT_SECTIONS; ++i)
+        if (!m_sections[i])
+            return false;
+    return true;
+}
+
+uint32 PlayerSnapshot::GetRawSize() const
+{
+    uint32 size = 0;
+    for (uint32 i = 0; i < MAX_PLAYER_SNAPSHOT_SECTIONS; ++i)
+        size += PLAYER_SNAPSHOT_SECTION_HEADER_SIZE + (m_sections[i] ? m_sections[i]->wpos() : 0);
+    return size;
+}
+
+ByteBuffer& PlayerSnapshot::ModifySection(uint32 section)
+{
+    if (!m_sections[section])
+        m_sections[section] = std::make_shared<ByteBuffer>();
+    else if (m_sections[section].use_count() > 1)
+        m_sections[section] = std::make_shared<ByteBuffer>(*m_sections[section]);
+    return *m_sections[section];
+}
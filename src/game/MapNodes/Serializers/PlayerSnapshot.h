@@ -0,0 +1,87 @@
+#pragma once
+
+#include <memory>
+
+#include "Common.h"
+#include "ByteBuffer.h"
+
+class Player;
+
+#define PLAYER_SNAPSHOT_MAGIC       0x534E5050 // "PPNS"
+#define PLAYER_SNAPSHOT_VERSION     1
+#define PLAYER_SNAPSHOT_MAX_RAW_SIZE (4 * 1024 * 1024) // a player is a few dozens of KB
+
+enum PlayerSnapshotSection
+{
+    PLAYER_SNAPSHOT_FIELDS,
+    PLAYER_SNAPSHOT_SKILLS,
+    PLAYER_SNAPSHOT_AURAS,
+    PLAYER_SNAPSHOT_SPELLS,
+    PLAYER_SNAPSHOT_COOLDOWNS,
+    PLAYER_SNAPSHOT_INVENTORY,
+    PLAYER_SNAPSHOT_QUESTS,
+    PLAYER_SNAPSHOT_REPUTATION,
+    MAX_PLAYER_SNAPSHOT_SECTIONS
+};
+
+enum PlayerSnapshotFlags
+{
+    PLAYER_SNAPSHOT_FLAG_COMPRESSED = 0x1,
+};
+
+/**
+ * Binary image of a Player, used to transfer it between the Master and the Nodes.
+ *
+ * Format (all integers little endian):
+ *  header:  uint32 magic, uint16 version, uint16 flags, uint32 rawSize, uint32 payloadSize
+ *  payload: (zlib compressed if PLAYER_SNAPSHOT_FLAG_COMPRESSED) rawSize bytes of
+ *           MAX_PLAYER_SNAPSHOT_SECTIONS x { uint8 section, uint32 length, length bytes }
+ *
+ * Each section is the output of the corresponding Player::SerializeXXX function.
+ * The whole player is serialized by Capture: only the encoding (and compression)
+ * can be deferred, as it does not touch the Player anymore.
+ * Copying a snapshot shares its sections, ModifySection duplicates a shared one.
+ */
+class PlayerSnapshot
+{
+    public:
+        typedef std::shared_ptr<ByteBuffer> SectionPtr;
+
+        /**
+         * @brief Walks the player to fill all the sections. Has to be called
+         *  from the thread updating the player map.
+         */
+        void Capture(Player& player);
+        /**
+         * @brief Loads the sections into $player, in the order Player::Serialize
+         *  would read them. The player must have been prepared with Player::PrepareWakeUp.
+         * @return false if a section is corrupted.
+         */
+        bool Apply(Player& player);
+
+        /**
+         * @brief Writes the snapshot to $out. Does not touch the Player, safe from any thread.
+         * @param compress Compress the payload (only kept if smaller).
+         */
+        void Encode(ByteBuffer& out, bool compress) const;
+        /**
+         * @brief Reads a snapshot written by Encode from the read position of $in.
+         * @return false if the data is corrupted, or was written by another version.
+         */
+        bool Decode(ByteBuffer& in);
+
+        bool IsComplete() const;
+        uint32 GetRawSize() const;
+        ByteBuffer const* GetSection(uint32 section) const { return m_sections[section].get(); }
+        /**
+         * @brief Returns a writable section. The section is copied first if it
+         *  is shared with another snapshot.
+         */
+        ByteBuffer& ModifySection(uint32 section);
+
+    protected:
+        template <typename OP>
+        static void SerializeSection(Player& player, uint32 section, OP& buf);
+
+        SectionPtr m_sections[MAX_PLAYER_SNAPSHOT_SECTIONS];
+};
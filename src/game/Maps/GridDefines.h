@@ -141,6 +141,8 @@ struct MANGOS_DLL_DECL CoordPair
         return *this;
     }
 
+    uint32 GetId() const { return y_coord * LIMIT + x_coord; }
+
     uint32 x_coord;
     uint32 y_coord;
 };
@@ -28,13 +28,18 @@
 #include "Transport.h"
 #include "ObjectAccessor.h"
 #include "BattleGroundMgr.h"
+#include "MoveSpline.h"
 
 #include "MovementBroadcaster.h"
 #include "PlayerBroadcaster.h"
 #include "World.h"
 
+#include <chrono>
+
 using namespace MaNGOS;
 
+AllocationCounters GridSearchResultsCounters::s_allocations;
+
 void
 VisibleChangesNotifier::Visit(CameraMapType &m)
 {
@@ -202,10 +207,60 @@ template<class T> void
 ObjectUpdater::Visit(GridRefManager<T> &m)
 {
     for (typename GridRefManager<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
+        UpdateObject(iter->getSource(), IsIdle(iter->getSource()));
+}
+
+bool ObjectUpdater::IsIdle(Creature const* creature) const
+{
+    if (!i_skipUpdates || i_nearPlayers)
+        return false;
+
+    // Fights, movements, pets and scripts keep their timing
+    return !creature->isInCombat() && creature->movespline->Finalized() && !creature->isActiveObject() &&
+           !creature->GetCharmerOrOwnerGuid() && !creature->GetScriptId();
+}
+
+bool ObjectUpdater::IsIdle(GameObject const* go) const
+{
+    if (!i_skipUpdates || i_nearPlayers)
+        return false;
+
+    // Traps may be triggered by creatures
+    return go->GetGoType() != GAMEOBJECT_TYPE_TRAP && !go->GetOwnerGuid() && !go->isActiveObject() &&
+           !go->GetGOInfo()->ScriptId;
+}
+
+void ObjectUpdater::UpdateObject(WorldObject* obj, bool idle)
+{
+    ObjectUpdateTier tier = OBJECT_UPDATE_TIER_FULL;
+    if (idle)
     {
-        WorldObject::UpdateHelper helper(iter->getSource());
-        helper.UpdateRealTime(i_now, i_timeDiff);
+        // Spread idle objects updates over the ticks
+        if ((i_tick + obj->GetGUIDLow()) % (i_skipUpdates + 1))
+        {
+            obj->AddSkippedUpdateTime(i_timeDiff);
+            ++i_stats.objects[OBJECT_UPDATE_TIER_SKIPPED];
+            return;
+        }
+        tier = OBJECT_UPDATE_TIER_REDUCED;
     }
+
+    ++i_stats.objects[tier];
+
+    // Update time per tier is only measured when idle objects are tiered
+    if (!i_skipUpdates)
+    {
+        WorldObject::UpdateHelper helper(obj);
+        helper.UpdateRealTime(i_now, i_timeDiff + obj->GetSkippedUpdateTime());
+        obj->ResetSkippedUpdateTime();
+        return;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    WorldObject::UpdateHelper helper(obj);
+    helper.UpdateRealTime(i_now, i_timeDiff + obj->GetSkippedUpdateTime());
+    obj->ResetSkippedUpdateTime();
+    i_stats.timeUs[tier] += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
 }
 
 bool CannibalizeObjectCheck::operator()(Corpse* u)
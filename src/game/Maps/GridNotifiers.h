@@ -33,6 +33,8 @@
 #include "Player.h"
 #include "Unit.h"
 #include "CreatureAI.h"
+#include "Utilities/ObjectPool.h"
+#include "Utilities/SmallVector.h"
 
 class Player;
 //class Map;
@@ -47,11 +49,38 @@ namespace MaNGOS
         std::set<WorldObject*> i_visibleNow;
 
         explicit VisibleNotifier(Camera &c) : i_camera(c), i_clientGUIDs(c.GetOwner()->m_visibleGUIDs) {}
+        // Partial update: only the objects added to i_clientGUIDs are put out of range
+        VisibleNotifier(Camera &c, ObjectGuidSet const& outOfRange) : i_camera(c), i_clientGUIDs(outOfRange) {}
         template<class T> void Visit(GridRefManager<T> &m);
         void Visit(CameraMapType&) {}
+        void VisitUnit(Unit* unit);
         void Notify(void);
     };
 
+    // Updates the visibility of the stealthed or invisible units of the visited cells only:
+    // their detection depends on the distance to the viewer, even if they did not move
+    struct MANGOS_DLL_DECL HiddenUnitsVisibleNotifier
+    {
+        VisibleNotifier& i_notifier;
+
+        explicit HiddenUnitsVisibleNotifier(VisibleNotifier& notifier) : i_notifier(notifier) {}
+        void Visit(PlayerMapType &m) { VisitUnits(m); }
+        void Visit(CreatureMapType &m) { VisitUnits(m); }
+        template<class T> void VisitUnits(GridRefManager<T> &m);
+        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED> &) {}
+    };
+
+    // Collects the objects of the visited cells in the visible list of the player
+    struct MANGOS_DLL_DECL VisibleObjectsCollector
+    {
+        Player& i_player;
+        ObjectGuidSet& i_guids;
+
+        VisibleObjectsCollector(Player& player, ObjectGuidSet& guids) : i_player(player), i_guids(guids) {}
+        template<class T> void Visit(GridRefManager<T> &m);
+        void Visit(CameraMapType&) {}
+    };
+
     struct MANGOS_DLL_DECL VisibleChangesNotifier
     {
         WorldObject &i_object;
@@ -119,12 +148,22 @@ namespace MaNGOS
     {
         uint32 i_timeDiff;
         uint32 i_now;
-        explicit ObjectUpdater(const uint32 &diff, uint32 now) : i_timeDiff(diff), i_now(now) {}
+        uint32 i_skipUpdates;                               // idle objects are updated once every (i_skipUpdates + 1) ticks
+        uint32 i_tick;
+        bool i_nearPlayers;                                 // visited cell is near a player: no idle object
+        ObjectUpdateTierStats i_stats;
+        explicit ObjectUpdater(const uint32 &diff, uint32 now, uint32 skipUpdates = 0, uint32 tick = 0) :
+            i_timeDiff(diff), i_now(now), i_skipUpdates(skipUpdates), i_tick(tick), i_nearPlayers(true) {}
         template<class T> void Visit(GridRefManager<T> &m);
         void Visit(PlayerMapType &) {}
         void Visit(CorpseMapType &) {}
         void Visit(CameraMapType &) {}
         void Visit(CreatureMapType &);
+
+        bool IsIdle(Creature const* creature) const;
+        bool IsIdle(GameObject const* go) const;
+        bool IsIdle(WorldObject const* /*obj*/) const { return false; }
+        void UpdateObject(WorldObject* obj, bool idle);
     };
 
     struct MANGOS_DLL_DECL PlayerRelocationNotifier
@@ -348,14 +387,36 @@ namespace MaNGOS
         template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED> &) {}
     };
 
+    struct GridSearchResultsCounters
+    {
+        // allocations: hits, each one a std::list node with the list searchers
+        // heapAllocations: blocks allocated for searches with more hits than the inline capacity
+        // (the temporary buffer of a sort of such results is not counted)
+        static AllocationCounters s_allocations;
+    };
+
+    // Results of a list searcher, the first 32 hits are kept inline
+    template<class T>
+    class GridSearchResults : public SmallVector<T*, 32>
+    {
+        public:
+            ~GridSearchResults()
+            {
+                GridSearchResultsCounters::s_allocations.allocations += this->size();
+                GridSearchResultsCounters::s_allocations.frees += this->size();
+                for (size_t capacity = this->InlineCapacity; capacity < this->capacity(); capacity *= 2)
+                    ++GridSearchResultsCounters::s_allocations.heapAllocations;
+            }
+    };
+
     // All accepted by Check units if any
-    template<class Check>
+    template<class Check, class Container = std::list<Unit*> >
         struct MANGOS_DLL_DECL UnitListSearcher
     {
-        std::list<Unit*> &i_objects;
+        Container &i_objects;
         Check& i_check;
 
-        UnitListSearcher(std::list<Unit*> &objects, Check & check) : i_objects(objects),i_check(check) {}
+        UnitListSearcher(Container &objects, Check & check) : i_objects(objects),i_check(check) {}
 
         void Visit(PlayerMapType &m);
         void Visit(CreatureMapType &m);
@@ -392,13 +453,13 @@ namespace MaNGOS
         template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED> &) {}
     };
 
-    template<class Check>
+    template<class Check, class Container = std::list<Creature*> >
         struct MANGOS_DLL_DECL CreatureListSearcher
     {
-        std::list<Creature*> &i_objects;
+        Container &i_objects;
         Check& i_check;
 
-        CreatureListSearcher(std::list<Creature*> &objects, Check & check) : i_objects(objects),i_check(check) {}
+        CreatureListSearcher(Container &objects, Check & check) : i_objects(objects),i_check(check) {}
 
         void Visit(CreatureMapType &m);
 
@@ -44,16 +44,41 @@ inline void MaNGOS::VisibleNotifier::Visit(GridRefManager<T> &m)
     }
 }
 
+inline void MaNGOS::VisibleNotifier::VisitUnit(Unit* unit)
+{
+    if (Player* player = unit->ToPlayer())
+        i_camera.UpdateVisibilityOf(player, i_data, i_visibleNow);
+    else if (Creature* creature = unit->ToCreature())
+        i_camera.UpdateVisibilityOf(creature, i_data, i_visibleNow);
+    i_clientGUIDs.erase(unit->GetObjectGuid());
+}
+
+template<class T>
+inline void MaNGOS::HiddenUnitsVisibleNotifier::VisitUnits(GridRefManager<T> &m)
+{
+    for (typename GridRefManager<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
+    {
+        Unit* unit = iter->getSource();
+        if (unit->GetVisibility() != VISIBILITY_ON || unit->m_invisibilityMask)
+            i_notifier.VisitUnit(unit);
+    }
+}
+
+template<class T>
+inline void MaNGOS::VisibleObjectsCollector::Visit(GridRefManager<T> &m)
+{
+    for (typename GridRefManager<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
+        if (i_player.IsInVisibleList(iter->getSource()))
+            i_guids.insert(iter->getSource()->GetObjectGuid());
+}
+
 inline void MaNGOS::ObjectUpdater::Visit(CreatureMapType &m)
 {
     std::vector<Creature*> creaturesToUpdate;
     for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
         creaturesToUpdate.push_back(iter->getSource());
     for (std::vector<Creature*>::iterator it = creaturesToUpdate.begin(); it != creaturesToUpdate.end(); ++it)
-    {
-        WorldObject::UpdateHelper helper(*it);
-        helper.UpdateRealTime(i_now, i_timeDiff);
-    }
+        UpdateObject(*it, IsIdle(*it));
 }
 
 inline void CallAIMoveLOS(Creature* c, Unit* moving)
@@ -478,16 +503,16 @@ void MaNGOS::UnitLastSearcher<Check>::Visit(PlayerMapType &m)
     }
 }
 
-template<class Check>
-void MaNGOS::UnitListSearcher<Check>::Visit(PlayerMapType &m)
+template<class Check, class Container>
+void MaNGOS::UnitListSearcher<Check, Container>::Visit(PlayerMapType &m)
 {
     for(PlayerMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
         if (i_check(itr->getSource()))
             i_objects.push_back(itr->getSource());
 }
 
-template<class Check>
-void MaNGOS::UnitListSearcher<Check>::Visit(CreatureMapType &m)
+template<class Check, class Container>
+void MaNGOS::UnitListSearcher<Check, Container>::Visit(CreatureMapType &m)
 {
     for(CreatureMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
         if (i_check(itr->getSource()))
@@ -523,8 +548,8 @@ void MaNGOS::CreatureLastSearcher<Check>::Visit(CreatureMapType &m)
     }
 }
 
-template<class Check>
-void MaNGOS::CreatureListSearcher<Check>::Visit(CreatureMapType &m)
+template<class Check, class Container>
+void MaNGOS::CreatureListSearcher<Check, Container>::Visit(CreatureMapType &m)
 {
     for(CreatureMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
         if (i_check(itr->getSource()))
@@ -57,8 +57,7 @@ Map::~Map()
 {
     UnloadAll(true);
 
-    if (!m_scriptSchedule.empty())
-        sScriptMgr.DecreaseScheduledScriptCount(m_scriptSchedule.size());
+    ClearScriptSchedule();
 
     if (m_persistentState)
         m_persistentState->SetUsedByMapState(NULL);         // field pointer can be deleted after this
@@ -95,12 +94,21 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId)
       m_updateFinished(false), m_updateDiffMod(0), m_GridActivationDistance(DEFAULT_VISIBILITY_DISTANCE),
       _lastPlayersUpdate(WorldTimer::getMSTime()), _lastMapUpdate(WorldTimer::getMSTime()),
       _lastCellsUpdate(WorldTimer::getMSTime()), _inactivePlayersSkippedUpdates(0),
+      _cellsUpdateTick(0), _idleObjectsSkipUpdates(0),
       _objUpdatesThreads(0), _unitRelocationThreads(0), _lastPlayerLeftTime(0),
-      m_lastMvtSpellsUpdate(0)
+      m_lastMvtSpellsUpdate(0), m_scriptSubmissions(nullptr), m_scriptClock(0),
+      m_scriptLastMSTime(WorldTimer::getMSTime()), m_scriptScheduledCount(0),
+      _monsterMovePackets(0), _monsterMoveBytes(0), _updateCostUs(0)
 {
     m_CreatureGuids.Set(sObjectMgr.GetFirstTemporaryCreatureLowGuid());
     m_GameObjectGuids.Set(sObjectMgr.GetFirstTemporaryGameObjectLowGuid());
 
+    for (int i = 0; i < MAX_OBJECT_UPDATE_TIER; ++i)
+    {
+        _updateTierObjects[i] = 0;
+        _updateTierTimeUs[i] = 0;
+    }
+
     for (unsigned int j = 0; j < MAX_NUMBER_OF_GRIDS; ++j)
     {
         for (unsigned int idx = 0; idx < MAX_NUMBER_OF_GRIDS; ++idx)
@@ -578,7 +586,7 @@ inline void Map::UpdateCellsAroundObject(uint32 now, uint32 diff, WorldObject co
     if (!object || !object->IsInWorld() || !object->IsPositionValid())
         return;
 
-    MaNGOS::ObjectUpdater updater(diff, now);
+    MaNGOS::ObjectUpdater updater(diff, now, _idleObjectsSkipUpdates, _cellsUpdateTick);
     TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
     TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(updater);
 
@@ -598,11 +606,13 @@ inline void Map::UpdateCellsAroundObject(uint32 now, uint32 diff, WorldObject co
                 CellPair pair(x, y);
                 Cell cell(pair);
                 cell.SetNoCreate();
+                updater.i_nearPlayers = isCellNearPlayers(cell_id);
                 Visit(cell, grid_object_update);
                 Visit(cell, world_object_update);
             }
         }
     }
+    AddObjectUpdateTierStats(updater.i_stats);
 }
 
 inline void Map::MarkCellsAroundObject(WorldObject const* object)
@@ -622,48 +632,108 @@ inline void Map::MarkCellsAroundObject(WorldObject const* object)
     }
 }
 
+inline void Map::MarkCellsNearPlayers()
+{
+    for (std::vector<uint32>::const_iterator it = _nearPlayersCells.begin(); it != _nearPlayersCells.end(); ++it)
+        near_players_cells.reset(*it);
+    _nearPlayersCells.clear();
+
+    float nearDistance = float(sWorld.getConfig(CONFIG_UINT32_IDLE_OBJECTS_NEAR_DISTANCE));
+    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+    {
+        Player* plr = m_mapRefIter->getSource();
+        if (!plr || !plr->IsInWorld() || !plr->IsPositionValid())
+            continue;
+
+        CellArea area = Cell::CalculateCellArea(plr->GetPositionX(), plr->GetPositionY(), nearDistance);
+        for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+            for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+            {
+                uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
+                if (!near_players_cells.test(cell_id))
+                {
+                    near_players_cells.set(cell_id);
+                    _nearPlayersCells.push_back(cell_id);
+                }
+            }
+    }
+}
 
-inline void Map::UpdateActiveCellsCallback(uint32 diff, uint32 now, uint32 threadId, uint32 totalThreads, uint32 step)
+void Map::AddObjectUpdateTierStats(ObjectUpdateTierStats const& stats)
 {
-    MaNGOS::ObjectUpdater updater(diff, now);
-    TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
-    TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(updater);
+    for (int i = 0; i < MAX_OBJECT_UPDATE_TIER; ++i)
+    {
+        _updateTierObjects[i] += stats.objects[i];
+        _updateTierTimeUs[i] += stats.timeUs[i];
+    }
+}
+
+
+void Map::resetMarkedCells()
+{
+    for (std::vector<uint32>::const_iterator it = _activeCells.begin(); it != _activeCells.end(); ++it)
+        marked_cells.reset(*it);
+    _activeCells.clear();
+}
+
+void Map::markCell(uint32 pCellId)
+{
+    if (marked_cells.test(pCellId))
+        return;
+    marked_cells.set(pCellId);
+    _activeCells.push_back(pCellId);
+}
 
+inline void Map::SplitActiveCellsInStripes(uint32 totalThreads)
+{
+    // Rows of cells are grouped in stripes of MTCells.SafeDistance. Stripes are dispatched to the
+    // threads in turn, even stripes at step 0 and odd ones at step 1: two threads never update
+    // cells closer than the safe distance at the same time.
     int safeDistCells = sWorld.getConfig(CONFIG_UINT32_MTCELLS_SAFEDISTANCE) / SIZE_OF_GRID_CELL + 1;
     totalThreads *= 2;
-    threadId = 2 * threadId + step;
-    for (int y = 0; y < TOTAL_NUMBER_OF_CELLS_PER_MAP; ++y)
+    _activeCellsStripes.resize(totalThreads);
+    for (uint32 i = 0; i < totalThreads; ++i)
+        _activeCellsStripes[i].clear();
+
+    std::sort(_activeCells.begin(), _activeCells.end());
+    for (std::vector<uint32>::const_iterator it = _activeCells.begin(); it != _activeCells.end(); ++it)
     {
-        // Skip grids not for this thread
-        if ((y / safeDistCells) % totalThreads != threadId)
-            continue;
-        for (int x = 0; x < TOTAL_NUMBER_OF_CELLS_PER_MAP; ++x)
-        {
-            uint32 cellId = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-            if (!isCellMarked(cellId))
-                continue;
-            CellPair pair(x, y);
-            Cell cell(pair);
-            cell.SetNoCreate();
-            Visit(cell, grid_object_update);
-            Visit(cell, world_object_update);
-        }
+        uint32 y = *it / TOTAL_NUMBER_OF_CELLS_PER_MAP;
+        _activeCellsStripes[(y / safeDistCells) % totalThreads].push_back(*it);
+    }
+}
+
+inline void Map::UpdateActiveCellsCallback(uint32 diff, uint32 now, uint32 threadId, uint32 step)
+{
+    MaNGOS::ObjectUpdater updater(diff, now, _idleObjectsSkipUpdates, _cellsUpdateTick);
+    TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
+    TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(updater);
+
+    std::vector<uint32> const& cells = _activeCellsStripes[2 * threadId + step];
+    for (std::vector<uint32>::const_iterator it = cells.begin(); it != cells.end(); ++it)
+    {
+        CellPair pair(*it % TOTAL_NUMBER_OF_CELLS_PER_MAP, *it / TOTAL_NUMBER_OF_CELLS_PER_MAP);
+        Cell cell(pair);
+        cell.SetNoCreate();
+        updater.i_nearPlayers = isCellNearPlayers(*it);
+        Visit(cell, grid_object_update);
+        Visit(cell, world_object_update);
     }
+    AddObjectUpdateTierStats(updater.i_stats);
 }
 
 class MapAsynchCellsWorker : public ACE_Based::Runnable
 {
 public:
-    MapAsynchCellsWorker(int i, int nthreads, uint32 _diff, uint32 _now, uint32 _step, Map* m) : threadIdx(i), nThreads(nthreads), now(_now), diff(_diff), map(m), step(_step)
+    MapAsynchCellsWorker(int i, uint32 _diff, uint32 _now, uint32 _step, Map* m) : threadIdx(i), now(_now), diff(_diff), map(m), step(_step)
     {
     }
 
     virtual void run()
     {
-        map->UpdateActiveCellsCallback(diff, now, threadIdx, nThreads, step);
+        map->UpdateActiveCellsCallback(diff, now, threadIdx, step);
     }
     int threadIdx;
-    int nThreads;
     uint32 diff, now, step;
     Map* map;
 };
@@ -681,11 +751,12 @@ inline void Map::UpdateActiveCellsAsynch(uint32 now, uint32 diff)
         MarkCellsAroundObject(*m_activeNonPlayersIter);
 
     const int nthreads = sWorld.getConfig(CONFIG_UINT32_MTCELLS_THREADS);
+    SplitActiveCellsInStripes(nthreads);
     // Step 1
     std::vector<ACE_Based::Thread*> threads;
     for (int i = 0; i < (nthreads - 1); ++i)
-        threads.push_back(new ACE_Based::Thread(new MapAsynchCellsWorker(i, nthreads, diff, now, 0, this)));
-    UpdateActiveCellsCallback(diff, now, nthreads-1, nthreads, 0);
+        threads.push_back(new ACE_Based::Thread(new MapAsynchCellsWorker(i, diff, now, 0, this)));
+    UpdateActiveCellsCallback(diff, now, nthreads-1, 0);
     for (int i = 0; i < threads.size(); ++i)
     {
         threads[i]->wait();
@@ -694,8 +765,8 @@ inline void Map::UpdateActiveCellsAsynch(uint32 now, uint32 diff)
     // Step 2
     threads.clear();
     for (int i = 0; i < (nthreads - 1); ++i)
-        threads.push_back(new ACE_Based::Thread(new MapAsynchCellsWorker(i, nthreads, diff, now, 1, this)));
-    UpdateActiveCellsCallback(diff, now, nthreads-1, nthreads, 1);
+        threads.push_back(new ACE_Based::Thread(new MapAsynchCellsWorker(i, diff, now, 1, this)));
+    UpdateActiveCellsCallback(diff, now, nthreads-1, 1);
     for (int i = 0; i < threads.size(); ++i)
     {
         threads[i]->wait();
@@ -756,6 +827,18 @@ inline void Map::UpdateCells(uint32 map_diff)
         return;
     _lastCellsUpdate = now;
 
+    for (int i = 0; i < MAX_OBJECT_UPDATE_TIER; ++i)
+    {
+        _updateTierObjects[i] = 0;
+        _updateTierTimeUs[i] = 0;
+    }
+
+    /// idle objects far from players are updated less often
+    ++_cellsUpdateTick;
+    _idleObjectsSkipUpdates = IsContinent() ? sWorld.getConfig(CONFIG_UINT32_IDLE_OBJECTS_SKIP_UPDATES) : 0;
+    if (_idleObjectsSkipUpdates)
+        MarkCellsNearPlayers();
+
     /// update active cells around players and active objects
     if (IsContinent() && sWorld.getConfig(CONFIG_UINT32_MTCELLS_THREADS))
         UpdateActiveCellsAsynch(now, diff);
@@ -902,13 +985,9 @@ void Map::Update(uint32 t_diff)
     if (_updateIdx >= 0)
     {
         additionnalWaitTime = WorldTimer::getMSTime();
-        sMapMgr.MarkContinentUpdateFinished(_updateIdx);
-        while (!sMapMgr.IsContinentUpdateFinished())
+        sMapMgr.MarkContinentUpdateFinished();
+        while (!sMapMgr.WaitContinentsUpdateFinished(10))
         {
-            ACE_Based::Thread::Sleep(10);
-            if (sMapMgr.IsContinentUpdateFinished())
-                break;
-
             UpdateSessionsMovementAndSpellsIfNeeded();
             UpdatePlayers();
             ++additionnalUpdateCounts;
@@ -935,6 +1014,9 @@ void Map::Update(uint32 t_diff)
     if (i_data)
         i_data->Update(t_diff);
 
+    if (m_persistentState)
+        m_persistentState->UpdateRespawnTimesFlush(t_diff);
+
     bool packetBroadcastSlow = sWorld.GetBroadcaster()->IsMapSlow(GetInstanceId());
     if (sWorld.getConfig(CONFIG_UINT32_PERFLOG_SLOW_MAP_UPDATE) && updateMapTime > sWorld.getConfig(CONFIG_UINT32_PERFLOG_SLOW_MAP_UPDATE))
         sLog.out(LOG_PERFORMANCE, "Update single map %3u inst %2u: %3ums "
@@ -944,6 +1026,12 @@ void Map::Update(uint32 t_diff)
                  sessionsUpdateTime, playersUpdateTime, activeCellsUpdateTime, objectsUpdateTime,
                  visibilityUpdateTime, playersUpdateTime2, additionnalUpdateCounts, additionnalWaitTime,
                 packetBroadcastSlow ? "SLOWBCAST" : "");
+    if (_idleObjectsSkipUpdates && sWorld.getConfig(CONFIG_UINT32_PERFLOG_SLOW_MAP_UPDATE) && updateMapTime > sWorld.getConfig(CONFIG_UINT32_PERFLOG_SLOW_MAP_UPDATE))
+        sLog.out(LOG_PERFORMANCE, "Update single map %3u inst %2u: cells objects full %u (%ums) reduced %u (%ums) skipped %u",
+            GetId(), GetInstanceId(),
+            _updateTierObjects[OBJECT_UPDATE_TIER_FULL].load(), uint32(_updateTierTimeUs[OBJECT_UPDATE_TIER_FULL].load() / 1000),
+            _updateTierObjects[OBJECT_UPDATE_TIER_REDUCED].load(), uint32(_updateTierTimeUs[OBJECT_UPDATE_TIER_REDUCED].load() / 1000),
+            _updateTierObjects[OBJECT_UPDATE_TIER_SKIPPED].load());
     // Continent only
     if (IsContinent())
     {
@@ -2166,8 +2254,6 @@ void Map::ScriptsStart(ScriptMapMap const& scripts, uint32 id, Object* source, O
 
     ///- Schedule script execution for all scripts in the script map
     ScriptMap const *s2 = &(s->second);
-    bool immedScript = false;
-    m_scriptSchedule_lock.acquire();
     for (ScriptMap::const_iterator iter = s2->begin(); iter != s2->end(); ++iter)
     {
         ScriptAction sa;
@@ -2176,13 +2262,8 @@ void Map::ScriptsStart(ScriptMapMap const& scripts, uint32 id, Object* source, O
         sa.ownerGuid  = ownerGuid;
 
         sa.script = &iter->second;
-        m_scriptSchedule.insert(ScriptScheduleMap::value_type(time_t(sWorld.GetGameTime() + iter->first), sa));
-        if (iter->first == 0)
-            immedScript = true;
-
-        sScriptMgr.IncreaseScheduledScriptsCount();
+        ScheduleScript(sa, iter->first * IN_MILLISECONDS);
     }
-    m_scriptSchedule_lock.release();
 }
 
 void Map::ScriptCommandStart(ScriptInfo const& script, uint32 delay, Object* source, Object* target)
@@ -2200,29 +2281,186 @@ void Map::ScriptCommandStart(ScriptInfo const& script, uint32 delay, Object* sou
     sa.ownerGuid  = ownerGuid;
 
     sa.script = &script;
-    m_scriptSchedule_lock.acquire();
-    m_scriptSchedule.insert(ScriptScheduleMap::value_type(time_t(sWorld.GetGameTime() + delay), sa));
+    ScheduleScript(sa, delay * IN_MILLISECONDS);
+}
+
+/// Can be called from any thread: the map thread picks the script up in FetchScriptSubmissions
+void Map::ScheduleScript(ScriptAction const& action, uint32 delay)
+{
+    ScriptSubmission* submission = new ScriptSubmission;
+    submission->action = action;
+    submission->delay = delay;
+    submission->next = m_scriptSubmissions.load(std::memory_order_relaxed);
+    while (!m_scriptSubmissions.compare_exchange_weak(submission->next, submission, std::memory_order_release, std::memory_order_relaxed))
+        ;
+
     sScriptMgr.IncreaseScheduledScriptsCount();
-    m_scriptSchedule_lock.release();
+}
+
+/// Move submitted scripts into the timer wheel (map thread only)
+void Map::FetchScriptSubmissions()
+{
+    ScriptSubmission* submissions = m_scriptSubmissions.exchange(nullptr, std::memory_order_acquire);
+
+    // Restore submission order, so that steps with the same delay are executed in order
+    ScriptSubmission* ordered = nullptr;
+    while (submissions)
+    {
+        ScriptSubmission* next = submissions->next;
+        submissions->next = ordered;
+        ordered = submissions;
+        submissions = next;
+    }
+
+    uint64 wheelEnd = m_scriptClock + (SCRIPT_WHEEL_SLOTS - 1) * SCRIPT_WHEEL_SLOT_MS;
+    while (ordered)
+    {
+        ScriptSubmission* submission = ordered;
+        ordered = ordered->next;
+
+        uint64 dueTime = m_scriptClock + submission->delay;
+        if (dueTime < wheelEnd)
+        {
+            ScriptTimer timer;
+            timer.dueTime = dueTime;
+            timer.action = submission->action;
+            m_scriptWheel[(dueTime / SCRIPT_WHEEL_SLOT_MS) % SCRIPT_WHEEL_SLOTS].push_back(timer);
+        }
+        else
+            m_scriptFarSchedule.insert(ScriptScheduleMap::value_type(dueTime, submission->action));
+
+        ++m_scriptScheduledCount;
+        delete submission;
+    }
+}
+
+/// Move scripts due in the wheel slots from fromTime to now into the execution queue
+void Map::CollectDueScripts(uint64 fromTime)
+{
+    uint64 tick = fromTime / SCRIPT_WHEEL_SLOT_MS;
+    uint64 lastTick = m_scriptClock / SCRIPT_WHEEL_SLOT_MS;
+    if (lastTick - tick >= SCRIPT_WHEEL_SLOTS)
+        tick = lastTick - SCRIPT_WHEEL_SLOTS + 1;
+
+    ScriptTimerList due;
+    for (; tick <= lastTick; ++tick)
+    {
+        ScriptTimerList& slot = m_scriptWheel[tick % SCRIPT_WHEEL_SLOTS];
+        size_t kept = 0;
+        for (size_t i = 0; i < slot.size(); ++i)
+        {
+            if (slot[i].dueTime <= m_scriptClock)
+                due.push_back(slot[i]);
+            else
+                slot[kept++] = slot[i];
+        }
+        slot.resize(kept);
+    }
+
+    std::stable_sort(due.begin(), due.end());
+    for (ScriptTimerList::const_iterator itr = due.begin(); itr != due.end(); ++itr)
+        m_scriptDue.push_back(itr->action);
+}
+
+/// Remove all pending steps of the script, used by terminate commands
+void Map::TerminateScript(ScriptAction const& action)
+{
+    uint32 id = action.script->id;
+    ObjectGuid sourceGuid = action.sourceGuid;
+    ObjectGuid targetGuid = action.targetGuid;
+    ObjectGuid ownerGuid = action.ownerGuid;
+
+    FetchScriptSubmissions();
+
+    uint32 removed = 0;
+    for (std::deque<ScriptAction>::iterator itr = m_scriptDue.begin(); itr != m_scriptDue.end();)
+    {
+        if (itr->IsSameScript(id, sourceGuid, targetGuid, ownerGuid))
+        {
+            itr = m_scriptDue.erase(itr);
+            ++removed;
+        }
+        else
+            ++itr;
+    }
+
+    for (uint32 i = 0; i < SCRIPT_WHEEL_SLOTS; ++i)
+    {
+        ScriptTimerList& slot = m_scriptWheel[i];
+        size_t kept = 0;
+        for (size_t j = 0; j < slot.size(); ++j)
+        {
+            if (slot[j].action.IsSameScript(id, sourceGuid, targetGuid, ownerGuid))
+                ++removed;
+            else
+                slot[kept++] = slot[j];
+        }
+        slot.resize(kept);
+    }
+
+    for (ScriptScheduleMap::iterator itr = m_scriptFarSchedule.begin(); itr != m_scriptFarSchedule.end();)
+    {
+        if (itr->second.IsSameScript(id, sourceGuid, targetGuid, ownerGuid))
+        {
+            m_scriptFarSchedule.erase(itr++);
+            ++removed;
+        }
+        else
+            ++itr;
+    }
+
+    if (removed)
+    {
+        m_scriptScheduledCount -= removed;
+        sScriptMgr.DecreaseScheduledScriptCount(removed);
+    }
+}
+
+void Map::ClearScriptSchedule()
+{
+    FetchScriptSubmissions();
+
+    if (m_scriptScheduledCount)
+        sScriptMgr.DecreaseScheduledScriptCount(m_scriptScheduledCount);
+
+    m_scriptScheduledCount = 0;
+    m_scriptDue.clear();
+    m_scriptFarSchedule.clear();
+    for (uint32 i = 0; i < SCRIPT_WHEEL_SLOTS; ++i)
+        m_scriptWheel[i].clear();
 }
 
 /// Process queued scripts
 void Map::ScriptsProcess()
 {
-    m_scriptSchedule_lock.acquire();
-    if (m_scriptSchedule.empty())
+    uint32 beginTime = WorldTimer::getMSTime();
+    uint64 previousClock = m_scriptClock;
+    m_scriptClock += WorldTimer::getMSTimeDiff(m_scriptLastMSTime, beginTime);
+    m_scriptLastMSTime = beginTime;
+
+    ///- Far scripts entering the wheel span
+    uint64 wheelEnd = m_scriptClock + (SCRIPT_WHEEL_SLOTS - 1) * SCRIPT_WHEEL_SLOT_MS;
+    while (!m_scriptFarSchedule.empty() && m_scriptFarSchedule.begin()->first < wheelEnd)
     {
-        m_scriptSchedule_lock.release();
-        return;
+        ScriptTimer timer;
+        timer.dueTime = m_scriptFarSchedule.begin()->first;
+        timer.action = m_scriptFarSchedule.begin()->second;
+        m_scriptWheel[(timer.dueTime / SCRIPT_WHEEL_SLOT_MS) % SCRIPT_WHEEL_SLOTS].push_back(timer);
+        m_scriptFarSchedule.erase(m_scriptFarSchedule.begin());
     }
 
+    FetchScriptSubmissions();
+    if (!m_scriptScheduledCount)
+        return;
+
+    CollectDueScripts(previousClock);
+
     ///- Process overdue queued scripts
-    ScriptScheduleMap::iterator iter = m_scriptSchedule.begin();
-    // ok as multimap is a *sorted* associative container
-    while (!m_scriptSchedule.empty() && (iter->first <= sWorld.GetGameTime()))
+    uint32 processedCount = 0;
+    while (!m_scriptDue.empty())
     {
-        ScriptAction step = iter->second;
-        m_scriptSchedule_lock.release();
+        ScriptAction step = m_scriptDue.front();
+        m_scriptDue.pop_front();
 
         Object* source = NULL;
 
@@ -3688,27 +3926,7 @@ void Map::ScriptsProcess()
                     result = true;
 
                 if (result) // Terminate further steps of this script
-                {
-                    uint32 id = iter->second.script->id;
-                    ObjectGuid sourceGuid = iter->second.sourceGuid;
-                    ObjectGuid targetGuid = iter->second.targetGuid;
-                    ObjectGuid ownerGuid = iter->second.ownerGuid;
-
-                    for (ScriptScheduleMap::iterator rmItr = m_scriptSchedule.begin(); rmItr != m_scriptSchedule.end();)
-                    {
-                        if (rmItr->second.IsSameScript(id, sourceGuid, targetGuid, ownerGuid))
-                        {
-                            m_scriptSchedule.erase(rmItr++);
-                            sScriptMgr.DecreaseScheduledScriptCount();
-                        }
-                        else
-                        {
-                            ++rmItr;
-                        }
-                    }
-                    iter = m_scriptSchedule.begin();
-                    continue;
-                }
+                    TerminateScript(step);
 
                 break;
             }
@@ -3797,27 +4015,7 @@ void Map::ScriptsProcess()
                     player->GroupEventFailHappens(step.script->terminateCond.failQuest);
                 }
                 if (terminateResult) // Terminate further steps of this script
-                {
-                    uint32 id = iter->second.script->id;
-                    ObjectGuid sourceGuid = iter->second.sourceGuid;
-                    ObjectGuid targetGuid = iter->second.targetGuid;
-                    ObjectGuid ownerGuid = iter->second.ownerGuid;
-
-                    for (ScriptScheduleMap::iterator rmItr = m_scriptSchedule.begin(); rmItr != m_scriptSchedule.end();)
-                    {
-                        if (rmItr->second.IsSameScript(id, sourceGuid, targetGuid, ownerGuid))
-                        {
-                            m_scriptSchedule.erase(rmItr++);
-                            sScriptMgr.DecreaseScheduledScriptCount();
-                        }
-                        else
-                        {
-                            ++rmItr;
-                        }
-                    }
-                    iter = m_scriptSchedule.begin();
-                    continue;
-                }
+                    TerminateScript(step);
 
                 break;
             }
@@ -3988,15 +4186,22 @@ void Map::ScriptsProcess()
                 break;
         }
 
-        m_scriptSchedule_lock.acquire();
-        iter = m_scriptSchedule.begin();
-        if (iter->second.script == step.script)
-            m_scriptSchedule.erase(iter);
-        iter = m_scriptSchedule.begin();
-
+        --m_scriptScheduledCount;
         sScriptMgr.DecreaseScheduledScriptCount();
+        ++processedCount;
+
+        // Scripts started by this step without delay are run in the same pass
+        if (m_scriptSubmissions.load(std::memory_order_relaxed))
+        {
+            FetchScriptSubmissions();
+            CollectDueScripts(m_scriptClock);
+        }
     }
-    m_scriptSchedule_lock.release();
+
+    beginTime = WorldTimer::getMSTimeDiffToNow(beginTime);
+    if (sWorld.getConfig(CONFIG_UINT32_PERFLOG_SLOW_MAP_SCRIPTS) && beginTime > sWorld.getConfig(CONFIG_UINT32_PERFLOG_SLOW_MAP_SCRIPTS))
+        sLog.out(LOG_PERFORMANCE, "Map %u inst %u: %3ums to process %u scripts (%u scheduled, %u far)",
+            GetId(), GetInstanceId(), beginTime, processedCount, m_scriptScheduledCount, uint32(m_scriptFarSchedule.size()));
 }
 
 /**
@@ -4270,6 +4475,11 @@ void Map::UpdateVisibilityForRelocations()
         return;
     _processingUnitsRelocation = true;
 
+    // Cameras in the unchanged part of their view only update these units (see Camera::UpdateVisibilityAfterMove)
+    i_unitsRelocatedByCell.clear();
+    for (std::set<Unit*>::const_iterator itr = i_unitsRelocated.begin(); itr != i_unitsRelocated.end(); ++itr)
+        i_unitsRelocatedByCell[MaNGOS::ComputeCellPair((*itr)->GetPositionX(), (*itr)->GetPositionY()).GetId()].push_back(*itr);
+
     // Compute number of threads to spawn
     uint32 threads = 1;
     if (IsContinent())
@@ -4325,6 +4535,7 @@ void Map::UpdateVisibilityForRelocations()
         --_unitRelocationThreads;
 
     _processingUnitsRelocation = false;
+    i_unitsRelocatedByCell.clear();
     delete[] updaters;
     delete[] visUpdaters;
 
@@ -4732,8 +4943,7 @@ void Map::CrashUnload()
     }
     //UnloadAll(true);
 
-    if (!m_scriptSchedule.empty())
-        sScriptMgr.DecreaseScheduledScriptCount(m_scriptSchedule.size());
+    ClearScriptSchedule();
 
     if (m_persistentState)
     {
@@ -4779,6 +4989,11 @@ void Map::PrintInfos(ChatHandler& handler)
     handler.PSendSysMessage("%u non player active", m_activeNonPlayers.size());
     handler.PSendSysMessage("%u objects to client update [%u threads]", i_objectsToClientUpdate.size(), _objUpdatesThreads);
     handler.PSendSysMessage("%u objects relocated [%u threads]", i_unitsRelocated.size(), _unitRelocationThreads);
-    handler.PSendSysMessage("%u scripts scheduled", m_scriptSchedule.size());
+    handler.PSendSysMessage("%u scripts scheduled (%u far)", m_scriptScheduledCount, uint32(m_scriptFarSchedule.size()));
+    handler.PSendSysMessage("%u monster move packets (%u KB)", _monsterMovePackets.load(), uint32(_monsterMoveBytes.load() / 1024));
+    handler.PSendSysMessage("Cells objects: %u full (%uus) %u reduced (%uus) %u skipped [1/%u]",
+        _updateTierObjects[OBJECT_UPDATE_TIER_FULL].load(), uint32(_updateTierTimeUs[OBJECT_UPDATE_TIER_FULL].load()),
+        _updateTierObjects[OBJECT_UPDATE_TIER_REDUCED].load(), uint32(_updateTierTimeUs[OBJECT_UPDATE_TIER_REDUCED].load()),
+        _updateTierObjects[OBJECT_UPDATE_TIER_SKIPPED].load(), _idleObjectsSkipUpdates + 1);
     handler.PSendSysMessage("Vis:%.1f Act:%.1f", m_VisibleDistance, m_GridActivationDistance);
 }
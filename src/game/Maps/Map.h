@@ -45,9 +45,12 @@
 #include "SQLStorages.h"
 #include "CreatureLinkingMgr.h"
 
+#include <atomic>
 #include <bitset>
+#include <deque>
 #include <list>
 #include <set>
+#include <unordered_map>
 
 using Movement::Vector3;
 
@@ -188,9 +191,38 @@ struct AreaLocale
 typedef std::map<uint32, CreatureGroup*> CreatureGroupHolderType;
 typedef ACE_Thread_Mutex MapMutexType; // Use ACE_Null_Mutex to disable locks
 
+// Timed db-scripts timer wheel: 512 slots of 8ms, scripts due later wait in a sorted far queue
+#define SCRIPT_WHEEL_SLOTS      512
+#define SCRIPT_WHEEL_SLOT_MS    8
+
 // Instance IDs reserved for internal use (instanced continent parts, ...)
 #define RESERVED_INSTANCES_LAST 100
 
+// Creatures / gameobjects update frequency in active cells (c.f. Continents.IdleObjects.SkipUpdates)
+enum ObjectUpdateTier
+{
+    OBJECT_UPDATE_TIER_FULL     = 0,                        // updated at every cells update
+    OBJECT_UPDATE_TIER_REDUCED  = 1,                        // idle and far from players, updated with the accumulated time
+    OBJECT_UPDATE_TIER_SKIPPED  = 2,                        // idle object waiting for its next update
+};
+
+#define MAX_OBJECT_UPDATE_TIER  3
+
+struct ObjectUpdateTierStats
+{
+    ObjectUpdateTierStats()
+    {
+        for (int i = 0; i < MAX_OBJECT_UPDATE_TIER; ++i)
+        {
+            objects[i] = 0;
+            timeUs[i] = 0;
+        }
+    }
+
+    uint32 objects[MAX_OBJECT_UPDATE_TIER];
+    uint64 timeUs[MAX_OBJECT_UPDATE_TIER];
+};
+
 class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::ObjectLevelLockable<Map, ACE_Thread_Mutex>
 {
     friend class MapReference;
@@ -224,8 +256,10 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
         inline void UpdateCellsAroundObject(uint32 now, uint32 diff, WorldObject const* object);
         inline void UpdateActiveCellsSynch(uint32 now, uint32 diff);
         inline void MarkCellsAroundObject(WorldObject const* object);
+        inline void MarkCellsNearPlayers();
         inline void UpdateActiveCellsAsynch(uint32 now, uint32 diff);
-        inline void UpdateActiveCellsCallback(uint32 diff, uint32 now, uint32 threadId, uint32 totalThreads, uint32 step);
+        inline void SplitActiveCellsInStripes(uint32 totalThreads);
+        inline void UpdateActiveCellsCallback(uint32 diff, uint32 now, uint32 threadId, uint32 step);
         inline void UpdateCells(uint32 diff);
         void UpdateSync(const uint32);
         void UpdatePlayers();
@@ -310,9 +344,11 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
         void UpdateActiveObjectVisibility(Player *player, ObjectGuidSet &visibleGuids);
         void UpdateActiveObjectVisibility(Player *player, ObjectGuidSet &visibleGuids, UpdateData &data, std::set<WorldObject*> &visibleNow);
 
-        void resetMarkedCells() { marked_cells.reset(); }
+        void resetMarkedCells();
         bool isCellMarked(uint32 pCellId) { return marked_cells.test(pCellId); }
-        void markCell(uint32 pCellId) { marked_cells.set(pCellId); }
+        void markCell(uint32 pCellId);
+        bool isCellNearPlayers(uint32 pCellId) const { return !_idleObjectsSkipUpdates || near_players_cells.test(pCellId); }
+        void AddObjectUpdateTierStats(ObjectUpdateTierStats const& stats);
 
         bool HavePlayers() const { return !m_mapRefManager.isEmpty(); }
         uint32 GetPlayersCountExceptGMs() const;
@@ -396,6 +432,16 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
             i_unitsRelocated.erase(obj);
             i_unitsRelocated_lock.release();
         }
+        // Units of the cell whose relocation is being processed, NULL if none.
+        // Only available during UpdateVisibilityForRelocations.
+        std::vector<Unit*> const* GetRelocatedUnitsInCell(CellPair const& cell) const
+        {
+            if (!_processingUnitsRelocation)
+                return nullptr;
+            std::unordered_map<uint32, std::vector<Unit*> >::const_iterator itr = i_unitsRelocatedByCell.find(cell.GetId());
+            return itr != i_unitsRelocatedByCell.end() ? &itr->second : nullptr;
+        }
+        bool IsProcessingUnitsRelocation() const { return _processingUnitsRelocation; }
 
         void AddUnitToMovementUpdate(Unit* unit)
         {
@@ -490,6 +536,9 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
         void TeleportAllPlayersToHomeBind();
 
         void SetMapUpdateIndex(int idx) { _updateIdx = idx; }
+        // Smoothed duration of an update of this instance, in microseconds (see MapManager::Update)
+        void RecordUpdateCost(uint32 us) { _updateCostUs = _updateCostUs ? uint32((uint64(_updateCostUs) * 3 + us) / 4) : us; }
+        uint32 GetUpdateCost() const { return _updateCostUs; }
 
         // Get Holder for Creature Linking
         CreatureLinkingHolder* GetCreatureLinkingHolder() { return &m_creatureLinkingHolder; }
@@ -528,6 +577,11 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
 
         void setNGrid(NGridType* grid, uint32 x, uint32 y);
         void ScriptsProcess();
+        void ScheduleScript(ScriptAction const& action, uint32 delay);
+        void FetchScriptSubmissions();
+        void CollectDueScripts(uint64 fromTime);
+        void TerminateScript(ScriptAction const& action);
+        void ClearScriptSchedule();
 
         void SendObjectUpdates();
         void UpdateVisibilityForRelocations();
@@ -541,6 +595,7 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
         uint32                  _unitRelocationThreads;
         mutable MapMutexType    i_unitsRelocated_lock;
         std::set<Unit* >        i_unitsRelocated;
+        std::unordered_map<uint32 /*cell id*/, std::vector<Unit*> > i_unitsRelocatedByCell;
 
         mutable MapMutexType    unitsMvtUpdate_lock;
         std::set<Unit*>         unitsMvtUpdate;
@@ -588,13 +643,40 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
         bool m_bLoadedGrids[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
 
         std::bitset<TOTAL_NUMBER_OF_CELLS_PER_MAP*TOTAL_NUMBER_OF_CELLS_PER_MAP> marked_cells;
+        std::vector<uint32> _activeCells;                   // ids of the marked cells
+        std::vector<std::vector<uint32> > _activeCellsStripes; // marked cells ids per cells update thread and step
+        // Cells within Continents.IdleObjects.NearDistance of a player, only filled when idle objects updates are reduced
+        std::bitset<TOTAL_NUMBER_OF_CELLS_PER_MAP*TOTAL_NUMBER_OF_CELLS_PER_MAP> near_players_cells;
+        std::vector<uint32> _nearPlayersCells;
 
         mutable MapMutexType    i_objectsToRemove_lock;
         std::set<WorldObject *> i_objectsToRemove;
 
-        typedef std::multimap<time_t, ScriptAction> ScriptScheduleMap;
-        MapMutexType      m_scriptSchedule_lock;
-        ScriptScheduleMap m_scriptSchedule;
+        // Scripts may be started from any thread (cell updates): they are pushed on a lock-free
+        // list and moved into the timer wheel by the map thread at the next ScriptsProcess.
+        struct ScriptSubmission
+        {
+            ScriptAction action;
+            uint32 delay;                                   // in ms
+            ScriptSubmission* next;
+        };
+        struct ScriptTimer
+        {
+            uint64 dueTime;
+            ScriptAction action;
+
+            bool operator<(ScriptTimer const& other) const { return dueTime < other.dueTime; }
+        };
+        typedef std::vector<ScriptTimer> ScriptTimerList;
+        typedef std::multimap<uint64, ScriptAction> ScriptScheduleMap;
+
+        std::atomic<ScriptSubmission*> m_scriptSubmissions;
+        uint64 m_scriptClock;                               // map script time in ms
+        uint32 m_scriptLastMSTime;
+        ScriptTimerList m_scriptWheel[SCRIPT_WHEEL_SLOTS];
+        ScriptScheduleMap m_scriptFarSchedule;              // scripts due after the wheel span
+        std::deque<ScriptAction> m_scriptDue;
+        uint32 m_scriptScheduledCount;
 
         InstanceData* i_data;
         uint32 i_script_id;
@@ -618,8 +700,15 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
         uint32 _lastPlayersUpdate;
         uint32 _inactivePlayersSkippedUpdates;
         uint32 _lastCellsUpdate;
+        uint32 _cellsUpdateTick;
+        uint32 _idleObjectsSkipUpdates;                     // for the current cells update, 0 if all objects are updated
+        std::atomic<uint32> _updateTierObjects[MAX_OBJECT_UPDATE_TIER];
+        std::atomic<uint64> _updateTierTimeUs[MAX_OBJECT_UPDATE_TIER];
+        std::atomic<uint32> _monsterMovePackets;
+        std::atomic<uint64> _monsterMoveBytes;
 
         int8 _updateIdx;
+        uint32 _updateCostUs;
 
         // Holder for information about linked mobs
         CreatureLinkingHolder m_creatureLinkingHolder;
@@ -627,6 +716,8 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
     public:
         CreatureGroupHolderType CreatureGroupHolder;
         uint32 GetLastPlayerLeftTime() const { return _lastPlayerLeftTime; }
+        // Spline packets (SMSG_MONSTER_MOVE*) built for units on this map, may be called from cell threads
+        void AddMonsterMovePacket(uint32 bytes) { ++_monsterMovePackets; _monsterMoveBytes += bytes; }
 };
 
 class MANGOS_DLL_SPEC WorldMap : public Map
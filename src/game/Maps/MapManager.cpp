@@ -31,6 +31,11 @@
 #include "ObjectMgr.h"
 #include "ZoneScriptMgr.h"
 #include "Map.h"
+#include "Config/Config.h"
+
+#include <chrono>
+#include <deque>
+#include <sstream>
 
 typedef MaNGOS::ClassLevelLockable<MapManager, ACE_Recursive_Thread_Mutex> MapManagerLock;
 INSTANTIATE_SINGLETON_2(MapManager, MapManagerLock);
@@ -40,8 +45,7 @@ MapManager::MapManager()
     : i_gridCleanUpDelay(sWorld.getConfig(CONFIG_UINT32_INTERVAL_GRIDCLEAN)),
     i_MaxInstanceId(RESERVED_INSTANCES_LAST),
     i_GridStateErrorCount(0),
-    i_continentUpdateFinished(NULL),
-    i_maxContinentThread(0)
+    i_continentsUpdating(0)
 {
     i_timer.SetInterval(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE));
 }
@@ -72,6 +76,25 @@ MapManager::Initialize()
         terrain->AddRef(); // So it won't be deleted
         terrain->LoadAll();
     }
+
+    std::istringstream poolMaps(sConfig.GetStringDefault("Instance.PoolMaps", ""));
+    uint32 poolMapId;
+    while (poolMaps >> poolMapId)
+    {
+        MapEntry const* entry = sMapStorage.LookupEntry<MapEntry>(poolMapId);
+        if (!entry || !entry->Instanceable())
+        {
+            sLog.outError("Instance.PoolMaps: map %u is not an instanceable map, ignored.", poolMapId);
+            continue;
+        }
+        // Raid maps are reset weekly, an instance waiting in the pool would not be
+        if (entry->IsRaid())
+        {
+            sLog.outError("Instance.PoolMaps: map %u is a raid map, ignored.", poolMapId);
+            continue;
+        }
+        i_instancePoolMapIds.push_back(poolMapId);
+    }
 }
 
 void MapManager::InitStateMachine()
@@ -154,7 +177,12 @@ Map* MapManager::CreateBgMap(uint32 mapid, BattleGround* bg)
     sTerrainMgr.LoadTerrain(mapid);
 
     Guard _guard(*this);
-    return CreateBattleGroundMap(mapid, sMapMgr.GenerateInstanceId(), bg);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    BattleGroundMap* map = static_cast<BattleGroundMap*>(TakePooledInstance(mapid));
+    bool pooled = map != NULL;
+    map = CreateBattleGroundMap(mapid, pooled ? map->GetInstanceId() : sMapMgr.GenerateInstanceId(), bg, map);
+    RecordInstanceCreation(map, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count(), pooled);
+    return map;
 }
 
 Map* MapManager::FindMap(uint32 mapid, uint32 instanceId) const
@@ -238,36 +266,117 @@ void MapManager::DeleteInstance(uint32 mapid, uint32 instanceId)
     }
 }
 
+// Instances left to update during one MapManager::Update. Maps are queued most
+// expensive first and taken by the first idle thread, so that the heaviest raids
+// start first and end up on different threads. While the continents are still
+// updating, the instances already updated are queued again for another update.
+class InstanceUpdateQueue
+{
+public:
+    InstanceUpdateQueue() : finished(false), repeatUpdates(0) {}
+
+    void Push(Map* map)
+    {
+        queue.push_back(Entry(map, 0));
+    }
+
+    /// Takes the next map to update. Returns false when there is nothing left to do.
+    bool Pop(Map*& map, bool& repeat)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        while (!queue.empty())
+        {
+            Entry entry = queue.front();
+            if (!entry.second)
+            {
+                queue.pop_front();
+                map = entry.first;
+                repeat = false;
+                return true;
+            }
+            // Only repeated updates are left
+            if (finished)
+                break;
+            Clock::time_point next = Clock::time_point(Clock::duration(entry.second));
+            if (next <= Clock::now())
+            {
+                queue.pop_front();
+                map = entry.first;
+                repeat = true;
+                ++repeatUpdates;
+                return true;
+            }
+            condition.wait_until(guard, next);
+        }
+        return false;
+    }
+
+    /// Queues $map for another update, unless the continents are done.
+    void Repeat(Map* map)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (finished)
+            return;
+        Clock::time_point next = Clock::now() + std::chrono::milliseconds(INSTANCE_REPEAT_UPDATE_DELAY);
+        queue.push_back(Entry(map, next.time_since_epoch().count()));
+        condition.notify_one();
+    }
+
+    /// The continents are updated: only the first updates are still to be done.
+    void Finish()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        finished = true;
+        condition.notify_all();
+    }
+
+    uint32 GetRepeatUpdates() const { return repeatUpdates; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    typedef std::pair<Map*, Clock::rep /*earliest repeated update, 0 for the first one*/> Entry;
+
+    // Minimum time between two updates of an instance while the continents update
+    static const uint32 INSTANCE_REPEAT_UPDATE_DELAY = 5;
+
+    std::deque<Entry> queue;
+    bool finished;
+    uint32 repeatUpdates;
+    std::mutex lock;
+    std::condition_variable condition;
+};
+
 class MapAsyncUpdater : public ACE_Based::Runnable
 {
 public:
-    MapAsyncUpdater(bool* updFinished, uint32 updateDiff) :
-        updateFinished(updFinished), diff(updateDiff), loops(0)
+    MapAsyncUpdater(InstanceUpdateQueue& updateQueue, uint32 updateDiff) :
+        queue(updateQueue), diff(updateDiff), busyTimeUs(0), updates(0)
     {
     }
 
     virtual void run()
     {
         WorldDatabase.ThreadStart();
-        do
+        Map* map;
+        bool repeat;
+        while (queue.Pop(map, repeat))
         {
-            for (std::vector<Map*>::iterator it = maps.begin(); it != maps.end(); ++it)
-            {
-                if (loops && *updateFinished)
-                    break;
-                (*it)->DoUpdate(diff);
-            }
-            if (!(*updateFinished))
-                ACE_Based::Thread::Sleep(5);
-            ++loops;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            map->DoUpdate(diff);
+            uint32 timeUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+            // Repeated updates only process a few ms worth of packets and movement
+            if (!repeat)
+                map->RecordUpdateCost(timeUs);
+            busyTimeUs += timeUs;
+            ++updates;
+            queue.Repeat(map);
         }
-        while (!(*updateFinished));
         WorldDatabase.ThreadEnd();
     }
-    std::vector<Map*> maps;
-    volatile bool* updateFinished;
+    InstanceUpdateQueue& queue;
     uint32 diff;
-    uint32 loops;
+    uint64 busyTimeUs;
+    uint32 updates;
 };
 
 class ContinentAsyncUpdater : public ACE_Based::Runnable
@@ -287,6 +396,60 @@ public:
     uint32 diff;
 };
 
+// Loads the maps newly added to the instance pool, off the world thread
+class InstancePoolLoader : public ACE_Based::Runnable
+{
+public:
+    explicit InstancePoolLoader(std::vector<Map*> const& poolMaps) : maps(poolMaps)
+    {
+    }
+
+    virtual void run()
+    {
+        WorldDatabase.ThreadStart();
+        for (std::vector<Map*>::const_iterator itr = maps.begin(); itr != maps.end(); ++itr)
+        {
+            Map* map = *itr;
+            map->CreateInstanceData(false);
+            map->SpawnActiveObjects();
+            if (AreaTrigger const* entrance = sObjectMgr.GetMapEntranceTrigger(map->GetId()))
+                map->LoadGrid(Cell(MaNGOS::ComputeCellPair(entrance->target_X, entrance->target_Y)));
+        }
+        WorldDatabase.ThreadEnd();
+    }
+    std::vector<Map*> maps;
+};
+
+// Busy time of each instance thread, and the most expensive instances
+static void LogInstancesUpdate(std::vector<Map*> instances, std::vector<MapAsyncUpdater*> const& updaters, uint32 repeatUpdates, uint32 updateTime)
+{
+    std::ostringstream threads;
+    for (std::vector<MapAsyncUpdater*>::const_iterator itr = updaters.begin(); itr != updaters.end(); ++itr)
+        threads << (itr == updaters.begin() ? "" : "|") << uint32((*itr)->busyTimeUs / 1000) << "ms/" << (*itr)->updates;
+
+    std::sort(instances.begin(), instances.end(), [](Map const* a, Map const* b) { return a->GetUpdateCost() > b->GetUpdateCost(); });
+    std::ostringstream costs;
+    for (uint32 i = 0; i < instances.size() && i < 5; ++i)
+        costs << " " << instances[i]->GetId() << ":" << instances[i]->GetInstanceId() << "=" << instances[i]->GetUpdateCost() << "us";
+
+    sLog.out(LOG_PERFORMANCE, "Update instances: %ums, %u maps, %u repeated updates [threads busy/updates %s] [cost%s]",
+             updateTime, uint32(instances.size()), repeatUpdates, threads.str().c_str(), costs.str().c_str());
+}
+
+void MapManager::MarkContinentUpdateFinished()
+{
+    std::lock_guard<std::mutex> guard(i_continentsLock);
+    MANGOS_ASSERT(i_continentsUpdating > 0);
+    if (!--i_continentsUpdating)
+        i_continentsCondition.notify_all();
+}
+
+bool MapManager::WaitContinentsUpdateFinished(uint32 timeoutMs)
+{
+    std::unique_lock<std::mutex> guard(i_continentsLock);
+    return i_continentsCondition.wait_for(guard, std::chrono::milliseconds(timeoutMs), [this]() { return i_continentsUpdating <= 0; });
+}
+
 void MapManager::Update(uint32 diff)
 {
     i_timer.Update(diff);
@@ -294,13 +457,21 @@ void MapManager::Update(uint32 diff)
         return;
 
     uint32 mapsDiff = (uint32)i_timer.GetCurrent();
-    bool updateFinished = false;
+
+    std::vector<Map*> poolLoading;
+    poolLoading.swap(i_instancePoolLoading);
+    ACE_Based::Thread* poolLoaderThread = poolLoading.empty() ? NULL : new ACE_Based::Thread(new InstancePoolLoader(poolLoading));
+
+    InstanceUpdateQueue instancesQueue;
     std::vector<MapAsyncUpdater*> instanceUpdaters(sWorld.getConfig(CONFIG_UINT32_MAPUPDATE_INSTANCED_UPDATE_THREADS));
     std::vector<ContinentAsyncUpdater*> continentsUpdaters;
+    std::vector<Map*> instances;
     for (int i = 0; i < instanceUpdaters.size(); ++i)
-        instanceUpdaters[i] = new MapAsyncUpdater(&updateFinished, mapsDiff); // Will be deleted at thread end
+    {
+        instanceUpdaters[i] = new MapAsyncUpdater(instancesQueue, mapsDiff);
+        instanceUpdaters[i]->incReference();                // read after the thread end
+    }
 
-    int mapIdx = 0;
     int continentsIdx = 0;
     uint32 now = WorldTimer::getMSTime();
     for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end(); ++iter)
@@ -317,10 +488,7 @@ void MapManager::Update(uint32 diff)
         if (iter->second->Instanceable())
         {
             if (instanceUpdaters.size())
-            {
-                instanceUpdaters[mapIdx % instanceUpdaters.size()]->maps.push_back(iter->second);
-                ++mapIdx;
-            }
+                instances.push_back(iter->second);
             else
                 iter->second->Update(mapsDiff);
         }
@@ -331,10 +499,13 @@ void MapManager::Update(uint32 diff)
             continentsUpdaters.push_back(task);
         }
     }
-    i_maxContinentThread = continentsIdx;
-    i_continentUpdateFinished = new volatile bool[i_maxContinentThread];
-    for (int i = 0; i < i_maxContinentThread; ++i)
-        i_continentUpdateFinished[i] = false;
+    i_continentsUpdating = continentsIdx;
+
+    // Longest processing time first
+    std::stable_sort(instances.begin(), instances.end(), [](Map const* a, Map const* b) { return a->GetUpdateCost() > b->GetUpdateCost(); });
+    for (std::vector<Map*>::const_iterator itr = instances.begin(); itr != instances.end(); ++itr)
+        instancesQueue.Push(*itr);
+    uint32 instancesUpdateBegin = WorldTimer::getMSTime();
 
     std::vector<ACE_Based::Thread*> asyncUpdateThreads(instanceUpdaters.size() + continentsUpdaters.size());
 
@@ -350,7 +521,7 @@ void MapManager::Update(uint32 diff)
         delete asyncUpdateThreads[tid];
     }
 
-    updateFinished = true;
+    instancesQueue.Finish();
     SwitchPlayersInstances();
 
     // And then instances updating
@@ -359,8 +530,23 @@ void MapManager::Update(uint32 diff)
         asyncUpdateThreads[tid]->wait();
         delete asyncUpdateThreads[tid];
     }
-    delete[] i_continentUpdateFinished;
-    i_continentUpdateFinished = NULL;
+
+    uint32 instancesUpdateTime = WorldTimer::getMSTimeDiffToNow(instancesUpdateBegin);
+    if (!instances.empty() && sWorld.getConfig(CONFIG_UINT32_PERFLOG_SLOW_MAP_UPDATE) && instancesUpdateTime > sWorld.getConfig(CONFIG_UINT32_PERFLOG_SLOW_MAP_UPDATE))
+        LogInstancesUpdate(instances, instanceUpdaters, instancesQueue.GetRepeatUpdates(), instancesUpdateTime);
+    for (int tid = 0; tid < instanceUpdaters.size(); ++tid)
+        instanceUpdaters[tid]->decReference();
+
+    if (poolLoaderThread)
+    {
+        poolLoaderThread->wait();
+        delete poolLoaderThread;
+
+        Guard _guard(*this);
+        uint32 poolTime = WorldTimer::getMSTime();
+        for (std::vector<Map*>::const_iterator itr = poolLoading.begin(); itr != poolLoading.end(); ++itr)
+            i_instancePool[(*itr)->GetId()].push_back(PooledInstance(*itr, poolTime));
+    }
 
     MapMapType::iterator crashedMapsIter = i_maps.begin();
     while (crashedMapsIter != i_maps.end())
@@ -393,9 +579,84 @@ void MapManager::Update(uint32 diff)
             ++iter;
     }
 
+    RefillInstancePool();
+
     i_timer.SetCurrent(0);
 }
 
+// New dungeon instances are reset two hours after their creation when nobody entered them
+static const uint32 INSTANCE_POOL_MAX_AGE = HOUR * IN_MILLISECONDS;
+
+void MapManager::RefillInstancePool()
+{
+    if (i_instancePoolMapIds.empty())
+        return;
+
+    Guard _guard(*this);
+    uint32 poolSize = sWorld.getConfig(CONFIG_UINT32_INSTANCE_POOL_SIZE);
+    uint32 now = WorldTimer::getMSTime();
+    for (std::vector<uint32>::const_iterator itr = i_instancePoolMapIds.begin(); itr != i_instancePoolMapIds.end(); ++itr)
+    {
+        std::deque<PooledInstance>& pool = i_instancePool[*itr];
+        while (!pool.empty() && (pool.size() > poolSize || WorldTimer::getMSTimeDiff(pool.front().poolTime, now) > INSTANCE_POOL_MAX_AGE))
+        {
+            pool.front().map->UnloadAll(true);
+            delete pool.front().map;
+            pool.pop_front();
+            ++i_instanceCreationStats.expired;
+        }
+
+        uint32 loading = std::count_if(i_instancePoolLoading.begin(), i_instancePoolLoading.end(), [itr](Map const* map) { return map->GetId() == *itr; });
+        if (pool.size() + loading >= poolSize)
+            continue;
+
+        // One map per map id and update, to spread the cost
+        MapEntry const* entry = sMapStorage.LookupEntry<MapEntry>(*itr);
+        if (entry->IsBattleGround())
+            // Battleground spawns depend on the BattleGround the map is given to, only the map itself is built
+            pool.push_back(PooledInstance(new BattleGroundMap(*itr, i_gridCleanUpDelay, GenerateInstanceId()), now));
+        else
+            i_instancePoolLoading.push_back(new DungeonMap(*itr, i_gridCleanUpDelay, GenerateInstanceId()));
+    }
+}
+
+Map* MapManager::TakePooledInstance(uint32 mapId)
+{
+    InstancePool::iterator itr = i_instancePool.find(mapId);
+    if (itr == i_instancePool.end() || itr->second.empty())
+        return NULL;
+
+    Map* map = itr->second.front().map;
+    itr->second.pop_front();
+    return map;
+}
+
+uint32 MapManager::GetPooledInstancesCount(uint32 mapId) const
+{
+    Guard _guard(*this);
+    InstancePool::const_iterator itr = i_instancePool.find(mapId);
+    return itr == i_instancePool.end() ? 0 : itr->second.size();
+}
+
+void MapManager::RecordInstanceCreation(Map const* map, uint32 timeUs, bool pooled)
+{
+    if (pooled)
+    {
+        ++i_instanceCreationStats.pooled;
+        i_instanceCreationStats.pooledTimeUs += timeUs;
+        i_instanceCreationStats.maxPooledTimeUs = std::max(i_instanceCreationStats.maxPooledTimeUs, timeUs);
+    }
+    else
+    {
+        ++i_instanceCreationStats.created;
+        i_instanceCreationStats.createdTimeUs += timeUs;
+        i_instanceCreationStats.maxCreatedTimeUs = std::max(i_instanceCreationStats.maxCreatedTimeUs, timeUs);
+    }
+
+    if (sWorld.getConfig(CONFIG_UINT32_PERFLOG_SLOW_MAP_UPDATE) && timeUs > sWorld.getConfig(CONFIG_UINT32_PERFLOG_SLOW_MAP_UPDATE) * 1000)
+        sLog.out(LOG_PERFORMANCE, "Instance %u of map %u created in %ums (%s)", map->GetInstanceId(), map->GetId(), timeUs / 1000, pooled ? "pooled" : "built on demand");
+}
+
 void MapManager::RemoveAllObjectsInRemoveList()
 {
     for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end(); ++iter)
@@ -419,6 +680,14 @@ bool MapManager::IsValidMAP(uint32 mapid)
 
 void MapManager::UnloadAll()
 {
+    for (InstancePool::iterator itr = i_instancePool.begin(); itr != i_instancePool.end(); ++itr)
+        for (std::deque<PooledInstance>::iterator poolItr = itr->second.begin(); poolItr != itr->second.end(); ++poolItr)
+            delete poolItr->map;
+    i_instancePool.clear();
+    for (std::vector<Map*>::iterator itr = i_instancePoolLoading.begin(); itr != i_instancePoolLoading.end(); ++itr)
+        delete *itr;
+    i_instancePoolLoading.clear();
+
     for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end(); ++iter)
         iter->second->UnloadAll(true);
 
@@ -480,7 +749,9 @@ Map* MapManager::CreateInstance(uint32 id, Player * player)
     Map * pNewMap = NULL;
     uint32 NewInstanceId = 0;                                   // instanceId of the resulting map
     bool newlyGeneratedInstanceId = false;
+    bool pooled = false;
     const MapEntry* entry = sMapStorage.LookupEntry<MapEntry>(id);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
     if (entry->IsBattleGround())
     {
@@ -503,9 +774,17 @@ Map* MapManager::CreateInstance(uint32 id, Player * player)
     {
         // if no instanceId via group members or instance saves is found
         // the instance will be created for the first time
-        NewInstanceId = GenerateInstanceId();
         newlyGeneratedInstanceId = true;
-        pNewMap = CreateDungeonMap(id, NewInstanceId);
+        if ((pNewMap = TakePooledInstance(id)))
+        {
+            NewInstanceId = pNewMap->GetInstanceId();
+            pooled = true;
+        }
+        else
+        {
+            NewInstanceId = GenerateInstanceId();
+            pNewMap = CreateDungeonMap(id, NewInstanceId);
+        }
     }
 
     //add a new map object into the registry
@@ -513,6 +792,7 @@ Map* MapManager::CreateInstance(uint32 id, Player * player)
     {
         i_maps[MapID(id, NewInstanceId)] = pNewMap;
         map = pNewMap;
+        RecordInstanceCreation(pNewMap, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count(), pooled);
     }
 
     return map;
@@ -587,11 +867,12 @@ DungeonMap* MapManager::CreateDungeonMap(uint32 id, uint32 InstanceId, DungeonPe
     return map;
 }
 
-BattleGroundMap* MapManager::CreateBattleGroundMap(uint32 id, uint32 InstanceId, BattleGround* bg)
+BattleGroundMap* MapManager::CreateBattleGroundMap(uint32 id, uint32 InstanceId, BattleGround* bg, BattleGroundMap* map)
 {
     DEBUG_LOG("MapInstanced::CreateBattleGroundMap: instance:%d for map:%d and bgType:%d created.", InstanceId, id, bg->GetTypeID());
 
-    BattleGroundMap *map = new BattleGroundMap(id, i_gridCleanUpDelay, InstanceId);
+    if (!map)
+        map = new BattleGroundMap(id, i_gridCleanUpDelay, InstanceId);
     MANGOS_ASSERT(map->IsBattleGround());
     map->SetBG(bg);
     bg->SetBgMap(map);
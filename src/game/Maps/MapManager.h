@@ -30,8 +30,27 @@
 #include "Map.h"
 #include "GridStates.h"
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
 class BattleGround;
 
+// Creation time of the instance maps, built on demand or taken from the pool
+struct InstanceCreationStats
+{
+    InstanceCreationStats() : created(0), createdTimeUs(0), maxCreatedTimeUs(0),
+        pooled(0), pooledTimeUs(0), maxPooledTimeUs(0), expired(0) {}
+
+    uint32 created;
+    uint64 createdTimeUs;
+    uint32 maxCreatedTimeUs;
+    uint32 pooled;
+    uint64 pooledTimeUs;
+    uint32 maxPooledTimeUs;
+    uint32 expired;                                         // pooled maps unloaded before being used
+};
+
 enum
 {
     MAP0_TOP_NORTH      = 1,
@@ -178,23 +197,15 @@ class MANGOS_DLL_DECL MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::
         void ScheduleInstanceSwitch(Player* player, uint16 newInstance);
         void SwitchPlayersInstances();
 
-        void MarkContinentUpdateFinished(int idx)
-        {
-            ASSERT(idx < i_maxContinentThread);
-            i_continentUpdateFinished[idx] = true;
-        }
-        bool IsContinentUpdateFinished()
-        {
-            // Check pointer rather than deref. Deleted after
-            // continent and instance updates are finished
-            if (i_continentUpdateFinished == NULL)
-                return true;
-
-            for (int i = 0; i < i_maxContinentThread; ++i)
-                if (!i_continentUpdateFinished[i])
-                    return false;
-            return true;
-        }
+        /* instance pool */
+        std::vector<uint32> const& GetInstancePoolMapIds() const { return i_instancePoolMapIds; }
+        uint32 GetPooledInstancesCount(uint32 mapId) const;
+        InstanceCreationStats const& GetInstanceCreationStats() const { return i_instanceCreationStats; }
+
+        // Called by each continent thread once its map is updated
+        void MarkContinentUpdateFinished();
+        /// Waits at most $timeoutMs for all the continents to be updated. Returns true if they are.
+        bool WaitContinentsUpdateFinished(uint32 timeoutMs);
     private:
 
         // debugging code, should be deleted some day
@@ -214,15 +225,36 @@ class MANGOS_DLL_DECL MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::
 
         Map* CreateInstance(uint32 id, Player * player);
         DungeonMap* CreateDungeonMap(uint32 id, uint32 InstanceId, DungeonPersistentState *save = NULL);
-        BattleGroundMap* CreateBattleGroundMap(uint32 id, uint32 InstanceId, BattleGround* bg);
+        // $map is a pre-built map to use instead of a new one
+        BattleGroundMap* CreateBattleGroundMap(uint32 id, uint32 InstanceId, BattleGround* bg, BattleGroundMap* map = NULL);
+
+        // Pre-built instance maps. New maps are constructed in the world thread, then their instance data,
+        // active objects and entrance grid are loaded by a separate thread during the next maps update.
+        struct PooledInstance
+        {
+            PooledInstance(Map* m, uint32 time) : map(m), poolTime(time) {}
+            Map* map;
+            uint32 poolTime;
+        };
+        typedef std::map<uint32 /*map id*/, std::deque<PooledInstance> > InstancePool;
+
+        Map* TakePooledInstance(uint32 mapId);
+        void RefillInstancePool();
+        void RecordInstanceCreation(Map const* map, uint32 timeUs, bool pooled);
+
+        std::vector<uint32> i_instancePoolMapIds;
+        InstancePool i_instancePool;                        // ready to be used
+        std::vector<Map*> i_instancePoolLoading;            // loaded during the next update
+        InstanceCreationStats i_instanceCreationStats;
 
         uint32 i_gridCleanUpDelay;
         MapMapType i_maps;
         IntervalTimer i_timer;
 
         uint32 i_MaxInstanceId;
-        int             i_maxContinentThread;
-        volatile bool*  i_continentUpdateFinished;
+        int                     i_continentsUpdating;
+        std::mutex              i_continentsLock;
+        std::condition_variable i_continentsCondition;
 
         // Instanced continent zones
         const static int LAST_CONTINENT_ID = 2;
@@ -36,15 +36,20 @@
 #include "Group.h"
 #include "InstanceData.h"
 #include "ProgressBar.h"
+#include "Config/Config.h"
+
+#include <cstdio>
 
 INSTANTIATE_SINGLETON_1(MapPersistentStateManager);
 
 static uint32 resetEventTypeDelay[MAX_RESET_EVENT_TYPE] = { 0, 3600, 900, 300, 60 };
 
+#define RESPAWN_TIMES_MAX_ROWS_PER_QUERY 500
+
 //== MapPersistentState functions ==========================
 MapPersistentState::MapPersistentState(uint16 MapId, uint32 InstanceId)
     : m_instanceid(InstanceId), m_mapid(MapId),
-      m_usedByMap(nullptr)
+      m_usedByMap(nullptr), m_respawnTimesFlushTimer(0)
 {
 }
 
@@ -72,8 +77,24 @@ bool MapPersistentState::UnloadIfEmpty()
         return true;
 }
 
+bool MapPersistentState::CanDelayRespawnTimeSave() const
+{
+    // Flushed by the map update, or when the map releases the state
+    return m_usedByMap && sWorld.getConfig(CONFIG_UINT32_INTERVAL_RESPAWN_TIMES_FLUSH) && !GetMapEntry()->IsBattleGround();
+}
+
 void MapPersistentState::SaveCreatureRespawnTime(uint32 loguid, time_t t)
 {
+    if (CanDelayRespawnTimeSave())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_pendingRespawnTimesLock);
+            m_pendingCreatureRespawnTimes[loguid] = t;
+        }
+        SetCreatureRespawnTime(loguid, t);
+        return;
+    }
+
     SetCreatureRespawnTime(loguid, t);
 
     // BGs/Arenas always reset at server restart/unload, so no reason store in DB
@@ -97,6 +118,16 @@ void MapPersistentState::SaveCreatureRespawnTime(uint32 loguid, time_t t)
 
 void MapPersistentState::SaveGORespawnTime(uint32 loguid, time_t t)
 {
+    if (CanDelayRespawnTimeSave())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_pendingRespawnTimesLock);
+            m_pendingGORespawnTimes[loguid] = t;
+        }
+        SetGORespawnTime(loguid, t);
+        return;
+    }
+
     SetGORespawnTime(loguid, t);
 
     // BGs/Arenas always reset at server restart/unload, so no reason store in DB
@@ -139,8 +170,52 @@ void MapPersistentState::SetGORespawnTime(uint32 loguid, time_t t)
     }
 }
 
+void MapPersistentState::UpdateRespawnTimesFlush(uint32 diff)
+{
+    m_respawnTimesFlushTimer += diff;
+    if (m_respawnTimesFlushTimer < sWorld.getConfig(CONFIG_UINT32_INTERVAL_RESPAWN_TIMES_FLUSH))
+        return;
+
+    m_respawnTimesFlushTimer = 0;
+    FlushRespawnTimes();
+}
+
+void MapPersistentState::FlushRespawnTimes()
+{
+    RespawnTimeWrites creatures;
+    RespawnTimeWrites gameobjects;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingRespawnTimesLock);
+        if (m_pendingCreatureRespawnTimes.empty() && m_pendingGORespawnTimes.empty())
+            return;
+
+        creatures.reserve(m_pendingCreatureRespawnTimes.size());
+        for (RespawnTimes::const_iterator itr = m_pendingCreatureRespawnTimes.begin(); itr != m_pendingCreatureRespawnTimes.end(); ++itr)
+            creatures.push_back(RespawnTimeWrite(itr->first, itr->second, m_instanceid, GetMapId()));
+        gameobjects.reserve(m_pendingGORespawnTimes.size());
+        for (RespawnTimes::const_iterator itr = m_pendingGORespawnTimes.begin(); itr != m_pendingGORespawnTimes.end(); ++itr)
+            gameobjects.push_back(RespawnTimeWrite(itr->first, itr->second, m_instanceid, GetMapId()));
+        m_pendingCreatureRespawnTimes.clear();
+        m_pendingGORespawnTimes.clear();
+    }
+
+    sMapPersistentStateMgr.JournalRespawnTimes(creatures, gameobjects);
+    MapPersistentStateManager::ExecuteRespawnTimeWrites("creature_respawn", creatures, false);
+    MapPersistentStateManager::ExecuteRespawnTimeWrites("gameobject_respawn", gameobjects, false);
+}
+
+void MapPersistentState::ClearPendingRespawnTimes()
+{
+    std::lock_guard<std::mutex> lock(m_pendingRespawnTimesLock);
+    m_pendingCreatureRespawnTimes.clear();
+    m_pendingGORespawnTimes.clear();
+}
+
 void MapPersistentState::ClearRespawnTimes()
 {
+    // respawn rows are deleted by the caller
+    ClearPendingRespawnTimes();
+
     m_goRespawnTimes.clear();
     m_creatureRespawnTimes.clear();
 
@@ -263,12 +338,14 @@ void DungeonPersistentState::DeleteRespawnTimesAndData()
     CharacterDatabase.PExecute("DELETE FROM gameobject_respawn WHERE instance = '%u'", GetInstanceId());
     CharacterDatabase.PExecute("UPDATE instance SET data = '' WHERE id = '%u'", GetInstanceId());
     CharacterDatabase.CommitTransaction();
+    sMapPersistentStateMgr.JournalRespawnTimesRemoval(RESPAWN_JOURNAL_DEL_INSTANCE, GetInstanceId());
 
     ClearRespawnTimes();                                    // state can be deleted at call if only respawn data prevent unload
 }
 
 void DungeonPersistentState::DeleteFromDB()
 {
+    ClearPendingRespawnTimes();
     MapPersistentStateManager::DeleteInstanceFromDB(GetMapId(), GetInstanceId());
 }
 
@@ -324,9 +401,8 @@ void DungeonResetScheduler::LoadResetTimes()
     // for random dungeons as we allocate the cleared IDs for future instances, since
     // the player bindings will remain due to the wrong mapid being reset.
     // _____BAD_____
-    ResetTimeMapType InstResetTime;
 
-    QueryResult *result = CharacterDatabase.Query("SELECT id, map, resettime FROM instance");
+    QueryResult *result = CharacterDatabase.Query("SELECT id, map FROM instance");
     if (result)
     {
         do
@@ -334,45 +410,24 @@ void DungeonResetScheduler::LoadResetTimes()
             Field* fields = result->Fetch();
             uint32 id = fields[0].GetUInt32();
             uint32 mapid = fields[1].GetUInt32();
-            time_t resettime = time_t(fields[2].GetUInt64());
 
             MapEntry const* mapEntry = sMapStorage.LookupEntry<MapEntry>(mapid);
 
             if (!mapEntry || !mapEntry->IsDungeon())
-            {
                 sMapPersistentStateMgr.DeleteInstanceFromDB(mapid, id);
-                continue;
-            }
-
-            // Don't set or update reset time for raid instances
-            if (mapEntry->IsRaid())
-                continue;
-
-            InstResetTime[id] = std::pair<uint32, uint64>(mapid,
-                resettime ? resettime : now + 2 * HOUR);
         }
         while (result->NextRow());
         delete result;
 
         // update reset time for normal instances with the max creature respawn time + X hours
-        result = CharacterDatabase.Query("SELECT MAX(respawntime), instance FROM creature_respawn WHERE instance > 0 GROUP BY instance");
-        if (result)
-        {
-            do
-            {
-                Field *fields = result->Fetch();
-                uint32 instance = fields[1].GetUInt32();
-                time_t resettime = time_t(fields[0].GetUInt64() + 2 * HOUR);
-                ResetTimeMapType::iterator itr = InstResetTime.find(instance);
-                if (itr != InstResetTime.end() && itr->second.second != resettime)
-                {
-                    CharacterDatabase.DirectPExecute("UPDATE instance SET resettime = '" UI64FMTD "' WHERE id = '%u'", uint64(resettime), instance);
-                    itr->second.second = resettime;
-                }
-            }
-            while (result->NextRow());
-            delete result;
-        }
+        std::ostringstream raidMaps;
+        for (auto itr = sMapStorage.begin<MapEntry>(); itr < sMapStorage.end<MapEntry>(); ++itr)
+            if (itr->IsRaid())
+                raidMaps << ", " << itr->id;
+
+        CharacterDatabase.DirectPExecute("UPDATE instance JOIN (SELECT instance, MAX(respawntime) + %u AS resettime FROM creature_respawn WHERE instance > 0 GROUP BY instance) respawn "
+            "ON instance.id = respawn.instance SET instance.resettime = respawn.resettime WHERE instance.resettime <> respawn.resettime AND instance.map NOT IN (0%s)",
+            uint32(2 * HOUR), raidMaps.str().c_str());
     }
 
     // load the global respawn times for raid instances
@@ -582,7 +637,8 @@ void DungeonResetScheduler::Update()
 
 //== MapPersistentStateManager functions =========================
 
-MapPersistentStateManager::MapPersistentStateManager() : lock_instLists(false), m_Scheduler(*this)
+MapPersistentStateManager::MapPersistentStateManager() : lock_instLists(false), m_Scheduler(*this),
+    m_respawnJournal(nullptr), m_respawnJournalRotateTime(0)
 {
 }
 
@@ -595,6 +651,211 @@ MapPersistentStateManager::~MapPersistentStateManager()
         delete  itr->second;
     for (PersistentStateMap::iterator itr = m_instanceSaveByMapId.begin(); itr != m_instanceSaveByMapId.end(); ++itr)
         delete  itr->second;
+
+    if (m_respawnJournal)
+        fclose(m_respawnJournal);
+}
+
+void MapPersistentStateManager::Update()
+{
+    m_Scheduler.Update();
+
+    // Entries of the previous journal are flushed for a long time: keep two generations only
+    if (m_respawnJournal && time(nullptr) >= m_respawnJournalRotateTime)
+    {
+        std::lock_guard<std::mutex> lock(m_respawnJournalLock);
+        fclose(m_respawnJournal);
+        std::string previous = m_respawnJournalPath + ".old";
+        rename(m_respawnJournalPath.c_str(), previous.c_str());
+        m_respawnJournal = fopen(m_respawnJournalPath.c_str(), "a");
+        if (!m_respawnJournal)
+            sLog.outError("Unable to open respawn times journal '%s', journal disabled.", m_respawnJournalPath.c_str());
+        m_respawnJournalRotateTime = time(nullptr) + std::max<time_t>(MINUTE, 10 * sWorld.getConfig(CONFIG_UINT32_INTERVAL_RESPAWN_TIMES_FLUSH) / IN_MILLISECONDS);
+    }
+}
+
+static void ExecuteRespawnTimesQuery(std::string const& sql, bool direct)
+{
+    if (direct)
+        CharacterDatabase.DirectExecute(sql.c_str());
+    else
+        CharacterDatabase.Execute(sql.c_str());
+}
+
+void MapPersistentStateManager::ExecuteRespawnTimeWrites(char const* table, RespawnTimeWrites const& writes, bool direct)
+{
+    if (writes.empty())
+        return;
+
+    time_t now = sWorld.GetGameTime();
+    std::ostringstream replaced;
+    uint32 replacedRows = 0;
+    // DELETE by instance to use the primary key
+    typedef std::map<uint32 /*instance*/, std::vector<uint32> > DeletedGuids;
+    DeletedGuids deleted;
+
+    for (RespawnTimeWrites::const_iterator itr = writes.begin(); itr != writes.end(); ++itr)
+    {
+        if (itr->time <= now)
+        {
+            deleted[itr->instance].push_back(itr->guid);
+            continue;
+        }
+
+        if (!replacedRows)
+            replaced << "REPLACE INTO " << table << " (guid, respawntime, instance, map) VALUES ";
+        else
+            replaced << ",";
+        replaced << "(" << itr->guid << "," << uint64(itr->time) << "," << itr->instance << "," << itr->map << ")";
+
+        if (++replacedRows >= RESPAWN_TIMES_MAX_ROWS_PER_QUERY)
+        {
+            ExecuteRespawnTimesQuery(replaced.str(), direct);
+            replaced.str("");
+            replacedRows = 0;
+        }
+    }
+    if (replacedRows)
+        ExecuteRespawnTimesQuery(replaced.str(), direct);
+
+    for (DeletedGuids::const_iterator itr = deleted.begin(); itr != deleted.end(); ++itr)
+    {
+        for (size_t first = 0; first < itr->second.size(); first += RESPAWN_TIMES_MAX_ROWS_PER_QUERY)
+        {
+            std::ostringstream query;
+            query << "DELETE FROM " << table << " WHERE instance = " << itr->first << " AND guid IN (";
+            size_t last = std::min(itr->second.size(), first + RESPAWN_TIMES_MAX_ROWS_PER_QUERY);
+            for (size_t i = first; i < last; ++i)
+                query << (i != first ? "," : "") << itr->second[i];
+            query << ")";
+            ExecuteRespawnTimesQuery(query.str(), direct);
+        }
+    }
+}
+
+static void AppendJournalRecords(std::string& buffer, char type, RespawnTimeWrites const& writes)
+{
+    char record[64];
+    for (RespawnTimeWrites::const_iterator itr = writes.begin(); itr != writes.end(); ++itr)
+    {
+        int length = snprintf(record, sizeof(record), "%c %u %u %u " UI64FMTD "\n", type, itr->guid, itr->instance, itr->map, uint64(itr->time));
+        buffer.append(record, length);
+    }
+}
+
+void MapPersistentStateManager::JournalRespawnTimes(RespawnTimeWrites const& creatures, RespawnTimeWrites const& gameobjects)
+{
+    if (m_respawnJournalPath.empty())
+        return;
+
+    // Formatted outside of the lock, written with one call per flushed map
+    std::string buffer;
+    AppendJournalRecords(buffer, RESPAWN_JOURNAL_CREATURE, creatures);
+    AppendJournalRecords(buffer, RESPAWN_JOURNAL_GAMEOBJECT, gameobjects);
+    if (buffer.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(m_respawnJournalLock);
+    if (!m_respawnJournal)
+        return;
+
+    fwrite(buffer.data(), 1, buffer.size(), m_respawnJournal);
+    fflush(m_respawnJournal);
+}
+
+void MapPersistentStateManager::JournalRespawnTimesRemoval(RespawnJournalRecord type, uint32 id)
+{
+    if (m_respawnJournalPath.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(m_respawnJournalLock);
+    if (!m_respawnJournal)
+        return;
+
+    fprintf(m_respawnJournal, "%c %u\n", char(type), id);
+    fflush(m_respawnJournal);
+}
+
+void MapPersistentStateManager::ReplayRespawnJournal()
+{
+    m_respawnJournalPath = sConfig.GetStringDefault("SaveRespawnTimeJournal", "");
+    if (m_respawnJournalPath.empty() || !sWorld.getConfig(CONFIG_UINT32_INTERVAL_RESPAWN_TIMES_FLUSH))
+        return;
+
+    // older generation first, last entry of a guid wins
+    typedef std::map<std::pair<uint32 /*instance*/, uint32 /*guid*/>, RespawnTimeWrite> JournalEntries;
+    JournalEntries entries[2];
+    uint32 count = 0;
+
+    std::string files[2] = { m_respawnJournalPath + ".old", m_respawnJournalPath };
+    for (uint32 f = 0; f < 2; ++f)
+    {
+        FILE* journal = fopen(files[f].c_str(), "r");
+        if (!journal)
+            continue;
+
+        char line[128];
+        while (fgets(line, sizeof(line), journal))
+        {
+            char type;
+            uint32 guid, instance, map;
+            uint64 respawnTime;
+            if (sscanf(line, "%c %u %u %u " UI64FMTD, &type, &guid, &instance, &map, &respawnTime) == 5 &&
+                (type == RESPAWN_JOURNAL_CREATURE || type == RESPAWN_JOURNAL_GAMEOBJECT))
+            {
+                JournalEntries& typeEntries = entries[type == RESPAWN_JOURNAL_CREATURE ? 0 : 1];
+                std::pair<uint32, uint32> key(instance, guid);
+                typeEntries.erase(key);
+                typeEntries.insert(JournalEntries::value_type(key, RespawnTimeWrite(guid, time_t(respawnTime), instance, map)));
+                ++count;
+                continue;
+            }
+
+            // Rows deleted after these entries were written must not come back
+            uint32 id;
+            if (sscanf(line, "%c %u", &type, &id) != 2)
+                continue;
+
+            for (uint32 i = 0; i < 2; ++i)
+            {
+                if (type == RESPAWN_JOURNAL_DEL_INSTANCE)
+                {
+                    entries[i].erase(entries[i].lower_bound(std::make_pair(id, 0u)), entries[i].lower_bound(std::make_pair(id + 1, 0u)));
+                    continue;
+                }
+
+                for (JournalEntries::iterator itr = entries[i].begin(); itr != entries[i].end();)
+                {
+                    if ((type == RESPAWN_JOURNAL_DEL_MAP && itr->second.map == id) ||
+                        (type == RESPAWN_JOURNAL_DEL_CREATURE && i == 0 && itr->second.guid == id))
+                        entries[i].erase(itr++);
+                    else
+                        ++itr;
+                }
+            }
+        }
+        fclose(journal);
+    }
+
+    char const* tables[2] = { "creature_respawn", "gameobject_respawn" };
+    for (uint32 i = 0; i < 2; ++i)
+    {
+        RespawnTimeWrites writes;
+        writes.reserve(entries[i].size());
+        for (JournalEntries::const_iterator itr = entries[i].begin(); itr != entries[i].end(); ++itr)
+            writes.push_back(itr->second);
+        ExecuteRespawnTimeWrites(tables[i], writes, true);
+    }
+
+    if (count)
+        sLog.outString(">> Replayed %u respawn times journal entries (%u creatures, %u gameobjects)", count, uint32(entries[0].size()), uint32(entries[1].size()));
+
+    // Everything is in DB now, start a new journal
+    remove(files[0].c_str());
+    m_respawnJournal = fopen(m_respawnJournalPath.c_str(), "w");
+    if (!m_respawnJournal)
+        sLog.outError("Unable to open respawn times journal '%s', journal disabled.", m_respawnJournalPath.c_str());
+    m_respawnJournalRotateTime = time(nullptr) + std::max<time_t>(MINUTE, 10 * sWorld.getConfig(CONFIG_UINT32_INTERVAL_RESPAWN_TIMES_FLUSH) / IN_MILLISECONDS);
 }
 
 /*
@@ -678,6 +939,7 @@ void MapPersistentStateManager::DeleteInstanceFromDB(uint32 mapid, uint32 instan
         CharacterDatabase.PExecute("DELETE FROM creature_respawn WHERE instance = '%u'", instanceid);
         CharacterDatabase.PExecute("DELETE FROM gameobject_respawn WHERE instance = '%u'", instanceid);
         CharacterDatabase.CommitTransaction();
+        sMapPersistentStateMgr.JournalRespawnTimesRemoval(RESPAWN_JOURNAL_DEL_INSTANCE, instanceid);
     }
 }
 
@@ -700,35 +962,16 @@ void MapPersistentStateManager::RemovePersistentState(uint32 mapId, uint32 insta
     }
 }
 
-void MapPersistentStateManager::_DelHelper(DatabaseType &db, const char *fields, const char *table, const char *queryTail, ...)
+// Deletes the rows of table matching the joins/conditions of queryTail with a single multi-table DELETE
+void MapPersistentStateManager::_DelHelper(DatabaseType &db, const char *table, const char *queryTail, ...)
 {
-    Tokens fieldTokens = StrSplit(fields, ", ");
-    MANGOS_ASSERT(fieldTokens.size() != 0);
-
     va_list ap;
     char szQueryTail [MAX_QUERY_LEN];
     va_start(ap, queryTail);
     vsnprintf(szQueryTail, MAX_QUERY_LEN, queryTail, ap);
     va_end(ap);
 
-    QueryResult *result = db.PQuery("SELECT %s FROM %s %s", fields, table, szQueryTail);
-    if (result)
-    {
-        do
-        {
-            Field *fields = result->Fetch();
-            std::ostringstream ss;
-            for (size_t i = 0; i < fieldTokens.size(); i++)
-            {
-                std::string fieldValue = fields[i].GetCppString();
-                db.escape_string(fieldValue);
-                ss << (i != 0 ? " AND " : "") << fieldTokens[i] << " = '" << fieldValue << "'";
-            }
-            db.PExecute("DELETE FROM %s WHERE %s", table, ss.str().c_str());
-        }
-        while (result->NextRow());
-        delete result;
-    }
+    db.PExecute("DELETE %s FROM %s %s", table, table, szQueryTail);
 }
 
 void MapPersistentStateManager::CleanupInstances()
@@ -737,19 +980,22 @@ void MapPersistentStateManager::CleanupInstances()
     bar.step();
 
     // load reset times and clean expired instances
+    uint32 stepTime = WorldTimer::getMSTime();
     m_Scheduler.LoadResetTimes();
+    sLog.outString(">> Instance reset times loaded in %u ms", WorldTimer::getMSTimeDiffToNow(stepTime));
 
+    stepTime = WorldTimer::getMSTime();
     CharacterDatabase.BeginTransaction();
     // clean character/group - instance binds with invalid group/characters
-    _DelHelper(CharacterDatabase, "character_instance.guid, instance", "character_instance", "LEFT JOIN characters ON character_instance.guid = characters.guid WHERE characters.guid IS NULL");
-    _DelHelper(CharacterDatabase, "group_instance.leaderGuid, instance", "group_instance", "LEFT JOIN characters ON group_instance.leaderGuid = characters.guid LEFT JOIN groups ON group_instance.leaderGuid = groups.leaderGuid WHERE characters.guid IS NULL OR groups.leaderGuid IS NULL");
+    _DelHelper(CharacterDatabase, "character_instance", "LEFT JOIN characters ON character_instance.guid = characters.guid WHERE characters.guid IS NULL");
+    _DelHelper(CharacterDatabase, "group_instance", "LEFT JOIN characters ON group_instance.leaderGuid = characters.guid LEFT JOIN groups ON group_instance.leaderGuid = groups.leaderGuid WHERE characters.guid IS NULL OR groups.leaderGuid IS NULL");
 
     // clean instances that do not have any players or groups bound to them
-    _DelHelper(CharacterDatabase, "id, map", "instance", "LEFT JOIN character_instance ON character_instance.instance = id LEFT JOIN group_instance ON group_instance.instance = id WHERE character_instance.instance IS NULL AND group_instance.instance IS NULL");
+    _DelHelper(CharacterDatabase, "instance", "LEFT JOIN character_instance ON character_instance.instance = id LEFT JOIN group_instance ON group_instance.instance = id WHERE character_instance.instance IS NULL AND group_instance.instance IS NULL");
 
     // clean invalid instance references in other tables
-    _DelHelper(CharacterDatabase, "character_instance.guid, instance", "character_instance", "LEFT JOIN instance ON character_instance.instance = instance.id WHERE instance.id IS NULL");
-    _DelHelper(CharacterDatabase, "group_instance.leaderGuid, instance", "group_instance", "LEFT JOIN instance ON group_instance.instance = instance.id WHERE instance.id IS NULL");
+    _DelHelper(CharacterDatabase, "character_instance", "LEFT JOIN instance ON character_instance.instance = instance.id WHERE instance.id IS NULL");
+    _DelHelper(CharacterDatabase, "group_instance", "LEFT JOIN instance ON group_instance.instance = instance.id WHERE instance.id IS NULL");
 
     // clean unused respawn data
     CharacterDatabase.PExecute("DELETE FROM creature_respawn WHERE instance >= %u AND instance NOT IN (SELECT id FROM instance)", RESERVED_INSTANCES_LAST);
@@ -759,67 +1005,90 @@ void MapPersistentStateManager::CleanupInstances()
 
     bar.step();
     sLog.outString();
-    sLog.outString(">> Instances cleaned up");
+    sLog.outString(">> Instances cleaned up in %u ms", WorldTimer::getMSTimeDiffToNow(stepTime));
 }
 
 void MapPersistentStateManager::PackInstances()
 {
-    // this routine renumbers player instance associations in such a way so they start from 1 and go up
-    // TODO: this can be done a LOT more efficiently
-
-    // obtain set of all associations
-    std::set<uint32> InstanceSet;
+    // this routine renumbers instance ids in such a way so they start from RESERVED_INSTANCES_LAST and go up.
+    // The moved ids are stored in a temporary old -> new table joined once per referencing table.
 
     // all valid ids are in the instance table
     // any associations to ids not in this table are assumed to be
     // cleaned already in CleanupInstances
-    CharacterDatabase.BeginTransaction();
-        CharacterDatabase.PExecute("UPDATE instance SET id = id + %u ORDER BY id DESC", RESERVED_INSTANCES_LAST);
-        CharacterDatabase.PExecute("UPDATE creature_respawn SET instance = instance + %u WHERE instance >= %u ORDER BY instance DESC", RESERVED_INSTANCES_LAST, RESERVED_INSTANCES_LAST);
-        CharacterDatabase.PExecute("UPDATE gameobject_respawn SET instance = instance + %u WHERE instance >= %u ORDER BY instance DESC", RESERVED_INSTANCES_LAST, RESERVED_INSTANCES_LAST);
-        CharacterDatabase.PExecute("UPDATE corpse SET instance = instance + %u WHERE instance >= 0 ORDER BY instance DESC", RESERVED_INSTANCES_LAST, RESERVED_INSTANCES_LAST);
-        CharacterDatabase.PExecute("UPDATE character_instance SET instance = instance + %u WHERE instance >= 0 ORDER BY instance DESC", RESERVED_INSTANCES_LAST, RESERVED_INSTANCES_LAST);
-        CharacterDatabase.PExecute("UPDATE group_instance SET instance = instance + %u WHERE instance >= 0 ORDER BY instance DESC", RESERVED_INSTANCES_LAST, RESERVED_INSTANCES_LAST);
-        CharacterDatabase.Execute("DELETE FROM instance WHERE map <= 1");
-    CharacterDatabase.CommitTransaction();
-    QueryResult *result = CharacterDatabase.Query("SELECT id FROM instance");
+    uint32 stepTime = WorldTimer::getMSTime();
+    std::vector<uint32> instanceIds;
+    QueryResult *result = CharacterDatabase.Query("SELECT id FROM instance WHERE map > 1 ORDER BY id");
     if (result)
     {
+        instanceIds.reserve(result->GetRowCount());
         do
         {
             Field *fields = result->Fetch();
-            InstanceSet.insert(fields[0].GetUInt32());
+            instanceIds.push_back(fields[0].GetUInt32());
         }
         while (result->NextRow());
         delete result;
     }
 
-    BarGoLink bar(InstanceSet.size() + 1);
+    BarGoLink bar(2);
     bar.step();
 
-    uint32 InstanceNumber = RESERVED_INSTANCES_LAST;
-    // we do assume std::set is sorted properly on integer value
-    for (std::set<uint32>::iterator i = InstanceSet.begin(); i != InstanceSet.end(); ++i)
+    // ids already at their place are kept
+    uint32 firstMoved = 0;
+    while (firstMoved < instanceIds.size() && instanceIds[firstMoved] == RESERVED_INSTANCES_LAST + firstMoved)
+        ++firstMoved;
+
+    sLog.outString(">> %u instances to renumber selected in %u ms", uint32(instanceIds.size()) - firstMoved, WorldTimer::getMSTimeDiffToNow(stepTime));
+
+    stepTime = WorldTimer::getMSTime();
+    CharacterDatabase.BeginTransaction();
+    CharacterDatabase.Execute("DELETE FROM instance WHERE map <= 1");
+    if (firstMoved < instanceIds.size())
     {
-        if (*i != InstanceNumber)
+        // ids are first moved above all the current ones (tmp_id), then down to their final value, so that
+        // no update ever hits an id still in use
+        uint32 tmpOffset = instanceIds.back() + 1;
+        CharacterDatabase.Execute("DROP TEMPORARY TABLE IF EXISTS instance_pack");
+        CharacterDatabase.Execute("CREATE TEMPORARY TABLE instance_pack (old_id INT UNSIGNED NOT NULL PRIMARY KEY, tmp_id INT UNSIGNED NOT NULL UNIQUE, new_id INT UNSIGNED NOT NULL)");
+
+        std::ostringstream ss;
+        uint32 rows = 0;
+        for (uint32 i = firstMoved; i < instanceIds.size(); ++i)
         {
-            CharacterDatabase.BeginTransaction();
-            // remap instance id
-            CharacterDatabase.PExecute("UPDATE creature_respawn SET instance = '%u' WHERE instance = '%u'", InstanceNumber, *i);
-            CharacterDatabase.PExecute("UPDATE gameobject_respawn SET instance = '%u' WHERE instance = '%u'", InstanceNumber, *i);
-            CharacterDatabase.PExecute("UPDATE corpse SET instance = '%u' WHERE instance = '%u'", InstanceNumber, *i);
-            CharacterDatabase.PExecute("UPDATE character_instance SET instance = '%u' WHERE instance = '%u'", InstanceNumber, *i);
-            CharacterDatabase.PExecute("UPDATE instance SET id = '%u' WHERE id = '%u'", InstanceNumber, *i);
-            CharacterDatabase.PExecute("UPDATE group_instance SET instance = '%u' WHERE instance = '%u'", InstanceNumber, *i);
-            //execute transaction synchronously
-            CharacterDatabase.CommitTransaction();
+            uint32 newId = RESERVED_INSTANCES_LAST + i;
+            ss << (rows ? ", (" : "INSERT INTO instance_pack VALUES (") << instanceIds[i] << ", " << tmpOffset + newId << ", " << newId << ")";
+            if (++rows == 1000 || i + 1 == instanceIds.size())
+            {
+                CharacterDatabase.Execute(ss.str().c_str());
+                ss.str("");
+                rows = 0;
+            }
         }
 
-        ++InstanceNumber;
-        bar.step();
+        static char const* const packedColumns[][2] =
+        {
+            { "instance",           "id" },
+            { "creature_respawn",   "instance" },
+            { "gameobject_respawn", "instance" },
+            { "corpse",             "instance" },
+            { "character_instance", "instance" },
+            { "group_instance",     "instance" },
+        };
+
+        for (auto const& column : packedColumns)
+            CharacterDatabase.PExecute("UPDATE %s JOIN instance_pack ON %s.%s = old_id SET %s.%s = tmp_id", column[0], column[0], column[1], column[0], column[1]);
+        for (auto const& column : packedColumns)
+            CharacterDatabase.PExecute("UPDATE %s JOIN instance_pack ON %s.%s = tmp_id SET %s.%s = new_id", column[0], column[0], column[1], column[0], column[1]);
+
+        CharacterDatabase.Execute("DROP TEMPORARY TABLE instance_pack");
     }
+    //execute transaction synchronously
+    CharacterDatabase.CommitTransaction();
+
+    bar.step();
 
-    sLog.outString(">> Instance numbers remapped, next instance id is %u", InstanceNumber);
+    sLog.outString(">> Instance numbers remapped in %u ms, next instance id is %u", WorldTimer::getMSTimeDiffToNow(stepTime), RESERVED_INSTANCES_LAST + uint32(instanceIds.size()));
     sLog.outString();
 }
 
@@ -941,6 +1210,7 @@ void MapPersistentStateManager::_ResetOrWarnAll(uint32 mapid, bool warn, uint32
         CharacterDatabase.PExecute("DELETE FROM group_instance USING group_instance LEFT JOIN instance ON group_instance.instance = id WHERE map = '%u'", mapid);
         CharacterDatabase.PExecute("DELETE FROM instance WHERE map = '%u'", mapid);
         CharacterDatabase.CommitTransaction();
+        JournalRespawnTimesRemoval(RESPAWN_JOURNAL_DEL_MAP, mapid);
 
         // calculate the next reset time
         time_t next_reset = DungeonResetScheduler::CalculateNextResetTime(mapEntry, now + timeLeft);
@@ -973,7 +1243,7 @@ void MapPersistentStateManager::GetStatistics(uint32& numStates, uint32& numBoun
 
 void MapPersistentStateManager::_CleanupExpiredInstancesAtTime(time_t t)
 {
-    _DelHelper(CharacterDatabase, "id, map", "instance", "LEFT JOIN instance_reset ON mapid = map WHERE (instance.resettime < '" UI64FMTD "' AND instance.resettime > '0') OR (NOT instance_reset.resettime IS NULL AND instance_reset.resettime < '" UI64FMTD "')", (uint64)t, (uint64)t);
+    _DelHelper(CharacterDatabase, "instance", "LEFT JOIN instance_reset ON mapid = map WHERE (instance.resettime < '" UI64FMTD "' AND instance.resettime > '0') OR (NOT instance_reset.resettime IS NULL AND instance_reset.resettime < '" UI64FMTD "')", (uint64)t, (uint64)t);
 }
 
 void MapPersistentStateManager::LoadCreatureRespawnTimes()
@@ -28,6 +28,7 @@
 #include "ace/Thread_Mutex.h"
 #include <list>
 #include <map>
+#include <mutex>
 #include "Utilities/UnorderedMapSet.h"
 #include "Database/DatabaseEnv.h"
 #include "DBCEnums.h"
@@ -55,6 +56,28 @@ struct MapCellObjectGuids
 
 typedef UNORDERED_MAP<uint32/*cell_id*/,MapCellObjectGuids> MapCellObjectGuidsMap;
 
+struct RespawnTimeWrite
+{
+    RespawnTimeWrite(uint32 _guid, time_t _time, uint32 _instance, uint32 _map) : guid(_guid), time(_time), instance(_instance), map(_map) {}
+
+    uint32 guid;
+    time_t time;                                            // row deleted when not in the future
+    uint32 instance;
+    uint32 map;
+};
+
+typedef std::vector<RespawnTimeWrite> RespawnTimeWrites;
+
+// Records of the respawn times journal (SaveRespawnTimeJournal), one per line
+enum RespawnJournalRecord
+{
+    RESPAWN_JOURNAL_CREATURE        = 'C',                  // C guid instance map respawntime
+    RESPAWN_JOURNAL_GAMEOBJECT      = 'G',                  // G guid instance map respawntime
+    RESPAWN_JOURNAL_DEL_INSTANCE    = 'I',                  // I instance: respawn rows of the instance deleted
+    RESPAWN_JOURNAL_DEL_MAP         = 'M',                  // M map: respawn rows of all instances of the map deleted
+    RESPAWN_JOURNAL_DEL_CREATURE    = 'D',                  // D guid: creature respawn rows deleted in all instances
+};
+
 class MapPersistentStateManager;
 
 class MapPersistentState
@@ -81,6 +104,8 @@ class MapPersistentState
         Map* GetMap() const { return m_usedByMap; }         // Can be NULL if map not loaded for persistent state
         void SetUsedByMapState(Map* map)
         {
+            if (!map)
+                FlushRespawnTimes();                        // nothing updates the state anymore
             m_usedByMap = map;
             if (!map)
                 UnloadIfEmpty();
@@ -99,6 +124,10 @@ class MapPersistentState
         }
         void SaveGORespawnTime(uint32 loguid, time_t t);
 
+        // Write-behind respawn times, flushed by the map update
+        void UpdateRespawnTimesFlush(uint32 diff);
+        void FlushRespawnTimes();
+
         // pool system
         void InitPools();
         SpawnedPoolData& GetSpawnedPoolData() { return m_spawnedPoolData; }
@@ -118,10 +147,12 @@ class MapPersistentState
         bool UnloadIfEmpty();
         void ClearRespawnTimes();
         bool HasRespawnTimes() const { return !m_creatureRespawnTimes.empty() || !m_goRespawnTimes.empty(); }
+        void ClearPendingRespawnTimes();
 
     private:
         void SetCreatureRespawnTime(uint32 loguid, time_t t);
         void SetGORespawnTime(uint32 loguid, time_t t);
+        bool CanDelayRespawnTimeSave() const;
 
     private:
         typedef UNORDERED_MAP<uint32, time_t> RespawnTimes;
@@ -136,6 +167,12 @@ class MapPersistentState
         MapCellObjectGuidsMap m_gridObjectGuids;            // Single map copy specific grid spawn data, like pool spawns
 
         SpawnedPoolData m_spawnedPoolData;                  // Pools spawns state for map copy
+
+        // respawn times not written to DB yet, last value only (cells may be updated by several threads)
+        RespawnTimes m_pendingCreatureRespawnTimes;
+        RespawnTimes m_pendingGORespawnTimes;
+        std::mutex m_pendingRespawnTimesLock;
+        uint32 m_respawnTimesFlushTimer;
 };
 
 inline bool MapPersistentState::CanBeUnload() const
@@ -323,6 +360,14 @@ class MANGOS_DLL_DECL MapPersistentStateManager : public MaNGOS::Singleton<MapPe
         void LoadCreatureRespawnTimes();
         void LoadGameobjectRespawnTimes();
 
+        // multi-row REPLACE / DELETE on `creature_respawn` or `gameobject_respawn`
+        static void ExecuteRespawnTimeWrites(char const* table, RespawnTimeWrites const& writes, bool direct);
+
+        // crash safety of the respawn times not flushed yet
+        void ReplayRespawnJournal();
+        void JournalRespawnTimes(RespawnTimeWrites const& creatures, RespawnTimeWrites const& gameobjects);
+        void JournalRespawnTimesRemoval(RespawnJournalRecord type, uint32 id);
+
         // auto select appropriate MapPersistentState (sub)class by MapEntry, and autoselect appropriate way store (by instance/map id)
         // always return != NULL
         MapPersistentState* AddPersistentState(MapEntry const* mapEntry, uint32 instanceId, time_t resetTime, bool canReset, bool load = false, bool initPools = true);
@@ -346,7 +391,7 @@ class MANGOS_DLL_DECL MapPersistentStateManager : public MaNGOS::Singleton<MapPe
 
         void GetStatistics(uint32& numStates, uint32& numBoundPlayers, uint32& numBoundGroups);
 
-        void Update() { m_Scheduler.Update(); }
+        void Update();
     protected:
         typedef UNORDERED_MAP<uint32 /*InstanceId or MapId*/, MapPersistentState*> PersistentStateMap;
 
@@ -356,7 +401,7 @@ class MANGOS_DLL_DECL MapPersistentStateManager : public MaNGOS::Singleton<MapPe
         void _CleanupExpiredInstancesAtTime(time_t t);
 
         void _ResetSave(PersistentStateMap& holder, PersistentStateMap::iterator &itr);
-        void _DelHelper(DatabaseType &db, const char *fields, const char *table, const char *queryTail,...);
+        void _DelHelper(DatabaseType &db, const char *table, const char *queryTail,...);
         // used during global instance resets
         bool lock_instLists;
         // fast lookup by instance id for instanceable maps
@@ -365,6 +410,11 @@ class MANGOS_DLL_DECL MapPersistentStateManager : public MaNGOS::Singleton<MapPe
         PersistentStateMap m_instanceSaveByMapId;
 
         DungeonResetScheduler m_Scheduler;
+
+        std::string m_respawnJournalPath;
+        FILE* m_respawnJournal;
+        std::mutex m_respawnJournalLock;
+        time_t m_respawnJournalRotateTime;
 };
 
 template<typename Do>
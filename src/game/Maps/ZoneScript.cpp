@@ -165,6 +165,7 @@ bool OPvPCapturePoint::DelCreature(uint32 type)
     //    map->Remove(cr,false);
     // delete respawn time for this creature
     CharacterDatabase.PExecute("DELETE FROM creature_respawn WHERE guid = '%u'", guid);
+    sMapPersistentStateMgr.JournalRespawnTimesRemoval(RESPAWN_JOURNAL_DEL_CREATURE, guid);
     cr->AddObjectToRemoveList();
     sObjectMgr.DeleteCreatureData(guid);
     m_CreatureTypes[m_Creatures[type]] = 0;
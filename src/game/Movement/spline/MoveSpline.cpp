@@ -17,6 +17,7 @@
  */
 
 #include "MoveSpline.h"
+#include "packet_builder.h"
 #include <sstream>
 #include "Log.h"
 #include "Unit.h"
@@ -147,6 +148,25 @@ void MoveSpline::Initialize(const MoveSplineInitArgs& args)
     last_point_sent_Idx = -1;
 
     init_spline(args);
+
+    std::atomic_store(&m_payload, MoveSplinePayloadPtr());
+}
+
+MoveSplinePayloadPtr MoveSpline::GetPayload() const
+{
+    // Stop splines are never serialized with their path
+    if (splineflags.done || !Initialized())
+        return MoveSplinePayloadPtr();
+
+    // Create blocks may be written by several visibility threads at once: a
+    // concurrent build only wastes work, the last published payload is identical.
+    MoveSplinePayloadPtr payload = std::atomic_load(&m_payload);
+    if (!payload)
+    {
+        payload = PacketBuilder::BuildPayload(*this);
+        std::atomic_store(&m_payload, payload);
+    }
+    return payload;
 }
 
 MoveSpline::MoveSpline() : m_Id(0), time_passed(0), point_Idx(0), point_Idx_offset(0), transportGuid(0), mvtOrigin("Unknown"), last_point_sent_Idx(-1)
@@ -21,6 +21,9 @@
 
 #include "spline.h"
 #include "MoveSplineInitArgs.h"
+#include "ByteBuffer.h"
+
+#include <memory>
 
 namespace Movement
 {
@@ -34,6 +37,19 @@ namespace Movement
         float orientation;
     };
 
+    // Immutable serialized path of an initialized spline. Built on the first send,
+    // then shared by every monster move / create block written for it until the next Initialize.
+    struct MoveSplinePayload
+    {
+        MoveSplinePayload(size_t monsterMoveSize, size_t createSize) :
+            monsterMovePath(monsterMoveSize), monsterMoveLastPoint(-1), createPath(createSize) {}
+
+        ByteBuffer monsterMovePath;                         // SMSG_MONSTER_MOVE path, starting at first point
+        int32 monsterMoveLastPoint;                         // last point written if the path was truncated, else -1
+        ByteBuffer createPath;                              // create block path and final destination
+    };
+    typedef std::shared_ptr<MoveSplinePayload const> MoveSplinePayloadPtr;
+
     // MoveSpline represents smooth catmullrom or linear curve and point that moves belong it
     // curve can be cyclic - in this case movement will be cyclic
     // point can have vertical acceleration motion componemt(used in fall, parabolic movement)
@@ -64,6 +80,7 @@ namespace Movement
             int32           last_point_sent_Idx;
             int32           point_Idx_offset;
             const char*     mvtOrigin; // For debug purposes
+            mutable MoveSplinePayloadPtr m_payload;         // published with atomic_load/atomic_store
 
             void init_spline(const MoveSplineInitArgs& args);
             UpdateResult _updateState(int32& ms_time_diff);
@@ -121,6 +138,9 @@ namespace Movement
             int32 Duration() const { return spline.length();}
             int32 Duration(int first, int last) const { return spline.length(first, last);}
 
+            // Serialized path of the spline, built on first use. Null for stop splines.
+            MoveSplinePayloadPtr GetPayload() const;
+
             std::string ToString() const;
             const char* GetMovementOrigin() const { return mvtOrigin; }
             void SetMovementOrigin(const char* m) { mvtOrigin = m; }
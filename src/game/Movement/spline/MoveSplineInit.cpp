@@ -169,7 +169,9 @@ int32 MoveSplineInit::Launch()
 
     // Clear client root here, after we've added it to the packet - STATE SHOULD NOT BE USED
     unit.clearUnitState(UNIT_STAT_CLIENT_ROOT);
-        
+
+    if (Map* map = unit.FindMap())
+        map->AddMonsterMovePacket(data.wpos());
     mvtData.AddPacket(data);
     // Do not forget to restore velocity after movement !
     if (args.velocity > 4 * realSpeedRun && !args.flags.done)
@@ -134,9 +134,12 @@ int PacketBuilder::WriteMonsterMove(const MoveSpline& move_spline, WorldPacket&
 
     const Spline<int32>& spline = move_spline.spline;
     MoveSplineFlag splineflags = move_spline.splineflags;
+    MoveSplinePayloadPtr payload = move_spline.GetPayload();
     if (splineflags & MoveSplineFlag::Mask_CatmullRom)
     {
-        if (splineflags.cyclic)
+        if (payload)
+            data.append(payload->monsterMovePath);
+        else if (splineflags.cyclic)
             WriteCatmullRomCyclicPath(spline, data);
         else
             WriteCatmullRomPath(spline, data);
@@ -144,7 +147,14 @@ int PacketBuilder::WriteMonsterMove(const MoveSpline& move_spline, WorldPacket&
     }
     else
     {
-        int32 lastNode = WriteLinearPath(spline, data, firstPoint);
+        int32 lastNode;
+        if (payload && firstPoint == 1)
+        {
+            data.append(payload->monsterMovePath);
+            lastNode = payload->monsterMoveLastPoint;
+        }
+        else
+            lastNode = WriteLinearPath(spline, data, firstPoint);
         uint32 duration = move_spline.Duration(0, lastNode >= 0 ? lastNode : move_spline.CountSplinePoints());
         data.put<uint32>(durationPos, duration - move_spline.time_passed);
         return lastNode;
@@ -172,12 +182,39 @@ void PacketBuilder::WriteCreate(const MoveSpline& move_spline, ByteBuffer& data)
         data << move_spline.Duration();
         data << move_spline.GetId();
 
-        uint32 nodes = move_spline.getPath().size();
-        data << nodes;
-        data.append<Vector3>(&move_spline.getPath()[0], nodes);
-        data << (move_spline.isCyclic() ? Vector3::zero() : move_spline.FinalDestination());
+        if (MoveSplinePayloadPtr payload = move_spline.GetPayload())
+            data.append(payload->createPath);
+        else
+        {
+            uint32 nodes = move_spline.getPath().size();
+            data << nodes;
+            data.append<Vector3>(&move_spline.getPath()[0], nodes);
+            data << (move_spline.isCyclic() ? Vector3::zero() : move_spline.FinalDestination());
+        }
     }
+}
+
+MoveSplinePayloadPtr PacketBuilder::BuildPayload(const MoveSpline& move_spline)
+{
+    const Spline<int32>& spline = move_spline.spline;
+    MoveSplineFlag splineflags = move_spline.splineflags;
+    uint32 nodes = move_spline.getPath().size();
+
+    std::shared_ptr<MoveSplinePayload> payload = std::make_shared<MoveSplinePayload>(4 + nodes * sizeof(Vector3), 4 + (nodes + 1) * sizeof(Vector3));
+    if (splineflags & MoveSplineFlag::Mask_CatmullRom)
+    {
+        if (splineflags.cyclic)
+            WriteCatmullRomCyclicPath(spline, payload->monsterMovePath);
+        else
+            WriteCatmullRomPath(spline, payload->monsterMovePath);
+    }
+    else
+        payload->monsterMoveLastPoint = WriteLinearPath(spline, payload->monsterMovePath, 1);
 
+    payload->createPath << nodes;
+    payload->createPath.append<Vector3>(&move_spline.getPath()[0], nodes);
+    payload->createPath << (move_spline.isCyclic() ? Vector3::zero() : move_spline.FinalDestination());
 
+    return payload;
 }
 }
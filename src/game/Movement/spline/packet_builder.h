@@ -20,12 +20,15 @@
 #ifndef MANGOSSERVER_PACKET_BUILDER_H
 #define MANGOSSERVER_PACKET_BUILDER_H
 
+#include <memory>
+
 class ByteBuffer;
 class WorldPacket;
 
 namespace Movement
 {
     class MoveSpline;
+    struct MoveSplinePayload;
     class PacketBuilder
     {
             static void WriteCommonMonsterMovePart(const MoveSpline& mov, WorldPacket& data);
@@ -33,6 +36,7 @@ namespace Movement
 
             static int WriteMonsterMove(const MoveSpline& mov, WorldPacket& data, int firstPoint = 1);
             static void WriteCreate(const MoveSpline& mov, ByteBuffer& data);
+            static std::shared_ptr<MoveSplinePayload const> BuildPayload(const MoveSpline& mov);
     };
 }
 #endif // MANGOSSERVER_PACKET_BUILDER_H
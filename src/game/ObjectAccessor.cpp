@@ -33,6 +33,7 @@
 #include "GridNotifiersImpl.h"
 #include "ObjectGuid.h"
 #include "World.h"
+#include "WhoListIndex.h"
 
 #include <cmath>
 
@@ -355,9 +356,11 @@ void ObjectAccessor::AddObject(Player *player)
 {
     HashMapHolder<Player>::Insert(player);
     playerNameToPlayerPointer[player->GetName()] = player;
+    sWhoListIndex.AddPlayer(player);
 }
 void ObjectAccessor::RemoveObject(Player *player)
 {
+    sWhoListIndex.RemovePlayer(player);
     HashMapHolder<Player>::Remove(player);
     playerNameToPlayerPointer.erase(player->GetName());
 }
@@ -1162,7 +1162,7 @@ void WorldObject::SetVisibilityModifier(float f)
 
 WorldObject::WorldObject()
     :   m_isActiveObject(false), m_currMap(nullptr), m_mapId(0), m_InstanceId(0), m_lootAndXPRangeModifier(0),
-        m_visibilityModifier(DEFAULT_VISIBILITY_MODIFIER)
+        m_visibilityModifier(DEFAULT_VISIBILITY_MODIFIER), m_skippedUpdateTime(0)
 {
     // Phasing
     worldMask = WORLD_DEFAULT_OBJECT;
@@ -893,6 +893,11 @@ m_obj->m_updateTracker.Reset();
         bool isActiveObject() const { return m_isActiveObject || m_viewPoint.hasViewers(); }
         void SetActiveObjectState(bool on);
 
+        // Time of the updates skipped by the map, given back at next update
+        void AddSkippedUpdateTime(uint32 t) { m_skippedUpdateTime += t; }
+        uint32 GetSkippedUpdateTime() const { return m_skippedUpdateTime; }
+        void ResetSkippedUpdateTime() { m_skippedUpdateTime = 0; }
+
         ViewPoint& GetViewPoint() { return m_viewPoint; }
 
         // WorldMask
@@ -942,6 +947,7 @@ m_obj->m_updateTracker.Reset();
         ViewPoint m_viewPoint;
 
         WorldUpdateCounter m_updateTracker;
+        uint32 m_skippedUpdateTime;
         
         float m_lootAndXPRangeModifier;
 };
@@ -82,6 +82,9 @@
 #include "MovementBroadcaster.h"
 #include "PlayerBroadcaster.h"
 #include "GameEventMgr.h"
+#include "WhoListIndex.h"
+#include "CharacterEnumCache.h"
+#include "CharacterDatabaseCache.h"
 #include "world/world_event_naxxramas.h"
 
 #define ZONE_UPDATE_INTERVAL (1*IN_MILLISECONDS)
@@ -575,7 +578,6 @@ Player::Player(WorldSession *session) : Unit(),
     m_petEntry = 0;
     m_petSpell = 0;
     m_areaCheckTimer = 0;
-    m_skippedUpdateTime = 0;
     m_DetectInvTimer = 1 * IN_MILLISECONDS;
 
     // GM variables
@@ -1605,56 +1607,43 @@ void Player::AutoReSummonPet()
 }
 
 
-bool Player::BuildEnumData(QueryResult * result, WorldPacket * p_data)
+bool Player::BuildEnumData(CharacterEnumData const& enumData, WorldPacket* p_data)
 {
-    //             0               1                2                3                 4                  5                       6                        7
-    //    "SELECT characters.guid, characters.name, characters.race, characters.class, characters.gender, characters.playerBytes, characters.playerBytes2, characters.level, "
-    //     8                9               10                     11                     12                     13                    14
-    //    "characters.zone, characters.map, characters.position_x, characters.position_y, characters.position_z, guild_member.guildid, characters.playerFlags, "
-    //    15                    16                   17                     18                   19
-    //    "characters.at_login, character_pet.entry, character_pet.modelid, character_pet.level, characters.equipmentCache "
-
-    Field *fields = result->Fetch();
-
-    uint32 guid = fields[0].GetUInt32();
-    uint8 pRace = fields[2].GetUInt8();
-    uint8 pClass = fields[3].GetUInt8();
-
-    PlayerInfo const *info = sObjectMgr.GetPlayerInfo(pRace, pClass);
+    PlayerInfo const *info = sObjectMgr.GetPlayerInfo(enumData.race, enumData.classId);
     if (!info)
     {
-        sLog.outError("Player %u has incorrect race/class pair. Don't build enum.", guid);
+        sLog.outError("Player %u has incorrect race/class pair. Don't build enum.", enumData.guid);
         return false;
     }
 
-    *p_data << ObjectGuid(HIGHGUID_PLAYER, guid);
-    *p_data << fields[1].GetString();                       // name
-    *p_data << uint8(pRace);                                // race
-    *p_data << uint8(pClass);                               // class
-    *p_data << uint8(fields[4].GetUInt8());                 // gender
+    *p_data << ObjectGuid(HIGHGUID_PLAYER, enumData.guid);
+    *p_data << enumData.name;                               // name
+    *p_data << uint8(enumData.race);                        // race
+    *p_data << uint8(enumData.classId);                     // class
+    *p_data << uint8(enumData.gender);                      // gender
 
-    uint32 playerBytes = fields[5].GetUInt32();
+    uint32 playerBytes = enumData.playerBytes;
     *p_data << uint8(playerBytes);                          // skin
     *p_data << uint8(playerBytes >> 8);                     // face
     *p_data << uint8(playerBytes >> 16);                    // hair style
     *p_data << uint8(playerBytes >> 24);                    // hair color
 
-    uint32 playerBytes2 = fields[6].GetUInt32();
+    uint32 playerBytes2 = enumData.playerBytes2;
     *p_data << uint8(playerBytes2 & 0xFF);                  // facial hair
 
-    *p_data << uint8(fields[7].GetUInt8());                 // level
-    *p_data << uint32(fields[8].GetUInt32());               // zone
-    *p_data << uint32(fields[9].GetUInt32());               // map
+    *p_data << uint8(enumData.level);                       // level
+    *p_data << uint32(enumData.zone);                       // zone
+    *p_data << uint32(enumData.map);                        // map
 
-    *p_data << fields[10].GetFloat();                       // x
-    *p_data << fields[11].GetFloat();                       // y
-    *p_data << fields[12].GetFloat();                       // z
+    *p_data << enumData.x;                                  // x
+    *p_data << enumData.y;                                  // y
+    *p_data << enumData.z;                                  // z
 
-    *p_data << uint32(fields[13].GetUInt32());              // guild id
+    *p_data << uint32(enumData.guildId);                    // guild id
 
     uint32 char_flags = 0;
-    uint32 playerFlags = fields[14].GetUInt32();
-    uint32 atLoginFlags = fields[15].GetUInt32();
+    uint32 playerFlags = enumData.playerFlags;
+    uint32 atLoginFlags = enumData.atLoginFlags;
     if (playerFlags & PLAYER_FLAGS_HIDE_HELM)
         char_flags |= CHARACTER_FLAG_HIDE_HELM;
     if (playerFlags & PLAYER_FLAGS_HIDE_CLOAK)
@@ -1676,14 +1665,13 @@ bool Player::BuildEnumData(QueryResult * result, WorldPacket * p_data)
         uint32 petFamily  = 0;
 
         // show pet at selection character in character list only for non-ghost character
-        if (result && !(playerFlags & PLAYER_FLAGS_GHOST) && (pClass == CLASS_WARLOCK || pClass == CLASS_HUNTER))
+        if (!(playerFlags & PLAYER_FLAGS_GHOST) && (enumData.classId == CLASS_WARLOCK || enumData.classId == CLASS_HUNTER))
         {
-            uint32 entry = fields[16].GetUInt32();
-            CreatureInfo const* cInfo = sCreatureStorage.LookupEntry<CreatureInfo>(entry);
+            CreatureInfo const* cInfo = sCreatureStorage.LookupEntry<CreatureInfo>(enumData.petEntry);
             if (cInfo)
             {
-                petDisplayId = fields[17].GetUInt32();
-                petLevel     = fields[18].GetUInt32();
+                petDisplayId = enumData.petModelId;
+                petLevel     = enumData.petLevel;
                 petFamily    = cInfo->family;
             }
         }
@@ -1694,7 +1682,7 @@ bool Player::BuildEnumData(QueryResult * result, WorldPacket * p_data)
     }
 
 
-    Tokens data = StrSplit(fields[19].GetCppString(), " ");
+    Tokens data = StrSplit(enumData.equipmentCache, " ");
     for (uint8 slot = 0; slot < EQUIPMENT_SLOT_END; slot++)
     {
         uint32 visualbase = slot * 2;                       // entry, perm ench., temp ench.
@@ -1716,6 +1704,40 @@ bool Player::BuildEnumData(QueryResult * result, WorldPacket * p_data)
     return true;
 }
 
+void Player::GetEnumData(CharacterEnumData& enumData) const
+{
+    enumData.guid = GetGUIDLow();
+    enumData.name = m_name;
+    enumData.race = getRace();
+    enumData.classId = getClass();
+    enumData.gender = getGender();
+    enumData.level = getLevel();
+    enumData.playerBytes = GetUInt32Value(PLAYER_BYTES);
+    enumData.playerBytes2 = GetUInt32Value(PLAYER_BYTES_2);
+    enumData.zone = IsInWorld() ? GetZoneId() : GetCachedZoneId();
+
+    WorldLocation location = _GetSavedLocation();
+    enumData.map = location.mapid;
+    enumData.x = location.coord_x;
+    enumData.y = location.coord_y;
+    enumData.z = location.coord_z;
+
+    enumData.guildId = GetGuildId();
+    enumData.playerFlags = _GetSavedPlayerFlags();
+    enumData.atLoginFlags = m_atLoginFlags;
+
+    // character_pet in PET_SAVE_AS_CURRENT slot
+    enumData.petEntry = enumData.petModelId = enumData.petLevel = 0;
+    if (CharacterPetCache const* pet = sCharacterDatabaseCache.GetCharacterCurrentPet(GetGUIDLow()))
+    {
+        enumData.petEntry = pet->entry;
+        enumData.petModelId = pet->modelid;
+        enumData.petLevel = pet->level;
+    }
+
+    enumData.equipmentCache = _GetSavedEquipmentCache();
+}
+
 bool Player::ToggleAFK()
 {
     ToggleFlag(PLAYER_FLAGS, PLAYER_FLAGS_AFK);
@@ -4111,6 +4133,8 @@ TrainerSpellState Player::GetTrainerSpellState(TrainerSpell const* trainer_spell
  */
 void Player::DeleteFromDB(ObjectGuid playerguid, uint32 accountId, bool updateRealmChars, bool deleteFinally)
 {
+    sCharacterEnumCache.InvalidateAccount(accountId ? accountId : sObjectMgr.GetPlayerAccountIdByGUID(playerguid));
+
     // for nonexistent account avoid update realm
     if (accountId == 0)
         updateRealmChars = false;
@@ -6172,6 +6196,12 @@ void Player::RewardReputation(Quest const *pQuest)
     // TODO: implement reputation spillover
 }
 
+void Player::SetInGuild(uint32 GuildId)
+{
+    SetUInt32Value(PLAYER_GUILDID, GuildId);
+    sWhoListIndex.UpdateGuild(this);
+}
+
 uint32 Player::GetGuildIdFromDB(ObjectGuid guid)
 {
     uint32 lowguid = guid.GetCounter();
@@ -6224,7 +6254,10 @@ uint32 Player::GetZoneIdFromDB(ObjectGuid guid)
         zone = sTerrainMgr.GetZoneId(map, posx, posy, posz);
 
         if (zone > 0)
+        {
             CharacterDatabase.PExecute("UPDATE characters SET zone='%u' WHERE guid='%u'", zone, lowguid);
+            sCharacterEnumCache.InvalidateAccount(sObjectMgr.GetPlayerAccountIdByGUID(guid));
+        }
     }
 
     return zone;
@@ -6330,6 +6363,9 @@ void Player::UpdateZone(uint32 newZone, uint32 newArea)
     m_zoneUpdateId    = newZone;
     m_zoneUpdateTimer = ZONE_UPDATE_INTERVAL;
 
+    if (oldZoneId != newZone)
+        sWhoListIndex.UpdateZone(this);
+
     // zone changed, so area changed as well, update it
     UpdateArea(newArea);
 
@@ -14209,6 +14245,7 @@ bool Player::LoadFromDB(ObjectGuid guid, SqlQueryHolder *holder)
     {
         CharacterDatabase.PExecute("UPDATE characters SET at_login = at_login | '%u' WHERE guid ='%u'",
                                    uint32(AT_LOGIN_RENAME), guid.GetCounter());
+        sCharacterEnumCache.InvalidateAccount(GetSession()->GetAccountId());
         return false;
     }
 
@@ -15651,30 +15688,14 @@ void Player::SaveToDB(bool online, bool force)
     uberInsert.addUInt32(GetUInt32Value(PLAYER_BYTES));
     uberInsert.addUInt32(GetUInt32Value(PLAYER_BYTES_2));
 
-    // Nostalrius: fix retrait flag PvP a la deco reco.
-    uint32 playerFlags = GetUInt32Value(PLAYER_FLAGS) & ~(PLAYER_FLAGS_IN_PVP | PLAYER_FLAGS_PVP_TIMER);
-    if (IsPvP())
-        playerFlags |= PLAYER_FLAGS_IN_PVP;
-    if (pvpInfo.endTimer)
-        playerFlags |= PLAYER_FLAGS_PVP_TIMER;
-    uberInsert.addUInt32(playerFlags);
+    uberInsert.addUInt32(_GetSavedPlayerFlags());
 
-    if (!IsBeingTeleported())
-    {
-        uberInsert.addUInt32(GetMapId());
-        uberInsert.addFloat(finiteAlways(GetPositionX()));
-        uberInsert.addFloat(finiteAlways(GetPositionY()));
-        uberInsert.addFloat(finiteAlways(GetPositionZ()));
-        uberInsert.addFloat(MapManager::NormalizeOrientation(finiteAlways(GetOrientation())));
-    }
-    else
-    {
-        uberInsert.addUInt32(GetTeleportDest().mapid);
-        uberInsert.addFloat(finiteAlways(GetTeleportDest().coord_x));
-        uberInsert.addFloat(finiteAlways(GetTeleportDest().coord_y));
-        uberInsert.addFloat(finiteAlways(GetTeleportDest().coord_z));
-        uberInsert.addFloat(MapManager::NormalizeOrientation(finiteAlways(GetTeleportDest().orientation)));
-    }
+    WorldLocation location = _GetSavedLocation();
+    uberInsert.addUInt32(location.mapid);
+    uberInsert.addFloat(location.coord_x);
+    uberInsert.addFloat(location.coord_y);
+    uberInsert.addFloat(location.coord_z);
+    uberInsert.addFloat(location.orientation);
 
     std::ostringstream ss;
     ss << m_taxi;                                   // string with TaxiMaskSize numbers
@@ -15742,15 +15763,7 @@ void Player::SaveToDB(bool online, bool force)
         ss << GetUInt32Value(PLAYER_EXPLORED_ZONES_1 + i) << " ";
     uberInsert.addString(ss);
 
-    for (uint32 i = 0; i < EQUIPMENT_SLOT_END; ++i)         //string: item id, ench (perm/temp)
-    {
-        ss << GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET) << " ";
-
-        uint32 ench1 = GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET + 1 + PERM_ENCHANTMENT_SLOT);
-        uint32 ench2 = GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET + 1 + TEMP_ENCHANTMENT_SLOT);
-        ss << uint32(MAKE_PAIR32(ench1, ench2)) << " ";
-    }
-    uberInsert.addString(ss);
+    uberInsert.addString(_GetSavedEquipmentCache());
 
     uberInsert.addUInt32(GetUInt32Value(PLAYER_AMMO_ID));
 
@@ -15790,6 +15803,43 @@ void Player::SaveToDB(bool online, bool force)
         data->uiLevel = getLevel();
         data->uiZoneId = GetCachedZoneId();
     }
+    sCharacterEnumCache.UpdateCharacter(this);
+}
+
+uint32 Player::_GetSavedPlayerFlags() const
+{
+    // Nostalrius: fix retrait flag PvP a la deco reco.
+    uint32 playerFlags = GetUInt32Value(PLAYER_FLAGS) & ~(PLAYER_FLAGS_IN_PVP | PLAYER_FLAGS_PVP_TIMER);
+    if (IsPvP())
+        playerFlags |= PLAYER_FLAGS_IN_PVP;
+    if (pvpInfo.endTimer)
+        playerFlags |= PLAYER_FLAGS_PVP_TIMER;
+    return playerFlags;
+}
+
+WorldLocation Player::_GetSavedLocation() const
+{
+    if (!IsBeingTeleported())
+        return WorldLocation(GetMapId(), finiteAlways(GetPositionX()), finiteAlways(GetPositionY()), finiteAlways(GetPositionZ()),
+                             MapManager::NormalizeOrientation(finiteAlways(GetOrientation())));
+
+    WorldLocation const& dest = m_teleport_dest;
+    return WorldLocation(dest.mapid, finiteAlways(dest.coord_x), finiteAlways(dest.coord_y), finiteAlways(dest.coord_z),
+                         MapManager::NormalizeOrientation(finiteAlways(dest.orientation)));
+}
+
+std::string Player::_GetSavedEquipmentCache() const
+{
+    std::ostringstream ss;
+    for (uint32 i = 0; i < EQUIPMENT_SLOT_END; ++i)         //string: item id, ench (perm/temp)
+    {
+        ss << GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET) << " ";
+
+        uint32 ench1 = GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET + 1 + PERM_ENCHANTMENT_SLOT);
+        uint32 ench2 = GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET + 1 + TEMP_ENCHANTMENT_SLOT);
+        ss << uint32(MAKE_PAIR32(ench1, ench2)) << " ";
+    }
+    return ss.str();
 }
 
 // fast save function for item/money cheating preventing - save only inventory and money state
@@ -16255,6 +16305,7 @@ void Player::SavePositionInDB(ObjectGuid guid, uint32 mapid, float x, float y, f
        << "transguid='0',taxi_path='' WHERE guid='" << guid.GetCounter() << "'";
     DEBUG_LOG("%s", ss.str().c_str());
     CharacterDatabase.Execute(ss.str().c_str());
+    sCharacterEnumCache.InvalidateAccount(sObjectMgr.GetPlayerAccountIdByGUID(guid));
 }
 
 void Player::SendAttackSwingDeadTarget()
@@ -19616,7 +19667,10 @@ void Player::RemoveAtLoginFlag(AtLoginFlags f, bool in_db_also /*= false*/)
     m_atLoginFlags &= ~f;
 
     if (in_db_also)
+    {
         CharacterDatabase.PExecute("UPDATE characters set at_login = at_login & ~ %u WHERE guid ='%u'", uint32(f), GetGUIDLow());
+        sCharacterEnumCache.InvalidateAccount(GetSession()->GetAccountId());
+    }
 }
 
 void Player::SendClearCooldown(uint32 spell_id, Unit* target)
@@ -20565,14 +20619,14 @@ void Player::HandleStealthedUnitsDetection()
     if (!FindMap())
         return;
 
-    std::list<Unit*> stealthedUnits;
+    MaNGOS::GridSearchResults<Unit> stealthedUnits;
 
     MaNGOS::AnyStealthedCheck u_check(this);
-    MaNGOS::UnitListSearcher<MaNGOS::AnyStealthedCheck > searcher(stealthedUnits, u_check);
+    MaNGOS::UnitListSearcher<MaNGOS::AnyStealthedCheck, MaNGOS::GridSearchResults<Unit> > searcher(stealthedUnits, u_check);
     Cell::VisitAllObjects(this, searcher, sWorld.getConfig(CONFIG_FLOAT_MAX_PLAYERS_STEALTH_DETECT_RANGE));
 
     WorldObject const* viewPoint = GetCamera().GetBody();
-    for (std::list<Unit*>::const_iterator i = stealthedUnits.begin(); i != stealthedUnits.end(); ++i)
+    for (MaNGOS::GridSearchResults<Unit>::const_iterator i = stealthedUnits.begin(); i != stealthedUnits.end(); ++i)
     {
         if ((*i) == this)
             continue;
@@ -63,6 +63,7 @@ class ZoneScript;
 class PlayerAI;
 class NodeSession;
 class PlayerBroadcaster;
+struct CharacterEnumData;
 
 #define PLAYER_MAX_SKILLS           127
 #define PLAYER_EXPLORED_ZONES_SIZE  64
@@ -900,7 +901,9 @@ class MANGOS_DLL_SPEC Player final: public Unit
         void SetTransport(Transport * t) override;
         void DismountCheck();
 
-        static bool BuildEnumData( QueryResult * result,  WorldPacket * p_data );
+        static bool BuildEnumData(CharacterEnumData const& enumData, WorldPacket* p_data);
+        // Characters screen data, as written by SaveToDB
+        void GetEnumData(CharacterEnumData& enumData) const;
 
         // knockback/jumping states
         bool IsLaunched() { return launched; }
@@ -1531,7 +1534,7 @@ class MANGOS_DLL_SPEC Player final: public Unit
         void RemoveFromGroup() { RemoveFromGroup(GetGroup(), GetObjectGuid()); }
         void SendUpdateToOutOfRangeGroupMembers();
 
-        void SetInGuild(uint32 GuildId) { SetUInt32Value(PLAYER_GUILDID, GuildId); }
+        void SetInGuild(uint32 GuildId);
         void SetRank(uint32 rankId){ SetUInt32Value(PLAYER_GUILDRANK, rankId); }
         void SetGuildIdInvited(uint32 GuildId) { m_GuildIdInvited = GuildId; }
         uint32 GetGuildId() const { return GetUInt32Value(PLAYER_GUILDID);  }
@@ -2009,6 +2012,7 @@ class MANGOS_DLL_SPEC Player final: public Unit
         Camera& GetCamera() { return m_camera; }
 
         bool HasAtLoginFlag(AtLoginFlags f) const { return m_atLoginFlags & f; }
+        uint32 GetAtLoginFlags() const { return m_atLoginFlags; }
         void SetAtLoginFlag(AtLoginFlags f) { m_atLoginFlags |= f; }
         void RemoveAtLoginFlag(AtLoginFlags f, bool in_db_also = false);
 
@@ -2153,13 +2157,9 @@ class MANGOS_DLL_SPEC Player final: public Unit
         void SetAutoInstanceSwitch(bool v) { m_enableInstanceSwitch = v; }
     protected:
         bool   m_enableInstanceSwitch;
-        uint32 m_skippedUpdateTime;
         uint32 m_DetectInvTimer;
 
     public:
-        void AddSkippedUpdateTime(uint32 t) { m_skippedUpdateTime += t; }
-        uint32 GetSkippedUpdateTime() const { return m_skippedUpdateTime; }
-        void ResetSkippedUpdateTime() { m_skippedUpdateTime = 0; }
         uint32 GetGMInvisibilityLevel() const { return m_gmInvisibilityLevel; }
         void SetGMInvisibilityLevel(uint32 level) { m_gmInvisibilityLevel = level; }
         uint32 GetGMTicketCounter() const { return m_currentTicketCounter; }
@@ -2238,6 +2238,9 @@ class MANGOS_DLL_SPEC Player final: public Unit
         void _SaveSpells();
         void _SaveBGData();
         void _SaveStats();
+        uint32 _GetSavedPlayerFlags() const;
+        WorldLocation _GetSavedLocation() const;
+        std::string _GetSavedEquipmentCache() const;
 
         void _SetCreateBits(UpdateMask *updateMask, Player *target) const;
         void _SetUpdateBits(UpdateMask *updateMask, Player *target) const;
@@ -2458,6 +2461,10 @@ public:
          */
         bool WakeUp();
 protected:
+        friend class PlayerSnapshot;
+
+        template <typename OP>
+        void SerializeFields(OP& buf);
         template <typename OP>
         void SerializeAuras(OP& buf);
         template <typename OP>
@@ -63,6 +63,7 @@
 #include "Anticheat.h"
 #include "CreatureLinkingMgr.h"
 #include "InstanceStatistics.h"
+#include "WhoListIndex.h"
 
 #include <math.h>
 #include <stdarg.h>
@@ -192,6 +193,8 @@ Unit::Unit()
         m_speed_rate[i] = 1.0f;
 
     m_charmInfo = nullptr;
+    m_procHolderIndex = nullptr;
+    m_auraModifierCache = nullptr;
 
     // remove aurastates allowing special moves
     for (int i = 0; i < MAX_REACTIVE; ++i)
@@ -229,6 +232,8 @@ Unit::~Unit()
 
     delete m_charmInfo;
     delete movespline;
+    delete m_procHolderIndex;
+    delete[] m_auraModifierCache.load();
 
     // those should be already removed at "RemoveFromWorld()" call
     MANGOS_ASSERT(m_gameObj.size() == 0);
@@ -2278,6 +2283,7 @@ void Unit::CalculateDamageAbsorbAndResist(Unit *pCaster, SpellSchoolMask schoolM
         mod->m_amount -= currentAbsorb;
         if ((*i)->GetHolder()->DropAuraCharge())
             mod->m_amount = 0;
+        InvalidateAuraModifierCache(mod->m_auraname);
         // Need remove it later
         if (mod->m_amount <= 0)
             existExpired = true;
@@ -2329,6 +2335,7 @@ void Unit::CalculateDamageAbsorbAndResist(Unit *pCaster, SpellSchoolMask schoolM
         }
 
         (*i)->GetModifier()->m_amount -= currentAbsorb;
+        InvalidateAuraModifierCache(SPELL_AURA_MANA_SHIELD);
         if ((*i)->GetModifier()->m_amount <= 0)
         {
             RemoveAurasDueToSpell((*i)->GetId());
@@ -3731,8 +3738,98 @@ void Unit::DeMorph()
     SetDisplayId(GetNativeDisplayId());
 }
 
+bool Unit::GetAuraModifierValues(AuraType auratype, uint32 misc_mask, AuraModifierValues& values) const
+{
+    AuraModifierCache* caches = m_auraModifierCache.load(std::memory_order_acquire);
+    AuraList const& mTotalAuraList = GetAurasByType(auratype);
+    if (!caches || mTotalAuraList.size() < AURA_MODIFIER_CACHE_MIN_AURAS)
+        return false;
+
+    AuraModifierCache& cache = caches[auratype];
+    uint32 sequence = cache.sequence.load(std::memory_order_acquire);
+    bool valid = false;
+    if (!(sequence & 1))
+    {
+        values = cache.values;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        valid = values.sequence == sequence && cache.sequence.load(std::memory_order_relaxed) == sequence;
+        if (valid && (!misc_mask || (values.miscMaskValid && values.miscMask == misc_mask)))
+            return true;
+    }
+
+    // Same rules as the list walks below
+    if (!valid)
+    {
+        values = AuraModifierValues();
+        for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
+        {
+            int32 amount = (*i)->GetModifier()->m_amount;
+            if ((*i)->GetId() != 2836)
+                values.total += amount;
+            values.multiplier *= (100.0f + amount) / 100.0f;
+            if (amount > values.maxPositive)
+                values.maxPositive = amount;
+            if (amount < values.maxNegative)
+                values.maxNegative = amount;
+        }
+    }
+
+    if (misc_mask)
+    {
+        values.miscMaskValid = true;
+        values.miscMask = misc_mask;
+        values.miscMaskTotal = 0;
+        values.miscMaskMultiplier = 1.0f;
+        for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
+        {
+            Modifier* mod = (*i)->GetModifier();
+            if (mod->m_miscvalue & misc_mask)
+            {
+                values.miscMaskTotal += mod->m_amount;
+                values.miscMaskMultiplier *= (100.0f + mod->m_amount) / 100.0f;
+            }
+        }
+    }
+
+    // Publish, unless an aura changed or another reader published since the values were read.
+    // An invalidation during the copy leaves the sequence different from the one stamped.
+    if (!(sequence & 1) && cache.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire))
+    {
+        std::atomic_thread_fence(std::memory_order_release);
+        values.sequence = sequence + 2;
+        cache.values = values;
+        cache.sequence.fetch_add(1, std::memory_order_release);
+    }
+    return true;
+}
+
+void Unit::InvalidateAuraModifierCache(AuraType auratype)
+{
+    if (auratype >= TOTAL_AURAS)
+        return;
+
+    AuraModifierCache* caches = m_auraModifierCache.load(std::memory_order_acquire);
+    if (!caches)
+    {
+        if (GetAurasByType(auratype).size() < AURA_MODIFIER_CACHE_MIN_AURAS)
+            return;
+
+        // Absorbs may change amounts from the attacker thread too
+        AuraModifierCache* allocated = new AuraModifierCache[TOTAL_AURAS];
+        if (!m_auraModifierCache.compare_exchange_strong(caches, allocated, std::memory_order_acq_rel))
+            delete[] allocated;
+        return;
+    }
+
+    caches[auratype].sequence.fetch_add(2, std::memory_order_release);
+}
+
 int32 Unit::GetTotalAuraModifier(AuraType auratype) const
 {
+    AuraModifierValues cached;
+    if (GetAuraModifierValues(auratype, 0, cached))
+        return cached.total;
+
     int32 modifier = 0;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
@@ -3750,6 +3847,10 @@ int32 Unit::GetTotalAuraModifier(AuraType auratype) const
 
 float Unit::GetTotalAuraMultiplier(AuraType auratype) const
 {
+    AuraModifierValues cached;
+    if (GetAuraModifierValues(auratype, 0, cached))
+        return cached.multiplier;
+
     float multiplier = 1.0f;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
@@ -3761,6 +3862,10 @@ float Unit::GetTotalAuraMultiplier(AuraType auratype) const
 
 int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype) const
 {
+    AuraModifierValues cached;
+    if (GetAuraModifierValues(auratype, 0, cached))
+        return cached.maxPositive;
+
     int32 modifier = 0;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
@@ -3773,6 +3878,10 @@ int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype) const
 
 int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype) const
 {
+    AuraModifierValues cached;
+    if (GetAuraModifierValues(auratype, 0, cached))
+        return cached.maxNegative;
+
     int32 modifier = 0;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
@@ -3788,6 +3897,10 @@ int32 Unit::GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask)
     if (!misc_mask)
         return 0;
 
+    AuraModifierValues cached;
+    if (GetAuraModifierValues(auratype, misc_mask, cached))
+        return cached.miscMaskTotal;
+
     int32 modifier = 0;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
@@ -3805,6 +3918,10 @@ float Unit::GetTotalAuraMultiplierByMiscMask(AuraType auratype, uint32 misc_mask
     if (!misc_mask)
         return 1.0f;
 
+    AuraModifierValues cached;
+    if (GetAuraModifierValues(auratype, misc_mask, cached))
+        return cached.miscMaskMultiplier;
+
     float multiplier = 1.0f;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
@@ -4072,6 +4189,7 @@ bool Unit::AddSpellAuraHolder(SpellAuraHolder *holder)
     }
     // add aura, register in lists and arrays
     m_spellAuraHolders.insert(SpellAuraHolderMap::value_type(holder->GetId(), holder));
+    AddToProcHolderIndex(holder);
 
     for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
         if (Aura *aur = holder->GetAuraByEffectIndex(SpellEffectIndex(i)))
@@ -4143,7 +4261,10 @@ bool Unit::RemoveAuraDueToDebuffLimit(SpellAuraHolder* currentAura)
 void Unit::AddAuraToModList(Aura *aura)
 {
     if (aura->GetModifier()->m_auraname < TOTAL_AURAS)
+    {
         m_modAuras[aura->GetModifier()->m_auraname].push_back(aura);
+        InvalidateAuraModifierCache(aura->GetModifier()->m_auraname);
+    }
 }
 
 void Unit::RemoveRankAurasDueToSpell(uint32 spellId)
@@ -4695,6 +4816,7 @@ void Unit::RemoveSpellAuraHolder(SpellAuraHolder *holder, AuraRemoveMode mode)
         if (itr->second == holder)
         {
             m_spellAuraHolders.erase(itr);
+            RemoveFromProcHolderIndex(holder);
             foundInMap = true;
             break;
         }
@@ -4762,7 +4884,10 @@ void Unit::RemoveAura(Aura *Aur, AuraRemoveMode mode)
 {
     // remove from list before mods removing (prevent cyclic calls, mods added before including to aura list - use reverse order)
     if (Aur->GetModifier()->m_auraname < TOTAL_AURAS)
+    {
         m_modAuras[Aur->GetModifier()->m_auraname].remove(Aur);
+        InvalidateAuraModifierCache(Aur->GetModifier()->m_auraname);
+    }
 
     // Set remove mode
     Aur->SetRemoveMode(mode);
@@ -8772,6 +8897,9 @@ void Unit::SetLevel(uint32 lvl)
 {
     SetUInt32Value(UNIT_FIELD_LEVEL, lvl);
 
+    if (GetTypeId() == TYPEID_PLAYER)
+        sWhoListIndex.UpdateLevel((Player*)this);
+
     // group update
     if ((GetTypeId() == TYPEID_PLAYER) && ((Player*)this)->GetGroup())
         ((Player*)this)->SetGroupUpdateFlag(GROUP_UPDATE_FLAG_LEVEL);
@@ -8947,6 +9075,7 @@ void Unit::ApplyAuraProcTriggerDamage(Aura* aura, bool apply)
         tAuraProcTriggerDamage.push_back(aura);
     else
         tAuraProcTriggerDamage.remove(aura);
+    InvalidateAuraModifierCache(SPELL_AURA_PROC_TRIGGER_DAMAGE);
 }
 
 uint32 Unit::GetCreatePowers(Powers power) const
@@ -9437,22 +9566,25 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* pTarget, uint32 procFlag,
     }
     DEBUG_UNIT(this, DEBUG_PROCS, "PROC: Flags 0x%.5x Ex 0x%.3x Spell %5u %s", procFlag, procExtra, procSpell ? procSpell->Id : 0, isVictim ? "[victim]" : "");
 
-    // Fill triggeredList list
-    for (SpellAuraHolderMap::const_iterator itr = GetSpellAuraHolderMap().begin(); itr != GetSpellAuraHolderMap().end(); ++itr)
+    // Fill triggeredList list, only with the holders able to proc on these flags.
+    // The buffer is reused: nothing in this loop can trigger another proc.
+    static thread_local ProcHolderBucket candidates;
+    GetProcHolderCandidates(procFlag, candidates);
+    for (ProcHolderBucket::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
     {
         // Can not proc on self.
-        if (procSpell && procSpell->Id == itr->first)
+        if (procSpell && procSpell->Id == itr->spellId)
             continue;
 
         // skip deleted auras (possible at recursive triggered call
-        if (itr->second->IsDeleted())
+        if (itr->holder->IsDeleted())
             continue;
 
         // Aura that applies a modifier with charges. Gere? otherwise.
         bool hasmodifier = false;
         for (int i = 0; i < 3; ++i)
-            if (itr->second->GetAuraByEffectIndex(SpellEffectIndex(i)))
-                if (SpellModifier* auraMod = itr->second->GetAuraByEffectIndex(SpellEffectIndex(i))->GetSpellModifier())
+            if (itr->holder->GetAuraByEffectIndex(SpellEffectIndex(i)))
+                if (SpellModifier* auraMod = itr->holder->GetAuraByEffectIndex(SpellEffectIndex(i))->GetSpellModifier())
                     if (auraMod->charges > 0 || (spell && spell->HasModifierApplied(auraMod)))
                     {
                         hasmodifier = true;
@@ -9462,11 +9594,11 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* pTarget, uint32 procFlag,
             continue;
 
         SpellProcEventEntry const* spellProcEvent = nullptr;
-        if (!IsTriggeredAtSpellProcEvent(pTarget, itr->second, procSpell, procFlag, procExtra, attType, isVictim, spellProcEvent))
+        if (!IsTriggeredAtSpellProcEvent(pTarget, itr->holder, procSpell, procFlag, procExtra, attType, isVictim, spellProcEvent))
             continue;
 
-        itr->second->SetInUse(true);                        // prevent holder deletion
-        triggeredList.push_back(ProcTriggeredData(spellProcEvent, itr->second, pTarget, procFlag));
+        itr->holder->SetInUse(true);                        // prevent holder deletion
+        triggeredList.push_back(ProcTriggeredData(spellProcEvent, itr->holder, pTarget, procFlag));
     }
 }
 
@@ -9872,10 +10004,10 @@ void Unit::UpdateReactives(uint32 p_time)
 
 Unit* Unit::SelectRandomUnfriendlyTarget(Unit* except /*= NULL*/, float radius /*= ATTACK_DISTANCE*/, bool inFront) const
 {
-    std::list<Unit *> targets;
+    MaNGOS::GridSearchResults<Unit> targets;
 
     MaNGOS::AnyUnfriendlyUnitInObjectRangeCheck u_check(this, this, radius);
-    MaNGOS::UnitListSearcher<MaNGOS::AnyUnfriendlyUnitInObjectRangeCheck> searcher(targets, u_check);
+    MaNGOS::UnitListSearcher<MaNGOS::AnyUnfriendlyUnitInObjectRangeCheck, MaNGOS::GridSearchResults<Unit> > searcher(targets, u_check);
     Cell::VisitAllObjects(this, searcher, radius);
 
     // remove current target
@@ -9883,14 +10015,10 @@ Unit* Unit::SelectRandomUnfriendlyTarget(Unit* except /*= NULL*/, float radius /
         targets.remove(except);
 
     // remove not LoS targets
-    for (std::list<Unit *>::iterator tIter = targets.begin(); tIter != targets.end();)
+    for (MaNGOS::GridSearchResults<Unit>::iterator tIter = targets.begin(); tIter != targets.end();)
     {
         if ((!IsWithinLOSInMap(*tIter)) || (inFront && !this->HasInArc(M_PI_F / 2, *tIter)))
-        {
-            std::list<Unit *>::iterator tIter2 = tIter;
-            ++tIter;
-            targets.erase(tIter2);
-        }
+            tIter = targets.erase(tIter);
         else
             ++tIter;
     }
@@ -9900,20 +10028,15 @@ Unit* Unit::SelectRandomUnfriendlyTarget(Unit* except /*= NULL*/, float radius /
         return nullptr;
 
     // select random
-    uint32 rIdx = urand(0, targets.size() - 1);
-    std::list<Unit *>::const_iterator tcIter = targets.begin();
-    for (uint32 i = 0; i < rIdx; ++i)
-        ++tcIter;
-
-    return *tcIter;
+    return targets[urand(0, targets.size() - 1)];
 }
 
 Unit* Unit::SelectRandomFriendlyTarget(Unit* except /*= NULL*/, float radius /*= ATTACK_DISTANCE*/) const
 {
-    std::list<Unit *> targets;
+    MaNGOS::GridSearchResults<Unit> targets;
 
     MaNGOS::AnyFriendlyUnitInObjectRangeCheck u_check(this, radius);
-    MaNGOS::UnitListSearcher<MaNGOS::AnyFriendlyUnitInObjectRangeCheck> searcher(targets, u_check);
+    MaNGOS::UnitListSearcher<MaNGOS::AnyFriendlyUnitInObjectRangeCheck, MaNGOS::GridSearchResults<Unit> > searcher(targets, u_check);
 
     Cell::VisitAllObjects(this, searcher, radius);
 
@@ -9925,14 +10048,10 @@ Unit* Unit::SelectRandomFriendlyTarget(Unit* except /*= NULL*/, float radius /*=
     targets.remove((Unit *) this);
 
     // remove not LoS targets
-    for (std::list<Unit *>::iterator tIter = targets.begin(); tIter != targets.end();)
+    for (MaNGOS::GridSearchResults<Unit>::iterator tIter = targets.begin(); tIter != targets.end();)
     {
         if (!IsWithinLOSInMap(*tIter))
-        {
-            std::list<Unit *>::iterator tIter2 = tIter;
-            ++tIter;
-            targets.erase(tIter2);
-        }
+            tIter = targets.erase(tIter);
         else
             ++tIter;
     }
@@ -9942,12 +10061,7 @@ Unit* Unit::SelectRandomFriendlyTarget(Unit* except /*= NULL*/, float radius /*=
         return nullptr;
 
     // select random
-    uint32 rIdx = urand(0, targets.size() - 1);
-    std::list<Unit *>::const_iterator tcIter = targets.begin();
-    for (uint32 i = 0; i < rIdx; ++i)
-        ++tcIter;
-
-    return *tcIter;
+    return targets[urand(0, targets.size() - 1)];
 }
 
 bool Unit::IsSecondaryThreatTarget()
@@ -10472,20 +10586,20 @@ void Unit::ProcessRelocationVisibilityUpdates()
     if (!IsInWorld())
         return;
 
-    GetViewPoint().Call_UpdateVisibilityForOwner(); // HEAVY LOAD
+    GetViewPoint().Call_UpdateVisibilityAfterMove();
     UpdateObjectVisibility();
 }
 
 // BEGIN Nostalrius specific functions
 void Unit::InterruptSpellsCastedOnMe(bool killDelayed, bool interruptPositiveSpells)
 {
-    std::list<Unit*> targets;
+    MaNGOS::GridSearchResults<Unit> targets;
     // Maximum spell range=100m ?
     MaNGOS::AnyUnitInObjectRangeCheck u_check(this, 100.0f);
-    MaNGOS::UnitListSearcher<MaNGOS::AnyUnitInObjectRangeCheck> searcher(targets, u_check);
+    MaNGOS::UnitListSearcher<MaNGOS::AnyUnitInObjectRangeCheck, MaNGOS::GridSearchResults<Unit> > searcher(targets, u_check);
     // Don't need to use visibility modifier, units won't be able to cast outside of draw distance
     Cell::VisitAllObjects(this, searcher, GetMap()->GetVisibilityDistance());
-    for (std::list<Unit*>::iterator iter = targets.begin(); iter != targets.end(); ++iter)
+    for (MaNGOS::GridSearchResults<Unit>::iterator iter = targets.begin(); iter != targets.end(); ++iter)
     {
         if (!interruptPositiveSpells && IsFriendlyTo(*iter))
             continue;
@@ -10514,11 +10628,11 @@ void Unit::InterruptAttacksOnMe(float dist)
     // Must use modifier, otherwise long range auto attacks will not toggle
     dist += GetVisibilityModifier();
 
-    std::list<Unit*> targets;
+    MaNGOS::GridSearchResults<Unit> targets;
     MaNGOS::AnyUnfriendlyUnitInObjectRangeCheck u_check(this, this, dist);
-    MaNGOS::UnitListSearcher<MaNGOS::AnyUnfriendlyUnitInObjectRangeCheck> searcher(targets, u_check);
+    MaNGOS::UnitListSearcher<MaNGOS::AnyUnfriendlyUnitInObjectRangeCheck, MaNGOS::GridSearchResults<Unit> > searcher(targets, u_check);
     Cell::VisitAllObjects(this, searcher, dist);
-    for (std::list<Unit*>::iterator iter = targets.begin(); iter != targets.end(); ++iter)
+    for (MaNGOS::GridSearchResults<Unit>::iterator iter = targets.begin(); iter != targets.end(); ++iter)
     {
         if ((*iter)->getVictim() != this)
             continue;
@@ -10536,11 +10650,11 @@ void Unit::CombatStopInRange(float dist)
     // must check with modifier, otherwise we could combat bug
     dist += GetVisibilityModifier();
 
-    std::list<Unit*> targets;
+    MaNGOS::GridSearchResults<Unit> targets;
     MaNGOS::AnyUnfriendlyUnitInObjectRangeCheck u_check(this, this, dist);
-    MaNGOS::UnitListSearcher<MaNGOS::AnyUnfriendlyUnitInObjectRangeCheck> searcher(targets, u_check);
+    MaNGOS::UnitListSearcher<MaNGOS::AnyUnfriendlyUnitInObjectRangeCheck, MaNGOS::GridSearchResults<Unit> > searcher(targets, u_check);
     Cell::VisitAllObjects(this, searcher, dist);
-    for (std::list<Unit*>::iterator iter = targets.begin(); iter != targets.end(); ++iter)
+    for (MaNGOS::GridSearchResults<Unit>::iterator iter = targets.begin(); iter != targets.end(); ++iter)
         (*iter)->CombatStopWithPets(true);
 }
 
@@ -10584,11 +10698,11 @@ uint32 Unit::DespawnHostileCreaturesInRange(float range)
     if (range == 0.0f)
         range = GetMap()->GetVisibilityDistance();
     uint32 count = 0;
-    std::list<Unit*> targets;
+    MaNGOS::GridSearchResults<Unit> targets;
     MaNGOS::AnyUnfriendlyUnitInObjectRangeCheck u_check(this, this, range);
-    MaNGOS::UnitListSearcher<MaNGOS::AnyUnfriendlyUnitInObjectRangeCheck> searcher(targets, u_check);
+    MaNGOS::UnitListSearcher<MaNGOS::AnyUnfriendlyUnitInObjectRangeCheck, MaNGOS::GridSearchResults<Unit> > searcher(targets, u_check);
     Cell::VisitAllObjects(this, searcher, range);
-    for (std::list<Unit*>::iterator iter = targets.begin(); iter != targets.end(); ++iter)
+    for (MaNGOS::GridSearchResults<Unit>::iterator iter = targets.begin(); iter != targets.end(); ++iter)
     {
         if ((*iter)->GetTypeId() == TYPEID_UNIT)
         {
@@ -11088,6 +11202,7 @@ void Unit::UpdateSplineMovement(uint32 t_diff)
         WorldPacket data(SMSG_MONSTER_MOVE, 64);
         data << GetPackGUID();
         movespline->setLastPointSent(Movement::PacketBuilder::WriteMonsterMove(*movespline, data, movespline->getLastPointSent() + 1));
+        GetMap()->AddMonsterMovePacket(data.wpos());
         SendMovementMessageToSet(std::move(data), true);
     }
 
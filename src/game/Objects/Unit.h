@@ -39,6 +39,7 @@
 #include "WorldPacket.h"
 #include "Timer.h"
 #include <list>
+#include <atomic>
 
 enum UnitMovementType
 {
@@ -931,6 +932,69 @@ struct ProcTriggeredData
 
 typedef std::list< ProcTriggeredData > ProcTriggeredList;
 
+#define PROC_FLAG_INDEX_COUNT 28                            // PROC_FLAG_* bits
+
+struct ProcHolderIndexEntry
+{
+    ProcHolderIndexEntry(SpellAuraHolder* _holder, uint32 _spellId, uint32 _procFlags, uint32 _sequence)
+        : holder(_holder), spellId(_spellId), procFlags(_procFlags), sequence(_sequence) {}
+
+    // SpellAuraHolderMap order: spell id, then insertion order
+    bool operator<(ProcHolderIndexEntry const& other) const
+    {
+        return spellId != other.spellId ? spellId < other.spellId : sequence < other.sequence;
+    }
+
+    SpellAuraHolder* holder;
+    uint32 spellId;
+    uint32 procFlags;
+    uint32 sequence;
+};
+
+typedef std::vector<ProcHolderIndexEntry> ProcHolderBucket;
+
+#define AURA_MODIFIER_CACHE_MIN_AURAS 3                     // shorter lists are walked
+
+// Aggregates of one AuraType list
+struct AuraModifierValues
+{
+    AuraModifierValues() : sequence(1), total(0), multiplier(1.0f), maxPositive(0), maxNegative(0),
+        miscMaskValid(false), miscMask(0), miscMaskTotal(0), miscMaskMultiplier(1.0f) {}
+
+    uint32 sequence;                                        // AuraModifierCache::sequence these values are valid for
+    int32 total;
+    float multiplier;
+    int32 maxPositive;
+    int32 maxNegative;
+
+    // last misc mask asked for (damage school in most cases)
+    bool miscMaskValid;
+    uint32 miscMask;
+    int32 miscMaskTotal;
+    float miscMaskMultiplier;
+};
+
+// Getters are also called on a unit from other cell threads, so each slot is a seqlock:
+// the first reader after a change publishes the values it computed, if nothing changed meanwhile.
+// Adding, removing or changing the amount of an aura bumps the sequence by 2, which invalidates them.
+struct AuraModifierCache
+{
+    AuraModifierCache() : sequence(0) {}
+
+    std::atomic<uint32> sequence;                           // odd while a reader publishes values
+    AuraModifierValues values;
+};
+
+// Holders which can proc, by proc flag bit. Allocated with the first one.
+struct ProcHolderIndex
+{
+    ProcHolderIndex() : sequence(0) {}
+
+    ProcHolderBucket buckets[PROC_FLAG_INDEX_COUNT];
+    ProcHolderBucket unconditional;                         // hardcoded in Unit::IsTriggeredAtSpellProcEvent, checked for any proc
+    uint32 sequence;
+};
+
 enum TeleportToOptions
 {
     TELE_TO_GM_MODE             = 0x01,
@@ -1617,6 +1681,7 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
 
         int32 GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask) const;
         float GetTotalAuraMultiplierByMiscMask(AuraType auratype, uint32 misc_mask) const;
+        void InvalidateAuraModifierCache(AuraType auratype);
         int32 GetMaxPositiveAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask) const;
         int32 GetMaxNegativeAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask) const;
 
@@ -1679,6 +1744,11 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         uint32 SpellCriticalHealingBonus(SpellEntry const *spellProto, uint32 damage, Unit *pVictim);
 
         bool IsTriggeredAtSpellProcEvent(Unit *pVictim, SpellAuraHolder* holder, SpellEntry const* procSpell, uint32 procFlag, uint32 procExtra, WeaponAttackType attType, bool isVictim, SpellProcEventEntry const*& spellProcEvent );
+        static uint32 GetHolderIndexProcFlags(SpellEntry const* spellProto, bool& unconditional);
+        void AddToProcHolderIndex(SpellAuraHolder* holder);
+        void RemoveFromProcHolderIndex(SpellAuraHolder* holder);
+        // Holders that may be triggered by procFlag, in SpellAuraHolderMap order
+        void GetProcHolderCandidates(uint32 procFlag, ProcHolderBucket& candidates) const;
         // Aura proc handlers
         SpellAuraProcResult HandleDummyAuraProc(Unit *pVictim, uint32 damage, Aura* triggeredByAura, SpellEntry const *procSpell, uint32 procFlag, uint32 procEx, uint32 cooldown);
         SpellAuraProcResult HandleHasteAuraProc(Unit *pVictim, uint32 damage, Aura* triggeredByAura, SpellEntry const *procSpell, uint32 procFlag, uint32 procEx, uint32 cooldown);
@@ -1933,6 +2003,7 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
 
         SpellAuraHolderMap m_spellAuraHolders;
         SpellAuraHolderMap::iterator m_spellAuraHoldersUpdateIterator; // != end() in Unit::m_spellAuraHolders update and point to next element
+        ProcHolderIndex* m_procHolderIndex;                            // NULL until a holder able to proc is added
         AuraList m_deletedAuras;                                       // auras removed while in ApplyModifier and waiting deleted
         SpellAuraHolderList m_deletedHolders;
 
@@ -1947,6 +2018,9 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         uint32 m_transform;
 
         AuraList m_modAuras[TOTAL_AURAS];
+        std::atomic<AuraModifierCache*> m_auraModifierCache; // TOTAL_AURAS entries, allocated for the first long list
+
+        bool GetAuraModifierValues(AuraType auratype, uint32 misc_mask, AuraModifierValues& values) const;
         float m_auraModifiersGroup[UNIT_MOD_END][MODIFIER_TYPE_END];
         WeaponDamageInfo m_weaponDamage[MAX_ATTACK][MAX_ITEM_PROTO_DAMAGES];
         uint8 m_weaponDamageCount[MAX_ATTACK];
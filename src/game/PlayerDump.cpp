@@ -26,6 +26,21 @@
 #include "UpdateFields.h"
 #include "ObjectMgr.h"
 #include "AccountMgr.h"
+#include "CharacterEnumCache.h"
+#include "Threading.h"
+
+#include <atomic>
+
+// Dump text buffered before being written to the dump file
+#define DUMP_CHUNK_SIZE     (64 * 1024)
+// Size above which the rows of a table are not merged in the same INSERT anymore at load
+#define DUMP_BATCH_SIZE     (64 * 1024)
+// Bulk operations log their progress each time this number of characters is processed
+#define DUMP_PROGRESS_STEP  100
+// Most threads of a bulk write, each one opens its own character database connection
+#define DUMP_BULK_MAX_THREADS       8
+// Queued dumps loaded at each world update by a bulk load
+#define DUMP_BULK_LOADS_PER_UPDATE  5
 
 // Character Dump tables
 struct DumpTable
@@ -280,7 +295,23 @@ void StoreGUID(QueryResult *result, uint32 data, uint32 field, std::set<uint32>&
 }
 
 // Writing - High-level functions
-void PlayerDumpWriter::DumpTableContent(std::string& dump, uint32 guid, char const*tableFrom, char const*tableTo, DumpTableType type)
+void PlayerDumpWriter::DumpOutput::Append(std::string const& text)
+{
+    buffer += text;
+    if (file && buffer.size() >= DUMP_CHUNK_SIZE)
+        Flush();
+}
+
+void PlayerDumpWriter::DumpOutput::Flush()
+{
+    if (!file || buffer.empty())
+        return;
+
+    fwrite(buffer.c_str(), 1, buffer.size(), file);
+    buffer.clear();
+}
+
+void PlayerDumpWriter::DumpTableContent(DumpOutput& dump, uint32 guid, char const*tableFrom, char const*tableTo, DumpTableType type)
 {
     GUIDs const* guids = NULL;
     char const* fieldname = NULL;
@@ -370,8 +401,8 @@ void PlayerDumpWriter::DumpTableContent(std::string& dump, uint32 guid, char con
                     break;
             }
 
-            dump += CreateDumpString(tableTo, result);
-            dump += "\n";
+            dump.Append(CreateDumpString(tableTo, result));
+            dump.Append("\n");
         }
         while (result->NextRow());
 
@@ -382,10 +413,15 @@ void PlayerDumpWriter::DumpTableContent(std::string& dump, uint32 guid, char con
 
 std::string PlayerDumpWriter::GetDump(uint32 guid)
 {
-    std::string dump;
+    DumpOutput dump;
+    WriteDumpContent(dump, guid);
+    return dump.buffer;
+}
 
-    dump += "IMPORTANT NOTE: This sql queries not created for apply directly, use '.pdump load' command in console or client chat instead.\n";
-    dump += "IMPORTANT NOTE: NOT APPLY ITS DIRECTLY to character DB or you will DAMAGE and CORRUPT character DB\n\n";
+void PlayerDumpWriter::WriteDumpContent(DumpOutput& dump, uint32 guid)
+{
+    dump.Append("IMPORTANT NOTE: This sql queries not created for apply directly, use '.pdump load' command in console or client chat instead.\n");
+    dump.Append("IMPORTANT NOTE: NOT APPLY ITS DIRECTLY to character DB or you will DAMAGE and CORRUPT character DB\n\n");
 
     // revision check guard
     QueryNamedResult* result = CharacterDatabase.QueryNamed("SELECT * FROM character_db_version LIMIT 1");
@@ -405,7 +441,7 @@ std::string PlayerDumpWriter::GetDump(uint32 guid)
         if (!reqName.empty())
         {
             // this will fail at wrong character DB version
-            dump += "UPDATE character_db_version SET " + reqName + " = 1 WHERE FALSE;\n\n";
+            dump.Append("UPDATE character_db_version SET " + reqName + " = 1 WHERE FALSE;\n\n");
         }
         else
             sLog.outError("Table 'character_db_version' not have revision guard field, revision guard query not added to pdump.");
@@ -420,8 +456,6 @@ std::string PlayerDumpWriter::GetDump(uint32 guid)
 
     // TODO: Add instance/group..
     // TODO: Add a dump level option to skip some non-important tables
-
-    return dump;
 }
 
 DumpReturn PlayerDumpWriter::WriteDump(const std::string& file, uint32 guid)
@@ -430,20 +464,134 @@ DumpReturn PlayerDumpWriter::WriteDump(const std::string& file, uint32 guid)
     if (!fout)
         return DUMP_FILE_OPEN_ERROR;
 
-    std::string dump = GetDump(guid);
+    DumpOutput dump(fout);
+    WriteDumpContent(dump, guid);
+    dump.Append("\n");
+    dump.Flush();
 
-    fprintf(fout, "%s\n", dump.c_str());
     fclose(fout);
     return DUMP_SUCCESS;
 }
 
+class PlayerDumpBulkWriter : public ACE_Based::Runnable
+{
+    public:
+        PlayerDumpBulkWriter(std::vector<uint32> const& guids, std::string const& directory, std::atomic<uint32>& next, std::atomic<uint32>& written, std::atomic<uint32>& failed) :
+            m_guids(guids), m_directory(directory), m_next(next), m_written(written), m_failed(failed) {}
+
+        void run()
+        {
+            CharacterDatabase.ThreadStart();
+            for (uint32 i = m_next++; i < m_guids.size(); i = m_next++)
+            {
+                std::ostringstream file;
+                file << m_directory << "/" << m_guids[i] << ".dump";
+
+                PlayerDumpWriter writer;
+                uint32 done = (writer.WriteDump(file.str(), m_guids[i]) == DUMP_SUCCESS) ? ++m_written + m_failed : ++m_failed + m_written;
+                if (done % DUMP_PROGRESS_STEP == 0)
+                    sLog.outString("PlayerDump: %u/%u characters written", done, uint32(m_guids.size()));
+            }
+            CharacterDatabase.ThreadEnd();
+        }
+
+    private:
+        std::vector<uint32> const& m_guids;
+        std::string const& m_directory;
+        std::atomic<uint32>& m_next;
+        std::atomic<uint32>& m_written;
+        std::atomic<uint32>& m_failed;
+};
+
+void PlayerDumpWriter::WriteDumps(std::vector<uint32> const& guids, std::string const& directory, uint32 threads, uint32& written, uint32& failed)
+{
+    std::atomic<uint32> next(0);
+    std::atomic<uint32> writtenCount(0);
+    std::atomic<uint32> failedCount(0);
+
+    threads = std::max(1u, std::min(std::min(threads, uint32(DUMP_BULK_MAX_THREADS)), uint32(guids.size())));
+    std::vector<ACE_Based::Thread*> writers(threads);
+    for (uint32 i = 0; i < threads; ++i)
+        writers[i] = new ACE_Based::Thread(new PlayerDumpBulkWriter(guids, directory, next, writtenCount, failedCount));
+
+    for (uint32 i = 0; i < threads; ++i)
+    {
+        writers[i]->wait();
+        delete writers[i];
+    }
+
+    written = writtenCount;
+    failed = failedCount;
+    sLog.outString("PlayerDump: %u characters written, %u failed", written, failed);
+}
+
+static ACE_Thread_Mutex s_bulkWriteLock;
+static ACE_Based::Thread* s_bulkWriteThread = NULL;
+static std::atomic<bool> s_bulkWriteRunning(false);
+
+class PlayerDumpBulkWriteJob : public ACE_Based::Runnable
+{
+    public:
+        PlayerDumpBulkWriteJob(std::vector<uint32> const& guids, std::string const& directory, uint32 threads) :
+            m_guids(guids), m_directory(directory), m_threads(threads) {}
+
+        void run()
+        {
+            uint32 written, failed;
+            PlayerDumpWriter::WriteDumps(m_guids, m_directory, m_threads, written, failed);
+            s_bulkWriteRunning = false;
+        }
+
+    private:
+        std::vector<uint32> m_guids;
+        std::string m_directory;
+        uint32 m_threads;
+};
+
+bool PlayerDumpWriter::StartBulkWrite(std::vector<uint32> const& guids, std::string const& directory, uint32 threads)
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(s_bulkWriteLock);
+    if (s_bulkWriteRunning)
+        return false;
+
+    // the previous job is over, release its thread
+    if (s_bulkWriteThread)
+    {
+        s_bulkWriteThread->wait();
+        delete s_bulkWriteThread;
+    }
+    s_bulkWriteRunning = true;
+    s_bulkWriteThread = new ACE_Based::Thread(new PlayerDumpBulkWriteJob(guids, directory, threads));
+    return true;
+}
+
+void PlayerDumpWriter::WaitBulkWrite()
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(s_bulkWriteLock);
+    if (!s_bulkWriteThread)
+        return;
+
+    s_bulkWriteThread->wait();
+    delete s_bulkWriteThread;
+    s_bulkWriteThread = NULL;
+}
+
 // Reading - High-level functions
 #define ROLLBACK(DR) {CharacterDatabase.RollbackTransaction(); fclose(fin); return (DR);}
 
-DumpReturn PlayerDumpReader::LoadDump(const std::string& file, uint32 account, std::string name, uint32 guid)
+DumpReturn PlayerDumpReader::LoadDump(const std::string& file, uint32 account, std::string name, uint32 guid, bool asyncCommit, Reservations* reservations)
 {
-    // check character count
-    uint32 charcount = sAccountMgr.GetCharactersCount(account);
+    // check character count, the DB does not see the commits still queued
+    uint32 charcount;
+    if (reservations)
+    {
+        std::map<uint32, uint32>::iterator itr = reservations->characters.find(account);
+        if (itr == reservations->characters.end())
+            itr = reservations->characters.insert(std::make_pair(account, sAccountMgr.GetCharactersCount(account))).first;
+        charcount = itr->second;
+    }
+    else
+        charcount = sAccountMgr.GetCharactersCount(account);
     if (charcount >= 10)
         return DUMP_TOO_MANY_CHARS;
 
@@ -476,8 +624,9 @@ DumpReturn PlayerDumpReader::LoadDump(const std::string& file, uint32 account, s
     if (ObjectMgr::CheckPlayerName(name, true) == CHAR_NAME_SUCCESS)
     {
         CharacterDatabase.escape_string(name);              // for safe, we use name only for sql quearies anyway
-        result = CharacterDatabase.PQuery("SELECT * FROM characters WHERE name = '%s'", name.c_str());
-        if (result)
+        if (reservations && reservations->names.find(name) != reservations->names.end())
+            name = "";                                      // use the one from the dump
+        else if ((result = CharacterDatabase.PQuery("SELECT * FROM characters WHERE name = '%s'", name.c_str())))
         {
             name = "";                                      // use the one from the dump
             delete result;
@@ -502,7 +651,11 @@ DumpReturn PlayerDumpReader::LoadDump(const std::string& file, uint32 account, s
     typedef PetIds::value_type PetIdsPair;
     PetIds petids;
 
-    CharacterDatabase.BeginTransaction();
+    // consecutive rows of the same table are inserted by a single multi-row statement
+    std::string batch;
+    std::string batchTable;
+
+    CharacterDatabase.BeginTransaction(asyncCommit ? guid : 0);
     while (!feof(fin))
     {
         if (!fgets(buf, 32000, fin))
@@ -526,6 +679,10 @@ DumpReturn PlayerDumpReader::LoadDump(const std::string& file, uint32 account, s
         // add required_ check
         if (line.substr(nw_pos, 41) == "UPDATE character_db_version SET required_")
         {
+            if (!batch.empty() && !CharacterDatabase.Execute(batch.c_str()))
+                ROLLBACK(DUMP_FILE_BROKEN);
+            batch.clear();
+
             if (!CharacterDatabase.Execute(line.c_str()))
                 ROLLBACK(DUMP_FILE_BROKEN);
 
@@ -579,8 +736,9 @@ DumpReturn PlayerDumpReader::LoadDump(const std::string& file, uint32 account, s
                     name = getnth(line, 3);                 // characters.name
                     CharacterDatabase.escape_string(name);
 
-                    result = CharacterDatabase.PQuery("SELECT * FROM characters WHERE name = '%s'", name.c_str());
-                    if (result)
+                    bool reserved = reservations && reservations->names.find(name) != reservations->names.end();
+                    result = reserved ? NULL : CharacterDatabase.PQuery("SELECT * FROM characters WHERE name = '%s'", name.c_str());
+                    if (reserved || result)
                     {
                         delete result;
 
@@ -713,11 +871,41 @@ DumpReturn PlayerDumpReader::LoadDump(const std::string& file, uint32 account, s
                 break;
         }
 
-        if (!CharacterDatabase.Execute(line.c_str()))
+        std::string::size_type values = line.find(" VALUES (");
+        std::string::size_type end = line.find_last_of(')');
+        if (values == std::string::npos || end == std::string::npos || end < values)
             ROLLBACK(DUMP_FILE_BROKEN);
+
+        if (!batch.empty() && (tn != batchTable || batch.size() + end - values > DUMP_BATCH_SIZE))
+        {
+            if (!CharacterDatabase.Execute(batch.c_str()))
+                ROLLBACK(DUMP_FILE_BROKEN);
+            batch.clear();
+        }
+
+        if (batch.empty())
+        {
+            batch.assign(line, 0, end + 1);
+            batchTable = tn;
+        }
+        else
+        {
+            batch += ", ";
+            batch.append(line, values + 8, end - values - 7);
+        }
     }
 
+    if (!batch.empty() && !CharacterDatabase.Execute(batch.c_str()))
+        ROLLBACK(DUMP_FILE_BROKEN);
+
     CharacterDatabase.CommitTransaction();
+    sCharacterEnumCache.InvalidateAccount(account);
+
+    if (reservations)
+    {
+        ++reservations->characters[account];
+        reservations->names.insert(name);
+    }
 
     //FIXME: current code with post-updating guids not safe for future per-map threads
     sObjectMgr.m_ItemGuids.Set(sObjectMgr.m_ItemGuids.GetNextAfterMaxUsed() + items.size());
@@ -731,3 +919,55 @@ DumpReturn PlayerDumpReader::LoadDump(const std::string& file, uint32 account, s
 
     return DUMP_SUCCESS;
 }
+
+static ACE_Thread_Mutex s_bulkLoadLock;
+static std::vector<PlayerDumpReader::BulkEntry> s_bulkLoadDumps;
+static uint32 s_bulkLoadNext = 0;
+static uint32 s_bulkLoaded = 0;
+static uint32 s_bulkLoadFailed = 0;
+// kept until the next bulk load, the last commits may still be queued when the batch ends
+static PlayerDumpReader::Reservations s_bulkLoadReservations;
+
+bool PlayerDumpReader::StartBulkLoad(std::vector<BulkEntry> const& dumps)
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(s_bulkLoadLock);
+    if (!s_bulkLoadDumps.empty())
+        return false;
+
+    s_bulkLoadDumps = dumps;
+    s_bulkLoadNext = 0;
+    s_bulkLoaded = 0;
+    s_bulkLoadFailed = 0;
+    s_bulkLoadReservations = Reservations();
+    return true;
+}
+
+void PlayerDumpReader::UpdateBulkLoad()
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(s_bulkLoadLock);
+    if (s_bulkLoadDumps.empty())
+        return;
+
+    for (uint32 count = 0; count < DUMP_BULK_LOADS_PER_UPDATE && s_bulkLoadNext < s_bulkLoadDumps.size(); ++count)
+    {
+        BulkEntry const& dump = s_bulkLoadDumps[s_bulkLoadNext++];
+        // committed on the async worker of each new character, in parallel
+        PlayerDumpReader reader;
+        if (reader.LoadDump(dump.file, dump.account, dump.name, 0, true, &s_bulkLoadReservations) == DUMP_SUCCESS)
+            ++s_bulkLoaded;
+        else
+        {
+            sLog.outError("PlayerDump: unable to load '%s' on account %u", dump.file.c_str(), dump.account);
+            ++s_bulkLoadFailed;
+        }
+
+        if (s_bulkLoadNext % DUMP_PROGRESS_STEP == 0)
+            sLog.outString("PlayerDump: %u/%u characters loaded", s_bulkLoadNext, uint32(s_bulkLoadDumps.size()));
+    }
+
+    if (s_bulkLoadNext < s_bulkLoadDumps.size())
+        return;
+
+    sLog.outString("PlayerDump: %u characters loaded, %u failed", s_bulkLoaded, s_bulkLoadFailed);
+    s_bulkLoadDumps.clear();
+}
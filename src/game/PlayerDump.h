@@ -22,9 +22,11 @@
 #ifndef _PLAYER_DUMP_H
 #define _PLAYER_DUMP_H
 
+#include <cstdio>
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
 
 enum DumpTableType
 {
@@ -77,10 +79,30 @@ class PlayerDumpWriter : public PlayerDump
 
         std::string GetDump(uint32 guid);
         DumpReturn WriteDump(const std::string& file, uint32 guid);
+
+        // Writes <directory>/<guid>.dump for each character, the characters being split between the given number of threads
+        static void WriteDumps(std::vector<uint32> const& guids, std::string const& directory, uint32 threads, uint32& written, uint32& failed);
+        // Same on a background thread which logs the progress. Returns false if a bulk write is already running.
+        static bool StartBulkWrite(std::vector<uint32> const& guids, std::string const& directory, uint32 threads);
+        // Waits for the end of the running bulk write, if any
+        static void WaitBulkWrite();
     private:
         typedef std::set<uint32> GUIDs;
 
-        void DumpTableContent(std::string& dump, uint32 guid, char const*tableFrom, char const*tableTo, DumpTableType type);
+        // Dump text, flushed to the file by chunks when there is one instead of being built entirely in memory
+        struct DumpOutput
+        {
+            explicit DumpOutput(FILE* f = NULL) : file(f) {}
+
+            void Append(std::string const& text);
+            void Flush();
+
+            std::string buffer;
+            FILE* file;
+        };
+
+        void WriteDumpContent(DumpOutput& dump, uint32 guid);
+        void DumpTableContent(DumpOutput& dump, uint32 guid, char const*tableFrom, char const*tableTo, DumpTableType type);
         std::string GenerateWhereStr(char const* field, GUIDs const& guids, GUIDs::const_iterator& itr);
         std::string GenerateWhereStr(char const* field, uint32 guid);
 
@@ -95,7 +117,30 @@ class PlayerDumpReader : public PlayerDump
     public:
         PlayerDumpReader() {}
 
-        DumpReturn LoadDump(const std::string& file, uint32 account, std::string name, uint32 guid);
+        // Names and character slots taken by loaded dumps whose commit may still be queued
+        struct Reservations
+        {
+            std::map<uint32, uint32> characters;            // account -> characters, read from the DB at its first dump
+            std::set<std::string> names;
+        };
+
+        // asyncCommit commits the dump on the async worker of the new character (serial = its guid), in parallel with others.
+        // The checks of the character count and of the name also count the reservations, which are updated on success.
+        DumpReturn LoadDump(const std::string& file, uint32 account, std::string name, uint32 guid, bool asyncCommit = false, Reservations* reservations = NULL);
+
+        struct BulkEntry
+        {
+            std::string file;
+            uint32 account;
+            std::string name;
+        };
+
+        // Queues the dumps to be loaded one after another by UpdateBulkLoad (guids are assigned sequentially),
+        // each in its own transaction. Returns false if a bulk load is already running.
+        static bool StartBulkLoad(std::vector<BulkEntry> const& dumps);
+        // Loads the next queued dumps. Called by the world thread while the maps are not updated,
+        // as loading a dump moves the object id generators.
+        static void UpdateBulkLoad();
 };
 
 #endif
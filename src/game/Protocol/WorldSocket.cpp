@@ -409,3 +409,29 @@ int WorldSocket::SendStartupPacket()
 
     return SendPacket(packet);
 }
+
+bool WorldSocket::IsImmediatePacket(const WorldPacket& pct) const
+{
+    switch (pct.GetOpcode())
+    {
+        case SMSG_AUTH_RESPONSE:
+        case SMSG_PONG:
+        case SMSG_CAST_RESULT:
+        case SMSG_ATTACKSWING_NOTINRANGE:
+        case SMSG_ATTACKSWING_BADFACING:
+        case SMSG_ATTACKSWING_NOTSTANDING:
+        case SMSG_ATTACKSWING_DEADTARGET:
+        case SMSG_ATTACKSWING_CANT_ATTACK:
+        case SMSG_LOGOUT_RESPONSE:
+        case SMSG_LOGOUT_COMPLETE:
+        case SMSG_TRANSFER_PENDING:
+        case SMSG_NEW_WORLD:
+        case MSG_MOVE_TELEPORT_ACK:
+        case SMSG_FORCE_MOVE_ROOT:
+        case SMSG_FORCE_MOVE_UNROOT:
+        case SMSG_MOVE_KNOCK_BACK:
+            return true;
+        default:
+            return false;
+    }
+}
@@ -46,6 +46,9 @@ class WorldSocket: public MangosSocket<WorldSession, WorldSocket, AuthCrypt>
         int OnSocketOpen();
         int SendStartupPacket();
 
+        /// Replies to the client actions, not delayed by the flush policy.
+        bool IsImmediatePacket (const WorldPacket& pct) const;
+
         int ProcessIncoming (WorldPacket* new_pct);
 
         /// Called by ProcessIncoming() on CMSG_AUTH_SESSION.
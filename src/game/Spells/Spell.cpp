@@ -349,6 +349,19 @@ Spell::Spell(Unit* caster, SpellEntry const *info, bool triggered, ObjectGuid or
 Spell::~Spell()
 {
     m_destroyed = true;
+    s_targetAllocations.frees += m_UniqueTargetInfo.size() + m_UniqueGOTargetInfo.size() + m_UniqueItemInfo.size();
+}
+
+MaNGOS::AllocationCounters Spell::s_allocations;
+MaNGOS::AllocationCounters Spell::s_targetAllocations;
+MaNGOS::AllocationCounters SpellEvent::s_allocations;
+
+template <typename List>
+static void CountTargetAllocation(List const& list)
+{
+    ++Spell::s_targetAllocations.allocations;
+    if (list.size() > List::InlineCapacity)
+        ++Spell::s_targetAllocations.heapAllocations;
 }
 
 template<typename T>
@@ -850,6 +863,7 @@ void Spell::CleanupTargetList()
     for (GOTargetList::iterator itr = m_UniqueGOTargetInfo.begin(); itr != m_UniqueGOTargetInfo.end(); ++itr)
         itr->deleted = true;
 
+    s_targetAllocations.frees += m_UniqueItemInfo.size();
     m_UniqueItemInfo.clear();
     m_delayMoment = 0;
 }
@@ -933,6 +947,7 @@ void Spell::AddUnitTarget(Unit* pVictim, SpellEffectIndex effIndex)
 
     // Add target to list
     m_UniqueTargetInfo.push_back(target);
+    CountTargetAllocation(m_UniqueTargetInfo);
 }
 
 void Spell::AddUnitTarget(ObjectGuid unitGuid, SpellEffectIndex effIndex)
@@ -1010,6 +1025,7 @@ void Spell::AddGOTarget(GameObject* pVictim, SpellEffectIndex effIndex)
 
     // Add target to list
     m_UniqueGOTargetInfo.push_back(target);
+    CountTargetAllocation(m_UniqueGOTargetInfo);
 }
 
 void Spell::AddGOTarget(ObjectGuid goGuid, SpellEffectIndex effIndex)
@@ -1041,6 +1057,7 @@ void Spell::AddItemTarget(Item* pitem, SpellEffectIndex effIndex)
     target.deleted    = false;
 
     m_UniqueItemInfo.push_back(target);
+    CountTargetAllocation(m_UniqueItemInfo);
 }
 
 void Spell::DoAllEffectOnTarget(TargetInfo *target)
@@ -1997,11 +2014,11 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
             unMaxTargets = EffectChainTarget;
             float max_range = radius + unMaxTargets * CHAIN_SPELL_JUMP_RADIUS;
 
-            UnitList tempTargetUnitMap;
+            MaNGOS::GridSearchResults<Unit> tempTargetUnitMap;
 
             {
                 MaNGOS::AnyAoETargetUnitInObjectRangeCheck u_check(m_caster, max_range);
-                MaNGOS::UnitListSearcher<MaNGOS::AnyAoETargetUnitInObjectRangeCheck> searcher(tempTargetUnitMap, u_check);
+                MaNGOS::UnitListSearcher<MaNGOS::AnyAoETargetUnitInObjectRangeCheck, MaNGOS::GridSearchResults<Unit> > searcher(tempTargetUnitMap, u_check);
                 Cell::VisitAllObjects(m_caster, searcher, max_range);
             }
 
@@ -2058,10 +2075,10 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
             m_targets.m_targetMask = 0;
             unMaxTargets = EffectChainTarget;
             float max_range = radius + unMaxTargets * CHAIN_SPELL_JUMP_RADIUS;
-            UnitList tempTargetUnitMap;
+            MaNGOS::GridSearchResults<Unit> tempTargetUnitMap;
             {
                 MaNGOS::AnyFriendlyUnitInObjectRangeCheck u_check(m_caster, max_range);
-                MaNGOS::UnitListSearcher<MaNGOS::AnyFriendlyUnitInObjectRangeCheck> searcher(tempTargetUnitMap, u_check);
+                MaNGOS::UnitListSearcher<MaNGOS::AnyFriendlyUnitInObjectRangeCheck, MaNGOS::GridSearchResults<Unit> > searcher(tempTargetUnitMap, u_check);
                 Cell::VisitAllObjects(m_caster, searcher, max_range);
             }
 
@@ -2153,9 +2170,9 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
                     //FIXME: This very like horrible hack and wrong for most spells
                     max_range = radius + unMaxTargets * CHAIN_SPELL_JUMP_RADIUS;
 
-                UnitList tempTargetUnitMap;
+                MaNGOS::GridSearchResults<Unit> tempTargetUnitMap;
                 MaNGOS::AnyAoEVisibleTargetUnitInObjectRangeCheck u_check(pUnitTarget, originalCaster, max_range);
-                MaNGOS::UnitListSearcher<MaNGOS::AnyAoEVisibleTargetUnitInObjectRangeCheck> searcher(tempTargetUnitMap, u_check);
+                MaNGOS::UnitListSearcher<MaNGOS::AnyAoEVisibleTargetUnitInObjectRangeCheck, MaNGOS::GridSearchResults<Unit> > searcher(tempTargetUnitMap, u_check);
                 Cell::VisitAllObjects(m_caster, searcher, max_range);
 
                 tempTargetUnitMap.sort(TargetDistanceOrderNear(pUnitTarget));
@@ -2235,16 +2252,18 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
             if (IsPositiveEffect(m_spellInfo, effIndex))
                 targetB = SPELL_TARGETS_FRIENDLY;
 
-            UnitList tempTargetUnitMap;
+            MaNGOS::GridSearchResults<Unit> tempTargetUnitMap;
             SpellScriptTargetBounds bounds = sSpellMgr.GetSpellScriptTargetBounds(m_spellInfo->Id);
 
             // fill real target list if no spell script target defined
-            FillAreaTargets(bounds.first != bounds.second ? tempTargetUnitMap : targetUnitMap,
-                            radius, PUSH_DEST_CENTER, bounds.first != bounds.second ? SPELL_TARGETS_ALL : targetB);
+            if (bounds.first != bounds.second)
+                FillAreaTargets(tempTargetUnitMap, radius, PUSH_DEST_CENTER, SPELL_TARGETS_ALL);
+            else
+                FillAreaTargets(targetUnitMap, radius, PUSH_DEST_CENTER, targetB);
 
             if (!tempTargetUnitMap.empty())
             {
-                for (UnitList::const_iterator iter = tempTargetUnitMap.begin(); iter != tempTargetUnitMap.end(); ++iter)
+                for (MaNGOS::GridSearchResults<Unit>::const_iterator iter = tempTargetUnitMap.begin(); iter != tempTargetUnitMap.end(); ++iter)
                 {
                     if ((*iter)->GetTypeId() != TYPEID_UNIT)
                         continue;
@@ -2282,14 +2301,17 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
                 break;
             }
 
-            UnitList tempTargetUnitMap;
+            MaNGOS::GridSearchResults<Unit> tempTargetUnitMap;
             SpellScriptTargetBounds bounds = sSpellMgr.GetSpellScriptTargetBounds(m_spellInfo->Id);
             // fill real target list if no spell script target defined
-            FillAreaTargets(bounds.first != bounds.second ? tempTargetUnitMap : targetUnitMap, radius, PUSH_DEST_CENTER, SPELL_TARGETS_ALL);
+            if (bounds.first != bounds.second)
+                FillAreaTargets(tempTargetUnitMap, radius, PUSH_DEST_CENTER, SPELL_TARGETS_ALL);
+            else
+                FillAreaTargets(targetUnitMap, radius, PUSH_DEST_CENTER, SPELL_TARGETS_ALL);
 
             if (!tempTargetUnitMap.empty())
             {
-                for (UnitList::const_iterator iter = tempTargetUnitMap.begin(); iter != tempTargetUnitMap.end(); ++iter)
+                for (MaNGOS::GridSearchResults<Unit>::const_iterator iter = tempTargetUnitMap.begin(); iter != tempTargetUnitMap.end(); ++iter)
                 {
                     if ((*iter)->GetTypeId() != TYPEID_UNIT)
                         continue;
@@ -2514,10 +2536,10 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
             case 24837:
             case 24838:
             {
-                UnitList tempTargetUnitMap;
+                MaNGOS::GridSearchResults<Unit> tempTargetUnitMap;
                 FillAreaTargets(tempTargetUnitMap, radius, PUSH_SELF_CENTER, SPELL_TARGETS_AOE_DAMAGE);
 
-                for (UnitList::const_iterator itr = tempTargetUnitMap.begin(); itr != tempTargetUnitMap.end(); ++itr)
+                for (MaNGOS::GridSearchResults<Unit>::const_iterator itr = tempTargetUnitMap.begin(); itr != tempTargetUnitMap.end(); ++itr)
                 {
                     float angle;
                     float arc;
@@ -2692,7 +2714,7 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
                 unMaxTargets = EffectChainTarget;
                 float max_range = radius + unMaxTargets * CHAIN_SPELL_JUMP_RADIUS;
 
-                UnitList tempTargetUnitMap;
+                MaNGOS::GridSearchResults<Unit> tempTargetUnitMap;
 
                 FillAreaTargets(tempTargetUnitMap, max_range, PUSH_SELF_CENTER, SPELL_TARGETS_FRIENDLY);
 
@@ -7772,7 +7794,9 @@ SpellCastResult Spell::CanOpenLock(SpellEffectIndex effIndex, uint32 lockId, Ski
 class SpellNotifierCreatureAndPlayer
 {
 public:
+    // Targets are added to one of them
     Spell::UnitList *i_data;
+    MaNGOS::GridSearchResults<Unit> *i_results;
     Spell &i_spell;
     SpellNotifyPushType i_push_type;
     float i_radius;
@@ -7794,7 +7818,20 @@ public:
 
     SpellNotifierCreatureAndPlayer(Spell &spell, Spell::UnitList &data, float radius, SpellNotifyPushType type,
                                    SpellTargets TargetType = SPELL_TARGETS_NOT_FRIENDLY, WorldObject* originalCaster = nullptr)
-        : i_data(&data), i_spell(spell), i_push_type(type), i_radius(radius), i_TargetType(TargetType),
+        : SpellNotifierCreatureAndPlayer(spell, radius, type, TargetType, originalCaster)
+    {
+        i_data = &data;
+    }
+
+    SpellNotifierCreatureAndPlayer(Spell &spell, MaNGOS::GridSearchResults<Unit> &results, float radius, SpellNotifyPushType type,
+                                   SpellTargets TargetType = SPELL_TARGETS_NOT_FRIENDLY, WorldObject* originalCaster = nullptr)
+        : SpellNotifierCreatureAndPlayer(spell, radius, type, TargetType, originalCaster)
+    {
+        i_results = &results;
+    }
+
+    SpellNotifierCreatureAndPlayer(Spell &spell, float radius, SpellNotifyPushType type, SpellTargets TargetType, WorldObject* originalCaster)
+        : i_data(nullptr), i_results(nullptr), i_spell(spell), i_push_type(type), i_radius(radius), i_TargetType(TargetType),
           i_originalCaster(originalCaster), i_castingObject(i_spell.GetCastingObject())
     {
         if (!i_originalCaster)
@@ -7830,10 +7867,18 @@ public:
         }
     }
 
+    void Push(Unit* target)
+    {
+        if (i_results)
+            i_results->push_back(target);
+        else
+            i_data->push_back(target);
+    }
+
     template<class T>
     void Visit(GridRefManager<T>  &m)
     {
-        MANGOS_ASSERT(i_data);
+        MANGOS_ASSERT(i_data || i_results);
 
         if (!i_originalCaster || !i_castingObject)
             return;
@@ -7914,31 +7959,31 @@ public:
             {
                 case PUSH_IN_FRONT:
                     if (i_castingObject->isInFront((Unit*)(itr->getSource()), i_radius, 2 * M_PI_F / 3))
-                        i_data->push_back(itr->getSource());
+                        Push(itr->getSource());
                     break;
                 case PUSH_IN_FRONT_90:
                     if (i_castingObject->isInFront((Unit*)(itr->getSource()), i_radius, M_PI_F / 2))
-                        i_data->push_back(itr->getSource());
+                        Push(itr->getSource());
                     break;
                 case PUSH_IN_FRONT_15:
                     if (i_castingObject->isInFront((Unit*)(itr->getSource()), i_radius, M_PI_F / 12))
-                        i_data->push_back(itr->getSource());
+                        Push(itr->getSource());
                     break;
                 case PUSH_IN_BACK: // 75
                     if (i_castingObject->isInBack((Unit*)(itr->getSource()), i_radius, 5 * M_PI_F / 12))
-                        i_data->push_back(itr->getSource());
+                        Push(itr->getSource());
                     break;
                 case PUSH_SELF_CENTER:
                     if (i_castingObject->IsWithinDist((Unit*)(itr->getSource()), i_radius))
-                        i_data->push_back(itr->getSource());
+                        Push(itr->getSource());
                     break;
                 case PUSH_DEST_CENTER:
                     if (itr->getSource()->IsWithinDist3d(i_spell.m_targets.m_destX, i_spell.m_targets.m_destY, i_spell.m_targets.m_destZ, i_radius))
-                        i_data->push_back(itr->getSource());
+                        Push(itr->getSource());
                     break;
                 case PUSH_TARGET_CENTER:
                     if (i_spell.m_targets.getUnitTarget() && i_spell.m_targets.getUnitTarget()->IsWithinDist((Unit*)(itr->getSource()), i_radius))
-                        i_data->push_back(itr->getSource());
+                        Push(itr->getSource());
                     break;
             }
         }
@@ -7976,6 +8021,12 @@ void Spell::FillAreaTargets(UnitList &targetUnitMap, float radius, SpellNotifyPu
     Cell::VisitAllObjects(notifier.GetCenterX(), notifier.GetCenterY(), m_caster->GetMap(), notifier, radius);
 }
 
+void Spell::FillAreaTargets(MaNGOS::GridSearchResults<Unit> &targetUnitMap, float radius, SpellNotifyPushType pushType, SpellTargets spellTargets, WorldObject* originalCaster /*=NULL*/)
+{
+    SpellNotifierCreatureAndPlayer notifier(*this, targetUnitMap, radius, pushType, spellTargets, originalCaster);
+    Cell::VisitAllObjects(notifier.GetCenterX(), notifier.GetCenterY(), m_caster->GetMap(), notifier, radius);
+}
+
 void Spell::FillRaidOrPartyTargets(UnitList &TagUnitMap, Unit* target, float radius, bool raid, bool withPets, bool withcaster) const
 {
     Player *pTarget = target->GetCharmerOrOwnerPlayerOrPlayerItself();
@@ -31,11 +31,8 @@
 #include "Unit.h"
 #include "Player.h"
 
-#ifdef USE_STANDARD_MALLOC
-#include <vector>
-#else
-#include "tbb/concurrent_vector.h"
-#endif
+#include "Utilities/ObjectPool.h"
+#include "Utilities/SmallStableVector.h"
 
 #include <memory>
 
@@ -80,6 +77,7 @@ namespace MaNGOS
 {
     struct SpellNotifierPlayer;
     struct SpellNotifierCreatureAndPlayer;
+    template<class T> class GridSearchResults;
 }
 
 class SpellCastTargets;
@@ -226,6 +224,13 @@ class Spell
     friend struct MaNGOS::SpellNotifierCreatureAndPlayer;
     friend void Unit::SetCurrentCastedSpell( Spell * pSpell );
     public:
+        // Spells are short lived and created by the map threads: their memory is recycled per thread
+        static void* operator new(size_t size) { return MaNGOS::ObjectPool<Spell>::Allocate(size, s_allocations); }
+        static void operator delete(void* p, size_t size) { MaNGOS::ObjectPool<Spell>::Free(p, size, s_allocations); }
+
+        static MaNGOS::AllocationCounters s_allocations;
+        // Target entries. heapAllocations counts the entries which did not fit in the inline storage of the lists
+        static MaNGOS::AllocationCounters s_targetAllocations;
 
         void EffectEmpty(SpellEffectIndex eff_idx);
         void EffectNULL(SpellEffectIndex eff_idx);
@@ -376,6 +381,7 @@ class Spell
         void SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList &targetUnitMap);
 
         void FillAreaTargets(UnitList &targetUnitMap, float radius, SpellNotifyPushType pushType, SpellTargets spellTargets, WorldObject* originalCaster = NULL);
+        void FillAreaTargets(MaNGOS::GridSearchResults<Unit> &targetUnitMap, float radius, SpellNotifyPushType pushType, SpellTargets spellTargets, WorldObject* originalCaster = NULL);
         void FillRaidOrPartyTargets( UnitList &TagUnitMap, Unit* target, float radius, bool raid, bool withPets, bool withcaster ) const;
 
         template<typename T> WorldObject* FindCorpseUsing();
@@ -606,15 +612,11 @@ class Spell
         };
         bool m_destroyed;
 
-#ifndef USE_STANDARD_MALLOC
-        typedef tbb::concurrent_vector<TargetInfo>     TargetList;
-        typedef tbb::concurrent_vector<GOTargetInfo>   GOTargetList;
-        typedef tbb::concurrent_vector<ItemTargetInfo> ItemTargetList;
-#else
-        typedef std::vector<TargetInfo> TargetList;
-        typedef std::vector<GOTargetInfo> GOTargetList;
-        typedef std::vector<ItemTargetInfo> ItemTargetList;
-#endif
+        // Most spells hit a few targets: no allocation below these sizes.
+        // Entries are never moved, targets are referenced by pointer while the list grows.
+        typedef MaNGOS::SmallStableVector<TargetInfo, 8>     TargetList;
+        typedef MaNGOS::SmallStableVector<GOTargetInfo, 2>   GOTargetList;
+        typedef MaNGOS::SmallStableVector<ItemTargetInfo, 2> ItemTargetList;
 
         TargetList     m_UniqueTargetInfo;
         GOTargetList   m_UniqueGOTargetInfo;
@@ -764,6 +766,11 @@ class SpellEvent : public BasicEvent
         SpellEvent(Spell* spell);
         virtual ~SpellEvent();
 
+        static void* operator new(size_t size) { return MaNGOS::ObjectPool<SpellEvent>::Allocate(size, s_allocations); }
+        static void operator delete(void* p, size_t size) { MaNGOS::ObjectPool<SpellEvent>::Free(p, size, s_allocations); }
+
+        static MaNGOS::AllocationCounters s_allocations;
+
         virtual bool Execute(uint64 e_time, uint32 p_time);
         virtual void Abort(uint64 e_time);
         virtual bool IsDeletable() const;
@@ -825,10 +825,13 @@ void PersistentAreaAura::Update(uint32 diff)
 
 void Aura::ApplyModifier(bool apply, bool Real, bool skipCheckExclusive)
 {
+    AuraType aura = m_modifier.m_auraname;
+    // Amount may have been changed by the caller, or by the handler
+    GetTarget()->InvalidateAuraModifierCache(aura);
+
     // Dans Unit::RemoveAura, ApplyModifier est toujours appelle.
     if (IsApplied() == apply)
         return;
-    AuraType aura = m_modifier.m_auraname;
 
     GetHolder()->SetInUse(true);
     SetInUse(true);
@@ -842,6 +845,7 @@ void Aura::ApplyModifier(bool apply, bool Real, bool skipCheckExclusive)
     m_applied = apply;
     if (aura < TOTAL_AURAS)
         (*this.*AuraHandler [aura])(apply, Real);
+    GetTarget()->InvalidateAuraModifierCache(aura);
 
     if (!apply && !skipCheckExclusive && IsExclusive())
         ExclusiveAuraUnapply();
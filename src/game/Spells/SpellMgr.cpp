@@ -1402,6 +1402,7 @@ void SpellMgr::LoadSpellProcEvents()
         bar.step();
         sLog.outString();
         sLog.outString(">> No spell proc event conditions loaded");
+        BuildSpellExtraInfo();
         return;
     }
 
@@ -1441,6 +1442,8 @@ void SpellMgr::LoadSpellProcEvents()
 
     sLog.outString();
     sLog.outString(">> Loaded %u extra spell proc event conditions +%u custom proc (inc. +%u custom ranks)",  rankHelper.worker.count, rankHelper.worker.customProc, rankHelper.customRank);
+
+    BuildSpellExtraInfo();
 }
 
 struct DoSpellProcItemEnchant
@@ -1543,6 +1546,7 @@ void SpellMgr::LoadSpellBonuses()
         bar.step();
         sLog.outString();
         sLog.outString(">> Loaded %u spell bonus data", count);
+        BuildSpellExtraInfo();
         return;
     }
 
@@ -1666,6 +1670,8 @@ void SpellMgr::LoadSpellBonuses()
 
     sLog.outString();
     sLog.outString(">> Loaded %u extra spell bonus data",  count);
+
+    BuildSpellExtraInfo();
 }
 
 bool SpellMgr::IsSpellProcEventCanTriggeredBy(SpellProcEventEntry const * spellProcEvent, uint32 EventProcFlag, SpellEntry const * procSpell, uint32 procFlags, uint32 procExtra)
@@ -1744,6 +1750,7 @@ void SpellMgr::LoadSpellGroups()
     {
         sLog.outString();
         sLog.outString(">> Loaded %u spell group definitions", count);
+        BuildSpellExtraInfo();
         return;
     }
 
@@ -1807,6 +1814,8 @@ void SpellMgr::LoadSpellGroups()
     delete result;
     sLog.outString();
     sLog.outString(">> Loaded %u spell group definitions", count);
+
+    BuildSpellExtraInfo();
 }
 
 void SpellMgr::LoadSpellGroupStackRules()
@@ -1882,10 +1891,9 @@ bool SpellMgr::ListMorePowerfullSpells(uint32 spellId, std::list<uint32>& list)
     for (spellGroupIdsIt = spellGroupIds.begin(); spellGroupIdsIt != spellGroupIds.end(); ++spellGroupIdsIt)
     {
         bool spellPassed = false;
-        for (SpellGroupSpellMap::const_iterator itr = mSpellGroupSpell.begin(); itr != mSpellGroupSpell.end(); ++itr)
+        SpellGroupSpellMapBounds groupSpell = GetSpellGroupSpellMapBounds(SpellGroup(*spellGroupIdsIt));
+        for (SpellGroupSpellMap::const_iterator itr = groupSpell.first; itr != groupSpell.second; ++itr)
         {
-            if (itr->first != *(spellGroupIdsIt))
-                continue;
             if (!spellPassed)
             {
                 if (itr->second == spellId)
@@ -1924,10 +1932,9 @@ bool SpellMgr::ListLessPowerfullSpells(uint32 spellId, std::list<uint32>& list)
         return false;
     for (spellGroupIdsIt = spellGroupIds.begin(); spellGroupIdsIt != spellGroupIds.end(); ++spellGroupIdsIt)
     {
-        for (SpellGroupSpellMap::const_iterator itr = mSpellGroupSpell.begin(); itr != mSpellGroupSpell.end(); ++itr)
+        SpellGroupSpellMapBounds groupSpell = GetSpellGroupSpellMapBounds(SpellGroup(*spellGroupIdsIt));
+        for (SpellGroupSpellMap::const_iterator itr = groupSpell.first; itr != groupSpell.second; ++itr)
         {
-            if (itr->first != *(spellGroupIdsIt))
-                continue;
             if (itr->second == spellId)
                 break;
             list.push_back(itr->second);
@@ -1953,6 +1960,7 @@ void SpellMgr::LoadSpellElixirs()
 
         sLog.outString();
         sLog.outString(">> Loaded %u spell elixir definitions", count);
+        BuildSpellExtraInfo();
         return;
     }
 
@@ -1985,6 +1993,8 @@ void SpellMgr::LoadSpellElixirs()
 
     sLog.outString();
     sLog.outString(">> Loaded %u spell elixir definitions", count);
+
+    BuildSpellExtraInfo();
 }
 
 struct DoSpellThreat
@@ -2061,6 +2071,7 @@ void SpellMgr::LoadSpellThreats()
         bar.step();
         sLog.outString();
         sLog.outString(">> No spell threat entries loaded.");
+        BuildSpellExtraInfo();
         return;
     }
 
@@ -2092,6 +2103,8 @@ void SpellMgr::LoadSpellThreats()
 
     sLog.outString();
     sLog.outString(">> Loaded %u spell threat entries", rankHelper.worker.count);
+
+    BuildSpellExtraInfo();
 }
 
 bool SpellMgr::IsRankSpellDueToSpell(SpellEntry const *spellInfo_1, uint32 spellId_2) const
@@ -2848,6 +2861,7 @@ void SpellMgr::LoadSpellChains()
         sLog.outString();
         sLog.outString(">> Loaded 0 spell chain records");
         sLog.outErrorDb("`spell_chains` table is empty!");
+        BuildSpellExtraInfo();
         return;
     }
 
@@ -3064,6 +3078,8 @@ void SpellMgr::LoadSpellChains()
 
     sLog.outString();
     sLog.outString(">> Loaded %u spell chain records (%u from DBC data with %u req field updates, and %u loaded from table)", dbc_count + new_count, dbc_count, req_count, new_count);
+
+    BuildSpellExtraInfo();
 }
 
 void SpellMgr::LoadSpellLearnSkills()
@@ -4185,6 +4201,7 @@ void SpellMgr::LoadSpellAffects()
 
         sLog.outString();
         sLog.outString(">> Loaded %u spell affect definitions", count);
+        BuildSpellExtraInfo();
         return;
     }
 
@@ -4269,6 +4286,8 @@ void SpellMgr::LoadSpellAffects()
             sLog.outErrorDb("Spell %u (%s) misses spell_affect for effect %u", id, spellInfo->SpellName[sWorld.GetDefaultDbcLocale()], effectId);
         }
     }
+
+    BuildSpellExtraInfo();
 }
 
 void SpellMgr::LoadFacingCasterFlags()
@@ -4284,6 +4303,7 @@ void SpellMgr::LoadFacingCasterFlags()
         bar.step();
         sLog.outString();
         sLog.outString(">> Loaded %u facing caster flags", count);
+        BuildSpellExtraInfo();
         return;
     }
 
@@ -4314,6 +4334,81 @@ void SpellMgr::LoadFacingCasterFlags()
 
     sLog.outString();
     sLog.outString(">> Loaded %u facing caster flags", count);
+
+    BuildSpellExtraInfo();
+}
+
+void SpellMgr::BuildSpellExtraInfo()
+{
+    std::vector<uint32> extraIndex;
+    std::vector<SpellExtraInfo> extras(1);
+    std::vector<SpellGroup> groupRanges;
+
+    auto getExtra = [&extraIndex, &extras](uint32 spellId) -> SpellExtraInfo&
+    {
+        if (spellId >= extraIndex.size())
+            extraIndex.resize(spellId + 1, 0);
+        if (!extraIndex[spellId])
+        {
+            extraIndex[spellId] = extras.size();
+            extras.push_back(SpellExtraInfo());
+        }
+        return extras[extraIndex[spellId]];
+    };
+
+    for (SpellChainMap::const_iterator itr = mSpellChains.begin(); itr != mSpellChains.end(); ++itr)
+    {
+        SpellExtraInfo& extra = getExtra(itr->first);
+        extra.chain = itr->second;
+        extra.flags |= SPELL_EXTRA_HAS_CHAIN;
+    }
+
+    for (SpellThreatMap::const_iterator itr = mSpellThreatMap.begin(); itr != mSpellThreatMap.end(); ++itr)
+    {
+        SpellExtraInfo& extra = getExtra(itr->first);
+        extra.threat = itr->second;
+        extra.flags |= SPELL_EXTRA_HAS_THREAT;
+    }
+
+    for (SpellBonusMap::const_iterator itr = mSpellBonusMap.begin(); itr != mSpellBonusMap.end(); ++itr)
+    {
+        SpellExtraInfo& extra = getExtra(itr->first);
+        extra.bonus = itr->second;
+        extra.flags |= SPELL_EXTRA_HAS_BONUS;
+    }
+
+    for (SpellProcEventMap::const_iterator itr = mSpellProcEventMap.begin(); itr != mSpellProcEventMap.end(); ++itr)
+        getExtra(itr->first).procEvent = &itr->second;
+
+    for (SpellAffectMap::const_iterator itr = mSpellAffectMap.begin(); itr != mSpellAffectMap.end(); ++itr)
+    {
+        uint32 effectId = itr->first & 0xFF;
+        if (effectId >= MAX_EFFECT_INDEX)
+            continue;
+        SpellExtraInfo& extra = getExtra(itr->first >> 8);
+        extra.affectMask[effectId] = itr->second;
+        extra.flags |= SPELL_EXTRA_HAS_AFFECT_0 << effectId;
+    }
+
+    for (SpellElixirMap::const_iterator itr = mSpellElixirs.begin(); itr != mSpellElixirs.end(); ++itr)
+        getExtra(itr->first).elixirMask = itr->second;
+
+    for (SpellFacingFlagMap::const_iterator itr = mSpellFacingFlagMap.begin(); itr != mSpellFacingFlagMap.end(); ++itr)
+        getExtra(itr->first).facingFlag = itr->second;
+
+    // mSpellSpellGroup is ordered by spell id, so the groups of each spell are stored contiguously
+    for (SpellSpellGroupMap::const_iterator itr = mSpellSpellGroup.begin(); itr != mSpellSpellGroup.end(); ++itr)
+    {
+        SpellExtraInfo& extra = getExtra(itr->first);
+        if (!extra.groupsCount)
+            extra.groupsBegin = groupRanges.size();
+        groupRanges.push_back(itr->second);
+        ++extra.groupsCount;
+    }
+
+    mSpellExtraIndex.swap(extraIndex);
+    mSpellExtras.swap(extras);
+    mSpellGroupRanges.swap(groupRanges);
 }
 
 void SpellMgr::LoadSpells()
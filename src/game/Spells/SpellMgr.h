@@ -656,7 +656,8 @@ enum SpellGroup
 
 //                  spell_id, group_id
 typedef std::multimap<uint32, SpellGroup > SpellSpellGroupMap;
-typedef std::pair<SpellSpellGroupMap::const_iterator,SpellSpellGroupMap::const_iterator> SpellSpellGroupMapBounds;
+// groups of a spell, as a range of SpellMgr::mSpellGroupRanges
+typedef std::pair<SpellGroup const*, SpellGroup const*> SpellSpellGroupMapBounds;
 
 //                      group_id, spell_id
 typedef std::multimap<SpellGroup, int32> SpellGroupSpellMap;
@@ -861,6 +862,38 @@ inline bool IsProfessionOrRidingSkill(uint32 skill)
 typedef std::map<uint32, uint32> SpellFacingFlagMap;
 typedef std::vector<SpellEntry*> SpellEntryMap;
 
+enum SpellExtraInfoFlags
+{
+    SPELL_EXTRA_HAS_CHAIN       = 0x01,
+    SPELL_EXTRA_HAS_THREAT      = 0x02,
+    SPELL_EXTRA_HAS_BONUS       = 0x04,
+    SPELL_EXTRA_HAS_AFFECT_0    = 0x08,                     // + effect index for the other effects
+};
+
+// Data of the spell side tables for one spell, rebuilt after each of them is (re)loaded
+// so that the combat code reads a single record instead of searching each table
+struct SpellExtraInfo
+{
+    SpellExtraInfo() : procEvent(NULL), facingFlag(0), groupsBegin(0), groupsCount(0), elixirMask(0), flags(0)
+    {
+        memset(&chain, 0, sizeof(chain));
+        memset(&threat, 0, sizeof(threat));
+        memset(&bonus, 0, sizeof(bonus));
+        memset(affectMask, 0, sizeof(affectMask));
+    }
+
+    SpellChainNode chain;
+    SpellThreatEntry threat;
+    SpellBonusEntry bonus;
+    SpellProcEventEntry const* procEvent;                   // points into SpellMgr::mSpellProcEventMap
+    uint64 affectMask[MAX_EFFECT_INDEX];
+    uint32 facingFlag;
+    uint32 groupsBegin;                                     // first index in SpellMgr::mSpellGroupRanges
+    uint16 groupsCount;
+    uint8  elixirMask;
+    uint8  flags;                                           // SpellExtraInfoFlags
+};
+
 class SpellMgr
 {
     friend struct DoSpellBonuses;
@@ -877,15 +910,18 @@ class SpellMgr
         // Spell Groups - TrinityCore
         SpellSpellGroupMapBounds GetSpellSpellGroupMapBounds(uint32 spell_id) const
         {
-            spell_id = GetFirstSpellInChain(spell_id);
-            return SpellSpellGroupMapBounds(mSpellSpellGroup.lower_bound(spell_id),mSpellSpellGroup.upper_bound(spell_id));
+            SpellExtraInfo const* extra = GetSpellExtraInfo(GetFirstSpellInChain(spell_id));
+            if (!extra || !extra->groupsCount)
+                return SpellSpellGroupMapBounds(NULL, NULL);
+            SpellGroup const* begin = &mSpellGroupRanges[extra->groupsBegin];
+            return SpellSpellGroupMapBounds(begin, begin + extra->groupsCount);
         }
         uint32 IsSpellMemberOfSpellGroup(uint32 spellid, SpellGroup groupid) const
         {
             SpellSpellGroupMapBounds spellGroup = GetSpellSpellGroupMapBounds(spellid);
-            for (SpellSpellGroupMap::const_iterator itr = spellGroup.first; itr != spellGroup.second ; ++itr)
+            for (SpellGroup const* itr = spellGroup.first; itr != spellGroup.second ; ++itr)
             {
-                if (itr->second == groupid)
+                if (*itr == groupid)
                     return true;
             }
             return false;
@@ -930,9 +966,9 @@ class SpellMgr
             // find SpellGroups which are common for both spells
             SpellSpellGroupMapBounds spellGroup1 = GetSpellSpellGroupMapBounds(spellid_1);
             std::set<SpellGroup> groups;
-            for (SpellSpellGroupMap::const_iterator itr = spellGroup1.first; itr != spellGroup1.second ; ++itr)
-                if (IsSpellMemberOfSpellGroup(spellid_2, itr->second))
-                    groups.insert(itr->second);
+            for (SpellGroup const* itr = spellGroup1.first; itr != spellGroup1.second ; ++itr)
+                if (IsSpellMemberOfSpellGroup(spellid_2, *itr))
+                    groups.insert(*itr);
 
             SpellGroupStackRule rule = SPELL_GROUP_STACK_RULE_DEFAULT;
 
@@ -961,11 +997,9 @@ class SpellMgr
         bool IsMorePowerfullSpell(uint32 powerfullSpell, uint32 otherSpell, SpellGroup group) const
         {
             // The most powerfull spell appears after less powerfull spells in the list.
-            bool spellPassed = false;
-            for (SpellGroupSpellMap::const_iterator itr = mSpellGroupSpell.begin(); itr != mSpellGroupSpell.end(); ++itr)
+            SpellGroupSpellMapBounds groupSpell = GetSpellGroupSpellMapBounds(group);
+            for (SpellGroupSpellMap::const_iterator itr = groupSpell.first; itr != groupSpell.second; ++itr)
             {
-                if (itr->first != group)
-                    continue;
                 if (itr->second == powerfullSpell)
                     return false;
                 if (itr->second == otherSpell)
@@ -978,9 +1012,9 @@ class SpellMgr
         // Spell affects
         ClassFamilyMask GetSpellAffectMask(uint32 spellId, SpellEffectIndex effectId) const
         {
-            SpellAffectMap::const_iterator itr = mSpellAffectMap.find((spellId<<8) + effectId);
-            if (itr != mSpellAffectMap.end())
-                return ClassFamilyMask(itr->second);
+            SpellExtraInfo const* extra = GetSpellExtraInfo(spellId);
+            if (extra && (extra->flags & (SPELL_EXTRA_HAS_AFFECT_0 << effectId)))
+                return ClassFamilyMask(extra->affectMask[effectId]);
             if (SpellEntry const* spellEntry = GetSpellEntry(spellId))
                 return ClassFamilyMask(spellEntry->EffectItemType[effectId]);
             return ClassFamilyMask();
@@ -990,11 +1024,8 @@ class SpellMgr
 
         uint32 GetSpellElixirMask(uint32 spellid) const
         {
-            SpellElixirMap::const_iterator itr = mSpellElixirs.find(spellid);
-            if(itr==mSpellElixirs.end())
-                return 0x0;
-
-            return itr->second;
+            SpellExtraInfo const* extra = GetSpellExtraInfo(spellid);
+            return extra ? extra->elixirMask : 0x0;
         }
 
         SpellSpecific GetSpellElixirSpecific(uint32 spellid) const
@@ -1012,9 +1043,9 @@ class SpellMgr
 
         SpellThreatEntry const* GetSpellThreatEntry(uint32 spellid) const
         {
-            SpellThreatMap::const_iterator itr = mSpellThreatMap.find(spellid);
-            if (itr != mSpellThreatMap.end())
-                return &itr->second;
+            SpellExtraInfo const* extra = GetSpellExtraInfo(spellid);
+            if (extra && (extra->flags & SPELL_EXTRA_HAS_THREAT))
+                return &extra->threat;
 
             return NULL;
         }
@@ -1033,10 +1064,8 @@ class SpellMgr
         // Spell proc events
         SpellProcEventEntry const* GetSpellProcEvent(uint32 spellId) const
         {
-            SpellProcEventMap::const_iterator itr = mSpellProcEventMap.find(spellId);
-            if( itr != mSpellProcEventMap.end( ) )
-                return &itr->second;
-            return NULL;
+            SpellExtraInfo const* extra = GetSpellExtraInfo(spellId);
+            return extra ? extra->procEvent : NULL;
         }
 
         // Spell procs from item enchants
@@ -1055,19 +1084,17 @@ class SpellMgr
         SpellBonusEntry const* GetSpellBonusData(uint32 spellId) const
         {
             // Lookup data
-            SpellBonusMap::const_iterator itr = mSpellBonusMap.find(spellId);
-            if( itr != mSpellBonusMap.end( ) )
-                return &itr->second;
+            SpellExtraInfo const* extra = GetSpellExtraInfo(spellId);
+            if (extra && (extra->flags & SPELL_EXTRA_HAS_BONUS))
+                return &extra->bonus;
 
             return NULL;
         }
 
         uint32 GetSpellFacingFlag(uint32 spellId) const
         {
-            SpellFacingFlagMap::const_iterator itr =  mSpellFacingFlagMap.find(spellId);
-            if(itr != mSpellFacingFlagMap.end())
-                return itr->second;
-            return 0x0;
+            SpellExtraInfo const* extra = GetSpellExtraInfo(spellId);
+            return extra ? extra->facingFlag : 0x0;
         }
 
         // Spell target coordinates
@@ -1082,11 +1109,11 @@ class SpellMgr
         // Spell ranks chains
         SpellChainNode const* GetSpellChainNode(uint32 spell_id) const
         {
-            SpellChainMap::const_iterator itr = mSpellChains.find(spell_id);
-            if(itr == mSpellChains.end())
+            SpellExtraInfo const* extra = GetSpellExtraInfo(spell_id);
+            if (!extra || !(extra->flags & SPELL_EXTRA_HAS_CHAIN))
                 return NULL;
 
-            return &itr->second;
+            return &extra->chain;
         }
 
         uint32 GetFirstSpellInChain(uint32 spell_id) const
@@ -1130,17 +1157,17 @@ class SpellMgr
 
         uint8 IsHighRankOfSpell(uint32 spell1,uint32 spell2) const
         {
-            SpellChainMap::const_iterator itr = mSpellChains.find(spell1);
+            SpellChainNode const* node = GetSpellChainNode(spell1);
 
             uint32 rank2 = GetSpellRank(spell2);
 
             // not ordered correctly by rank value
-            if(itr == mSpellChains.end() || !rank2 || itr->second.rank <= rank2)
+            if(!node || !rank2 || node->rank <= rank2)
                 return false;
 
             // check present in same rank chain
-            for(; itr != mSpellChains.end(); itr = mSpellChains.find(itr->second.prev))
-                if(itr->second.prev==spell2)
+            for(; node; node = GetSpellChainNode(node->prev))
+                if(node->prev==spell2)
                     return true;
 
             return false;
@@ -1296,6 +1323,14 @@ class SpellMgr
         }
 
     private:
+        SpellExtraInfo const* GetSpellExtraInfo(uint32 spellId) const
+        {
+            if (spellId >= mSpellExtraIndex.size() || !mSpellExtraIndex[spellId])
+                return NULL;
+            return &mSpellExtras[mSpellExtraIndex[spellId]];
+        }
+        void BuildSpellExtraInfo();
+
         SpellScriptTarget  mSpellScriptTarget;
         SpellChainMap      mSpellChains;
         SpellChainMapNext  mSpellChainsNext;
@@ -1323,6 +1358,10 @@ class SpellMgr
         SpellSpellGroupMap mSpellSpellGroup;
         SpellGroupSpellMap mSpellGroupSpell;
         SpellGroupStackMap   mSpellGroupStack;
+        // Flattened side tables
+        std::vector<uint32> mSpellExtraIndex;                   // spell id -> index in mSpellExtras, 0 if none
+        std::vector<SpellExtraInfo> mSpellExtras;               // first record unused
+        std::vector<SpellGroup> mSpellGroupRanges;              // groups of each spell, in spell id order
         // SpellEntry
         SpellEntryMap      mSpellEntryMap;
 };
@@ -68,6 +68,7 @@ HostileReference::HostileReference(Unit* pUnit, ThreatManager *pThreatManager, f
     iUnitGuid = pUnit->GetObjectGuid();
     iOnline = true;
     iAccessible = true;
+    iSortPending = false;
 }
 
 //============================================================
@@ -210,6 +211,47 @@ void ThreatContainer::clearReferences()
         delete(*i);
     }
     iThreatList.clear();
+    iThreatIndex.clear();
+    iSortPendingCount = 0;
+}
+
+//============================================================
+// New references are appended, the next sort moves them to their place
+
+void ThreatContainer::addReference(HostileReference* pHostileReference)
+{
+    pHostileReference->iThreatListItr = iThreatList.insert(iThreatList.end(), pHostileReference);
+    pHostileReference->iSortPending = true;
+    ++iSortPendingCount;
+    iThreatIndex[pHostileReference->getUnitGuid()] = pHostileReference;
+}
+
+//============================================================
+
+void ThreatContainer::remove(HostileReference* pRef)
+{
+    ThreatIndex::iterator itr = iThreatIndex.find(pRef->getUnitGuid());
+    if (itr == iThreatIndex.end() || itr->second != pRef)
+        return;
+
+    iThreatIndex.erase(itr);
+    iThreatList.erase(pRef->iThreatListItr);
+    if (pRef->iSortPending)
+    {
+        pRef->iSortPending = false;
+        --iSortPendingCount;
+    }
+}
+
+//============================================================
+
+void ThreatContainer::markSortPending(HostileReference* pRef)
+{
+    if (!pRef->iSortPending)
+    {
+        pRef->iSortPending = true;
+        ++iSortPendingCount;
+    }
 }
 
 //============================================================
@@ -219,18 +261,8 @@ HostileReference* ThreatContainer::getReferenceByTarget(Unit* pVictim)
     if (!pVictim)
         return nullptr;
 
-    HostileReference* result = nullptr;
-    ObjectGuid guid = pVictim->GetObjectGuid();
-    for (ThreatList::const_iterator i = iThreatList.begin(); i != iThreatList.end(); ++i)
-    {
-        if ((*i)->getUnitGuid() == guid)
-        {
-            result = (*i);
-            break;
-        }
-    }
-
-    return result;
+    ThreatIndex::const_iterator itr = iThreatIndex.find(pVictim->GetObjectGuid());
+    return itr != iThreatIndex.end() ? itr->second : nullptr;
 }
 
 //============================================================
@@ -273,11 +305,28 @@ bool HostileReferenceSortPredicate(const HostileReference* lhs, const HostileRef
 
 //============================================================
 // Check if the list is dirty and sort if necessary
+// Only the references whose threat changed are sorted, then merged back into the others which
+// are still in order. Nodes are spliced, so iterators held on the list stay valid.
 
 void ThreatContainer::update()
 {
-    if (iDirty && iThreatList.size() > 1)
-        iThreatList.sort(HostileReferenceSortPredicate);
+    if (iDirty && iSortPendingCount)
+    {
+        ThreatList pending;
+        for (ThreatList::iterator itr = iThreatList.begin(); itr != iThreatList.end();)
+        {
+            ThreatList::iterator current = itr++;
+            if ((*current)->iSortPending)
+            {
+                (*current)->iSortPending = false;
+                pending.splice(pending.end(), iThreatList, current);
+            }
+        }
+
+        pending.sort(HostileReferenceSortPredicate);
+        iThreatList.merge(pending, HostileReferenceSortPredicate);
+        iSortPendingCount = 0;
+    }
     iDirty = false;
 }
 
@@ -513,6 +562,11 @@ void ThreatManager::processThreatEvent(ThreatRefStatusChangeEvent* threatRefStat
     switch (threatRefStatusChangeEvent->getType())
     {
         case UEV_THREAT_REF_THREAT_CHANGE:
+            if (hostileReference->isOnline())
+                iThreatContainer.markSortPending(hostileReference);
+            else
+                iThreatOfflineContainer.markSortPending(hostileReference);
+
             if ((getCurrentVictim() == hostileReference && threatRefStatusChangeEvent->getFValue() < 0.0f) ||
                     (getCurrentVictim() != hostileReference && threatRefStatusChangeEvent->getFValue() > 0.0f))
                 setDirty(true);                             // the order in the threat list might have changed
@@ -532,8 +586,8 @@ void ThreatManager::processThreatEvent(ThreatRefStatusChangeEvent* threatRefStat
             {
                 if (getCurrentVictim() && hostileReference->getThreat() > (1.1f * getCurrentVictim()->getThreat()))
                     setDirty(true);
-                iThreatContainer.addReference(hostileReference);
                 iThreatOfflineContainer.remove(hostileReference);
+                iThreatContainer.addReference(hostileReference);
             }
             break;
         case UEV_THREAT_REF_REMOVE_FROM_LIST:
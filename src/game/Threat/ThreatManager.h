@@ -34,7 +34,11 @@
 class Unit;
 class Creature;
 class ThreatManager;
+class ThreatContainer;
 class SpellEntry;
+class HostileReference;
+
+typedef std::list<HostileReference*> ThreatList;
 
 //==============================================================
 // Class to calculate the real threat based
@@ -120,6 +124,8 @@ class MANGOS_DLL_SPEC HostileReference : public Reference<Unit, ThreatManager>
         // Tell our refFrom (source) object, that the link is cut (Target destroyed)
         void sourceObjectDestroyLink() override;
     private:
+        friend class ThreatContainer;
+
         // Inform the source, that the status of that reference was changed
         void fireStatusChanged(ThreatRefStatusChangeEvent& pThreatRefStatusChangeEvent);
 
@@ -129,27 +135,33 @@ class MANGOS_DLL_SPEC HostileReference : public Reference<Unit, ThreatManager>
         ObjectGuid iUnitGuid;
         bool iOnline;
         bool iAccessible;
+        bool iSortPending;                                  // threat changed since the container last placed it
+        ThreatList::iterator iThreatListItr;                // position in the container list, for constant time removal
 };
 
 //==============================================================
 class ThreatManager;
 
-typedef std::list<HostileReference*> ThreatList;
-
 class MANGOS_DLL_SPEC ThreatContainer
 {
+    typedef UNORDERED_MAP<ObjectGuid, HostileReference*> ThreatIndex;
+
     ThreatList iThreatList;
+    ThreatIndex iThreatIndex;                               // victim guid -> reference
+    uint32 iSortPendingCount;
     bool iDirty;
 protected:
     friend class ThreatManager;
 
-    void remove(HostileReference* pRef) { iThreatList.remove(pRef); }
-    void addReference(HostileReference* pHostileReference) { iThreatList.push_back(pHostileReference); }
+    void remove(HostileReference* pRef);
+    void addReference(HostileReference* pHostileReference);
     void clearReferences();
+    // The threat of the reference changed, it is moved to its place at the next sort
+    void markSortPending(HostileReference* pRef);
     // Sort the list if necessary
     void update();
 public:
-    ThreatContainer() { iDirty = false; }
+    ThreatContainer() : iSortPendingCount(0), iDirty(false) {}
     ~ThreatContainer() { clearReferences(); }
 
     HostileReference* addThreat(Unit* pVictim, float pThreat);
@@ -396,6 +396,136 @@ bool Unit::IsTriggeredAtSpellProcEvent(Unit *pVictim, SpellAuraHolder* holder, S
     return roll_chance_f(chance);
 }
 
+// Must stay in sync with IsTriggeredAtSpellProcEvent: holders not indexed are never checked
+uint32 Unit::GetHolderIndexProcFlags(SpellEntry const* spellProto, bool& unconditional)
+{
+    // Hardcoded auras, triggered whatever their proc flags
+    unconditional = spellProto->SpellIconID == 1820 ||
+                    (spellProto->SpellIconID == 79 && (spellProto->SpellFamilyName == SPELLFAMILY_PALADIN || spellProto->SpellFamilyName == SPELLFAMILY_PRIEST)) ||
+                    spellProto->Id == 25906 || spellProto->Id == 16864 ||
+                    spellProto->EffectApplyAuraName[0] == SPELL_AURA_ADD_TARGET_TRIGGER;
+
+    SpellProcEventEntry const* spellProcEvent = sSpellMgr.GetSpellProcEvent(spellProto->Id);
+    if (spellProcEvent && spellProcEvent->procFlags)
+        return spellProcEvent->procFlags;
+    return spellProto->procFlags;
+}
+
+// Buckets are kept in SpellAuraHolderMap order, so candidates only need a merge
+static void InsertInProcHolderBucket(ProcHolderBucket& bucket, ProcHolderIndexEntry const& entry)
+{
+    bucket.insert(std::upper_bound(bucket.begin(), bucket.end(), entry), entry);
+}
+
+void Unit::AddToProcHolderIndex(SpellAuraHolder* holder)
+{
+    bool unconditional;
+    uint32 procFlags = GetHolderIndexProcFlags(holder->GetSpellProto(), unconditional);
+    if (!procFlags && !unconditional)
+        return;
+
+    if (!m_procHolderIndex)
+        m_procHolderIndex = new ProcHolderIndex;
+
+    ProcHolderIndexEntry entry(holder, holder->GetId(), procFlags, m_procHolderIndex->sequence++);
+    if (unconditional)
+    {
+        InsertInProcHolderBucket(m_procHolderIndex->unconditional, entry);
+        return;
+    }
+
+    for (uint32 bit = 0; bit < PROC_FLAG_INDEX_COUNT; ++bit)
+        if (procFlags & (1 << bit))
+            InsertInProcHolderBucket(m_procHolderIndex->buckets[bit], entry);
+}
+
+static void RemoveFromProcHolderBucket(ProcHolderBucket& bucket, SpellAuraHolder* holder)
+{
+    for (ProcHolderBucket::iterator itr = bucket.begin(); itr != bucket.end(); ++itr)
+    {
+        if (itr->holder == holder)
+        {
+            bucket.erase(itr);
+            return;
+        }
+    }
+}
+
+void Unit::RemoveFromProcHolderIndex(SpellAuraHolder* holder)
+{
+    if (!m_procHolderIndex)
+        return;
+
+    // Not recomputed from the spell: spell_proc_event may have been reloaded since the holder was added
+    RemoveFromProcHolderBucket(m_procHolderIndex->unconditional, holder);
+    for (uint32 bit = 0; bit < PROC_FLAG_INDEX_COUNT; ++bit)
+        RemoveFromProcHolderBucket(m_procHolderIndex->buckets[bit], holder);
+}
+
+void Unit::GetProcHolderCandidates(uint32 procFlag, ProcHolderBucket& candidates) const
+{
+    candidates.clear();
+    if (!m_procHolderIndex)
+        return;
+
+    // Cursors on the sorted buckets to merge. An entry of a bucket is skipped when
+    // it is also in the bucket of a lower bit of procFlag, so it is merged only once.
+    struct Cursor
+    {
+        ProcHolderBucket::const_iterator itr;
+        ProcHolderBucket::const_iterator end;
+        uint32 lowerBits;
+
+        void Skip()
+        {
+            while (itr != end && (itr->procFlags & lowerBits))
+                ++itr;
+        }
+    };
+    Cursor cursors[PROC_FLAG_INDEX_COUNT + 1];
+    uint32 count = 0;
+
+    if (!m_procHolderIndex->unconditional.empty())
+    {
+        Cursor& cursor = cursors[count++];
+        cursor.itr = m_procHolderIndex->unconditional.begin();
+        cursor.end = m_procHolderIndex->unconditional.end();
+        cursor.lowerBits = 0;
+    }
+
+    for (uint32 bit = 0; bit < PROC_FLAG_INDEX_COUNT; ++bit)
+    {
+        if (!(procFlag & (1 << bit)))
+            continue;
+
+        ProcHolderBucket const& bucket = m_procHolderIndex->buckets[bit];
+        if (bucket.empty())
+            continue;
+
+        Cursor& cursor = cursors[count++];
+        cursor.itr = bucket.begin();
+        cursor.end = bucket.end();
+        cursor.lowerBits = procFlag & ((1 << bit) - 1);
+        cursor.Skip();
+    }
+
+    // Only a few buckets for one proc: a linear scan of the cursors is enough
+    for (;;)
+    {
+        Cursor* next = nullptr;
+        for (uint32 i = 0; i < count; ++i)
+            if (cursors[i].itr != cursors[i].end && (!next || *cursors[i].itr < *next->itr))
+                next = &cursors[i];
+
+        if (!next)
+            break;
+
+        candidates.push_back(*next->itr);
+        ++next->itr;
+        next->Skip();
+    }
+}
+
 SpellAuraProcResult Unit::HandleHasteAuraProc(Unit *pVictim, uint32 damage, Aura* triggeredByAura, SpellEntry const * /*procSpell*/, uint32 /*procFlag*/, uint32 procEx, uint32 cooldown)
 {
     // Flurry: last charge crit will reapply the buff, don't remove any charges
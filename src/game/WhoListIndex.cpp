@@ -0,0 +1,345 @@
+/*
+ * Copyright (C) 2005-2011 MaNGOS <http://getmangos.com/>
+ * Copyright (C) 2009-2011 MaNGOSZero <https://github.com/mangos/zero>
+ * Copyright (C) 2011-2016 Nostalrius <https://nostalrius.org>
+ * Copyright (C) 2016-2017 Elysium Project <https://github.com/elysium-project>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "WhoListIndex.h"
+#include "Policies/SingletonImp.h"
+#include "Player.h"
+#include "World.h"
+#include "WorldSession.h"
+#include "WorldPacket.h"
+#include "ObjectMgr.h"
+#include "GuildMgr.h"
+#include "Util.h"
+
+INSTANTIATE_SINGLETON_1(WhoListIndex);
+
+void WhoListIndex::SetNames(Entry& entry, std::string const& name, std::string const& guildName)
+{
+    entry.name = name;
+    entry.guildName = guildName;
+    // Names which can not be converted only match the queries without name filter
+    if (Utf8toWStr(name, entry.wname))
+        wstrToLower(entry.wname);
+    else
+        entry.wname.clear();
+    if (Utf8toWStr(guildName, entry.wguildName))
+        wstrToLower(entry.wguildName);
+    else
+        entry.wguildName.clear();
+}
+
+void WhoListIndex::Link(uint32 guid, Entry const& entry)
+{
+    m_levelBuckets[entry.teamId][GetLevelBucket(entry.level)].insert(guid);
+    m_zoneBuckets[entry.zoneId].insert(guid);
+}
+
+void WhoListIndex::Unlink(uint32 guid, Entry const& entry)
+{
+    m_levelBuckets[entry.teamId][GetLevelBucket(entry.level)].erase(guid);
+    std::unordered_map<uint32, Bucket>::iterator itr = m_zoneBuckets.find(entry.zoneId);
+    if (itr != m_zoneBuckets.end())
+    {
+        itr->second.erase(guid);
+        if (itr->second.empty())
+            m_zoneBuckets.erase(itr);
+    }
+}
+
+void WhoListIndex::AddPlayer(Player* player)
+{
+    Entry entry;
+    entry.player = player;
+    entry.level = player->getLevel();
+    entry.zoneId = player->GetCachedZoneId();
+    entry.race = player->getRace();
+    entry.classId = player->getClass();
+    entry.teamId = player->GetTeamId();
+    entry.guildId = player->GetGuildId();
+    SetNames(entry, player->GetName(), sGuildMgr.GetGuildNameById(player->GetGuildId()));
+
+    uint32 guid = player->GetGUIDLow();
+    ACE_Write_Guard<ACE_RW_Thread_Mutex> guard(m_lock);
+    EntryMap::iterator itr = m_entries.find(guid);
+    if (itr != m_entries.end())
+        Unlink(guid, itr->second);
+    m_entries[guid] = entry;
+    Link(guid, entry);
+}
+
+void WhoListIndex::RemovePlayer(Player* player)
+{
+    uint32 guid = player->GetGUIDLow();
+    ACE_Write_Guard<ACE_RW_Thread_Mutex> guard(m_lock);
+    EntryMap::iterator itr = m_entries.find(guid);
+    // The same character may already have been added again (Master / Node transfer)
+    if (itr == m_entries.end() || itr->second.player != player)
+        return;
+    Unlink(guid, itr->second);
+    m_entries.erase(itr);
+}
+
+void WhoListIndex::UpdateLevel(Player* player)
+{
+    uint32 guid = player->GetGUIDLow();
+    ACE_Write_Guard<ACE_RW_Thread_Mutex> guard(m_lock);
+    EntryMap::iterator itr = m_entries.find(guid);
+    if (itr == m_entries.end() || itr->second.player != player || itr->second.level == player->getLevel())
+        return;
+    Unlink(guid, itr->second);
+    itr->second.level = player->getLevel();
+    Link(guid, itr->second);
+}
+
+void WhoListIndex::UpdateZone(Player* player)
+{
+    uint32 guid = player->GetGUIDLow();
+    ACE_Write_Guard<ACE_RW_Thread_Mutex> guard(m_lock);
+    EntryMap::iterator itr = m_entries.find(guid);
+    if (itr == m_entries.end() || itr->second.player != player || itr->second.zoneId == player->GetCachedZoneId())
+        return;
+    Unlink(guid, itr->second);
+    itr->second.zoneId = player->GetCachedZoneId();
+    Link(guid, itr->second);
+}
+
+void WhoListIndex::UpdateGuild(Player* player)
+{
+    std::string guildName = sGuildMgr.GetGuildNameById(player->GetGuildId());
+    ACE_Write_Guard<ACE_RW_Thread_Mutex> guard(m_lock);
+    EntryMap::iterator itr = m_entries.find(player->GetGUIDLow());
+    if (itr == m_entries.end() || itr->second.player != player)
+        return;
+    itr->second.guildId = player->GetGuildId();
+    SetNames(itr->second, itr->second.name, guildName);
+}
+
+void WhoListIndex::UpdateGuildName(uint32 guildId, std::string const& guildName)
+{
+    ACE_Write_Guard<ACE_RW_Thread_Mutex> guard(m_lock);
+    for (EntryMap::iterator itr = m_entries.begin(); itr != m_entries.end(); ++itr)
+        if (itr->second.guildId == guildId && itr->second.guildName != guildName)
+            SetNames(itr->second, itr->second.name, guildName);
+}
+
+std::string WhoListIndex::BuildCacheKey(WorldSession* session, WhoListQuery const& query)
+{
+    // Everything the answer depends on, apart from the index itself
+    Player* viewer = session->GetPlayer();
+    ByteBuffer key;
+    auto appendString = [&key](std::wstring const& str)
+    {
+        key << uint32(str.size());
+        key.append(reinterpret_cast<uint8 const*>(str.data()), str.size() * sizeof(wchar_t));
+    };
+
+    key << uint32(viewer->GetTeamId());
+    key << uint32(sWorld.getConfig(CONFIG_PHASE_WHO) ? 0 : viewer->worldMask);
+    key << uint32(session->GetSessionDbLocaleIndex());
+    key << uint32(IsBattleGroundZone(viewer->GetCachedZoneId()) ? viewer->GetInstanceId() : 0);
+    key << query.levelMin << query.levelMax << query.raceMask << query.classMask;
+    key << query.zonesCount;
+    for (uint32 i = 0; i < query.zonesCount; ++i)
+        key << query.zoneIds[i];
+    key << query.stringsCount;
+    for (uint32 i = 0; i < query.stringsCount; ++i)
+        appendString(query.strings[i]);
+    appendString(query.playerName);
+    appendString(query.guildName);
+    return std::string(reinterpret_cast<char const*>(key.contents()), key.wpos());
+}
+
+void WhoListIndex::BuildWhoList(WorldSession* session, WhoListQuery const& query, WorldPacket& data)
+{
+    uint32 cacheDelay = sWorld.getConfig(CONFIG_UINT32_WHO_LIST_CACHE_DELAY);
+    // GMs see a different list depending on their security, and hardly spam /who
+    bool cacheable = cacheDelay && session->GetSecurity() == SEC_PLAYER && session->GetPlayer()->GetVisibility() == VISIBILITY_ON;
+    std::string key;
+    if (cacheable)
+    {
+        key = BuildCacheKey(session, query);
+        ACE_Guard<ACE_Thread_Mutex> guard(m_cacheLock);
+        AnswerCache::const_iterator itr = m_cache.find(key);
+        if (itr != m_cache.end() && WorldTimer::getMSTimeDiffToNow(itr->second.time) < cacheDelay)
+        {
+            data.append(itr->second.data);
+            return;
+        }
+    }
+
+    FillWhoList(session, query, data);
+
+    if (!cacheable)
+        return;
+
+    ACE_Guard<ACE_Thread_Mutex> guard(m_cacheLock);
+    uint32 now = WorldTimer::getMSTime();
+    if (m_cache.size() >= WHO_LIST_MAX_CACHED_ANSWERS)
+    {
+        for (AnswerCache::iterator itr = m_cache.begin(); itr != m_cache.end();)
+        {
+            if (WorldTimer::getMSTimeDiff(itr->second.time, now) >= cacheDelay)
+                itr = m_cache.erase(itr);
+            else
+                ++itr;
+        }
+        if (m_cache.size() >= WHO_LIST_MAX_CACHED_ANSWERS)
+            m_cache.clear();
+    }
+    CachedAnswer& answer = m_cache[key];
+    answer.time = now;
+    answer.data.clear();
+    answer.data.append(data.contents(), data.wpos());
+}
+
+void WhoListIndex::FillWhoList(WorldSession* session, WhoListQuery const& query, WorldPacket& data) const
+{
+    Player* viewer = session->GetPlayer();
+    int32 localeIndex = session->GetSessionDbLocaleIndex();
+    size_t countPos = data.wpos();
+    data << uint32(0);                                      // listed count, set below
+    data << uint32(0);                                      // online count, set below
+
+    uint32 listed = 0;
+    std::map<uint32, std::wstring> areaNames;               // lowercased, filled on demand
+
+    ACE_Read_Guard<ACE_RW_Thread_Mutex> guard(m_lock);
+
+    // Returns false once the answer is full
+    auto visit = [&](Bucket const& bucket)
+    {
+        for (Bucket::const_iterator itr = bucket.begin(); itr != bucket.end(); ++itr)
+        {
+            Entry const& entry = m_entries.find(*itr)->second;
+            if (!MatchEntry(viewer, query, entry, localeIndex, areaNames))
+                continue;
+
+            data << entry.name;                             // player name
+            data << entry.guildName;                        // guild name
+            data << uint32(entry.level);                    // player level
+            data << uint32(entry.classId);                  // player class
+            data << uint32(entry.race);                     // player race
+            data << uint32(entry.zoneId);                   // player zone id
+
+            if (++listed == WHO_LIST_MAX_RESULTS)
+                return false;
+        }
+        return true;
+    };
+
+    if (query.zonesCount)
+    {
+        std::set<uint32> zones(query.zoneIds, query.zoneIds + query.zonesCount);
+        for (std::set<uint32>::const_iterator zone = zones.begin(); zone != zones.end(); ++zone)
+        {
+            std::unordered_map<uint32, Bucket>::const_iterator itr = m_zoneBuckets.find(*zone);
+            if (itr != m_zoneBuckets.end() && !visit(itr->second))
+                break;
+        }
+    }
+    else if (query.levelMin <= query.levelMax)
+    {
+        bool bothTeams = session->GetSecurity() > SEC_PLAYER || sWorld.getConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_WHO_LIST);
+        bool full = false;
+        for (uint32 teamId = 0; teamId < TEAM_NEUTRAL && !full; ++teamId)
+        {
+            if (!bothTeams && teamId != uint32(viewer->GetTeamId()))
+                continue;
+            for (uint32 i = GetLevelBucket(query.levelMin); i <= GetLevelBucket(query.levelMax) && !full; ++i)
+                full = !visit(m_levelBuckets[teamId][i]);
+        }
+    }
+
+    uint32 online = m_entries.size();
+    data.put<uint32>(countPos, listed);
+    data.put<uint32>(countPos + 4, online > WHO_LIST_MAX_RESULTS ? online : listed);
+}
+
+bool WhoListIndex::MatchEntry(Player* viewer, WhoListQuery const& query, Entry const& entry, int32 localeIndex, std::map<uint32, std::wstring>& areaNames) const
+{
+    Player* pl = entry.player;
+
+    if (viewer->GetSession()->GetSecurity() == SEC_PLAYER)
+    {
+        // player can see member of other team only if CONFIG_BOOL_ALLOW_TWO_SIDE_WHO_LIST
+        if (entry.teamId != viewer->GetTeamId() && !sWorld.getConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_WHO_LIST))
+            return false;
+
+        // player can see MODERATOR, GAME MASTER, ADMINISTRATOR only if CONFIG_GM_IN_WHO_LIST
+        if (pl->GetSession()->GetSecurity() > AccountTypes(sWorld.getConfig(CONFIG_UINT32_GM_LEVEL_IN_WHO_LIST)))
+            return false;
+    }
+
+    // do not process players which are not in world
+    if (!pl->IsInWorld())
+        return false;
+
+    if (entry.level < query.levelMin || entry.level > query.levelMax)
+        return false;
+
+    if (!(query.classMask & (1 << entry.classId)) || !(query.raceMask & (1 << entry.race)))
+        return false;
+
+    if (!query.playerName.empty() && entry.wname.find(query.playerName) == std::wstring::npos)
+        return false;
+
+    if (!query.guildName.empty() && entry.wguildName.find(query.guildName) == std::wstring::npos)
+        return false;
+
+    // World of Warcraft Client Patch 1.7.0 (2005-09-13)
+    // Using the / who command while in a Battleground instance will now only display players in your instance.
+    if (query.zonesCount && entry.zoneId == viewer->GetCachedZoneId() && IsBattleGroundZone(entry.zoneId) &&
+            viewer->GetInstanceId() != pl->GetInstanceId())
+        return false;
+
+    // check if target is globally visible for player
+    if (!pl->IsVisibleGloballyFor(viewer))
+        return false;
+
+    bool hasString = false;
+    for (uint32 i = 0; i < query.stringsCount; ++i)
+    {
+        std::wstring const& str = query.strings[i];
+        if (str.empty())
+            continue;
+        hasString = true;
+
+        if (entry.wguildName.find(str) != std::wstring::npos || entry.wname.find(str) != std::wstring::npos)
+            return true;
+
+        std::map<uint32, std::wstring>::iterator area = areaNames.find(entry.zoneId);
+        if (area == areaNames.end())
+        {
+            std::string aname;
+            if (AreaEntry const* areaEntry = AreaEntry::GetById(entry.zoneId))
+            {
+                aname = areaEntry->Name;
+                sObjectMgr.GetAreaLocaleString(areaEntry->Id, localeIndex, &aname);
+            }
+            area = areaNames.insert(std::make_pair(entry.zoneId, std::wstring())).first;
+            if (Utf8toWStr(aname, area->second))
+                wstrToLower(area->second);
+        }
+        if (area->second.find(str) != std::wstring::npos)
+            return true;
+    }
+    return !hasString;
+}
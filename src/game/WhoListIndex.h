@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2005-2011 MaNGOS <http://getmangos.com/>
+ * Copyright (C) 2009-2011 MaNGOSZero <https://github.com/mangos/zero>
+ * Copyright (C) 2011-2016 Nostalrius <https://nostalrius.org>
+ * Copyright (C) 2016-2017 Elysium Project <https://github.com/elysium-project>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __MANGOS_WHOLISTINDEX_H
+#define __MANGOS_WHOLISTINDEX_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+#include "ByteBuffer.h"
+#include "SharedDefines.h"
+
+#include <unordered_map>
+
+#include <ace/RW_Thread_Mutex.h>
+#include <ace/Thread_Mutex.h>
+
+class Player;
+class WorldSession;
+class WorldPacket;
+
+#define WHO_LIST_MAX_ZONES          10                      // client limit
+#define WHO_LIST_MAX_STRINGS        4                       // client limit
+#define WHO_LIST_MAX_RESULTS        49                      // 50 is maximum player count sent to client
+#define WHO_LIST_LEVEL_BUCKET_SIZE  10
+#define WHO_LIST_LEVEL_BUCKETS      7                       // the last bucket holds all levels above 60
+#define WHO_LIST_MAX_CACHED_ANSWERS 1024
+
+struct WhoListQuery
+{
+    uint32 levelMin, levelMax, raceMask, classMask, zonesCount, stringsCount;
+    uint32 zoneIds[WHO_LIST_MAX_ZONES];
+    std::wstring strings[WHO_LIST_MAX_STRINGS];             // lowercased
+    std::wstring playerName, guildName;                     // lowercased
+};
+
+/**
+ * Online players as listed by /who.
+ *
+ * Kept up to date on login, logout, level, zone and guild change. Names are
+ * stored already lowercased, and players are bucketed by team and level range,
+ * and by zone, so that a query only visits the players which may match it.
+ * The answers are cached for WhoList.CacheDelay ms, so addons spamming the
+ * same request do not walk the index again.
+ *
+ * Queries run in the world async tasks while the maps are updated, and the
+ * maps update levels and zones: everything here is locked.
+ */
+class WhoListIndex
+{
+    public:
+        void AddPlayer(Player* player);
+        void RemovePlayer(Player* player);
+        void UpdateLevel(Player* player);
+        void UpdateZone(Player* player);
+        void UpdateGuild(Player* player);
+        /// Guild::Create adds the members before GuildMgr knows the guild: called once it does
+        void UpdateGuildName(uint32 guildId, std::string const& guildName);
+
+        /// Fills the SMSG_WHO answer to $query for the player of $session
+        void BuildWhoList(WorldSession* session, WhoListQuery const& query, WorldPacket& data);
+
+    private:
+        struct Entry
+        {
+            Player* player;
+            std::string name, guildName;
+            std::wstring wname, wguildName;                 // lowercased
+            uint32 level, zoneId, guildId;
+            uint8 race, classId, teamId;
+        };
+        // Guid low of the players, sorted so that the answers are stable
+        typedef std::set<uint32> Bucket;
+        typedef std::unordered_map<uint32, Entry> EntryMap;
+
+        struct CachedAnswer
+        {
+            uint32 time;
+            ByteBuffer data;
+        };
+        typedef std::map<std::string, CachedAnswer> AnswerCache;
+
+        static uint32 GetLevelBucket(uint32 level) { return std::min<uint32>(level / WHO_LIST_LEVEL_BUCKET_SIZE, WHO_LIST_LEVEL_BUCKETS - 1); }
+        static void SetNames(Entry& entry, std::string const& name, std::string const& guildName);
+        static std::string BuildCacheKey(WorldSession* session, WhoListQuery const& query);
+        static bool IsBattleGroundZone(uint32 zoneId) { return zoneId == 2597 || zoneId == 3277 || zoneId == 3358; }
+
+        void Link(uint32 guid, Entry const& entry);
+        void Unlink(uint32 guid, Entry const& entry);
+        void FillWhoList(WorldSession* session, WhoListQuery const& query, WorldPacket& data) const;
+        bool MatchEntry(Player* viewer, WhoListQuery const& query, Entry const& entry, int32 localeIndex, std::map<uint32, std::wstring>& areaNames) const;
+
+        EntryMap m_entries;
+        Bucket m_levelBuckets[TEAM_NEUTRAL][WHO_LIST_LEVEL_BUCKETS];
+        std::unordered_map<uint32, Bucket> m_zoneBuckets;
+        mutable ACE_RW_Thread_Mutex m_lock;
+
+        AnswerCache m_cache;
+        ACE_Thread_Mutex m_cacheLock;
+};
+
+#define sWhoListIndex MaNGOS::Singleton<WhoListIndex>::Instance()
+
+#endif
@@ -70,6 +70,7 @@
 #include "AutoTesting/AutoTestingMgr.h"
 #include "Transports/TransportMgr.h"
 #include "PlayerBotMgr.h"
+#include "PlayerDump.h"
 #include "ProgressBar.h"
 #include "ZoneScriptMgr.h"
 #include "CharacterDatabaseCache.h"
@@ -184,6 +185,7 @@ void World::Shutdown()
 {
     sWorld.KickAll();                                       // save and kick all players
     sWorld.UpdateSessions( 1 );                             // real players unload required UpdateSessions call
+    PlayerDumpWriter::WaitBulkWrite();
     if (m_charDbWorkerThread)
         m_charDbWorkerThread->wait();
 }
@@ -605,6 +607,7 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_INTERACTION_MAIL,    "AllowTwoSide.Interaction.Mail", false);
     setConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_WHO_LIST,            "AllowTwoSide.WhoList", false);
     setConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_ADD_FRIEND,          "AllowTwoSide.AddFriend", false);
+    setConfig(CONFIG_UINT32_WHO_LIST_CACHE_DELAY,             "WhoList.CacheDelay", 2000);
 
     setConfig(CONFIG_UINT32_STRICT_PLAYER_NAMES,  "StrictPlayerNames",  0);
     setConfig(CONFIG_UINT32_STRICT_CHARTER_NAMES, "StrictCharterNames", 0);
@@ -621,6 +624,8 @@ void World::LoadConfigSettings(bool reload)
     // must be after CONFIG_UINT32_CHARACTERS_PER_REALM
     setConfigMin(CONFIG_UINT32_CHARACTERS_PER_ACCOUNT, "CharactersPerAccount", 50, getConfig(CONFIG_UINT32_CHARACTERS_PER_REALM));
 
+    setConfig(CONFIG_UINT32_CHARACTER_ENUM_CACHE_SIZE, "CharacterEnumCache.Size", 5000);
+
     setConfigMinMax(CONFIG_UINT32_SKIP_CINEMATICS, "SkipCinematics", 0, 0, 2);
 
     if (configNoReload(reload, CONFIG_UINT32_MAX_PLAYER_LEVEL, "MaxPlayerLevel", DEFAULT_MAX_LEVEL))
@@ -647,6 +652,7 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_UINT32_MAX_SPELL_CASTS_IN_CHAIN, "MaxSpellCastsInChain", 10);
     setConfig(CONFIG_UINT32_INSTANCE_RESET_TIME_HOUR, "Instance.ResetTimeHour", 4);
     setConfig(CONFIG_UINT32_INSTANCE_UNLOAD_DELAY,    "Instance.UnloadDelay", 30 * MINUTE * IN_MILLISECONDS);
+    setConfig(CONFIG_UINT32_INSTANCE_POOL_SIZE,       "Instance.PoolSize", 0);
 
     setConfig(CONFIG_UINT32_MAX_PRIMARY_TRADE_SKILL, "MaxPrimaryTradeSkill", 2);
     setConfigMinMax(CONFIG_UINT32_MIN_PETITION_SIGNS, "MinPetitionSigns", 9, 0, 9);
@@ -702,6 +708,7 @@ void World::LoadConfigSettings(bool reload)
     }
 
     setConfig(CONFIG_BOOL_SAVE_RESPAWN_TIME_IMMEDIATELY, "SaveRespawnTimeImmediately", true);
+    setConfig(CONFIG_UINT32_INTERVAL_RESPAWN_TIMES_FLUSH, "SaveRespawnTimeFlushInterval", 10000);
     setConfig(CONFIG_BOOL_WEATHER, "ActivateWeather", true);
 
     setConfig(CONFIG_BOOL_ALWAYS_MAX_SKILL_FOR_LEVEL, "AlwaysMaxSkillForLevel", false);
@@ -788,6 +795,7 @@ void World::LoadConfigSettings(bool reload)
 
     m_relocation_ai_notify_delay = sConfig.GetIntDefault("Visibility.AIRelocationNotifyDelay", 1000u);
     m_relocation_lower_limit_sq  = pow(sConfig.GetFloatDefault("Visibility.RelocationLowerLimit", 10), 2);
+    setConfig(CONFIG_UINT32_VISIBILITY_FULL_UPDATE_INTERVAL, "Visibility.FullUpdateInterval", 5000);
 
     m_VisibleUnitGreyDistance = sConfig.GetFloatDefault("Visibility.Distance.Grey.Unit", 1);
     if (m_VisibleUnitGreyDistance >  MAX_VISIBILITY_DISTANCE)
@@ -952,6 +960,8 @@ void World::LoadNostalriusConfig(bool reload)
     setConfigMinMax(CONFIG_UINT32_MAPUPDATE_UPDATE_PLAYERS_DIFF,        "MapUpdate.UpdatePlayersDiff", 100, 1, 10000);
     setConfigMinMax(CONFIG_UINT32_MAPUPDATE_UPDATE_CELLS_DIFF,          "MapUpdate.UpdateCellsDiff", 100, 1, 10000);
     setConfigMinMax(CONFIG_UINT32_INACTIVE_PLAYERS_SKIP_UPDATES,        "Continents.InactivePlayers.SkipUpdates", 0, 0, 100);
+    setConfigMinMax(CONFIG_UINT32_IDLE_OBJECTS_SKIP_UPDATES,            "Continents.IdleObjects.SkipUpdates", 0, 0, 100);
+    setConfigMinMax(CONFIG_UINT32_IDLE_OBJECTS_NEAR_DISTANCE,           "Continents.IdleObjects.NearDistance", 60, 0, 533);
     setConfig(CONFIG_UINT32_MAPUPDATE_TICK_LOWER_GRID_ACTIVATION_DISTANCE,      "MapUpdate.ReduceGridActivationDist.Tick", 0);
     setConfig(CONFIG_UINT32_MAPUPDATE_TICK_INCREASE_GRID_ACTIVATION_DISTANCE,   "MapUpdate.IncreaseGridActivationDist.Tick", 0);
     setConfig(CONFIG_UINT32_MAPUPDATE_MIN_GRID_ACTIVATION_DISTANCE,             "MapUpdate.MinGridActivationDistance", 0);
@@ -978,6 +988,7 @@ void World::LoadNostalriusConfig(bool reload)
     setConfig(CONFIG_UINT32_PERFLOG_SLOW_UNIQUE_SESSION_UPDATE, "PerformanceLog.SlowUniqueSessionUpdate", 20);
     setConfig(CONFIG_UINT32_PERFLOG_SLOW_PACKET,                "PerformanceLog.SlowPackets", 20);
     setConfig(CONFIG_UINT32_PERFLOG_SLOW_MAP_PACKETS,           "PerformanceLog.SlowMapPackets", 60);
+    setConfig(CONFIG_UINT32_PERFLOG_SLOW_MAP_SCRIPTS,           "PerformanceLog.SlowMapScripts", 20);
     setConfig(CONFIG_UINT32_PERFLOG_SLOW_SESSIONS_UPDATE,       "PerformanceLog.SlowSessionsUpdate", 0);
     setConfig(CONFIG_UINT32_PERFLOG_SLOW_PACKET_BCAST,          "PerformanceLog.SlowPacketBroadcast", 0);
     setConfig(CONFIG_UINT32_CONTINENTS_MOTIONUPDATE_THREADS,                "Continents.MotionUpdate.Threads", 0);
@@ -1171,6 +1182,9 @@ void World::SetInitialWorldSettings()
     if (!isMapServer)
     {
         ///- Clean up and pack instances
+        sLog.outString("Replaying respawn times journal...");
+        sMapPersistentStateMgr.ReplayRespawnJournal();          // must be called before instances cleanup and packing
+
         sLog.outString("Cleaning up instances...");
         sMapPersistentStateMgr.CleanupInstances();              // must be called before `creature_respawn`/`gameobject_respawn` tables
 
@@ -1825,6 +1839,9 @@ void World::Update(uint32 diff)
     if (getConfig(CONFIG_UINT32_PERFLOG_SLOW_MAPSYSTEM_UPDATE) && updateMapSystemTime > getConfig(CONFIG_UINT32_PERFLOG_SLOW_MAPSYSTEM_UPDATE))
         sLog.out(LOG_PERFORMANCE, "Update map system: %ums [%ums for async]", updateMapSystemTime, WorldTimer::getMSTimeDiffToNow(asyncWaitBegin));
 
+    ///- Load the next queued character dumps (.pdump bulkload), the maps are not updated here
+    PlayerDumpReader::UpdateBulkLoad();
+
     ///- Sauvegarde des variables internes (table variables) : MaJ par rapport a la DB
     if (m_timers[WUPDATE_SAVE_VAR].Passed())
     {
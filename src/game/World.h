@@ -116,6 +116,8 @@ enum eConfigUInt32Values
     CONFIG_UINT32_AV_MIN_PLAYERS_IN_QUEUE,
     CONFIG_UINT32_AV_INITIAL_MAX_PLAYERS,
     CONFIG_UINT32_INACTIVE_PLAYERS_SKIP_UPDATES,
+    CONFIG_UINT32_IDLE_OBJECTS_SKIP_UPDATES,
+    CONFIG_UINT32_IDLE_OBJECTS_NEAR_DISTANCE,
     CONFIG_UINT32_ITEM_INSTANTSAVE_QUALITY,
     CONFIG_UINT32_WHISP_DIFF_ZONE_MIN_LEVEL,
     CONFIG_UINT32_CHANNEL_INVITE_MIN_LEVEL,
@@ -155,6 +157,7 @@ enum eConfigUInt32Values
     CONFIG_UINT32_PERFLOG_SLOW_ASYNC_QUERIES,
     CONFIG_UINT32_PERFLOG_SLOW_PACKET,
     CONFIG_UINT32_PERFLOG_SLOW_MAP_PACKETS,
+    CONFIG_UINT32_PERFLOG_SLOW_MAP_SCRIPTS,
     CONFIG_UINT32_PERFLOG_SLOW_PACKET_BCAST,
     CONFIG_UINT32_ASYNC_QUERIES_TICK_TIMEOUT,
     CONFIG_UINT32_LOGIN_PER_TICK,
@@ -168,9 +171,11 @@ enum eConfigUInt32Values
     CONFIG_UINT32_MAP_OBJECTSUPDATE_TIMEOUT,
     CONFIG_UINT32_MAP_VISIBILITYUPDATE_THREADS,
     CONFIG_UINT32_MAP_VISIBILITYUPDATE_TIMEOUT,
+    CONFIG_UINT32_VISIBILITY_FULL_UPDATE_INTERVAL,
     CONFIG_UINT32_INTERVAL_SAVE,
     CONFIG_UINT32_INTERVAL_GRIDCLEAN,
     CONFIG_UINT32_INTERVAL_MAPUPDATE,
+    CONFIG_UINT32_INTERVAL_RESPAWN_TIMES_FLUSH,
     CONFIG_UINT32_INTERVAL_CHANGEWEATHER,
     CONFIG_UINT32_PORT_WORLD,
     CONFIG_UINT32_GAME_TYPE,
@@ -184,6 +189,7 @@ enum eConfigUInt32Values
     CONFIG_UINT32_CHARACTERS_CREATING_DISABLED,
     CONFIG_UINT32_CHARACTERS_PER_ACCOUNT,
     CONFIG_UINT32_CHARACTERS_PER_REALM,
+    CONFIG_UINT32_CHARACTER_ENUM_CACHE_SIZE,
     CONFIG_UINT32_SKIP_CINEMATICS,
     CONFIG_UINT32_MAX_PLAYER_LEVEL,
     CONFIG_UINT32_START_PLAYER_LEVEL,
@@ -193,6 +199,7 @@ enum eConfigUInt32Values
     CONFIG_UINT32_MIN_HONOR_KILLS,
     CONFIG_UINT32_INSTANCE_RESET_TIME_HOUR,
     CONFIG_UINT32_INSTANCE_UNLOAD_DELAY,
+    CONFIG_UINT32_INSTANCE_POOL_SIZE,
     CONFIG_UINT32_MAX_SPELL_CASTS_IN_CHAIN,
     CONFIG_UINT32_MAX_PRIMARY_TRADE_SKILL,
     CONFIG_UINT32_MIN_PETITION_SIGNS,
@@ -203,6 +210,7 @@ enum eConfigUInt32Values
     CONFIG_UINT32_GM_WISPERING_TO,
     CONFIG_UINT32_GM_LEVEL_IN_GM_LIST,
     CONFIG_UINT32_GM_LEVEL_IN_WHO_LIST,
+    CONFIG_UINT32_WHO_LIST_CACHE_DELAY,
     CONFIG_UINT32_START_GM_LEVEL,
     CONFIG_UINT32_GROUP_VISIBILITY,
     CONFIG_UINT32_MAIL_DELIVERY_DELAY,
@@ -36,6 +36,7 @@
 struct ItemPrototype;
 struct AuctionEntry;
 struct AuctionHouseEntry;
+struct CharacterEnumData;
 
 class ObjectGuid;
 class Creature;
@@ -544,6 +545,7 @@ class MANGOS_DLL_SPEC WorldSession
         void HandleCharCreateOpcode(WorldPacket& recvPacket);
         void HandlePlayerLoginOpcode(WorldPacket& recvPacket);
         void HandleCharEnum(QueryResult * result);
+        void SendCharEnum(std::vector<CharacterEnumData> const& characters);
         void HandlePlayerLogin(LoginQueryHolder * holder);
 
         // played time
@@ -36,6 +36,7 @@
 #include "MapManager.h"
 #include "Player.h"
 #include "Chat.h"
+#include "CharacterEnumCache.h"
 
 #include <iterator>
 
@@ -325,6 +326,7 @@ void ChatHandler::HandleCharacterDeletedRestoreHelper(DeletedInfo const& delInfo
 
     CharacterDatabase.PExecute("UPDATE characters SET name='%s', account='%u', deleteDate=NULL, deleteInfos_Name=NULL, deleteInfos_Account=NULL WHERE deleteDate IS NOT NULL AND guid = %u",
         delInfo.name.c_str(), delInfo.accountId, delInfo.lowguid);
+    sCharacterEnumCache.InvalidateAccount(delInfo.accountId);
 }
 
 /**
@@ -412,6 +412,9 @@ int Master::Run()
         sWorldSocketMgr->SetThreads(sConfig.GetIntDefault("Network.Threads", 1) + 1);
         sWorldSocketMgr->SetInterval(sConfig.GetIntDefault("Network.Interval", 10));
         sWorldSocketMgr->SetTcpNodelay(sConfig.GetBoolDefault("Network.TcpNodelay", true));
+        sWorldSocketMgr->SetTcpCork(sConfig.GetBoolDefault("Network.TcpCork", false));
+        sWorldSocketMgr->SetFlushPolicy(sConfig.GetIntDefault("Network.FlushDelay", 0), sConfig.GetIntDefault("Network.FlushBytes", 4096));
+        sWorldSocketMgr->SetCpuAffinity(sConfig.GetIntDefault("Network.CpuAffinity", 0));
 
         if (sWorldSocketMgr->StartNetwork(wsport, bind_ip) == -1)
         {
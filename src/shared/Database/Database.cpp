@@ -120,7 +120,7 @@ bool SqlConnection::Initialize(const char *infoString)
 
 bool SqlConnection::ExecuteStmt(int nIndex, const SqlStmtParameters& id )
 {
-    if(nIndex == -1)
+    if(nIndex == -1 || IsTransactionLost())
         return false;
 
     //get prepared statement object
@@ -154,6 +154,13 @@ bool Database::Initialize(const char * infoString, int nConns /*= 1*/, int nWork
 
     m_pingIntervallms = sConfig.GetIntDefault ("MaxPingTime", 30) * (MINUTE * 1000);
 
+    m_groupCommitMaxStatements = sConfig.GetIntDefault("Database.GroupCommit.MaxStatements", 64);
+    m_groupCommitMaxLatency = sConfig.GetIntDefault("Database.GroupCommit.MaxLatency", 20);
+#ifdef DO_POSTGRESQL
+    // A failing statement aborts the whole PostgreSQL transaction
+    m_groupCommitMaxStatements = 1;
+#endif
+
     //create DB connections
 
     //setup connection pool size
@@ -227,12 +234,14 @@ bool Database::InitDelayThread(int i, std::string const& infoString)
     SqlConnection* threadConnection = CreateConnection();
     if(!threadConnection->Initialize(infoString.c_str()))
         return false;
+
+    // The worker polls its serial queue as soon as it starts
+    m_serialDelayQueue[i] = new SqlQueue();
+
     m_threadsBodies[i] = new SqlDelayThread(this, threadConnection, i);
     m_threadsBodies[i]->incReference();
     m_delayThreads[i] = new ACE_Based::Thread(m_threadsBodies[i]);
 
-    m_serialDelayQueue[i] = new SqlQueue();
-
     return true;
 }
 
@@ -552,7 +561,7 @@ void Database::AddToSerialDelayQueue(SqlOperation *op)
     // TODO: Load balance, must maintain mapping of serial ID so queries are
     // executed sequentially, however
     int worker = op->GetSerialId() % m_numAsyncWorkers;
-    m_serialDelayQueue[worker]->add(op);
+    AddToSerialDelayQueue(worker, op);
 }
 
 bool Database::NextSerialDelayedOperation(int workerId, SqlOperation*& op)
@@ -738,3 +747,61 @@ void Database::TransHelper::reset()
         m_pTrans = NULL;
     }
 }
+
+void Database::NotifyDelayThreads(bool all)
+{
+    // Seen after our add: a worker registers itself before checking the queues
+    if (!m_delayWaiters)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_delayWakeLock);
+    }
+    // Serial operations belong to one worker, wake them all to reach it
+    if (all)
+        m_delayWakeCondition.notify_all();
+    else
+        m_delayWakeCondition.notify_one();
+}
+
+void Database::WakeDelayThreads()
+{
+    std::lock_guard<std::mutex> lock(m_delayWakeLock);
+    m_delayWakeCondition.notify_all();
+}
+
+void Database::WaitForDelayedOperation(SqlDelayThread const* thread, int workerId, uint32 timeoutMs)
+{
+    std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    std::unique_lock<std::mutex> lock(m_delayWakeLock);
+    ++m_delayWaiters;
+    while (thread->IsRunning() && !HasDelayedOperation(workerId))
+        if (m_delayWakeCondition.wait_until(lock, until) == std::cv_status::timeout)
+            break;
+    --m_delayWaiters;
+}
+
+bool Database::HasDelayedOperation(int workerId)
+{
+    if (!m_delayQueue->empty())
+        return true;
+
+    return m_serialDelayQueue && workerId < m_numAsyncWorkers && !m_serialDelayQueue[workerId]->empty();
+}
+
+uint32 Database::GetDelayedOperationsCount(int workerId)
+{
+    uint32 count = m_delayQueue->size();
+    if (m_serialDelayQueue && workerId < m_numAsyncWorkers)
+        count += m_serialDelayQueue[workerId]->size();
+    return count;
+}
+
+SqlDelayStats const* Database::GetDelayThreadStats(uint32 workerId) const
+{
+    if (!m_threadsBodies || workerId >= m_numAsyncWorkers)
+        return NULL;
+
+    return &m_threadsBodies[workerId]->GetStats();
+}
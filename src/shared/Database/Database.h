@@ -31,6 +31,10 @@
 #include <ace/Atomic_Op.h>
 #include "SqlPreparedStatement.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
 class SqlTransaction;
 class SqlResultQueue;
 class SqlQueryHolder;
@@ -67,6 +71,9 @@ class MANGOS_DLL_SPEC SqlConnection
         virtual bool CommitTransaction() { return true; }
         // can't rollback without transaction support
         virtual bool RollbackTransaction() { return true; }
+        // true once the server ended the open transaction (deadlock, lost connection):
+        // nothing more is executed until it is committed (which fails) or rolled back
+        virtual bool IsTransactionLost() const { return false; }
 
         //methods to work with prepared statements
         bool ExecuteStmt(int nIndex, const SqlStmtParameters& id);
@@ -247,12 +254,24 @@ class MANGOS_DLL_SPEC Database
         //you should call it explicitly after your server successfully started up
         //NO ASYNC TRANSACTIONS DURING SERVER STARTUP - ONLY DURING RUNTIME!!!
         void AllowAsyncTransactions() { m_bAllowAsyncTransactions = true; }
-        inline void AddToDelayQueue(SqlOperation* op) { m_delayQueue->add(op); }
+        inline void AddToDelayQueue(SqlOperation* op) { m_delayQueue->add(op); NotifyDelayThreads(false); }
         inline bool NextDelayedOperation(SqlOperation*& op) { return m_delayQueue->next(op); }
 
-        inline void AddToSerialDelayQueue(int workerId, SqlOperation *op) { m_serialDelayQueue[workerId]->add(op); }
+        inline void AddToSerialDelayQueue(int workerId, SqlOperation *op) { m_serialDelayQueue[workerId]->add(op); NotifyDelayThreads(true); }
         bool NextSerialDelayedOperation(int workerId, SqlOperation*& op);
 
+        // Delay threads sleep here until work is queued for them
+        void WaitForDelayedOperation(SqlDelayThread const* thread, int workerId, uint32 timeoutMs);
+        void WakeDelayThreads();
+        bool HasDelayedOperation(int workerId);
+        uint32 GetDelayedOperationsCount(int workerId);
+
+        uint32 GetGroupCommitMaxStatements() const { return m_groupCommitMaxStatements; }
+        uint32 GetGroupCommitMaxLatency() const { return m_groupCommitMaxLatency; }
+
+        uint32 GetAsyncWorkersCount() const { return m_numAsyncWorkers; }
+        SqlDelayStats const* GetDelayThreadStats(uint32 workerId) const;
+
         bool HasAsyncQuery();
 
         void AddToSerialDelayQueue(SqlOperation *op);
@@ -262,7 +281,7 @@ class MANGOS_DLL_SPEC Database
     protected:
         Database() : m_pAsyncConn(NULL), m_pResultQueue(NULL), m_threadsBodies(NULL), m_delayThreads(NULL), m_numAsyncWorkers(0),
             m_serialDelayQueue(NULL), m_delayQueue(new SqlQueue()), m_logSQL(false), m_pingIntervallms(0), m_nQueryConnPoolSize(1),
-            m_bAllowAsyncTransactions(false), m_iStmtIndex(-1)
+            m_bAllowAsyncTransactions(false), m_iStmtIndex(-1), m_delayWaiters(0), m_groupCommitMaxStatements(1), m_groupCommitMaxLatency(0)
         {
             m_nQueryCounter = -1;
         }
@@ -326,6 +345,15 @@ class MANGOS_DLL_SPEC Database
         SqlDelayThread**    m_threadsBodies;                  ///< Pointer to delay sql executer (owned by m_delayThread)
         ACE_Based::Thread** m_delayThreads;                   ///< Pointer to executer thread
 
+        void NotifyDelayThreads(bool all);
+
+        std::mutex m_delayWakeLock;
+        std::condition_variable m_delayWakeCondition;
+        std::atomic<uint32> m_delayWaiters;                  ///< Delay threads sleeping, producers skip the notify when 0
+
+        uint32 m_groupCommitMaxStatements;
+        uint32 m_groupCommitMaxLatency;
+
         bool m_bAllowAsyncTransactions;                      ///< flag which specifies if async transactions are enabled
 
         //PREPARED STATEMENT REGISTRY
@@ -165,10 +165,20 @@ bool MySQLConnection::HandleMySQLError(uint32 errNo)
         case CR_SERVER_LOST_EXTENDED:
         {
             mysql_close(mMysql);
+            // The transaction is lost with the connection: retrying the statement alone would commit it
+            if (m_inTransaction)
+            {
+                m_transactionLost = true;
+                Reconnect();
+                return false;
+            }
             return Reconnect();
         }
 
         case ER_LOCK_DEADLOCK:
+            // The server rolled back the whole transaction
+            if (m_inTransaction)
+                m_transactionLost = true;
             return false;
         // Query related errors - skip query
         case ER_WRONG_VALUE_COUNT:
@@ -273,7 +283,7 @@ QueryNamedResult* MySQLConnection::QueryNamed(const char *sql)
 
 bool MySQLConnection::Execute(const char* sql)
 {
-    if (!mMysql)
+    if (!mMysql || m_transactionLost)
         return false;
 
     uint32 _s = WorldTimer::getMSTime();
@@ -314,19 +324,49 @@ bool MySQLConnection::_TransactionCmd(const char *sql)
 
 bool MySQLConnection::BeginTransaction()
 {
-    return _TransactionCmd("START TRANSACTION");
+    m_inTransaction = _TransactionCmd("START TRANSACTION");
+    m_transactionLost = false;
+    return m_inTransaction;
 }
 
 bool MySQLConnection::CommitTransaction()
 {
+    bool lost = m_transactionLost;
+    m_inTransaction = false;
+    m_transactionLost = false;
+    if (lost)
+    {
+        _TransactionCmd("ROLLBACK");
+        return false;
+    }
     return _TransactionCmd("COMMIT");
 }
 
 bool MySQLConnection::RollbackTransaction()
 {
+    m_inTransaction = false;
+    m_transactionLost = false;
     return _TransactionCmd("ROLLBACK");
 }
 
+void MySQLConnection::HandleStatementError(uint32 errNo)
+{
+    // Prepared statements are not retried: only remember that the transaction is gone
+    if (!m_inTransaction)
+        return;
+
+    switch (errNo)
+    {
+        case CR_SERVER_GONE_ERROR:
+        case CR_SERVER_LOST:
+        case CR_INVALID_CONN_HANDLE:
+        case CR_SERVER_LOST_EXTENDED:
+        case ER_LOCK_DEADLOCK:
+            m_transactionLost = true;
+            break;
+    }
+}
+
 unsigned long MySQLConnection::escape_string(char *to, const char *from, unsigned long length)
 {
     if (!mMysql || !to || !from || !length)
@@ -495,6 +535,7 @@ bool MySqlPreparedStatement::execute()
     {
         sLog.outError("SQL: cannot execute '%s'", m_szFmt.c_str());
         sLog.outError("SQL ERROR: %s", mysql_stmt_error(m_stmt));
+        static_cast<MySQLConnection&>(m_pConn).HandleStatementError(mysql_stmt_errno(m_stmt));
         return false;
     }
 
@@ -72,12 +72,13 @@ private:
 class MANGOS_DLL_SPEC MySQLConnection : public SqlConnection
 {
     public:
-        MySQLConnection(Database& db) : SqlConnection(db), mMysql(NULL) {}
+        MySQLConnection(Database& db) : SqlConnection(db), mMysql(NULL), m_inTransaction(false), m_transactionLost(false) {}
         ~MySQLConnection();
 
         bool OpenConnection(bool reconnect);
         bool Reconnect();
         bool HandleMySQLError(uint32 errNo);
+        void HandleStatementError(uint32 errNo);
 
         QueryResult* Query(const char *sql);
         QueryNamedResult* QueryNamed(const char *sql);
@@ -88,6 +89,7 @@ class MANGOS_DLL_SPEC MySQLConnection : public SqlConnection
         bool BeginTransaction();
         bool CommitTransaction();
         bool RollbackTransaction();
+        bool IsTransactionLost() const { return m_transactionLost; }
 
     protected:
         SqlPreparedStatement * CreateStatement(const std::string& fmt);
@@ -97,6 +99,8 @@ class MANGOS_DLL_SPEC MySQLConnection : public SqlConnection
         bool _Query(const char *sql, MYSQL_RES **pResult, MYSQL_FIELD **pFields, uint64* pRowCount, uint32* pFieldCount);
 
         MYSQL *mMysql;
+        bool m_inTransaction;
+        bool m_transactionLost;
 };
 
 class MANGOS_DLL_SPEC DatabaseMysql : public Database
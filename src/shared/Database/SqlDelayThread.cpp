@@ -22,9 +22,28 @@
 #include "Database/SqlDelayThread.h"
 #include "Database/SqlOperations.h"
 #include "DatabaseEnv.h"
+#include "Timer.h"
+
+SqlDelayHistogram::SqlDelayHistogram()
+{
+    for (uint32 i = 0; i < SQL_DELAY_HISTOGRAM_BUCKETS; ++i)
+        buckets[i] = 0;
+}
+
+void SqlDelayHistogram::Add(uint32 value)
+{
+    uint32 bucket = 0;
+    while (value && bucket < SQL_DELAY_HISTOGRAM_BUCKETS - 1)
+    {
+        value >>= 1;
+        ++bucket;
+    }
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
 
 SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn, int workerId)
-    : m_dbEngine(db), m_dbConnection(conn), m_running(true), m_workerId(workerId)
+    : m_dbEngine(db), m_dbConnection(conn), m_running(true), m_workerId(workerId),
+      m_groupStatements(0), m_groupStartTime(0)
 {
 }
 
@@ -41,22 +60,21 @@ void SqlDelayThread::run()
     mysql_thread_init();
     #endif
 
-    const uint32 loopSleepms = 10;
-
-    const uint32 pingEveryLoop = m_dbEngine->GetPingIntervall() / loopSleepms;
-
-    uint32 loopCounter = 0;
+    uint32 lastPing = WorldTimer::getMSTime();
     while (m_running)
     {
+        // Sleeps until an operation is queued for us, or it is time to ping
+        uint32 sincePing = WorldTimer::getMSTimeDiffToNow(lastPing);
+        if (sincePing < m_dbEngine->GetPingIntervall())
+            m_dbEngine->WaitForDelayedOperation(this, m_workerId, m_dbEngine->GetPingIntervall() - sincePing);
+
         // if the running state gets turned off while sleeping
         // empty the queue before exiting
-        ACE_Based::Thread::Sleep(loopSleepms);
-
         ProcessRequests();
 
-        if((loopCounter++) >= pingEveryLoop)
+        if (WorldTimer::getMSTimeDiffToNow(lastPing) >= m_dbEngine->GetPingIntervall())
         {
-            loopCounter = 0;
+            lastPing = WorldTimer::getMSTime();
             m_dbEngine->Ping();
             if (QueryResult* res = m_dbConnection->Query("SELECT 1"))
                 delete res;
@@ -71,21 +89,95 @@ void SqlDelayThread::run()
 void SqlDelayThread::Stop()
 {
     m_running = false;
+    m_dbEngine->WakeDelayThreads();
+}
+
+bool SqlDelayThread::NextRequest(SqlOperation*& op)
+{
+    if (m_dbEngine->NextDelayedOperation(op))
+        return true;
+
+    // Process any serial operations for this worker
+    return m_dbEngine->NextSerialDelayedOperation(m_workerId, op);
 }
 
 void SqlDelayThread::ProcessRequests()
 {
+    m_stats.queueDepth.Add(m_dbEngine->GetDelayedOperationsCount(m_workerId));
+
     SqlOperation* s = NULL;
-    while (m_dbEngine->NextDelayedOperation(s))
+    while (NextRequest(s))
     {
-        s->Execute(m_dbConnection);
-        delete s;
+        ++m_stats.operations;
+
+        uint32 statements = s->GroupSize();
+        if (!statements || m_dbEngine->GetGroupCommitMaxStatements() <= 1)
+        {
+            // Queries and holders do not join a group, and must see previous writes
+            CommitGroup();
+            s->Execute(m_dbConnection);
+            delete s;
+            continue;
+        }
+
+        AddToGroup(s, statements);
     }
 
-    // Process any serial operations for this worker
-    while (m_dbEngine->NextSerialDelayedOperation(m_workerId, s))
+    CommitGroup();
+}
+
+void SqlDelayThread::AddToGroup(SqlOperation* op, uint32 statements)
+{
+    if (m_group.empty())
     {
-        s->Execute(m_dbConnection);
-        delete s;
+        // Kept aside: a lone operation is executed as usual at commit time
+        m_groupStartTime = WorldTimer::getMSTime();
+        m_groupStatements = statements;
+        m_group.push_back(op);
+        return;
     }
+
+    if (m_group.size() == 1)
+    {
+        m_dbConnection->BeginTransaction();
+        m_group.front()->ExecuteGrouped(m_dbConnection);
+    }
+
+    op->ExecuteGrouped(m_dbConnection);
+    m_group.push_back(op);
+    m_groupStatements += statements;
+
+    // Nothing more can be executed in a lost transaction: replay the group now
+    if (m_dbConnection->IsTransactionLost() ||
+        m_groupStatements >= m_dbEngine->GetGroupCommitMaxStatements() ||
+        WorldTimer::getMSTimeDiffToNow(m_groupStartTime) >= m_dbEngine->GetGroupCommitMaxLatency())
+        CommitGroup();
+}
+
+void SqlDelayThread::CommitGroup()
+{
+    if (m_group.empty())
+        return;
+
+    if (m_group.size() == 1)
+        m_group.front()->Execute(m_dbConnection);
+    else if (!m_dbConnection->CommitTransaction())
+    {
+        // Deadlock, lost connection or failed commit: the server dropped the
+        // whole group. Execute each operation alone, as it would have been without grouping.
+        sLog.outError("SqlDelayThread: commit of %u grouped operations failed, executing them one by one", uint32(m_group.size()));
+        m_dbConnection->RollbackTransaction();
+        for (SqlGroup::const_iterator itr = m_group.begin(); itr != m_group.end(); ++itr)
+            (*itr)->Execute(m_dbConnection);
+        ++m_stats.replays;
+    }
+
+    m_stats.batchSize.Add(m_group.size());
+    m_stats.commitLatency.Add(WorldTimer::getMSTimeDiffToNow(m_groupStartTime));
+    ++m_stats.commits;
+
+    for (SqlGroup::const_iterator itr = m_group.begin(); itr != m_group.end(); ++itr)
+        delete *itr;
+    m_group.clear();
+    m_groupStatements = 0;
 }
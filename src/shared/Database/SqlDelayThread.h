@@ -26,32 +26,71 @@
 #include "LockedQueue.h"
 #include "Threading.h"
 
+#include <atomic>
+#include <vector>
 
 class Database;
 class SqlOperation;
 class SqlConnection;
 
+#define SQL_DELAY_HISTOGRAM_BUCKETS 12
+
+// Power of two buckets: 0, 1, 2-3, 4-7 ... the last one counts everything above
+struct SqlDelayHistogram
+{
+    SqlDelayHistogram();
+
+    void Add(uint32 value);
+    uint32 Get(uint32 bucket) const { return buckets[bucket].load(std::memory_order_relaxed); }
+    static uint32 BucketLowerBound(uint32 bucket) { return bucket ? (1 << (bucket - 1)) : 0; }
+
+    std::atomic<uint32> buckets[SQL_DELAY_HISTOGRAM_BUCKETS];
+};
+
+// Written by the worker, read by the GM command thread
+struct SqlDelayStats
+{
+    SqlDelayStats() : operations(0), commits(0), replays(0) {}
+
+    SqlDelayHistogram queueDepth;                           ///< Queued operations when the worker wakes up
+    SqlDelayHistogram batchSize;                            ///< Operations per commit
+    SqlDelayHistogram commitLatency;                        ///< Ms between the first grouped operation and the commit
+    std::atomic<uint32> operations;
+    std::atomic<uint32> commits;
+    std::atomic<uint32> replays;                            ///< Groups executed again one by one after a failed commit
+};
+
 class SqlDelayThread : public ACE_Based::Runnable
 {
-    typedef ACE_Based::LockedQueue<SqlOperation*, ACE_Thread_Mutex> SqlQueue;
+    typedef std::vector<SqlOperation*> SqlGroup;
 
     private:
-        SqlQueue m_sqlQueue;                                ///< Queue of SQL statements
         Database* m_dbEngine;                               ///< Pointer to used Database engine
         SqlConnection * m_dbConnection;                     ///< Pointer to DB connection
         volatile bool m_running;
 
         int m_workerId;
 
+        // Group commit: write operations executed in one transaction
+        SqlGroup m_group;
+        uint32 m_groupStatements;
+        uint32 m_groupStartTime;
+
+        SqlDelayStats m_stats;
+
         //process all enqueued requests
         void ProcessRequests();
+        bool NextRequest(SqlOperation*& op);
+
+        void AddToGroup(SqlOperation* op, uint32 statements);
+        void CommitGroup();
 
     public:
         SqlDelayThread(Database* db, SqlConnection* conn, int workerId);
         ~SqlDelayThread();
 
-        ///< Put sql statement to delay queue
-        bool Delay(SqlOperation* sql) { m_sqlQueue.add(sql); return true; }
+        bool IsRunning() const { return m_running; }
+        SqlDelayStats const& GetStats() const { return m_stats; }
 
         virtual void Stop();                                ///< Stop event
         virtual void run();                                 ///< Main Thread loop
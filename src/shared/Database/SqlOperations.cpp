@@ -52,21 +52,51 @@ bool SqlTransaction::Execute(SqlConnection *conn)
 
     LOCK_DB_CONN(conn);
 
-    conn->BeginTransaction();
+    // Statements are not retried inside a transaction: after a deadlock or a
+    // reconnection, the whole transaction is executed again, once
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+        conn->BeginTransaction();
+
+        bool failed = false;
+        const int nItems = m_queue.size();
+        for (int i = 0; i < nItems && !failed; ++i)
+            failed = !m_queue[i]->Execute(conn);
+
+        bool lost = conn->IsTransactionLost();
+        if (failed)
+            conn->RollbackTransaction();
+        else if (conn->CommitTransaction())
+            return true;
+
+        if (!lost)
+            return false;
+    }
+
+    return false;
+}
+
+bool SqlTransaction::ExecuteGrouped(SqlConnection *conn)
+{
+    if(m_queue.empty())
+        return true;
+
+    LOCK_DB_CONN(conn);
+
+    // Other operations share the transaction: only undo our own statements on failure
+    conn->Execute("SAVEPOINT sql_transaction");
 
     const int nItems = m_queue.size();
     for (int i = 0; i < nItems; ++i)
     {
-        SqlOperation * pStmt = m_queue[i];
-
-        if(!pStmt->Execute(conn))
+        if(!m_queue[i]->Execute(conn))
         {
-            conn->RollbackTransaction();
+            conn->Execute("ROLLBACK TO SAVEPOINT sql_transaction");
             return false;
         }
     }
 
-    return conn->CommitTransaction();
+    return true;
 }
 
 SqlPreparedRequest::SqlPreparedRequest(int nIndex, SqlStmtParameters * arg ) : m_nIndex(nIndex), m_param(arg)
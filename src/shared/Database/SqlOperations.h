@@ -44,6 +44,10 @@ class SqlOperation
         uint32 GetSerialId() const { return serialId; }
         virtual void OnRemove() { delete this; }
         virtual bool Execute(SqlConnection *conn) = 0;
+        // Statements this operation adds to a group commit, 0 if it can not be grouped
+        virtual uint32 GroupSize() const { return 0; }
+        // Executes inside the transaction already opened by the delay thread
+        virtual bool ExecuteGrouped(SqlConnection *conn) { return Execute(conn); }
         virtual ~SqlOperation() {}
 
     protected:
@@ -60,6 +64,7 @@ class SqlPlainRequest : public SqlOperation
         SqlPlainRequest(const char *sql) : m_sql(mangos_strdup(sql)){}
         ~SqlPlainRequest() { char* tofree = const_cast<char*>(m_sql); delete [] tofree; }
         bool Execute(SqlConnection *conn);
+        uint32 GroupSize() const { return 1; }
 };
 
 class SqlTransaction : public SqlOperation
@@ -74,6 +79,8 @@ class SqlTransaction : public SqlOperation
         void DelayExecute(SqlOperation * sql)   {   m_queue.push_back(sql); }
 
         bool Execute(SqlConnection *conn);
+        uint32 GroupSize() const { return m_queue.empty() ? 1 : m_queue.size(); }
+        bool ExecuteGrouped(SqlConnection *conn);
 };
 
 class SqlPreparedRequest : public SqlOperation
@@ -83,6 +90,7 @@ class SqlPreparedRequest : public SqlOperation
         ~SqlPreparedRequest();
 
         bool Execute(SqlConnection *conn);
+        uint32 GroupSize() const { return 1; }
 
     private:
         const int m_nIndex;
@@ -138,6 +138,13 @@ namespace ACE_Based
                 ACE_Guard<LockType> g(this->_lock);
                 return _queue.empty();
             }
+
+            //! Number of queued elements, with locks held
+            size_t size()
+            {
+                ACE_Guard<LockType> g(this->_lock);
+                return _queue.size();
+            }
     };
 }
 #endif